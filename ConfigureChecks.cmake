@@ -119,8 +119,23 @@ endif()
 check_function_exists("getifaddrs"       HAVE_GETIFADDRS)
 check_function_exists("issetugid"        HAVE_ISSETUGID)
 check_function_exists("mkstemps"         HAVE_MKSTEMPS)
+check_function_exists("mmap"             HAVE_MMAP)
 check_function_exists("setresgid"        HAVE_SETRESGID)
 check_function_exists("setresuid"        HAVE_SETRESUID)
+check_function_exists("shm_open"         HAVE_SHM_OPEN)
+if(NOT HAVE_SHM_OPEN AND NOT WIN32)
+	#
+	# Older versions of glibc have shm_open() in librt.
+	#
+	cmake_push_check_state()
+	set(CMAKE_REQUIRED_LIBRARIES rt)
+	check_function_exists("shm_open"         HAVE_SHM_OPEN_IN_LIBRT)
+	cmake_pop_check_state()
+	if(HAVE_SHM_OPEN_IN_LIBRT)
+		set(HAVE_SHM_OPEN 1)
+		set(SHM_OPEN_LIBRARIES rt)
+	endif()
+endif()
 check_function_exists("strptime"         HAVE_STRPTIME)
 if (APPLE)
 	cmake_push_check_state()
@@ -34,6 +34,7 @@ typedef enum {
 
 #include "cfile.h"
 struct _info_data;
+struct _shm_ring;
 /*
  * State of a capture session.
  */
@@ -56,6 +57,9 @@ typedef struct _capture_session {
     Buffer buf;                           /**< Buffer we're reading packet data into */
     struct wtap *wtap;                    /**< current wtap file */
     struct _info_data *cap_data_info;     /**< stats for this capture */
+    struct _shm_ring *shm_ring;           /**< packet ring shared with the capture child, or NULL */
+    GArray   *shm_ring_ifaces;            /**< per-interface record fields for packets from the ring */
+    guint32   shm_ring_packets;           /**< number of packets taken from the ring */
 } capture_session;
 
 extern void
@@ -20,6 +20,7 @@
 #include <signal.h>
 
 #include <wsutil/strtoi.h>
+#include <wsutil/shm_ring.h>
 
 #ifdef _WIN32
 #include <wsutil/unicode-utils.h>
@@ -66,6 +67,8 @@
 
 #include "file.h"
 
+#include <wiretap/pcap-encap.h>
+
 #include "ui/capture.h"
 #include <capchild/capture_sync.h>
 
@@ -99,6 +102,7 @@ static const char *sync_pipe_signame(int);
 
 
 static gboolean sync_pipe_input_cb(gint source, gpointer user_data);
+static void sync_pipe_ring_close(capture_session *cap_session);
 static int sync_pipe_wait_for_child(ws_process_id fork_child, gchar **msgp);
 static void pipe_convert_header(const guchar *header, int header_len, char *indicator, int *block_len);
 static ssize_t pipe_read_block(int pipe_fd, char *indicator, int len, char *msg,
@@ -129,6 +133,9 @@ capture_session_init(capture_session *cap_session, capture_file *cf)
 #endif
     cap_session->count                           = 0;
     cap_session->session_started                 = FALSE;
+    cap_session->shm_ring                        = NULL;
+    cap_session->shm_ring_ifaces                 = NULL;
+    cap_session->shm_ring_packets                = 0;
 }
 
 /* Append an arg (realloc) to an argc/argv array */
@@ -404,6 +411,13 @@ sync_pipe_start(capture_options *capture_opts, capture_session *cap_session, inf
         }
     }
 
+    /*
+     * Have dumpcap also hand us the packets through shared memory; that
+     * only works if they're all going to the one file.
+     */
+    if (capture_opts->use_shm_ring && !capture_opts->multi_files_on)
+        argv = sync_pipe_add_arg(argv, &argc, "--shm-ring");
+
     /* dumpcap should be running in capture child mode (hidden feature) */
 #ifndef DEBUG_CHILD
     argv = sync_pipe_add_arg(argv, &argc, "-Z");
@@ -1647,6 +1661,7 @@ sync_pipe_input_cb(gint source, gpointer user_data)
 #endif
         g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_DEBUG, "sync_pipe_input_cb: cleaning extcap pipe");
         extcap_if_cleanup(cap_session->capture_opts, &primary_msg);
+        sync_pipe_ring_close(cap_session);
         capture_input_closed(cap_session, primary_msg);
         g_free(primary_msg);
         return FALSE;
@@ -1712,6 +1727,19 @@ sync_pipe_input_cb(gint source, gpointer user_data)
         /* the capture child will close the sync_pipe, nothing to do for now */
         break;
         }
+    case SP_SHM_RING: {
+        int err;
+
+        /* The child has set up a shared memory ring with the packets in it. */
+        sync_pipe_ring_close(cap_session);
+        cap_session->shm_ring = shm_ring_open(buffer, &err);
+        cap_session->shm_ring_packets = 0;
+        if (cap_session->shm_ring == NULL) {
+            g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_WARNING,
+                  "Couldn't open packet ring \"%s\": %s", buffer, g_strerror(err));
+        }
+        break;
+        }
     case SP_DROPS: {
         const char *name = NULL;
         const gchar* end;
@@ -2066,6 +2094,171 @@ sync_pipe_kill(ws_process_id fork_child)
     }
 }
 
+/* What we need to know about an interface to make records for its packets */
+typedef struct {
+    int encap;          /* WTAP_ENCAP_ value */
+    int tsprec;         /* WTAP_TSPREC_ value */
+    int fcs_len;        /* FCS length in bytes, or -1 if not known */
+} ring_iface_t;
+
+static void
+sync_pipe_ring_close(capture_session *cap_session)
+{
+    shm_ring_close(cap_session->shm_ring);
+    cap_session->shm_ring = NULL;
+    if (cap_session->shm_ring_ifaces != NULL) {
+        g_array_free(cap_session->shm_ring_ifaces, TRUE);
+        cap_session->shm_ring_ifaces = NULL;
+    }
+}
+
+/*
+ * Get the interfaces in the capture file.  Returns FALSE if packets on
+ * any of them have a pseudo-header that we can only get from the file.
+ */
+static gboolean
+sync_pipe_ring_get_ifaces(capture_session *cap_session, struct wtap *wth)
+{
+    wtapng_iface_descriptions_t *idb_inf;
+    gboolean usable = TRUE;
+    guint i;
+
+    if (cap_session->shm_ring_ifaces == NULL)
+        cap_session->shm_ring_ifaces = g_array_new(FALSE, FALSE, sizeof(ring_iface_t));
+    g_array_set_size(cap_session->shm_ring_ifaces, 0);
+
+    idb_inf = wtap_file_get_idb_info(wth);
+    for (i = 0; i < idb_inf->interface_data->len; i++) {
+        wtap_block_t idb = g_array_index(idb_inf->interface_data, wtap_block_t, i);
+        wtapng_if_descr_mandatory_t *if_descr =
+            (wtapng_if_descr_mandatory_t *)wtap_block_get_mandatory_data(idb);
+        ring_iface_t iface;
+        guint8 fcs_len;
+
+        if (wtap_encap_requires_phdr(if_descr->wtap_encap)) {
+            usable = FALSE;
+            break;
+        }
+        iface.encap = if_descr->wtap_encap;
+        iface.tsprec = if_descr->tsprecision;
+        if (wtap_block_get_uint8_option_value(idb, OPT_IDB_FCSLEN, &fcs_len) == WTAP_OPTTYPE_SUCCESS)
+            iface.fcs_len = fcs_len;
+        else
+            iface.fcs_len = -1;
+        g_array_append_val(cap_session->shm_ring_ifaces, iface);
+    }
+    g_free(idb_inf);
+    return usable;
+}
+
+void
+sync_pipe_ring_accept(capture_session *cap_session, struct wtap *wth)
+{
+    gboolean accept;
+
+    if (cap_session->shm_ring == NULL)
+        return;
+
+    accept = sync_pipe_ring_get_ifaces(cap_session, wth);
+    g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_DEBUG, "sync_pipe_ring_accept: %s the packet ring",
+          accept ? "using" : "not using");
+    shm_ring_accept(cap_session->shm_ring, accept);
+    if (!accept)
+        sync_pipe_ring_close(cap_session);
+}
+
+/*
+ * The ring overflowed; skip the packets we've already taken from it in
+ * the capture file, and read from the file from now on.
+ */
+static void
+sync_pipe_ring_fall_back(capture_session *cap_session, struct wtap *wth,
+                         wtap_rec *rec, Buffer *buf)
+{
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+
+    g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_DEBUG,
+          "sync_pipe_ring_read: ring overflowed after %u packets, reading the capture file",
+          cap_session->shm_ring_packets);
+    sync_pipe_ring_close(cap_session);
+
+    wtap_cleareof(wth);
+    while (cap_session->shm_ring_packets != 0) {
+        if (!wtap_read(wth, rec, buf, &err, &err_info, &data_offset)) {
+            /* The caller's wtap_read() will fail the same way. */
+            g_free(err_info);
+            break;
+        }
+        if (rec->rec_type == REC_TYPE_PACKET)
+            cap_session->shm_ring_packets--;
+    }
+}
+
+gboolean
+sync_pipe_ring_read(capture_session *cap_session, struct wtap *wth,
+                    wtap_rec *rec, Buffer *buf)
+{
+    sp_ring_packet_hdr hdr;
+    const ring_iface_t *iface;
+    const guint8 *data;
+    guint32 len;
+    guint8 *pd;
+
+    if (cap_session->shm_ring == NULL)
+        return FALSE;
+
+    data = shm_ring_peek(cap_session->shm_ring, &len);
+    if (data == NULL) {
+        /*
+         * dumpcap puts every packet into the ring before telling us
+         * about it, so if it isn't there it didn't fit.
+         */
+        sync_pipe_ring_fall_back(cap_session, wth, rec, buf);
+        return FALSE;
+    }
+
+    memcpy(&hdr, data, sizeof hdr);
+    if (len < sizeof hdr || len - sizeof hdr != hdr.caplen) {
+        g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_WARNING, "Bad record in the packet ring");
+        sync_pipe_ring_fall_back(cap_session, wth, rec, buf);
+        return FALSE;
+    }
+    if (hdr.interface_id >= cap_session->shm_ring_ifaces->len) {
+        /* A new interface; find out about it. */
+        if (!sync_pipe_ring_get_ifaces(cap_session, wth) ||
+            hdr.interface_id >= cap_session->shm_ring_ifaces->len) {
+            sync_pipe_ring_fall_back(cap_session, wth, rec, buf);
+            return FALSE;
+        }
+    }
+    iface = &g_array_index(cap_session->shm_ring_ifaces, ring_iface_t, hdr.interface_id);
+
+    rec->rec_type = REC_TYPE_PACKET;
+    rec->presence_flags = WTAP_HAS_TS|WTAP_HAS_CAP_LEN|WTAP_HAS_INTERFACE_ID;
+    rec->ts.secs = (time_t)hdr.ts_secs;
+    rec->ts.nsecs = (int)hdr.ts_nsecs;
+    rec->tsprec = iface->tsprec;
+    rec->opt_comment = NULL;
+    rec->has_comment_changed = FALSE;
+    rec->rec_header.packet_header.caplen = hdr.caplen;
+    rec->rec_header.packet_header.len = hdr.len;
+    rec->rec_header.packet_header.pkt_encap = iface->encap;
+    rec->rec_header.packet_header.interface_id = hdr.interface_id;
+    rec->rec_header.packet_header.drop_count = 0;
+    rec->rec_header.packet_header.pack_flags = 0;
+
+    ws_buffer_assure_space(buf, hdr.caplen);
+    pd = ws_buffer_start_ptr(buf);
+    memcpy(pd, data + sizeof hdr, hdr.caplen);
+    wtap_pcap_fill_in_pseudo_header(iface->encap, iface->fcs_len, rec, pd);
+
+    shm_ring_consume(cap_session->shm_ring);
+    cap_session->shm_ring_packets++;
+    return TRUE;
+}
+
 void capture_sync_set_fetch_dumpcap_pid_cb(void(*cb)(ws_process_id pid)) {
     fetch_dumpcap_pid = cb;
 }
@@ -51,6 +51,38 @@ sync_pipe_stop(capture_session *cap_session);
 extern void
 sync_pipe_kill(ws_process_id fork_child);
 
+/**
+ * Tell the capture child whether we'll take its packets from the shared
+ * memory ring it set up, rather than reading them back from the capture
+ * file. Call after opening the capture file; does nothing if there's no
+ * ring. We decline if any interface's packets need information from the
+ * file to fill in their pseudo-header.
+ *
+ *  @param cap_session the capture session
+ *  @param wth the capture file the child is writing to
+ */
+extern void
+sync_pipe_ring_accept(capture_session *cap_session, struct wtap *wth);
+
+/**
+ * Get the next new packet from the shared memory ring, in place of
+ * calling wtap_read() on the capture file.
+ *
+ * Once the ring has overflowed and we've taken everything that fit, this
+ * skips past the packets we've already taken in wth, so the caller can
+ * carry on reading the file from there.
+ *
+ *  @param cap_session the capture session
+ *  @param wth the capture file the child is writing to
+ *  @param rec filled in with the packet's metadata
+ *  @param buf filled in with the packet's data
+ *  @return TRUE if we got the packet, FALSE if the caller has to read it
+ *  from wth with wtap_read()
+ */
+extern gboolean
+sync_pipe_ring_read(capture_session *cap_session, struct wtap *wth,
+                    wtap_rec *rec, Buffer *buf);
+
 /**
  * Set wireless channel using dumpcap
  *  On success, *data points to a buffer containing the dumpcap output,
@@ -73,6 +73,7 @@
 #include <wsutil/report_message.h>
 #include <wsutil/str_util.h>
 #include <wsutil/file_util.h>
+#include <wsutil/cpu_info.h>
 
 #include <wsutil/wsgcrypt.h>
 
@@ -152,15 +153,10 @@ static gboolean cap_file_hashes    = TRUE;  /* Calculate file hashes */
 
 #define HASH_STR_SIZE (65) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
+#define HASH_MAX_CHUNKS 8   /* chunks being hashed at once, per file */
 
-
-static gchar file_sha256[HASH_STR_SIZE];
-static gchar file_rmd160[HASH_STR_SIZE];
-static gchar file_sha1[HASH_STR_SIZE];
-
-static guint num_ipv4_addresses;
-static guint num_ipv6_addresses;
-static guint num_decryption_secrets;
+/* Most files we work on at once */
+#define MAX_THREADS 16
 
 /*
  * If we have at least two packets with time stamps, and they're not in
@@ -214,8 +210,35 @@ typedef struct _capture_info {
   GArray               *interface_packet_counts;  /* array of per_packet interface_id counts; one entry per file IDB */
   guint32               pkt_interface_id_unknown; /* counts if packet interface_id didn't match a known one */
   GArray               *idb_info_strings;         /* array of IDB info strings */
+
+  guint                 num_ipv4_addresses;
+  guint                 num_ipv6_addresses;
+  guint                 num_decryption_secrets;
+
+  gchar                 file_sha256[HASH_STR_SIZE];
+  gchar                 file_rmd160[HASH_STR_SIZE];
+  gchar                 file_sha1[HASH_STR_SIZE];
+
+  wtap                 *wth;                      /* kept open until reported, for the SHB */
 } capture_info;
 
+/*
+ * Files named on the command line are processed on a pool of threads,
+ * but reported on in the order in which they were given.
+ */
+typedef struct {
+  const char           *filename;
+  capture_info          cf_info;
+  int                   status;
+  gboolean              done;
+} capinfos_job_t;
+
+static GMutex job_mutex;
+static GCond  job_cond;
+
+/* The capture_info being filled in by this thread, for the wiretap callbacks */
+static GPrivate current_cf_info;
+
 static char *decimal_point;
 
 static void
@@ -699,9 +722,9 @@ print_stats(const gchar *filename, capture_info *cf_info)
     }
   }
   if (cap_file_hashes) {
-    printf     ("SHA256:              %s\n", file_sha256);
-    printf     ("RIPEMD160:           %s\n", file_rmd160);
-    printf     ("SHA1:                %s\n", file_sha1);
+    printf     ("SHA256:              %s\n", cf_info->file_sha256);
+    printf     ("RIPEMD160:           %s\n", cf_info->file_rmd160);
+    printf     ("SHA1:                %s\n", cf_info->file_sha1);
   }
   if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
 
@@ -741,14 +764,14 @@ print_stats(const gchar *filename, capture_info *cf_info)
     }
 
     if (cap_file_nrb) {
-      if (num_ipv4_addresses != 0)
-        printf   ("Number of resolved IPv4 addresses in file: %u\n", num_ipv4_addresses);
-      if (num_ipv6_addresses != 0)
-        printf   ("Number of resolved IPv6 addresses in file: %u\n", num_ipv6_addresses);
+      if (cf_info->num_ipv4_addresses != 0)
+        printf   ("Number of resolved IPv4 addresses in file: %u\n", cf_info->num_ipv4_addresses);
+      if (cf_info->num_ipv6_addresses != 0)
+        printf   ("Number of resolved IPv6 addresses in file: %u\n", cf_info->num_ipv6_addresses);
     }
     if (cap_file_dsb) {
-      if (num_decryption_secrets != 0)
-        printf   ("Number of decryption secrets in file: %u\n", num_decryption_secrets);
+      if (cf_info->num_decryption_secrets != 0)
+        printf   ("Number of decryption secrets in file: %u\n", cf_info->num_decryption_secrets);
     }
   }
 }
@@ -966,17 +989,17 @@ print_stats_table(const gchar *filename, capture_info *cf_info)
   if (cap_file_hashes) {
     putsep();
     putquote();
-    printf("%s", file_sha256);
+    printf("%s", cf_info->file_sha256);
     putquote();
 
     putsep();
     putquote();
-    printf("%s", file_rmd160);
+    printf("%s", cf_info->file_rmd160);
     putquote();
 
     putsep();
     putquote();
-    printf("%s", file_sha1);
+    printf("%s", cf_info->file_sha1);
     putquote();
   }
 
@@ -1074,25 +1097,209 @@ cleanup_capture_info(capture_info *cf_info)
 static void
 count_ipv4_address(const guint addr _U_, const gchar *name _U_)
 {
-  num_ipv4_addresses++;
+  capture_info *cf_info = (capture_info *)g_private_get(&current_cf_info);
+
+  cf_info->num_ipv4_addresses++;
 }
 
 static void
 count_ipv6_address(const void *addrp _U_, const gchar *name _U_)
 {
-  num_ipv6_addresses++;
+  capture_info *cf_info = (capture_info *)g_private_get(&current_cf_info);
+
+  cf_info->num_ipv6_addresses++;
 }
 
 static void
 count_decryption_secret(guint32 secrets_type _U_, const void *secrets _U_, guint size _U_)
 {
+  capture_info *cf_info = (capture_info *)g_private_get(&current_cf_info);
+
   /* XXX - count them based on the secrets type (which is an opaque code,
      not a small integer)? */
-  num_decryption_secrets++;
+  cf_info->num_decryption_secrets++;
+}
+
+static void
+hash_to_str(const unsigned char *hash, size_t length, char *str) {
+  int i;
+
+  for (i = 0; i < (int) length; i++) {
+    g_snprintf(str+(i*2), 3, "%02x", hash[i]);
+  }
+}
+
+/*
+ * The file hashes are computed while wiretap is reading the file: a
+ * reader thread reads the raw file and hands each chunk to one thread
+ * per digest, so the three digests are computed at the same time as
+ * each other and as the packet scan, and the file only has to come
+ * off the disk once.
+ */
+#define NUM_HASHES 3
+
+typedef struct _file_hasher file_hasher_t;
+
+typedef struct {
+  file_hasher_t        *hasher;
+  int                   algo;
+  size_t                length;
+  gchar                *result;     /* where the hex string goes */
+  GAsyncQueue          *chunks;     /* GBytes; an empty one marks the end */
+  GThread              *thread;
+} hash_worker_t;
+
+struct _file_hasher {
+  const char           *filename;
+  gboolean              read_ok;    /* set before the end of the data is queued */
+  GThread              *reader;
+  hash_worker_t         workers[NUM_HASHES];
+  GMutex                mutex;
+  GCond                 cond;
+  guint                 chunks_in_flight;
+};
+
+static gpointer
+hash_worker_thread(gpointer data)
+{
+  hash_worker_t *worker = (hash_worker_t *)data;
+  gcry_md_hd_t hd = NULL;
+  GBytes *chunk;
+  gsize chunk_len;
+  gconstpointer chunk_data;
+
+  if (gcry_md_open(&hd, worker->algo, 0) != 0)
+    hd = NULL;
+
+  for (;;) {
+    chunk = (GBytes *)g_async_queue_pop(worker->chunks);
+    chunk_data = g_bytes_get_data(chunk, &chunk_len);
+    if (chunk_len == 0) {
+      g_bytes_unref(chunk);
+      break;
+    }
+    if (hd)
+      gcry_md_write(hd, chunk_data, chunk_len);
+    g_bytes_unref(chunk);
+  }
+
+  if (hd) {
+    if (worker->hasher->read_ok) {
+      gcry_md_final(hd);
+      hash_to_str(gcry_md_read(hd, worker->algo), worker->length, worker->result);
+    }
+    gcry_md_close(hd);
+  }
+  return NULL;
+}
+
+static void
+hash_chunk_free(gpointer data)
+{
+  file_hasher_t *hasher = *(file_hasher_t **)data;
+
+  g_free(data);
+  g_mutex_lock(&hasher->mutex);
+  hasher->chunks_in_flight--;
+  g_cond_signal(&hasher->cond);
+  g_mutex_unlock(&hasher->mutex);
+}
+
+static gpointer
+hash_reader_thread(gpointer data)
+{
+  file_hasher_t *hasher = (file_hasher_t *)data;
+  FILE *fh;
+  guint8 *chunk_buf;
+  size_t hash_bytes;
+  GBytes *chunk;
+  int i;
+
+  fh = ws_fopen(hasher->filename, "rb");
+  if (fh) {
+    for (;;) {
+      /* Don't get too far ahead of the slowest digest. */
+      g_mutex_lock(&hasher->mutex);
+      while (hasher->chunks_in_flight >= HASH_MAX_CHUNKS)
+        g_cond_wait(&hasher->cond, &hasher->mutex);
+      hasher->chunks_in_flight++;
+      g_mutex_unlock(&hasher->mutex);
+
+      /* The hasher pointer goes in front of the data, for hash_chunk_free() */
+      chunk_buf = (guint8 *)g_malloc(sizeof(file_hasher_t *) + HASH_BUF_SIZE);
+      *(file_hasher_t **)chunk_buf = hasher;
+      hash_bytes = fread(chunk_buf + sizeof(file_hasher_t *), 1, HASH_BUF_SIZE, fh);
+      if (hash_bytes == 0) {
+        hash_chunk_free(chunk_buf);
+        hasher->read_ok = !ferror(fh);
+        break;
+      }
+      chunk = g_bytes_new_with_free_func(chunk_buf + sizeof(file_hasher_t *), hash_bytes,
+                                         hash_chunk_free, chunk_buf);
+      for (i = 0; i < NUM_HASHES; i++)
+        g_async_queue_push(hasher->workers[i].chunks, g_bytes_ref(chunk));
+      g_bytes_unref(chunk);
+    }
+    fclose(fh);
+  }
+
+  for (i = 0; i < NUM_HASHES; i++)
+    g_async_queue_push(hasher->workers[i].chunks, g_bytes_new(NULL, 0));
+  return NULL;
+}
+
+static void
+file_hasher_start(file_hasher_t *hasher, const char *filename, capture_info *cf_info)
+{
+  static const struct {
+    int algo;
+    size_t length;
+  } hashes[NUM_HASHES] = {
+    { GCRY_MD_SHA256, HASH_SIZE_SHA256 },
+    { GCRY_MD_RMD160, HASH_SIZE_RMD160 },
+    { GCRY_MD_SHA1,   HASH_SIZE_SHA1 },
+  };
+  gchar *results[NUM_HASHES];
+  int i;
+
+  results[0] = cf_info->file_sha256;
+  results[1] = cf_info->file_rmd160;
+  results[2] = cf_info->file_sha1;
+
+  hasher->filename = filename;
+  hasher->read_ok = FALSE;
+  g_mutex_init(&hasher->mutex);
+  g_cond_init(&hasher->cond);
+  hasher->chunks_in_flight = 0;
+  for (i = 0; i < NUM_HASHES; i++) {
+    hash_worker_t *worker = &hasher->workers[i];
+
+    worker->hasher = hasher;
+    worker->algo = hashes[i].algo;
+    worker->length = hashes[i].length;
+    worker->result = results[i];
+    worker->chunks = g_async_queue_new();
+    worker->thread = g_thread_new("capinfos hash", hash_worker_thread, worker);
+  }
+  hasher->reader = g_thread_new("capinfos hash reader", hash_reader_thread, hasher);
+}
+
+static void
+file_hasher_finish(file_hasher_t *hasher)
+{
+  int i;
+
+  g_thread_join(hasher->reader);
+  for (i = 0; i < NUM_HASHES; i++) {
+    g_thread_join(hasher->workers[i].thread);
+    g_async_queue_unref(hasher->workers[i].chunks);
+  }
+  g_mutex_clear(&hasher->mutex);
+  g_cond_clear(&hasher->cond);
 }
 
 static int
-process_cap_file(const char *filename, gboolean need_separator)
+process_cap_file(const char *filename, capture_info *cf_info)
 {
   int                   status = 0;
   wtap                 *wth;
@@ -1107,7 +1314,6 @@ process_cap_file(const char *filename, gboolean need_separator)
   guint32               snaplen_max_inferred =          0;
   wtap_rec              rec;
   Buffer                buf;
-  capture_info          cf_info;
   gboolean              have_times = TRUE;
   nstime_t              start_time;
   int                   start_time_tsprec;
@@ -1119,6 +1325,7 @@ process_cap_file(const char *filename, gboolean need_separator)
   order_t               order = IN_ORDER;
   guint                 i;
   wtapng_iface_descriptions_t *idb_info;
+  guint64               index_bytes;
 
   wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
   if (!wth) {
@@ -1126,10 +1333,6 @@ process_cap_file(const char *filename, gboolean need_separator)
     return 2;
   }
 
-  if (need_separator && long_report) {
-    printf("\n");
-  }
-
   nstime_set_zero(&start_time);
   start_time_tsprec = WTAP_TSPREC_UNKNOWN;
   nstime_set_zero(&stop_time);
@@ -1137,18 +1340,18 @@ process_cap_file(const char *filename, gboolean need_separator)
   nstime_set_zero(&cur_time);
   nstime_set_zero(&prev_time);
 
-  cf_info.shb = wtap_file_get_shb(wth);
+  cf_info->shb = wtap_file_get_shb(wth);
 
-  cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+  cf_info->encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
 
   idb_info = wtap_file_get_idb_info(wth);
 
   g_assert(idb_info->interface_data != NULL);
 
-  cf_info.num_interfaces = idb_info->interface_data->len;
-  cf_info.interface_packet_counts  = g_array_sized_new(FALSE, TRUE, sizeof(guint32), cf_info.num_interfaces);
-  g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
-  cf_info.pkt_interface_id_unknown = 0;
+  cf_info->num_interfaces = idb_info->interface_data->len;
+  cf_info->interface_packet_counts  = g_array_sized_new(FALSE, TRUE, sizeof(guint32), cf_info->num_interfaces);
+  g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
+  cf_info->pkt_interface_id_unknown = 0;
 
   g_free(idb_info);
   idb_info = NULL;
@@ -1160,9 +1363,28 @@ process_cap_file(const char *filename, gboolean need_separator)
   wtap_set_cb_new_secrets(wth, count_decryption_secret);
 
   /* Zero out the counters for the callbacks. */
-  num_ipv4_addresses = 0;
-  num_ipv6_addresses = 0;
-  num_decryption_secrets = 0;
+  cf_info->num_ipv4_addresses = 0;
+  cf_info->num_ipv6_addresses = 0;
+  cf_info->num_decryption_secrets = 0;
+  g_private_set(&current_cf_info, cf_info);
+
+  /*
+   * If the file has an index, and we aren't reporting anything that
+   * needs a look at each packet, take the totals from the index rather
+   * than reading the whole file.
+   */
+  err = 0;
+  if (!cap_file_encap && !cap_snaplen && !cap_order && !cap_file_idb &&
+      !cap_file_nrb && !cap_file_dsb &&
+      wtap_index_summary(wth, &packet, &index_bytes, &start_time, &stop_time)) {
+    bytes = (gint64)index_bytes;
+    start_time_tsprec = wtap_file_tsprec(wth);
+    if (start_time_tsprec == WTAP_TSPREC_PER_PACKET ||
+        start_time_tsprec == WTAP_TSPREC_UNKNOWN)
+      start_time_tsprec = WTAP_TSPREC_NSEC;
+    stop_time_tsprec = start_time_tsprec;
+    goto tallied;
+  }
 
   /* Tally up data that we need to parse through the file to find */
   wtap_rec_init(&rec);
@@ -1212,7 +1434,7 @@ process_cap_file(const char *filename, gboolean need_separator)
 
       if ((rec.rec_header.packet_header.pkt_encap > 0) &&
           (rec.rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-        cf_info.encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
+        cf_info->encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
       } else {
         fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
                 rec.rec_header.packet_header.pkt_encap, packet, filename);
@@ -1220,8 +1442,8 @@ process_cap_file(const char *filename, gboolean need_separator)
 
       /* Packet interface_id info */
       if (rec.presence_flags & WTAP_HAS_INTERFACE_ID) {
-        /* cf_info.num_interfaces is size, not index, so it's one more than max index */
-        if (rec.rec_header.packet_header.interface_id >= cf_info.num_interfaces) {
+        /* cf_info->num_interfaces is size, not index, so it's one more than max index */
+        if (rec.rec_header.packet_header.interface_id >= cf_info->num_interfaces) {
           /*
            * OK, re-fetch the number of interfaces, as there might have
            * been an interface that was in the middle of packets, and
@@ -1230,27 +1452,27 @@ process_cap_file(const char *filename, gboolean need_separator)
            */
           idb_info = wtap_file_get_idb_info(wth);
 
-          cf_info.num_interfaces = idb_info->interface_data->len;
-          g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
+          cf_info->num_interfaces = idb_info->interface_data->len;
+          g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
 
           g_free(idb_info);
           idb_info = NULL;
         }
-        if (rec.rec_header.packet_header.interface_id < cf_info.num_interfaces) {
-          g_array_index(cf_info.interface_packet_counts, guint32,
+        if (rec.rec_header.packet_header.interface_id < cf_info->num_interfaces) {
+          g_array_index(cf_info->interface_packet_counts, guint32,
                         rec.rec_header.packet_header.interface_id) += 1;
         }
         else {
-          cf_info.pkt_interface_id_unknown += 1;
+          cf_info->pkt_interface_id_unknown += 1;
         }
       }
       else {
         /* it's for interface_id 0 */
-        if (cf_info.num_interfaces != 0) {
-          g_array_index(cf_info.interface_packet_counts, guint32, 0) += 1;
+        if (cf_info->num_interfaces != 0) {
+          g_array_index(cf_info->interface_packet_counts, guint32, 0) += 1;
         }
         else {
-          cf_info.pkt_interface_id_unknown += 1;
+          cf_info->pkt_interface_id_unknown += 1;
         }
       }
     }
@@ -1259,6 +1481,8 @@ process_cap_file(const char *filename, gboolean need_separator)
   wtap_rec_cleanup(&rec);
   ws_buffer_free(&buf);
 
+tallied:
+
   /*
    * Get IDB info strings.
    * We do this at the end, so we can get information for all IDBs in
@@ -1266,12 +1490,12 @@ process_cap_file(const char *filename, gboolean need_separator)
    */
   idb_info = wtap_file_get_idb_info(wth);
 
-  cf_info.idb_info_strings = g_array_sized_new(FALSE, FALSE, sizeof(gchar*), cf_info.num_interfaces);
-  cf_info.num_interfaces = idb_info->interface_data->len;
-  for (i = 0; i < cf_info.num_interfaces; i++) {
+  cf_info->idb_info_strings = g_array_sized_new(FALSE, FALSE, sizeof(gchar*), cf_info->num_interfaces);
+  cf_info->num_interfaces = idb_info->interface_data->len;
+  for (i = 0; i < cf_info->num_interfaces; i++) {
     const wtap_block_t if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
     gchar *s = wtap_get_debug_if_descr(if_descr, 21, "\n");
-    g_array_append_val(cf_info.idb_info_strings, s);
+    g_array_append_val(cf_info->idb_info_strings, s);
   }
 
   g_free(idb_info);
@@ -1288,7 +1512,7 @@ process_cap_file(const char *filename, gboolean need_separator)
         fprintf(stderr,
           "  (will continue anyway, checksums might be incorrect)\n");
     } else {
-        cleanup_capture_info(&cf_info);
+        cleanup_capture_info(cf_info);
         wtap_close(wth);
         return 2;
     }
@@ -1300,76 +1524,125 @@ process_cap_file(const char *filename, gboolean need_separator)
     fprintf(stderr,
         "capinfos: Can't get size of \"%s\": %s.\n",
         filename, g_strerror(err));
-    cleanup_capture_info(&cf_info);
+    cleanup_capture_info(cf_info);
     wtap_close(wth);
     return 2;
   }
 
-  cf_info.filesize = size;
+  cf_info->filesize = size;
 
   /* File Type */
-  cf_info.file_type = wtap_file_type_subtype(wth);
-  cf_info.compression_type = wtap_get_compression_type(wth);
+  cf_info->file_type = wtap_file_type_subtype(wth);
+  cf_info->compression_type = wtap_get_compression_type(wth);
 
   /* File Encapsulation */
-  cf_info.file_encap = wtap_file_encap(wth);
+  cf_info->file_encap = wtap_file_encap(wth);
 
-  cf_info.file_tsprec = wtap_file_tsprec(wth);
+  cf_info->file_tsprec = wtap_file_tsprec(wth);
 
   /* Packet size limit (snaplen) */
-  cf_info.snaplen = wtap_snapshot_length(wth);
-  if (cf_info.snaplen > 0)
-    cf_info.snap_set = TRUE;
+  cf_info->snaplen = wtap_snapshot_length(wth);
+  if (cf_info->snaplen > 0)
+    cf_info->snap_set = TRUE;
   else
-    cf_info.snap_set = FALSE;
+    cf_info->snap_set = FALSE;
 
-  cf_info.snaplen_min_inferred = snaplen_min_inferred;
-  cf_info.snaplen_max_inferred = snaplen_max_inferred;
+  cf_info->snaplen_min_inferred = snaplen_min_inferred;
+  cf_info->snaplen_max_inferred = snaplen_max_inferred;
 
   /* # of packets */
-  cf_info.packet_count = packet;
+  cf_info->packet_count = packet;
 
   /* File Times */
-  cf_info.times_known = have_times;
-  cf_info.start_time = start_time;
-  cf_info.start_time_tsprec = start_time_tsprec;
-  cf_info.stop_time = stop_time;
-  cf_info.stop_time_tsprec = stop_time_tsprec;
-  nstime_delta(&cf_info.duration, &stop_time, &start_time);
+  cf_info->times_known = have_times;
+  cf_info->start_time = start_time;
+  cf_info->start_time_tsprec = start_time_tsprec;
+  cf_info->stop_time = stop_time;
+  cf_info->stop_time_tsprec = stop_time_tsprec;
+  nstime_delta(&cf_info->duration, &stop_time, &start_time);
   /* Duration precision is the higher of the start and stop time precisions. */
-  if (cf_info.stop_time_tsprec > cf_info.start_time_tsprec)
-    cf_info.duration_tsprec = cf_info.stop_time_tsprec;
+  if (cf_info->stop_time_tsprec > cf_info->start_time_tsprec)
+    cf_info->duration_tsprec = cf_info->stop_time_tsprec;
   else
-    cf_info.duration_tsprec = cf_info.start_time_tsprec;
-  cf_info.know_order = know_order;
-  cf_info.order = order;
+    cf_info->duration_tsprec = cf_info->start_time_tsprec;
+  cf_info->know_order = know_order;
+  cf_info->order = order;
 
   /* Number of packet bytes */
-  cf_info.packet_bytes = bytes;
+  cf_info->packet_bytes = bytes;
 
-  cf_info.data_rate   = 0.0;
-  cf_info.packet_rate = 0.0;
-  cf_info.packet_size = 0.0;
+  cf_info->data_rate   = 0.0;
+  cf_info->packet_rate = 0.0;
+  cf_info->packet_size = 0.0;
 
   if (packet > 0) {
     double delta_time = nstime_to_sec(&stop_time) - nstime_to_sec(&start_time);
     if (delta_time > 0.0) {
-      cf_info.data_rate   = (double)bytes  / delta_time; /* Data rate per second */
-      cf_info.packet_rate = (double)packet / delta_time; /* packet rate per second */
+      cf_info->data_rate   = (double)bytes  / delta_time; /* Data rate per second */
+      cf_info->packet_rate = (double)packet / delta_time; /* packet rate per second */
     }
-    cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
+    cf_info->packet_size = (double)bytes / packet;                  /* Avg packet size      */
+  }
+
+  /* Keep the file open until it's been reported on; the SHB belongs to it. */
+  cf_info->wth = wth;
+
+  return status;
+}
+
+static void
+process_job(gpointer data, gpointer user_data _U_)
+{
+  capinfos_job_t *job = (capinfos_job_t *)data;
+  file_hasher_t hasher;
+  int status;
+
+  g_strlcpy(job->cf_info.file_sha256, "<unknown>", HASH_STR_SIZE);
+  g_strlcpy(job->cf_info.file_rmd160, "<unknown>", HASH_STR_SIZE);
+  g_strlcpy(job->cf_info.file_sha1, "<unknown>", HASH_STR_SIZE);
+
+  if (cap_file_hashes)
+    file_hasher_start(&hasher, job->filename, &job->cf_info);
+
+  status = process_cap_file(job->filename, &job->cf_info);
+
+  if (cap_file_hashes)
+    file_hasher_finish(&hasher);
+
+  g_mutex_lock(&job_mutex);
+  job->status = status;
+  job->done = TRUE;
+  g_cond_broadcast(&job_cond);
+  g_mutex_unlock(&job_mutex);
+}
+
+static void
+report_job(capinfos_job_t *job, gboolean need_separator)
+{
+  if (job->status == 2) {
+    /* Nothing to report; the failure has already been reported. */
+    return;
   }
 
   if (long_report) {
-    print_stats(filename, &cf_info);
+    if (need_separator)
+      printf("\n");
+    print_stats(job->filename, &job->cf_info);
   } else {
-    print_stats_table(filename, &cf_info);
+    print_stats_table(job->filename, &job->cf_info);
   }
 
-  cleanup_capture_info(&cf_info);
-  wtap_close(wth);
+  cleanup_capture_info(&job->cf_info);
+  wtap_close(job->cf_info.wth);
+  job->cf_info.wth = NULL;
+}
 
-  return status;
+static guint
+get_num_threads(void)
+{
+  guint num_threads = get_num_processors();
+
+  return MIN(num_threads, MAX_THREADS);
 }
 
 static void
@@ -1461,15 +1734,6 @@ failure_message_cont(const char *msg_format, va_list ap)
   fprintf(stderr, "\n");
 }
 
-static void
-hash_to_str(const unsigned char *hash, size_t length, char *str) {
-  int i;
-
-  for (i = 0; i < (int) length; i++) {
-    g_snprintf(str+(i*2), 3, "%02x", hash[i]);
-  }
-}
-
 int
 main(int argc, char *argv[])
 {
@@ -1484,10 +1748,12 @@ main(int argc, char *argv[])
   };
 
   int status = 0;
-  FILE  *fh;
-  char  *hash_buf = NULL;
-  gcry_md_hd_t hd = NULL;
-  size_t hash_bytes;
+  int num_jobs = 0;
+  capinfos_job_t *jobs = NULL;
+  GThreadPool *pool = NULL;
+  guint num_threads;
+  int next_job;
+  int i;
 
   /* Set the C-language locale to the native environment. */
   setlocale(LC_ALL, "");
@@ -1722,38 +1988,40 @@ main(int argc, char *argv[])
 
   if (cap_file_hashes) {
     gcry_check_version(NULL);
-    gcry_md_open(&hd, GCRY_MD_SHA256, 0);
-    if (hd) {
-      gcry_md_enable(hd, GCRY_MD_RMD160);
-      gcry_md_enable(hd, GCRY_MD_SHA1);
-    }
-    hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
   }
 
   overall_error_status = 0;
 
-  for (opt = optind; opt < argc; opt++) {
-
-    g_strlcpy(file_sha256, "<unknown>", HASH_STR_SIZE);
-    g_strlcpy(file_rmd160, "<unknown>", HASH_STR_SIZE);
-    g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
+  num_jobs = argc - optind;
+  jobs = g_new0(capinfos_job_t, num_jobs);
+  for (i = 0; i < num_jobs; i++)
+    jobs[i].filename = argv[optind + i];
 
-    if (cap_file_hashes) {
-      fh = ws_fopen(argv[opt], "rb");
-      if (fh && hd) {
-        while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
-          gcry_md_write(hd, hash_buf, hash_bytes);
-        }
-        gcry_md_final(hd);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, file_sha256);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_RMD160), HASH_SIZE_RMD160, file_rmd160);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
-      }
-      if (fh) fclose(fh);
-      if (hd) gcry_md_reset(hd);
+  /*
+   * With -C we have to stop at the first failure, so there's no point
+   * in working on the files after it; do them one at a time.
+   */
+  num_threads = stop_after_failure ? 1 : get_num_threads();
+  if (num_threads > 1 && num_jobs > 1)
+    pool = g_thread_pool_new(process_job, NULL, num_threads, FALSE, NULL);
+  next_job = 0;
+
+  for (i = 0; i < num_jobs; i++) {
+    if (pool) {
+      /* Work ahead, but don't have too many files open at once. */
+      while (next_job < num_jobs && next_job < i + 2 * (int)num_threads)
+        g_thread_pool_push(pool, &jobs[next_job++], NULL);
+
+      g_mutex_lock(&job_mutex);
+      while (!jobs[i].done)
+        g_cond_wait(&job_cond, &job_mutex);
+      g_mutex_unlock(&job_mutex);
+    } else {
+      process_job(&jobs[i], NULL);
     }
 
-    status = process_cap_file(argv[opt], need_separator);
+    report_job(&jobs[i], need_separator);
+    status = jobs[i].status;
     if (status) {
       /* Something failed.  It's been reported; remember that processing
          one file failed and, if -C was specified, stop. */
@@ -1771,8 +2039,9 @@ main(int argc, char *argv[])
   }
 
 exit:
-  g_free(hash_buf);
-  gcry_md_close(hd);
+  if (pool)
+    g_thread_pool_free(pool, FALSE, TRUE);
+  g_free(jobs);
   wtap_cleanup();
   free_progdirs();
   return overall_error_status;
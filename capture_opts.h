@@ -53,6 +53,7 @@ extern "C" {
 #define LONGOPT_NUM_CAP_COMMENT   128
 #define LONGOPT_LIST_TSTAMP_TYPES 129
 #define LONGOPT_SET_TSTAMP_TYPE   130
+#define LONGOPT_SHM_RING          131
 
 /*
  * Options for capturing common to all capturing programs.
@@ -283,6 +284,8 @@ typedef struct capture_options_tag {
     /* GUI related */
     gboolean           real_time_mode;        /**< Update list of packets in real time */
     gboolean           show_info;             /**< show the info dialog. */
+    gboolean           use_shm_ring;          /**< get packets from dumpcap through
+                                                   shared memory, not the file */
     gboolean           restart;               /**< restart after closing is done */
     gchar             *orig_save_file;        /**< the original capture file name (saved for a restart) */
 
@@ -59,6 +59,7 @@ struct packet_provider_data {
   frame_data  *prev_dis;
   frame_data  *prev_cap;
   frame_data_sequence *frames;       /* Sequence of frames, if we're keeping that information */
+  gint64       cur_file_off;         /* File offset of the record just read, which may not be in frames yet */
   GTree       *frames_user_comments; /* BST with user comments for frames (key = frame_data) */
 };
 
@@ -109,6 +110,8 @@ typedef struct _capture_file {
   gboolean                    search_in_progress;   /* TRUE if user just clicked OK in the Find dialog or hit <control>N/B */
   /* packet provider */
   struct packet_provider_data provider;
+  struct _record_prefetch    *prefetch;             /* Background reader for random access, or NULL */
+  struct _field_index        *field_index;          /* Frames with each value of some fields, or NULL */
   /* frames */
   guint32                     first_displayed;      /* Frame number of first frame displayed */
   guint32                     last_displayed;       /* Frame number of last frame displayed */
@@ -132,6 +135,8 @@ extern void cap_file_init(capture_file *cf);
 const char *cap_file_provider_get_interface_name(struct packet_provider_data *prov, guint32 interface_id);
 const char *cap_file_provider_get_interface_description(struct packet_provider_data *prov, guint32 interface_id);
 const char *cap_file_provider_get_user_comment(struct packet_provider_data *prov, const frame_data *fd);
+void cap_file_provider_get_frame_shift(struct packet_provider_data *prov, guint32 frame_num, nstime_t *shift);
+gint64 cap_file_provider_get_frame_file_off(const struct packet_provider_data *prov, const frame_data *fd);
 void cap_file_provider_set_user_comment(struct packet_provider_data *prov, frame_data *fd, const char *new_comment);
 
 #ifdef __cplusplus
@@ -32,6 +32,10 @@
 #include <signal.h>
 #include <errno.h>
 
+#ifdef HAVE_SHM_OPEN
+#include <unistd.h> /* for getpid(), getuid() and geteuid() */
+#endif
+
 #include <ui/cmdarg_err.h>
 #include <wsutil/strtoi.h>
 #include <cli_main.h>
@@ -81,6 +85,7 @@
 #include "wsutil/inet_addr.h"
 #include "wsutil/time_util.h"
 #include "wsutil/please_report_bug.h"
+#include "wsutil/shm_ring.h"
 
 #include "caputils/ws80211_utils.h"
 
@@ -304,6 +309,8 @@ typedef struct _loop_data {
     int       save_file_fd;
     char     *io_buffer;           /**< Our IO buffer if we increase the size from the standard size */
     guint64   bytes_written;       /**< Bytes written for the current file. */
+    pcapng_index_writer *index;    /**< Packet index for the current file, or NULL */
+    shm_ring_t *shm_ring;          /**< Ring our parent can also get the packets from, or NULL */
     /* autostop conditions */
     int       packets_written;     /**< Packets written for the current file. */
     int       file_count;
@@ -2973,6 +2980,45 @@ capture_loop_init_filter(pcap_t *pcap_h, gboolean from_cap_pipe,
     return INITFILTER_NO_ERROR;
 }
 
+/*
+ * Start indexing the packets written to a new pcapng output file, so that
+ * readers can seek by time and get totals without reading all of it. We
+ * write the blocks of pcapng sources as they are, without looking at their
+ * time stamps, so captures from those aren't indexed.
+ */
+static void
+capture_loop_start_index(loop_data *ld)
+{
+    capture_src *pcap_src;
+    guint        i;
+
+    pcapng_index_writer_free(ld->index);
+    ld->index = NULL;
+    for (i = 0; i < ld->pcaps->len; i++) {
+        pcap_src = g_array_index(ld->pcaps, capture_src *, i);
+        if (pcap_src->from_pcapng)
+            return;
+    }
+    ld->index = pcapng_index_writer_new(ld->saved_idbs->len);
+}
+
+/*
+ * Write the index covering the whole of the current output file; it has
+ * to be the file's last block.
+ */
+static gboolean
+capture_loop_finish_index(loop_data *ld, int *err)
+{
+    gboolean successful = TRUE;
+
+    if (ld->index != NULL) {
+        successful = pcapng_write_final_index_block(ld->pdh, ld->index, &ld->bytes_written, err);
+        pcapng_index_writer_free(ld->index);
+        ld->index = NULL;
+    }
+    return successful;
+}
+
 /*
  * Write the dumpcap pcapng SHB and IDBs if needed.
  * Called from capture_loop_init_output and do_file_switch_or_stop.
@@ -3081,6 +3127,9 @@ capture_loop_init_pcapng_output(capture_options *capture_opts, loop_data *ld)
 
     g_string_free(os_info_str, TRUE);
 
+    if (successful)
+        capture_loop_start_index(ld);
+
     return successful;
 }
 
@@ -3166,6 +3215,55 @@ capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *err
     return TRUE;
 }
 
+#ifdef HAVE_SHM_OPEN
+/*
+ * Set up a shared memory ring that our parent can get the packets we
+ * write from, and tell it its name.  We only do this if everything goes
+ * to one file and we're making the file's interface descriptions
+ * ourselves, so that the parent can fill in packet records from the ring
+ * using what's in the file.  Packets from pcapng sources are written as
+ * the blocks we got, not through capture_loop_write_packet_cb(), so they
+ * never go into the ring; if there are any, we don't set it up.  If we
+ * can't create it, our parent just reads the file.
+ *
+ * The ring is created with mode 0600.  By now we've given up any set-UID
+ * privileges, so it belongs to the user who ran us and our parent can
+ * open it; if we're somehow still running as someone else, don't create
+ * it.
+ */
+static void
+capture_loop_open_shm_ring(capture_options *capture_opts)
+{
+    char name[64];
+    const char *env;
+    guint32 ring_size = SP_SHM_RING_SIZE;
+    int  err;
+    guint i;
+
+    if (capture_opts->multi_files_on || capture_opts->output_to_pipe ||
+        global_ld.pcapng_passthrough || geteuid() != getuid())
+        return;
+    for (i = 0; i < global_ld.pcaps->len; i++) {
+        if (g_array_index(global_ld.pcaps, capture_src *, i)->from_pcapng)
+            return;
+    }
+
+    /* The test suite uses a small ring to make it overflow. */
+    env = g_getenv("WIRESHARK_SHM_RING_SIZE");
+    if (env != NULL && !ws_strtou32(env, NULL, &ring_size))
+        ring_size = SP_SHM_RING_SIZE;
+
+    g_snprintf(name, sizeof name, "/wireshark-dumpcap-%d", (int)getpid());
+    global_ld.shm_ring = shm_ring_create(name, ring_size, &err);
+    if (global_ld.shm_ring == NULL) {
+        g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG,
+              "Couldn't create packet ring %s: %s", name, g_strerror(err));
+        return;
+    }
+    pipe_write_block(2, SP_SHM_RING, name);
+}
+#endif /* HAVE_SHM_OPEN */
+
 static gboolean
 capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err_close)
 {
@@ -3178,6 +3276,7 @@ capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err
     g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "capture_loop_close_output");
 
     if (capture_opts->multi_files_on) {
+        capture_loop_finish_index(ld, err_close);
         return ringbuf_libpcap_dump_close(&capture_opts->save_file, err_close);
     } else {
         if (capture_opts->use_pcapng) {
@@ -3205,6 +3304,7 @@ capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err
                                                             err_close);
                 }
             }
+            capture_loop_finish_index(ld, err_close);
         }
         if (fclose(ld->pdh) == EOF) {
             if (err_close != NULL) {
@@ -3635,6 +3735,12 @@ do_file_switch_or_stop(capture_options *capture_opts)
             return FALSE;
         }
 
+        /* The index has to be the last block of the file we're leaving. */
+        if (!capture_loop_finish_index(&global_ld, &global_ld.err)) {
+            global_ld.go = FALSE;
+            return FALSE;
+        }
+
         /* Switch to the next ringbuffer file */
         if (ringbuf_switch_file(&global_ld.pdh, &capture_opts->save_file,
                                 &global_ld.save_file_fd, &global_ld.err)) {
@@ -3782,6 +3888,7 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     global_ld.pdh                 = NULL;
     global_ld.save_file_fd        = -1;
     global_ld.io_buffer           = NULL;
+    global_ld.shm_ring            = NULL;
     global_ld.file_count          = 0;
     global_ld.file_duration_timer = NULL;
     global_ld.next_interval_time  = 0;
@@ -3856,6 +3963,10 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
            update its windows to indicate that we have a live capture in
            progress. */
         fflush(global_ld.pdh);
+#ifdef HAVE_SHM_OPEN
+        if (capture_child && capture_opts->use_shm_ring)
+            capture_loop_open_shm_ring(capture_opts);
+#endif
         report_new_capture_file(capture_opts->save_file);
     }
 
@@ -3979,8 +4090,10 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
 #endif
             /* Let the parent process know. */
             if (global_ld.inpkts_to_sync_pipe) {
-                /* do sync here */
-                fflush(global_ld.pdh);
+                /* do sync here, unless our parent is getting the packets
+                   from the ring and doesn't need them in the file yet */
+                if (global_ld.shm_ring == NULL || !shm_ring_in_use(global_ld.shm_ring))
+                    fflush(global_ld.pdh);
 
                 /* Send our parent a message saying we've written out
                    "global_ld.inpkts_to_sync_pipe" packets to the capture file. */
@@ -4120,6 +4233,10 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
         global_ld.inpkts_to_sync_pipe = 0;
     }
 
+    /* our parent has been told about every packet in the ring */
+    shm_ring_close(global_ld.shm_ring);
+    global_ld.shm_ring = NULL;
+
     /* If we've displayed a message about a write error, there's no point
        in displaying another message about an error on close. */
     if (!close_ok && write_ok) {
@@ -4395,14 +4512,23 @@ capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
            If this fails, set "ld->go" to FALSE, to stop the capture, and set
            "ld->err" to the error. */
         if (global_capture_opts.use_pcapng) {
-            successful = pcapng_write_enhanced_packet_block(global_ld.pdh,
-                                                            NULL,
-                                                            phdr->ts.tv_sec, (gint32)phdr->ts.tv_usec,
-                                                            phdr->caplen, phdr->len,
-                                                            pcap_src->interface_id,
-                                                            ts_mul,
-                                                            pd, 0,
-                                                            &global_ld.bytes_written, &err);
+            successful = TRUE;
+            if (global_ld.index != NULL) {
+                successful = pcapng_index_add_packet(global_ld.pdh, global_ld.index,
+                                                     phdr->ts.tv_sec,
+                                                     pcap_src->ts_nsec ? (guint32)phdr->ts.tv_usec : (guint32)phdr->ts.tv_usec * 1000,
+                                                     phdr->len,
+                                                     &global_ld.bytes_written, &err);
+            }
+            if (successful)
+                successful = pcapng_write_enhanced_packet_block(global_ld.pdh,
+                                                                NULL,
+                                                                phdr->ts.tv_sec, (gint32)phdr->ts.tv_usec,
+                                                                phdr->caplen, phdr->len,
+                                                                pcap_src->interface_id,
+                                                                ts_mul,
+                                                                pd, 0,
+                                                                &global_ld.bytes_written, &err);
         } else {
             successful = libpcap_write_packet(global_ld.pdh,
                                               phdr->ts.tv_sec, (gint32)phdr->ts.tv_usec,
@@ -4420,6 +4546,16 @@ capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
                   "Wrote a pcap packet of length %d captured on interface %u.",
                    phdr->caplen, pcap_src->interface_id);
 #endif
+            if (global_ld.shm_ring != NULL) {
+                sp_ring_packet_hdr ring_hdr;
+
+                ring_hdr.ts_secs = phdr->ts.tv_sec;
+                ring_hdr.ts_nsecs = pcap_src->ts_nsec ? (guint32)phdr->ts.tv_usec : (guint32)phdr->ts.tv_usec * 1000;
+                ring_hdr.interface_id = pcap_src->interface_id;
+                ring_hdr.caplen = phdr->caplen;
+                ring_hdr.len = phdr->len;
+                shm_ring_put(global_ld.shm_ring, &ring_hdr, sizeof ring_hdr, pd, phdr->caplen);
+            }
             capture_loop_wrote_one_packet(pcap_src);
         }
     }
@@ -4626,6 +4762,7 @@ main(int argc, char *argv[])
     static const struct option long_options[] = {
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'v'},
+        {"shm-ring", no_argument, NULL, LONGOPT_SHM_RING},
         LONGOPT_CAPTURE_COMMON
         {0, 0, 0, 0 }
     };
@@ -4999,6 +5136,10 @@ main(int argc, char *argv[])
                 exit_main(status);
             }
             break;
+            /*** hidden option: also hand packets to our parent through shared memory ***/
+        case LONGOPT_SHM_RING:
+            global_capture_opts.use_shm_ring = TRUE;
+            break;
             /*** hidden option: Wireshark child mode (using binary output messages) ***/
         case 'Z':
             capture_child = TRUE;
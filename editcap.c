@@ -173,6 +173,8 @@ static gboolean               dup_detect                = FALSE;
 static gboolean               dup_detect_by_time        = FALSE;
 static gboolean               skip_radiotap             = FALSE;
 static gboolean               discard_all_secrets       = FALSE;
+static gboolean               write_index               = FALSE;
+static gboolean               time_ordered              = FALSE;
 
 static int                    do_strict_time_adjustment = FALSE;
 static struct time_adjustment strict_time_adj           = {NSTIME_INIT_ZERO, 0}; /* strict time adjustment */
@@ -762,6 +764,8 @@ print_usage(FILE *output)
     fprintf(output, "                         to) the given time (format as YYYY-MM-DD hh:mm:ss).\n");
     fprintf(output, "  -B <stop time>         only output packets whose timestamp is before the\n");
     fprintf(output, "                         given time (format as YYYY-MM-DD hh:mm:ss).\n");
+    fprintf(output, "  --time-ordered         the input file's packets are in time stamp order;\n");
+    fprintf(output, "                         lets -A and -B avoid reading the whole file.\n");
     fprintf(output, "\n");
     fprintf(output, "Duplicate packet removal:\n");
     fprintf(output, "  --novlan               remove vlan info from packets before checking for duplicates.\n");
@@ -845,6 +849,8 @@ print_usage(FILE *output)
     fprintf(output, "                         when writing the output file.  Does not discard\n");
     fprintf(output, "                         secrets added by \"--inject-secrets\" in the same\n");
     fprintf(output, "                         command line.\n");
+    fprintf(output, "  --write-index          write an index of the packets, for faster time\n");
+    fprintf(output, "                         slicing of the output file (pcapng only).\n");
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -h                     display this help and exit.\n");
@@ -1022,12 +1028,16 @@ main(int argc, char *argv[])
 #define LONGOPT_SEED                 0x8102
 #define LONGOPT_INJECT_SECRETS       0x8103
 #define LONGOPT_DISCARD_ALL_SECRETS  0x8104
+#define LONGOPT_WRITE_INDEX          0x8105
+#define LONGOPT_TIME_ORDERED         0x8106
     static const struct option long_options[] = {
         {"novlan", no_argument, NULL, LONGOPT_NO_VLAN},
         {"skip-radiotap-header", no_argument, NULL, LONGOPT_SKIP_RADIOTAP_HEADER},
         {"seed", required_argument, NULL, LONGOPT_SEED},
         {"inject-secrets", required_argument, NULL, LONGOPT_INJECT_SECRETS},
         {"discard-all-secrets", no_argument, NULL, LONGOPT_DISCARD_ALL_SECRETS},
+        {"write-index", no_argument, NULL, LONGOPT_WRITE_INDEX},
+        {"time-ordered", no_argument, NULL, LONGOPT_TIME_ORDERED},
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'V'},
         {0, 0, 0, 0 }
@@ -1167,6 +1177,18 @@ main(int argc, char *argv[])
             break;
         }
 
+        case LONGOPT_WRITE_INDEX:
+        {
+            write_index = TRUE;
+            break;
+        }
+
+        case LONGOPT_TIME_ORDERED:
+        {
+            time_ordered = TRUE;
+            break;
+        }
+
         case 'a':
         {
             guint frame_number;
@@ -1496,6 +1518,7 @@ main(int argc, char *argv[])
     }
 
     wtap_dump_params_init(&params, wth);
+    params.write_index = write_index;
 
     /*
      * Discard any secrets we read in while opening the file.
@@ -1580,6 +1603,45 @@ main(int argc, char *argv[])
         }
     }
 
+    /*
+     * If we only want packets in a time range and the input file has an
+     * index, don't read the parts of it that are all outside the range.
+     * Duplicate detection has to see the packets before the range, so
+     * read everything then.
+     */
+    if (check_startstop && !dup_detect && !dup_detect_by_time) {
+        nstime_t start_ts, stop_ts;
+        guint32 skipped, last;
+
+        start_ts.secs = starttime;
+        start_ts.nsecs = 0;
+        stop_ts.secs = stoptime;
+        stop_ts.nsecs = 0;
+        if (max_selected == 0 && frames_user_comments == NULL) {
+            /*
+             * Nothing depends on the packets' numbers in the input
+             * file, so wiretap can leave out everything outside the
+             * range.
+             */
+            wtap_set_time_window(wth, &start_ts, &stop_ts, time_ordered);
+        } else {
+            if (wtap_seek_to_time(wth, &start_ts, &skipped, &read_err)) {
+                if (verbose)
+                    fprintf(stderr, "Skipped %u packets using the index\n", skipped);
+                read_count += skipped;
+                count += skipped;
+            } else if (read_err != 0) {
+                cfile_read_failure_message("editcap", argv[optind], read_err, NULL);
+                ret = INVALID_FILE;
+                goto clean_exit;
+            }
+
+            if (wtap_index_last_record_before(wth, &stop_ts, &last) &&
+                last < max_packet_number)
+                max_packet_number = last;
+        }
+    }
+
     /* Read all of the packets in turn */
     wtap_rec_init(&read_rec);
     ws_buffer_init(&read_buf, 1514);
@@ -1592,7 +1654,7 @@ main(int argc, char *argv[])
         rec = &read_rec;
 
         /* Extra actions for the first packet */
-        if (read_count == 1) {
+        if (pdh == NULL) {
             if (split_packet_count != 0 || !nstime_is_unset(&secs_per_block)) {
                 if (!fileset_extract_prefix_suffix(argv[optind+1], &fprefix, &fsuffix)) {
                     ret = CANT_EXTRACT_PREFIX;
@@ -244,6 +244,115 @@ conversation_equal(gconstpointer key1, gconstpointer key2)
     return FALSE;
 }
 
+/*
+ * Bounded tables keep a binary min-heap of conv_array indexes ordered by
+ * frame count, plus the heap position of every entry. Frame counts only
+ * grow, so after an update an entry can only move towards the leaves.
+ */
+typedef guint64 (*ct_weight_func)(const conv_hash_t *ch, guint idx);
+
+#define CT_HEAP(ch, i)          g_array_index((ch)->heap, guint, (i))
+#define CT_HEAP_POS(ch, idx)    g_array_index((ch)->heap_pos, guint, (idx))
+
+static guint64
+conv_item_weight(const conv_hash_t *ch, guint idx)
+{
+    const conv_item_t *item = &g_array_index(ch->conv_array, conv_item_t, idx);
+
+    return item->rx_frames + item->tx_frames + item->error_frames;
+}
+
+static guint64
+host_weight(const conv_hash_t *ch, guint idx)
+{
+    const hostlist_talker_t *host = &g_array_index(ch->conv_array, hostlist_talker_t, idx);
+
+    return host->rx_frames + host->tx_frames + host->error_frames;
+}
+
+static void
+ct_heap_swap(conv_hash_t *ch, guint a, guint b)
+{
+    guint idx_a = CT_HEAP(ch, a);
+    guint idx_b = CT_HEAP(ch, b);
+
+    CT_HEAP(ch, a) = idx_b;
+    CT_HEAP(ch, b) = idx_a;
+    CT_HEAP_POS(ch, idx_b) = a;
+    CT_HEAP_POS(ch, idx_a) = b;
+}
+
+static void
+ct_heap_sift_down(conv_hash_t *ch, guint pos, ct_weight_func weight)
+{
+    guint len = ch->heap->len;
+
+    for (;;) {
+        guint smallest = pos;
+        guint left = 2 * pos + 1;
+        guint right = left + 1;
+
+        if (left < len && weight(ch, CT_HEAP(ch, left)) < weight(ch, CT_HEAP(ch, smallest))) {
+            smallest = left;
+        }
+        if (right < len && weight(ch, CT_HEAP(ch, right)) < weight(ch, CT_HEAP(ch, smallest))) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        ct_heap_swap(ch, pos, smallest);
+        pos = smallest;
+    }
+}
+
+/* Add a new entry, which has no frames yet, to the heap. */
+static void
+ct_heap_push(conv_hash_t *ch, guint idx)
+{
+    guint pos;
+
+    if (ch->heap == NULL) {
+        ch->heap = g_array_sized_new(FALSE, FALSE, sizeof(guint), ch->max_entries);
+        ch->heap_pos = g_array_sized_new(FALSE, FALSE, sizeof(guint), ch->max_entries);
+    }
+
+    pos = ch->heap->len;
+    g_array_append_val(ch->heap, idx);
+    if (ch->heap_pos->len <= idx) {
+        g_array_set_size(ch->heap_pos, idx + 1);
+    }
+    CT_HEAP_POS(ch, idx) = pos;
+
+    /* Zero is the smallest possible weight, so it goes to the top. */
+    while (pos > 0) {
+        guint parent = (pos - 1) / 2;
+        ct_heap_swap(ch, pos, parent);
+        pos = parent;
+    }
+}
+
+static void
+ct_heap_free(conv_hash_t *ch)
+{
+    if (ch->heap != NULL) {
+        g_array_free(ch->heap, TRUE);
+        g_array_free(ch->heap_pos, TRUE);
+    }
+    ch->heap = NULL;
+    ch->heap_pos = NULL;
+    ch->evicted = 0;
+}
+
+void
+conversation_table_set_max_entries(conv_hash_t *ch, guint max_entries)
+{
+    if (!ch || ch->conv_array != NULL) {
+        return;
+    }
+    ch->max_entries = max_entries;
+}
+
 void
 reset_conversation_table_data(conv_hash_t *ch)
 {
@@ -266,6 +375,8 @@ reset_conversation_table_data(conv_hash_t *ch)
         g_hash_table_destroy(ch->hashtable);
     }
 
+    ct_heap_free(ch);
+
     ch->conv_array=NULL;
     ch->hashtable=NULL;
 }
@@ -290,6 +401,8 @@ void reset_hostlist_table_data(conv_hash_t *ch)
         g_hash_table_destroy(ch->hashtable);
     }
 
+    ct_heap_free(ch);
+
     ch->conv_array=NULL;
     ch->hashtable=NULL;
 }
@@ -627,15 +740,37 @@ add_conversation_table_data_with_conv_id(
         existing_key.port2 = port2;
         existing_key.conv_id = conv_id;
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-            conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+            conversation_idx = GPOINTER_TO_UINT(conversation_idx_hash_val);
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
         }
     }
 
     /* if we still don't know what conversation this is it has to be a new one
-       and we have to allocate it and append it to the end of the list */
+       and we have to allocate it and append it to the end of the list, or
+       replace the smallest entry if the table is full */
     if (conv_item == NULL) {
         conv_key_t *new_key;
         conv_item_t new_conv_item;
+        guint64 error_frames = 0;
+        gboolean replace = ch->max_entries && ch->conv_array->len >= ch->max_entries;
+
+        if (replace) {
+            conv_key_t old_key;
+
+            conversation_idx = CT_HEAP(ch, 0);
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+            error_frames = conv_item_weight(ch, conversation_idx);
+
+            old_key.addr1 = conv_item->src_address;
+            old_key.addr2 = conv_item->dst_address;
+            old_key.port1 = conv_item->src_port;
+            old_key.port2 = conv_item->dst_port;
+            old_key.conv_id = conv_item->conv_id;
+            g_hash_table_remove(ch->hashtable, &old_key);
+            free_address(&conv_item->src_address);
+            free_address(&conv_item->dst_address);
+            ch->evicted++;
+        }
 
         copy_address(&new_conv_item.src_address, addr1);
         copy_address(&new_conv_item.dst_address, addr2);
@@ -648,6 +783,7 @@ add_conversation_table_data_with_conv_id(
         new_conv_item.tx_frames = 0;
         new_conv_item.rx_bytes = 0;
         new_conv_item.tx_bytes = 0;
+        new_conv_item.error_frames = error_frames;
 
         if (ts) {
             memcpy(&new_conv_item.start_time, ts, sizeof(new_conv_item.start_time));
@@ -658,9 +794,16 @@ add_conversation_table_data_with_conv_id(
             nstime_set_unset(&new_conv_item.start_time);
             nstime_set_unset(&new_conv_item.stop_time);
         }
-        g_array_append_val(ch->conv_array, new_conv_item);
-        conversation_idx = ch->conv_array->len - 1;
-        conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+        if (replace) {
+            *conv_item = new_conv_item;
+        } else {
+            g_array_append_val(ch->conv_array, new_conv_item);
+            conversation_idx = ch->conv_array->len - 1;
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+            if (ch->max_entries) {
+                ct_heap_push(ch, conversation_idx);
+            }
+        }
 
         /* ct->conversations address is not a constant but src/dst_address.data are */
         new_key = g_new(conv_key_t, 1);
@@ -681,6 +824,10 @@ add_conversation_table_data_with_conv_id(
         conv_item->rx_bytes += num_bytes;
     }
 
+    if (ch->max_entries) {
+        ct_heap_sift_down(ch, CT_HEAP_POS(ch, conversation_idx), conv_item_weight);
+    }
+
     if (ts) {
         if (nstime_cmp(ts, &conv_item->stop_time) > 0) {
             memcpy(&conv_item->stop_time, ts, sizeof(conv_item->stop_time));
@@ -730,7 +877,7 @@ void
 add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, hostlist_dissector_info_t *host_info, endpoint_type etype)
 {
     hostlist_talker_t *talker=NULL;
-    int talker_idx=0;
+    guint talker_idx=0;
 
     /* XXX should be optimized to allocate n extra entries at a time
        instead of just one */
@@ -751,15 +898,33 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         existing_key.port = port;
 
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &talker_idx_hash_val)) {
-            talker = &g_array_index(ch->conv_array, hostlist_talker_t, GPOINTER_TO_UINT(talker_idx_hash_val));
+            talker_idx = GPOINTER_TO_UINT(talker_idx_hash_val);
+            talker = &g_array_index(ch->conv_array, hostlist_talker_t, talker_idx);
         }
     }
 
     /* if we still don't know what talker this is it has to be a new one
-       and we have to allocate it and append it to the end of the list */
+       and we have to allocate it and append it to the end of the list, or
+       replace the smallest entry if the table is full */
     if(talker==NULL){
         host_key_t *new_key;
         hostlist_talker_t host;
+        guint64 error_frames = 0;
+        gboolean replace = ch->max_entries && ch->conv_array->len >= ch->max_entries;
+
+        if (replace) {
+            host_key_t old_key;
+
+            talker_idx = CT_HEAP(ch, 0);
+            talker = &g_array_index(ch->conv_array, hostlist_talker_t, talker_idx);
+            error_frames = host_weight(ch, talker_idx);
+
+            copy_address_shallow(&old_key.myaddress, &talker->myaddress);
+            old_key.port = talker->port;
+            g_hash_table_remove(ch->hashtable, &old_key);
+            free_address(&talker->myaddress);
+            ch->evicted++;
+        }
 
         copy_address(&host.myaddress, addr);
         host.dissector_info = host_info;
@@ -769,11 +934,19 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         host.tx_frames=0;
         host.rx_bytes=0;
         host.tx_bytes=0;
+        host.error_frames=error_frames;
         host.modified = TRUE;
 
-        g_array_append_val(ch->conv_array, host);
-        talker_idx= ch->conv_array->len - 1;
-        talker=&g_array_index(ch->conv_array, hostlist_talker_t, talker_idx);
+        if (replace) {
+            *talker = host;
+        } else {
+            g_array_append_val(ch->conv_array, host);
+            talker_idx= ch->conv_array->len - 1;
+            talker=&g_array_index(ch->conv_array, hostlist_talker_t, talker_idx);
+            if (ch->max_entries) {
+                ct_heap_push(ch, talker_idx);
+            }
+        }
 
         /* hl->hosts address is not a constant but address.data is */
         new_key = g_new(host_key_t,1);
@@ -793,6 +966,10 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         talker->rx_frames+=num_frames;
         talker->rx_bytes+=num_bytes;
     }
+
+    if (ch->max_entries) {
+        ct_heap_sift_down(ch, CT_HEAP_POS(ch, talker_idx), host_weight);
+    }
 }
 
 /*
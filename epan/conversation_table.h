@@ -49,11 +49,23 @@ typedef enum {
 
 /** Conversation hash + value storage
  * Hash table keys are conv_key_t. Hash table values are indexes into conv_array.
+ *
+ * If max_entries is set, only that many entries are kept, using the
+ * Space-Saving algorithm: once the table is full, a new conversation or
+ * endpoint replaces the entry with the fewest frames, and records that
+ * entry's frame count as its error_frames. Entries with error_frames of 0
+ * have exact counts; for the others the true frame count is at most the
+ * counted frames plus error_frames. Every conversation with more frames
+ * than total frames / max_entries is guaranteed to be in the table.
  */
 typedef struct _conversation_hash_t {
     GHashTable  *hashtable;       /**< conversations hash table */
     GArray      *conv_array;      /**< array of conversation values */
     void        *user_data;       /**< "GUI" specifics (if necessary) */
+    guint        max_entries;     /**< maximum number of entries kept, 0 for no limit */
+    guint64      evicted;         /**< number of entries replaced to stay within max_entries */
+    GArray      *heap;            /**< min-heap of conv_array indexes by frame count (max_entries only) */
+    GArray      *heap_pos;        /**< position of each conv_array entry in heap */
 } conv_hash_t;
 
 /** Key for hash lookups */
@@ -110,6 +122,8 @@ typedef struct _conversation_item_t {
     guint64             rx_bytes;       /**< number of received bytes */
     guint64             tx_bytes;       /**< number of transmitted bytes */
 
+    guint64             error_frames;   /**< maximum number of frames missed before the entry was added (see conv_hash_t) */
+
     nstime_t            start_time;     /**< relative start time for the conversation */
     nstime_t            stop_time;      /**< relative stop time for the conversation */
     nstime_t            start_abs_time; /**< absolute start time for the conversation */
@@ -126,6 +140,7 @@ typedef struct _hostlist_talker_t {
     guint64 tx_frames;      /**< number of transmitted packets */
     guint64 rx_bytes;       /**< number of received bytes */
     guint64 tx_bytes;       /**< number of transmitted bytes */
+    guint64 error_frames;   /**< maximum number of frames missed before the entry was added (see conv_hash_t) */
 
     gboolean modified;      /**< new to redraw the row */
 
@@ -204,6 +219,15 @@ WS_DLL_PUBLIC void conversation_table_iterate_tables(wmem_foreach_func func, voi
  */
 WS_DLL_PUBLIC guint conversation_table_get_num(void);
 
+/** Limit the number of entries kept in a conversation or hostlist table,
+ * keeping the ones with the most frames. Must be called before any data is
+ * added to the table.
+ *
+ * @param ch the table
+ * @param max_entries maximum number of entries, 0 for no limit
+ */
+WS_DLL_PUBLIC void conversation_table_set_max_entries(conv_hash_t *ch, guint max_entries);
+
 /** Remove all entries from the conversation table.
  *
  * @param ch the table to reset
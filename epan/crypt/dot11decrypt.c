@@ -123,6 +123,8 @@ static INT Dot11DecryptRsnaPwd2PskStep(
  * It calculates the passphrase-to-PSK mapping reccomanded for use with
  * RSNAs. This implementation uses the PBKDF2 method defined in the RFC
  * 2898.
+ * @param ctx [IN|OUT] context whose PMK cache is used to avoid running
+ * PBKDF2 again for a passphrase and SSID seen before
  * @param passphrase [IN] pointer to a password (sequence of between 8 and
  * 63 ASCII encoded characters)
  * @param ssid [IN] pointer to the SSID string encoded in max 32 ASCII
@@ -132,6 +134,7 @@ static INT Dot11DecryptRsnaPwd2PskStep(
  * Described in 802.11i-2004, page 165
  */
 static INT Dot11DecryptRsnaPwd2Psk(
+    PDOT11DECRYPT_CONTEXT ctx,
     const CHAR *passphrase,
     const CHAR *ssid,
     const size_t ssidLength,
@@ -1056,7 +1059,7 @@ INT Dot11DecryptSetKeys(
         if (Dot11DecryptValidateKey(keys+i)==TRUE) {
             if (keys[i].KeyType==DOT11DECRYPT_KEY_TYPE_WPA_PWD) {
                 DOT11DECRYPT_DEBUG_PRINT_LINE("Dot11DecryptSetKeys", "Set a WPA-PWD key", DOT11DECRYPT_DEBUG_LEVEL_4);
-                Dot11DecryptRsnaPwd2Psk(keys[i].UserPwd.Passphrase, keys[i].UserPwd.Ssid, keys[i].UserPwd.SsidLen, keys[i].KeyData.Wpa.Psk);
+                Dot11DecryptRsnaPwd2Psk(ctx, keys[i].UserPwd.Passphrase, keys[i].UserPwd.Ssid, keys[i].UserPwd.SsidLen, keys[i].KeyData.Wpa.Psk);
             }
 #ifdef DOT11DECRYPT_DEBUG
             else if (keys[i].KeyType==DOT11DECRYPT_KEY_TYPE_WPA_PMK) {
@@ -1210,6 +1213,11 @@ INT Dot11DecryptDestroyContext(
     Dot11DecryptCleanKeys(ctx);
     Dot11DecryptCleanSecAssoc(ctx);
 
+    if (ctx->pmk_cache) {
+        g_hash_table_destroy(ctx->pmk_cache);
+        ctx->pmk_cache = NULL;
+    }
+
     ctx->first_free_index=0;
     ctx->index=-1;
     ctx->sa_index=-1;
@@ -1659,7 +1667,7 @@ Dot11DecryptRsna4WHandshake(
                         memcpy(&pkt_key, tmp_key, sizeof(pkt_key));
                         memcpy(&pkt_key.UserPwd.Ssid, ctx->pkt_ssid, ctx->pkt_ssid_len);
                          pkt_key.UserPwd.SsidLen = ctx->pkt_ssid_len;
-                        Dot11DecryptRsnaPwd2Psk(pkt_key.UserPwd.Passphrase, pkt_key.UserPwd.Ssid,
+                        Dot11DecryptRsnaPwd2Psk(ctx, pkt_key.UserPwd.Passphrase, pkt_key.UserPwd.Ssid,
                             pkt_key.UserPwd.SsidLen, pkt_key.KeyData.Wpa.Psk);
                         tmp_pkt_key = &pkt_key;
                     } else {
@@ -2475,18 +2483,49 @@ Dot11DecryptRsnaPwd2PskStep(
     return DOT11DECRYPT_RET_SUCCESS;
 }
 
+/* Upper bound on the number of cached PMKs, each is only a few dozen bytes. */
+#define DOT11DECRYPT_PMK_CACHE_MAX  4096
+
 static INT
 Dot11DecryptRsnaPwd2Psk(
+    PDOT11DECRYPT_CONTEXT ctx,
     const CHAR *passphrase,
     const CHAR *ssid,
     const size_t ssidLength,
     UCHAR *output)
 {
     UCHAR m_output[40] = { 0 };
-    GByteArray *pp_ba = g_byte_array_new();
+    GByteArray *pp_ba;
+    GBytes *cache_key;
+    GBytes *pmk;
+
+    /* The key is "<SSID length><SSID><passphrase>". PBKDF2 with 2 * 4096
+     * HMAC-SHA1 rounds is by far the most expensive step of WPA-PWD
+     * decryption, and with wildcard SSIDs it is repeated for every 4-way
+     * handshake. */
+    {
+        GByteArray *key_ba = g_byte_array_new();
+        guint8 ssid_len = (guint8)ssidLength;
+
+        g_byte_array_append(key_ba, &ssid_len, 1);
+        g_byte_array_append(key_ba, (const guint8 *)ssid, (guint)ssidLength);
+        g_byte_array_append(key_ba, (const guint8 *)passphrase, (guint)strlen(passphrase));
+        cache_key = g_byte_array_free_to_bytes(key_ba);
+    }
 
+    if (ctx->pmk_cache) {
+        pmk = (GBytes *)g_hash_table_lookup(ctx->pmk_cache, cache_key);
+        if (pmk) {
+            memcpy(output, g_bytes_get_data(pmk, NULL), DOT11DECRYPT_WPA_PSK_LEN);
+            g_bytes_unref(cache_key);
+            return 0;
+        }
+    }
+
+    pp_ba = g_byte_array_new();
     if (!uri_str_to_bytes(passphrase, pp_ba)) {
         g_byte_array_free(pp_ba, TRUE);
+        g_bytes_unref(cache_key);
         return 0;
     }
 
@@ -2496,6 +2535,16 @@ Dot11DecryptRsnaPwd2Psk(
     memcpy(output, m_output, DOT11DECRYPT_WPA_PSK_LEN);
     g_byte_array_free(pp_ba, TRUE);
 
+    if (!ctx->pmk_cache) {
+        ctx->pmk_cache = g_hash_table_new_full(g_bytes_hash, g_bytes_equal,
+                (GDestroyNotify)g_bytes_unref, (GDestroyNotify)g_bytes_unref);
+    }
+    if (g_hash_table_size(ctx->pmk_cache) < DOT11DECRYPT_PMK_CACHE_MAX) {
+        g_hash_table_insert(ctx->pmk_cache, cache_key, g_bytes_new(m_output, DOT11DECRYPT_WPA_PSK_LEN));
+    } else {
+        g_bytes_unref(cache_key);
+    }
+
     return 0;
 }
 
@@ -138,6 +138,11 @@ typedef struct _DOT11DECRYPT_CONTEXT {
 
 	INT index;
 	INT first_free_index;
+
+	/* PMKs derived from passphrases, keyed by passphrase and SSID. Kept
+	 * across Dot11DecryptInitContext() calls, freed when the context is
+	 * destroyed. */
+	GHashTable *pmk_cache;
 } DOT11DECRYPT_CONTEXT, *PDOT11DECRYPT_CONTEXT;
 
 /************************************************************************/
@@ -435,6 +435,198 @@ dfilter_deprecated_tokens(dfilter_t *df) {
 	return NULL;
 }
 
+/* Find the constant loaded into a register. */
+static fvalue_t *
+dfilter_const_value(const dfilter_t *df, dfvm_value_t *arg)
+{
+	dfvm_insn_t *insn;
+	guint i;
+
+	if (arg->type != REGISTER)
+		return NULL;
+
+	for (i = 0; i < df->consts->len; i++) {
+		insn = (dfvm_insn_t *)g_ptr_array_index(df->consts, i);
+		if (insn->op == PUT_FVALUE &&
+		    insn->arg2->value.numeric == arg->value.numeric)
+			return insn->arg1->value.fvalue;
+	}
+	return NULL;
+}
+
+typedef void (*dfilter_comparison_func)(header_field_info *hfinfo,
+    dfvm_opcode_t op, fvalue_t *value, void *user_data);
+
+/*
+ * Call func for each comparison of a field with a constant that has to
+ * be true for the filter to match, turned around to "field op constant"
+ * if the constant comes first.
+ *
+ * Returns FALSE if the filter is too complicated for us to tell.
+ */
+static gboolean
+dfilter_foreach_required_comparison(const dfilter_t *df,
+    dfilter_comparison_func func, void *user_data)
+{
+	header_field_info **reg_fields;
+	header_field_info *hfinfo;
+	dfvm_insn_t *insn, *next;
+	dfvm_opcode_t op;
+	fvalue_t *value;
+	guint i, last;
+
+	if (df == NULL || df->insns->len == 0)
+		return FALSE;
+	last = df->insns->len - 1;
+
+	/*
+	 * A jump past a comparison can only make the filter match if
+	 * something inverts the result afterwards; don't try to work out
+	 * where that's safe.
+	 */
+	for (i = 0; i <= last; i++) {
+		insn = (dfvm_insn_t *)g_ptr_array_index(df->insns, i);
+		if (insn->op == NOT)
+			return FALSE;
+	}
+
+	/* The field each register has been read from, if any. */
+	reg_fields = g_new0(header_field_info *, df->num_registers);
+
+	/*
+	 * A comparison has to be true for the filter to match if a false
+	 * result goes straight to the end, and nothing before it can have
+	 * gone to the end with a true result, which only an "or" does.
+	 */
+	for (i = 0; i < last; i++) {
+		insn = (dfvm_insn_t *)g_ptr_array_index(df->insns, i);
+		op = insn->op;
+		if (op == IF_TRUE_GOTO)
+			break;
+		if (op == READ_TREE) {
+			if (insn->arg2->value.numeric < df->num_registers)
+				reg_fields[insn->arg2->value.numeric] = insn->arg1->value.hfinfo;
+			continue;
+		}
+		if (op != ANY_EQ && op != ANY_GT && op != ANY_GE &&
+		    op != ANY_LT && op != ANY_LE)
+			continue;
+		next = (dfvm_insn_t *)g_ptr_array_index(df->insns, i + 1);
+		if (next->op != IF_FALSE_GOTO || next->arg1->value.numeric != last)
+			continue;
+
+		if (insn->arg1->type == REGISTER &&
+		    insn->arg1->value.numeric < df->num_registers &&
+		    reg_fields[insn->arg1->value.numeric] != NULL) {
+			hfinfo = reg_fields[insn->arg1->value.numeric];
+			value = dfilter_const_value(df, insn->arg2);
+		} else if (insn->arg2->type == REGISTER &&
+		    insn->arg2->value.numeric < df->num_registers &&
+		    reg_fields[insn->arg2->value.numeric] != NULL) {
+			/* "constant op field"; turn it around. */
+			hfinfo = reg_fields[insn->arg2->value.numeric];
+			value = dfilter_const_value(df, insn->arg1);
+			if (op == ANY_GT)
+				op = ANY_LT;
+			else if (op == ANY_GE)
+				op = ANY_LE;
+			else if (op == ANY_LT)
+				op = ANY_GT;
+			else if (op == ANY_LE)
+				op = ANY_GE;
+		} else {
+			continue;
+		}
+		if (value != NULL)
+			func(hfinfo, op, value, user_data);
+	}
+	g_free(reg_fields);
+	return TRUE;
+}
+
+typedef struct {
+	header_field_info *hfinfo;
+	nstime_t *start;
+	nstime_t *stop;
+	gboolean found;
+} time_bounds_t;
+
+static void
+dfilter_time_bound(header_field_info *hfinfo, dfvm_opcode_t op,
+    fvalue_t *value, void *user_data)
+{
+	static const nstime_t one_ns = { 0, 1 };
+	time_bounds_t *bounds = (time_bounds_t *)user_data;
+	const nstime_t *ts;
+	nstime_t upper;
+
+	if (hfinfo != bounds->hfinfo ||
+	    fvalue_type_ftenum(value) != FT_ABSOLUTE_TIME)
+		return;
+	ts = (const nstime_t *)fvalue_get(value);
+
+	if (op == ANY_EQ || op == ANY_GT || op == ANY_GE) {
+		/* "Greater than" still starts at the constant. */
+		if (nstime_is_unset(bounds->start) || nstime_cmp(ts, bounds->start) > 0)
+			*bounds->start = *ts;
+	}
+	if (op == ANY_EQ || op == ANY_LT || op == ANY_LE) {
+		upper = *ts;
+		if (op != ANY_LT)
+			nstime_add(&upper, &one_ns);
+		if (nstime_is_unset(bounds->stop) || nstime_cmp(&upper, bounds->stop) < 0)
+			*bounds->stop = upper;
+	}
+	bounds->found = TRUE;
+}
+
+gboolean
+dfilter_get_time_bounds(const dfilter_t *df, const char *field,
+    nstime_t *start, nstime_t *stop)
+{
+	time_bounds_t bounds;
+
+	nstime_set_unset(start);
+	nstime_set_unset(stop);
+
+	bounds.hfinfo = proto_registrar_get_byname(field);
+	if (bounds.hfinfo == NULL || bounds.hfinfo->type != FT_ABSOLUTE_TIME)
+		return FALSE;
+	bounds.start = start;
+	bounds.stop = stop;
+	bounds.found = FALSE;
+
+	if (!dfilter_foreach_required_comparison(df, dfilter_time_bound, &bounds))
+		return FALSE;
+	return bounds.found;
+}
+
+typedef struct {
+	dfilter_equality_func func;
+	void *user_data;
+} equality_data_t;
+
+static void
+dfilter_equality(header_field_info *hfinfo, dfvm_opcode_t op,
+    fvalue_t *value, void *user_data)
+{
+	equality_data_t *data = (equality_data_t *)user_data;
+
+	if (op == ANY_EQ)
+		data->func(hfinfo, value, data->user_data);
+}
+
+gboolean
+dfilter_foreach_required_equality(const dfilter_t *df,
+    dfilter_equality_func func, void *user_data)
+{
+	equality_data_t data;
+
+	data.func = func;
+	data.user_data = user_data;
+	return dfilter_foreach_required_comparison(df, dfilter_equality, &data);
+}
+
 void
 dfilter_dump(dfilter_t *df)
 {
@@ -76,6 +76,32 @@ WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
 
+/* Get the range of values of an absolute time field that every packet
+ * matching the dfilter must have, from comparisons of the field with
+ * constants that have to be true for the filter to match. *start is
+ * the inclusive lower bound and *stop the exclusive upper bound; either
+ * is left unset (see nstime_is_unset()) if the filter doesn't bound it.
+ *
+ * Returns TRUE if at least one bound was found. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_get_time_bounds(const dfilter_t *df, const char *field,
+    nstime_t *start, nstime_t *stop);
+
+typedef void (*dfilter_equality_func)(header_field_info *hfinfo,
+    fvalue_t *value, void *user_data);
+
+/* Call func for each "field == constant" comparison that has to be true
+ * for the dfilter to match. A field that can occur more than once in a
+ * packet only has to have the value once.
+ *
+ * Returns FALSE, without calling func, if the filter is too complicated
+ * to tell. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_foreach_required_equality(const dfilter_t *df,
+    dfilter_equality_func func, void *user_data);
+
 /* Print bytecode of dfilter to stdout */
 WS_DLL_PUBLIC
 void
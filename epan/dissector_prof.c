@@ -0,0 +1,332 @@
+/* dissector_prof.c
+ * Per-dissector CPU and allocation profiler
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROF_READ_TICKS()	((guint64)__rdtsc())
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROF_READ_TICKS()	((guint64)__rdtsc())
+#else
+/* No cycle counter we know how to read; fall back to microseconds. */
+#define PROF_READ_TICKS()	((guint64)g_get_monotonic_time())
+#endif
+
+#include "proto.h"
+#include "wmem/wmem.h"
+#include "dissector_prof.h"
+
+/*
+ * Deepest nesting we keep timing information for. Deeper calls are still
+ * counted, just not timed. This matches PINFO_LAYER_MAX_RECURSION_DEPTH
+ * in packet.c.
+ */
+#define PROF_MAX_DEPTH 500
+
+struct _dissector_prof_entry {
+	int      proto_id;
+	guint    active;         /* number of frames for this entry on the stack */
+	guint64  calls;
+	guint64  sampled_calls;
+	guint64  incl_ticks;
+	guint64  excl_ticks;
+	guint64  incl_bytes;
+	guint64  excl_bytes;
+};
+
+typedef struct {
+	dissector_prof_entry_t *entry;
+	guint64  start_ticks;
+	guint64  start_bytes;
+	guint64  child_ticks;
+	guint64  child_bytes;
+} prof_frame_t;
+
+static gboolean prof_enabled = FALSE;
+static gboolean prof_sampling = FALSE;
+static guint    prof_sample_interval = 1;
+static guint    prof_sample_countdown = 0;
+
+static guint64  prof_packets = 0;
+static guint64  prof_sampled_packets = 0;
+
+/* Reference points used to convert ticks into microseconds. */
+static guint64  prof_calib_ticks = 0;
+static gint64   prof_calib_usec = 0;
+
+/* int proto_id -> dissector_prof_entry_t * */
+static GHashTable *prof_entries = NULL;
+
+static prof_frame_t prof_stack[PROF_MAX_DEPTH];
+static int prof_depth = 0;
+
+/* Forget any open frames, e.g. ones abandoned by an uncaught exception. */
+static void
+prof_drop_frames(void)
+{
+	while (prof_depth > 0)
+		prof_stack[--prof_depth].entry->active--;
+}
+
+static void
+prof_entry_clear(gpointer key _U_, gpointer value, gpointer user_data _U_)
+{
+	dissector_prof_entry_t *entry = (dissector_prof_entry_t *)value;
+	int proto_id = entry->proto_id;
+
+	memset(entry, 0, sizeof(*entry));
+	entry->proto_id = proto_id;
+}
+
+void
+dissector_prof_reset(void)
+{
+	prof_drop_frames();
+	if (prof_entries)
+		g_hash_table_foreach(prof_entries, prof_entry_clear, NULL);
+
+	prof_packets = 0;
+	prof_sampled_packets = 0;
+	prof_sample_countdown = 0;
+	prof_calib_ticks = PROF_READ_TICKS();
+	prof_calib_usec = g_get_monotonic_time();
+}
+
+void
+dissector_prof_enable(gboolean enable, guint sample_interval)
+{
+	if (enable && !prof_enabled)
+		dissector_prof_reset();
+
+	prof_enabled = enable;
+	prof_sampling = FALSE;
+	prof_sample_interval = sample_interval ? sample_interval : 1;
+	prof_drop_frames();
+}
+
+gboolean
+dissector_prof_is_enabled(void)
+{
+	return prof_enabled;
+}
+
+void
+dissector_prof_get_packet_counts(guint64 *packets, guint64 *sampled_packets)
+{
+	if (packets)
+		*packets = prof_packets;
+	if (sampled_packets)
+		*sampled_packets = prof_sampled_packets;
+}
+
+void
+dissector_prof_begin_packet(void)
+{
+	if (!prof_enabled)
+		return;
+
+	/*
+	 * Frames left over from a packet whose dissection was abandoned
+	 * by an exception are simply dropped.
+	 */
+	prof_drop_frames();
+
+	prof_packets++;
+	if (prof_sample_countdown == 0) {
+		prof_sampling = TRUE;
+		prof_sampled_packets++;
+		prof_sample_countdown = prof_sample_interval - 1;
+	} else {
+		prof_sampling = FALSE;
+		prof_sample_countdown--;
+	}
+}
+
+static dissector_prof_entry_t *
+prof_lookup(int proto_id)
+{
+	dissector_prof_entry_t *entry;
+
+	if (!prof_entries)
+		prof_entries = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+	entry = (dissector_prof_entry_t *)g_hash_table_lookup(prof_entries, GINT_TO_POINTER(proto_id));
+	if (!entry) {
+		entry = g_new0(dissector_prof_entry_t, 1);
+		entry->proto_id = proto_id;
+		g_hash_table_insert(prof_entries, GINT_TO_POINTER(proto_id), entry);
+	}
+	return entry;
+}
+
+int
+dissector_prof_enter(dissector_prof_entry_t **cache, int proto_id)
+{
+	dissector_prof_entry_t *entry;
+	prof_frame_t *frame;
+
+	if (!prof_enabled)
+		return -1;
+
+	if (cache) {
+		if (!*cache)
+			*cache = prof_lookup(proto_id);
+		entry = *cache;
+	} else {
+		entry = prof_lookup(proto_id);
+	}
+
+	entry->calls++;
+
+	if (!prof_sampling || prof_depth >= PROF_MAX_DEPTH)
+		return -1;
+
+	entry->sampled_calls++;
+	entry->active++;
+
+	frame = &prof_stack[prof_depth];
+	frame->entry = entry;
+	frame->child_ticks = 0;
+	frame->child_bytes = 0;
+	frame->start_bytes = wmem_get_total_allocated();
+	frame->start_ticks = PROF_READ_TICKS();
+
+	return prof_depth++;
+}
+
+void
+dissector_prof_leave(int token)
+{
+	guint64 now_ticks, now_bytes;
+
+	if (token < 0 || token >= prof_depth)
+		return;
+
+	now_ticks = PROF_READ_TICKS();
+	now_bytes = wmem_get_total_allocated();
+
+	/*
+	 * Normally token is the top of the stack; callers close their frame
+	 * in a FINALLY block, so an exception doesn't leave it open. Anything
+	 * still above it is closed now, charging it until this point.
+	 */
+	while (prof_depth > token) {
+		prof_frame_t *frame = &prof_stack[--prof_depth];
+		dissector_prof_entry_t *entry = frame->entry;
+		guint64 incl_ticks = now_ticks - frame->start_ticks;
+		guint64 incl_bytes = now_bytes - frame->start_bytes;
+
+		entry->excl_ticks += incl_ticks - MIN(incl_ticks, frame->child_ticks);
+		entry->excl_bytes += incl_bytes - MIN(incl_bytes, frame->child_bytes);
+
+		/* Only count recursive calls (e.g. IP in IP) once inclusively. */
+		if (--entry->active == 0) {
+			entry->incl_ticks += incl_ticks;
+			entry->incl_bytes += incl_bytes;
+		}
+
+		if (prof_depth > 0) {
+			prof_stack[prof_depth - 1].child_ticks += incl_ticks;
+			prof_stack[prof_depth - 1].child_bytes += incl_bytes;
+		}
+	}
+}
+
+static gint
+prof_stat_compare(gconstpointer a, gconstpointer b)
+{
+	const dissector_prof_stat_t *sa = (const dissector_prof_stat_t *)a;
+	const dissector_prof_stat_t *sb = (const dissector_prof_stat_t *)b;
+
+	if (sa->excl_usec > sb->excl_usec)
+		return -1;
+	if (sa->excl_usec < sb->excl_usec)
+		return 1;
+	if (sa->calls > sb->calls)
+		return -1;
+	if (sa->calls < sb->calls)
+		return 1;
+	return 0;
+}
+
+GArray *
+dissector_prof_snapshot(void)
+{
+	GArray *stats = g_array_new(FALSE, FALSE, sizeof(dissector_prof_stat_t));
+	GHashTableIter iter;
+	gpointer value;
+	gdouble ticks_per_usec = 1.0;
+	gint64 elapsed_usec;
+
+	elapsed_usec = g_get_monotonic_time() - prof_calib_usec;
+	if (elapsed_usec > 0)
+		ticks_per_usec = (gdouble)(PROF_READ_TICKS() - prof_calib_ticks) / (gdouble)elapsed_usec;
+	if (ticks_per_usec <= 0.0)
+		ticks_per_usec = 1.0;
+
+	if (!prof_entries)
+		return stats;
+
+	g_hash_table_iter_init(&iter, prof_entries);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		const dissector_prof_entry_t *entry = (const dissector_prof_entry_t *)value;
+		dissector_prof_stat_t stat;
+		gdouble scale;
+
+		if (entry->calls == 0)
+			continue;
+
+		/* Extrapolate the sampled figures to all calls. */
+		scale = entry->sampled_calls ? (gdouble)entry->calls / (gdouble)entry->sampled_calls : 0.0;
+
+		stat.proto_id = entry->proto_id;
+		stat.proto_name = proto_get_protocol_filter_name(entry->proto_id);
+		stat.calls = entry->calls;
+		stat.sampled_calls = entry->sampled_calls;
+		stat.incl_usec = entry->incl_ticks * scale / ticks_per_usec;
+		stat.excl_usec = entry->excl_ticks * scale / ticks_per_usec;
+		stat.incl_bytes = (guint64)(entry->incl_bytes * scale);
+		stat.excl_bytes = (guint64)(entry->excl_bytes * scale);
+		g_array_append_val(stats, stat);
+	}
+
+	g_array_sort(stats, prof_stat_compare);
+	return stats;
+}
+
+void
+dissector_prof_cleanup(void)
+{
+	prof_enabled = FALSE;
+	prof_drop_frames();
+	if (prof_entries) {
+		g_hash_table_destroy(prof_entries);
+		prof_entries = NULL;
+	}
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
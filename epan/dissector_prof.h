@@ -0,0 +1,114 @@
+/* dissector_prof.h
+ * Definitions for the per-dissector CPU and allocation profiler
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __DISSECTOR_PROF_H__
+#define __DISSECTOR_PROF_H__
+
+#include <glib.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * Optional instrumentation of call_dissector_through_handle() and the
+ * heuristic dissector loops. When enabled, every dissector call is counted
+ * per protocol. Timestamps (TSC where available) and wmem allocation totals
+ * are only read for one packet out of every "sample interval" packets, so the
+ * overhead stays small enough for production use; the reported times and
+ * byte counts are scaled up to estimates over all calls.
+ *
+ * Inclusive figures cover the dissector and everything it called, exclusive
+ * figures subtract the time and memory attributed to profiled subdissectors.
+ * Byte counts come from wmem_get_total_allocated() and so include the full
+ * new size of every wmem_realloc().
+ */
+
+/** Profile results for one protocol, as returned by dissector_prof_snapshot() */
+typedef struct _dissector_prof_stat_t {
+	int         proto_id;
+	const char *proto_name;     /**< protocol filter name */
+	guint64     calls;          /**< number of dissector calls */
+	guint64     sampled_calls;  /**< calls made while sampling a packet */
+	gdouble     incl_usec;      /**< estimated inclusive time, microseconds */
+	gdouble     excl_usec;      /**< estimated exclusive time, microseconds */
+	guint64     incl_bytes;     /**< estimated inclusive wmem allocations */
+	guint64     excl_bytes;     /**< estimated exclusive wmem allocations */
+} dissector_prof_stat_t;
+
+/** Turn profiling on or off.
+ *
+ * @param enable TRUE to start collecting
+ * @param sample_interval time one packet out of this many (0 and 1 mean
+ * every packet)
+ */
+WS_DLL_PUBLIC void dissector_prof_enable(gboolean enable, guint sample_interval);
+
+/** Is profiling currently enabled? */
+WS_DLL_PUBLIC gboolean dissector_prof_is_enabled(void);
+
+/** Discard everything collected so far. */
+WS_DLL_PUBLIC void dissector_prof_reset(void);
+
+/** Return the number of packets seen and sampled since the last reset. */
+WS_DLL_PUBLIC void dissector_prof_get_packet_counts(guint64 *packets, guint64 *sampled_packets);
+
+/** Collect the current results.
+ *
+ * @return a GArray of dissector_prof_stat_t, one per protocol that was
+ * called at least once, sorted by descending exclusive time. The caller
+ * must free it with g_array_free(array, TRUE).
+ */
+WS_DLL_PUBLIC GArray *dissector_prof_snapshot(void);
+
+/* Hooks used by packet.c. */
+struct _dissector_prof_entry;
+typedef struct _dissector_prof_entry dissector_prof_entry_t;
+
+/** Called at the start of every record; decides whether it is sampled. */
+extern void dissector_prof_begin_packet(void);
+
+/** Account for a call into the dissector for proto_id.
+ *
+ * @param cache if non-NULL, points to a per-handle slot used to avoid
+ * looking up the protocol entry on every call
+ * @param proto_id protocol the dissector belongs to
+ * @return a token to pass to dissector_prof_leave(), or -1 if the call
+ * isn't being timed
+ */
+extern int dissector_prof_enter(dissector_prof_entry_t **cache, int proto_id);
+
+/** Account for the return from a dissector call. Call it from a FINALLY
+ * block, so that the frame is also closed when the dissector throws and
+ * the time until the exception is caught isn't charged to it. Any deeper
+ * frames that were left open are closed as well. */
+extern void dissector_prof_leave(int token);
+
+extern void dissector_prof_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __DISSECTOR_PROF_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
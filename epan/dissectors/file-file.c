@@ -126,7 +126,7 @@ dissect_file_record(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
 
 		if(pinfo->fd->pfd != 0){
 			proto_item *ppd_item;
-			guint num_entries = g_slist_length(pinfo->fd->pfd);
+			guint num_entries = p_get_proto_data_count(wmem_file_scope(), pinfo);
 			guint i;
 			ppd_item = proto_tree_add_uint(fh_tree, hf_file_num_p_prot_data, tvb, 0, 0, num_entries);
 			proto_item_set_generated(ppd_item);
@@ -138,10 +138,13 @@ dissect_file_record(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
 
 #if 0
 		if (show_file_off) {
-			proto_tree_add_int64_format_value(fh_tree, hf_frame_file_off, tvb,
-						    0, 0, pinfo->fd->file_off,
-						    "%" G_GINT64_MODIFIER "d (0x%" G_GINT64_MODIFIER "x)",
-						    pinfo->fd->file_off, pinfo->fd->file_off);
+			gint64 file_off = epan_get_frame_file_off(pinfo->epan, pinfo->fd);
+
+			if (file_off >= 0)
+				proto_tree_add_int64_format_value(fh_tree, hf_frame_file_off, tvb,
+							    0, 0, file_off,
+							    "%" G_GINT64_MODIFIER "d (0x%" G_GINT64_MODIFIER "x)",
+							    file_off, file_off);
 		}
 #endif
 	}
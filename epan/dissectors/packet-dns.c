@@ -4184,17 +4184,17 @@ static void dns_stats_tree_init(stats_tree* st)
 static tap_packet_status dns_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p)
 {
   const struct DnsTap *pi = (const struct DnsTap *)p;
-  tick_stat_node(st, st_str_packets, 0, FALSE);
-  stats_tree_tick_pivot(st, st_node_packet_qr,
-          val_to_str(pi->packet_qr, dns_qr_vals, "Unknown qr (%d)"));
-  stats_tree_tick_pivot(st, st_node_packet_qtypes,
-          val_to_str(pi->packet_qtype, dns_types_description_vals, "Unknown packet type (%d)"));
-  stats_tree_tick_pivot(st, st_node_packet_qclasses,
-          val_to_str(pi->packet_qclass, dns_classes, "Unknown class (%d)"));
-  stats_tree_tick_pivot(st, st_node_packet_rcodes,
-          val_to_str(pi->packet_rcode, rcode_vals, "Unknown rcode (%d)"));
-  stats_tree_tick_pivot(st, st_node_packet_opcodes,
-          val_to_str(pi->packet_opcode, opcode_vals, "Unknown opcode (%d)"));
+  tick_stat_node_by_id(st, st_node_packets);
+  stats_tree_tick_pivot_uint(st, st_node_packet_qr, pi->packet_qr,
+          dns_qr_vals, "Unknown qr (%d)");
+  stats_tree_tick_pivot_uint(st, st_node_packet_qtypes, pi->packet_qtype,
+          dns_types_description_vals, "Unknown packet type (%d)");
+  stats_tree_tick_pivot_uint(st, st_node_packet_qclasses, pi->packet_qclass,
+          dns_classes, "Unknown class (%d)");
+  stats_tree_tick_pivot_uint(st, st_node_packet_rcodes, pi->packet_rcode,
+          rcode_vals, "Unknown rcode (%d)");
+  stats_tree_tick_pivot_uint(st, st_node_packet_opcodes, pi->packet_opcode,
+          opcode_vals, "Unknown opcode (%d)");
   avg_stat_node_add_value_int(st, st_str_packets_avg_size, 0, FALSE,
           pi->payload_size);
 
@@ -207,6 +207,7 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 	proto_tree  *volatile fh_tree = NULL;
 	proto_item  *item;
 	const gchar *cap_plurality, *frame_plurality;
+	nstime_t     shift_offset;
 	frame_data_t *fr_data = (frame_data_t*)data;
 	const color_filter_t *color_filter;
 	dissector_handle_t dissector_handle;
@@ -476,8 +477,9 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 								  " the valid range is 0-1000000000",
 								  (long) pinfo->abs_ts.nsecs);
 			}
+			epan_get_frame_shift(pinfo->epan, pinfo->num, &shift_offset);
 			item = proto_tree_add_time(fh_tree, hf_frame_shift_offset, tvb,
-					    0, 0, &(pinfo->fd->shift_offset));
+					    0, 0, &shift_offset);
 			proto_item_set_generated(item);
 
 			if (generate_epoch_time) {
@@ -561,10 +563,13 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 		}
 
 		if (show_file_off) {
-			proto_tree_add_int64_format_value(fh_tree, hf_frame_file_off, tvb,
-						    0, 0, pinfo->fd->file_off,
-						    "%" G_GINT64_MODIFIER "d (0x%" G_GINT64_MODIFIER "x)",
-						    pinfo->fd->file_off, pinfo->fd->file_off);
+			gint64 file_off = epan_get_frame_file_off(pinfo->epan, pinfo->fd);
+
+			if (file_off >= 0)
+				proto_tree_add_int64_format_value(fh_tree, hf_frame_file_off, tvb,
+							    0, 0, file_off,
+							    "%" G_GINT64_MODIFIER "d (0x%" G_GINT64_MODIFIER "x)",
+							    file_off, file_off);
 		}
 	}
 
@@ -473,33 +473,26 @@ http_reqs_stats_tree_packet(stats_tree* st, packet_info* pinfo, epan_dissect_t*
 	int reqs_by_this_addr;
 	int resps_by_this_addr;
 	int i = v->response_code;
-	gchar *ip_str;
 
 
 	if (v->request_method) {
-		ip_str = address_to_str(NULL, &pinfo->dst);
-
-		tick_stat_node(st, st_str_reqs, 0, FALSE);
-		tick_stat_node(st, st_str_reqs_by_srv_addr, st_node_reqs, TRUE);
-		tick_stat_node(st, st_str_reqs_by_http_host, st_node_reqs, TRUE);
-		reqs_by_this_addr = tick_stat_node(st, ip_str, st_node_reqs_by_srv_addr, TRUE);
+		tick_stat_node_by_id(st, st_node_reqs);
+		tick_stat_node_by_id(st, st_node_reqs_by_srv_addr);
+		tick_stat_node_by_id(st, st_node_reqs_by_http_host);
+		reqs_by_this_addr = stats_tree_tick_node_address(st, st_node_reqs_by_srv_addr, &pinfo->dst, TRUE);
 
 		if (v->http_host) {
 			reqs_by_this_host = tick_stat_node(st, v->http_host, st_node_reqs_by_http_host, TRUE);
-			tick_stat_node(st, ip_str, reqs_by_this_host, FALSE);
+			stats_tree_tick_node_address(st, reqs_by_this_host, &pinfo->dst, FALSE);
 
 			tick_stat_node(st, v->http_host, reqs_by_this_addr, FALSE);
 		}
 
-		wmem_free(NULL, ip_str);
-
 		return TAP_PACKET_REDRAW;
 
 	} else if (i != 0) {
-		ip_str = address_to_str(NULL, &pinfo->src);
-
-		tick_stat_node(st, st_str_resps_by_srv_addr, 0, FALSE);
-		resps_by_this_addr = tick_stat_node(st, ip_str, st_node_resps_by_srv_addr, TRUE);
+		tick_stat_node_by_id(st, st_node_resps_by_srv_addr);
+		resps_by_this_addr = stats_tree_tick_node_address(st, st_node_resps_by_srv_addr, &pinfo->src, TRUE);
 
 		if ( (i>100)&&(i<400) ) {
 			tick_stat_node(st, "OK", resps_by_this_addr, FALSE);
@@ -507,8 +500,6 @@ http_reqs_stats_tree_packet(stats_tree* st, packet_info* pinfo, epan_dissect_t*
 			tick_stat_node(st, "KO", resps_by_this_addr, FALSE);
 		}
 
-		wmem_free(NULL, ip_str);
-
 		return TAP_PACKET_REDRAW;
 	}
 
@@ -589,50 +580,56 @@ http_stats_tree_init(stats_tree* st)
 	st_node_other = stats_tree_create_node(st, st_str_other, st_node_packets, STAT_DT_INT, FALSE);
 }
 
+/* Names a status code node: "200 OK" */
+static gchar *
+http_status_node_name(const void *key, guint key_len _U_, const void *name_data _U_)
+{
+	guint32 code;
+	gchar *code_str;
+	gchar *name;
+
+	memcpy(&code, key, sizeof code);
+	code_str = val_to_str_wmem(NULL, code, vals_http_status_code, "Unknown (%d)");
+	name = g_strdup_printf("%u %s", code, code_str);
+	wmem_free(NULL, code_str);
+	return name;
+}
+
 /* HTTP/Packet Counter stats packet function */
 static tap_packet_status
 http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p)
 {
 	const http_info_value_t* v = (const http_info_value_t*)p;
-	guint i = v->response_code;
+	guint32 i = v->response_code;
 	int resp_grp;
-	const gchar *resp_str;
-	gchar str[64];
 
-	tick_stat_node(st, st_str_packets, 0, FALSE);
+	tick_stat_node_by_id(st, st_node_packets);
 
 	if (i) {
-		tick_stat_node(st, st_str_responses, st_node_packets, FALSE);
+		tick_stat_node_by_id(st, st_node_responses);
 
 		if ( (i<100)||(i>=600) ) {
 			resp_grp = st_node_resp_broken;
-			resp_str = st_str_resp_broken;
 		} else if (i<200) {
 			resp_grp = st_node_resp_100;
-			resp_str = st_str_resp_100;
 		} else if (i<300) {
 			resp_grp = st_node_resp_200;
-			resp_str = st_str_resp_200;
 		} else if (i<400) {
 			resp_grp = st_node_resp_300;
-			resp_str = st_str_resp_300;
 		} else if (i<500) {
 			resp_grp = st_node_resp_400;
-			resp_str = st_str_resp_400;
 		} else {
 			resp_grp = st_node_resp_500;
-			resp_str = st_str_resp_500;
 		}
 
-		tick_stat_node(st, resp_str, st_node_responses, FALSE);
+		tick_stat_node_by_id(st, resp_grp);
 
-		g_snprintf(str, sizeof(str), "%u %s", i,
-			   val_to_str(i, vals_http_status_code, "Unknown (%d)"));
-		tick_stat_node(st, str, resp_grp, FALSE);
+		stats_tree_manip_node_by_key(MN_INCREASE, st, resp_grp, &i, sizeof i,
+					     http_status_node_name, NULL, FALSE, 1);
 	} else if (v->request_method) {
 		stats_tree_tick_pivot(st,st_node_requests,v->request_method);
 	} else {
-		tick_stat_node(st, st_str_other, st_node_packets, FALSE);
+		tick_stat_node_by_id(st, st_node_other);
 	}
 
 	return TAP_PACKET_REDRAW;
@@ -4201,6 +4198,7 @@ proto_register_http(void)
 	register_follow_stream(proto_http, "http_follow", tcp_follow_conv_filter, tcp_follow_index_filter, tcp_follow_address_filter,
 							tcp_port_to_display, follow_tvb_tap_listener);
 	http_eo_tap = register_export_object(proto_http, http_eo_packet, NULL);
+	set_eo_single_packet(proto_http);
 }
 
 /*
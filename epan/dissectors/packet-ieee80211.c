@@ -88,6 +88,16 @@ typedef struct {
   guint8 *keydata;
 } proto_eapol_keydata_t;
 
+/* Payload decrypted during the first pass, reused when the frame is revisited. */
+typedef struct {
+  const DOT11DECRYPT_KEY_ITEM *used_key;  /* shared, see decryption_used_keys */
+  guint8 algorithm;
+  guint32 sec_header;
+  guint32 sec_trailer;
+  guint len;
+  guint8 *data;
+} proto_decrypted_payload_t;
+
 extern value_string_ext eap_type_vals_ext; /* from packet-eap.c */
 
 #ifndef roundup2
@@ -253,6 +263,7 @@ typedef struct mimo_control
 #define EAPOL_KEY 3
 #define PACKET_DATA_KEY 4
 #define ASSOC_COUNTER_KEY 5
+#define DECRYPTED_PAYLOAD_KEY 6
 /* ************************************************************************* */
 /*  Define some very useful macros that are used to analyze frame types etc. */
 /* ************************************************************************* */
@@ -3213,6 +3224,10 @@ typedef struct retransmit_key {
 static GHashTable *fc_analyse_retransmit_table = NULL;
 static GHashTable *fc_first_frame_table = NULL;
 
+/* Keys that decrypted frames in this file, each stored once with only its
+ * type and key data; decrypted payloads point into this map. */
+static wmem_map_t *decryption_used_keys = NULL;
+
 static int hf_ieee80211_fc_analysis_retransmission = -1;
 static int hf_ieee80211_fc_analysis_retransmission_frame = -1;
 
@@ -25954,6 +25969,36 @@ dissect_wlan_rsna_eapol_wpa_or_rsn_key(tvbuff_t *tvb, packet_info *pinfo, proto_
   return tvb_captured_length(tvb);
 }
 
+static guint
+used_key_hash(gconstpointer key)
+{
+  return wmem_strong_hash((const guint8 *)key, sizeof(DOT11DECRYPT_KEY_ITEM));
+}
+
+static gboolean
+used_key_equal(gconstpointer a, gconstpointer b)
+{
+  return memcmp(a, b, sizeof(DOT11DECRYPT_KEY_ITEM)) == 0;
+}
+
+/* Returns the file scope copy of the type and key data of key, without the
+ * passphrase and SSID it may have been derived from. */
+static const DOT11DECRYPT_KEY_ITEM *
+intern_used_key(const DOT11DECRYPT_KEY_ITEM *key)
+{
+  DOT11DECRYPT_KEY_ITEM stripped, *interned;
+
+  memset(&stripped, 0, sizeof(stripped));
+  stripped.KeyType = key->KeyType;
+  stripped.KeyData = key->KeyData;
+  interned = (DOT11DECRYPT_KEY_ITEM *)wmem_map_lookup(decryption_used_keys, &stripped);
+  if (!interned) {
+    interned = (DOT11DECRYPT_KEY_ITEM *)wmem_memdup(wmem_file_scope(), &stripped, sizeof(stripped));
+    wmem_map_insert(decryption_used_keys, interned, interned);
+  }
+  return interned;
+}
+
 /* It returns the algorithm used for decryption and the header and trailer lengths. */
 static tvbuff_t *
 try_decrypt(tvbuff_t *tvb, packet_info *pinfo, guint offset, guint len, gboolean scan_keys,
@@ -25968,6 +26013,20 @@ try_decrypt(tvbuff_t *tvb, packet_info *pinfo, guint offset, guint len, gboolean
   if (!enable_decryption)
     return NULL;
 
+  if (pinfo->fd->visited) {
+    /* Use the result of the first pass; decrypting again is costly and the
+     * security associations may have changed since. */
+    proto_decrypted_payload_t *payload;
+    payload = (proto_decrypted_payload_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_wlan, DECRYPTED_PAYLOAD_KEY);
+    if (payload) {
+      *algorithm = payload->algorithm;
+      *sec_header = payload->sec_header;
+      *sec_trailer = payload->sec_trailer;
+      *used_key = *payload->used_key;
+      return tvb_new_child_real_data(tvb, payload->data, payload->len, payload->len);
+    }
+  }
+
   /* get the entire packet                                  */
   enc_data = tvb_get_ptr(tvb, 0, len+offset);
 
@@ -25993,9 +26052,23 @@ try_decrypt(tvbuff_t *tvb, packet_info *pinfo, guint offset, guint len, gboolean
       default:
         return NULL;
     }
-    /* allocate buffer for decrypted payload                      */
-    tmp = (guint8 *)wmem_memdup(pinfo->pool, dec_data+offset, dec_caplen-offset);
     len = dec_caplen-offset;
+    if (!pinfo->fd->visited) {
+      /* keep the decrypted payload for later passes                */
+      proto_decrypted_payload_t *payload;
+      payload = wmem_new(wmem_file_scope(), proto_decrypted_payload_t);
+      payload->used_key = intern_used_key(used_key);
+      payload->algorithm = *algorithm;
+      payload->sec_header = *sec_header;
+      payload->sec_trailer = *sec_trailer;
+      payload->len = len;
+      payload->data = (guint8 *)wmem_memdup(wmem_file_scope(), dec_data+offset, len);
+      p_add_proto_data(wmem_file_scope(), pinfo, proto_wlan, DECRYPTED_PAYLOAD_KEY, payload);
+      tmp = payload->data;
+    } else {
+      /* allocate buffer for decrypted payload                      */
+      tmp = (guint8 *)wmem_memdup(pinfo->pool, dec_data+offset, len);
+    }
 
     /* decrypt successful, let's set up a new data tvb.              */
     decr_tvb = tvb_new_child_real_data(tvb, tmp, len, len);
@@ -26149,6 +26222,12 @@ weak_iv(guchar *iv)
   return -1;
 }
 
+static void
+wlan_decryption_shutdown(void)
+{
+  Dot11DecryptDestroyContext(&dot11decrypt_ctx);
+}
+
 static void
 wlan_retransmit_init(void)
 {
@@ -37670,6 +37749,8 @@ proto_register_ieee80211(void)
   reassembly_table_register(&wlan_reassembly_table,
                         &addresses_reassembly_table_functions);
   register_init_routine(wlan_retransmit_init);
+  register_shutdown_routine(wlan_decryption_shutdown);
+  decryption_used_keys = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), used_key_hash, used_key_equal);
   reassembly_table_register(&gas_reassembly_table,
                         &addresses_reassembly_table_functions);
 
@@ -2955,6 +2955,12 @@ ssl_create_decoder(const SslCipherSuite *cipher_suite, gint cipher_algo,
         DISSECTOR_ASSERT(iv_length <= sizeof(dec->_mac_key_or_write_iv));
         dec->write_iv.data = dec->_mac_key_or_write_iv;
         ssl_data_set(&dec->write_iv, iv, iv_length);
+        if (sk) {
+            guint key_length = (guint)gcry_cipher_get_algo_keylen(cipher_algo);
+            DISSECTOR_ASSERT(key_length <= sizeof(dec->_write_key));
+            dec->write_key.data = dec->_write_key;
+            ssl_data_set(&dec->write_key, sk, key_length);
+        }
     }
     dec->seq = 0;
     dec->decomp = ssl_create_decompressor(compression);
@@ -3199,6 +3205,190 @@ ssl_generate_pre_master_secret(SslDecryptSession *ssl_session,
     return FALSE;
 }
 
+/* Caches for derived keys and decrypted records. {{{ */
+/*
+ * When a capture is dissected again from scratch (preference changes,
+ * "Reload", Decode As, ...) the file scope is discarded and every TLS
+ * session is set up and decrypted again. The results of both steps only
+ * depend on their inputs, so they are remembered here, outside the file
+ * scope, and looked up by those inputs:
+ *
+ * - (D)TLS 1.2 and earlier key blocks, keyed by the version, cipher suite,
+ *   master secret and both randoms; TLS 1.3 write keys and IVs, keyed by the
+ *   traffic secret and the derivation parameters.
+ * - Plaintext of AEAD records whose authentication tag verified, keyed by
+ *   the write key, the IV, the nonce, the AAD fields, the tag and the whole
+ *   ciphertext. Only AEAD records are cached since their decryption does
+ *   not carry cipher state from one record to the next.
+ *
+ * The record cache is bounded by the "tls.decryption_cache_size"
+ * preference. Once the budget is used up no new records are added, which
+ * keeps the entries useful when the capture is read sequentially again.
+ * Both caches are emptied when the capture file is closed.
+ */
+#define TLS_KEY_CACHE_MAX_ENTRIES   65536
+
+static guint tls_decryption_cache_size = 64;    /* in MiB, 0 disables */
+
+static GHashTable *tls_key_cache = NULL;        /* GBytes -> GBytes */
+static GHashTable *tls_record_cache = NULL;     /* GBytes -> GBytes */
+static gsize tls_record_cache_used = 0;
+
+static void
+tls_cache_append(GByteArray *key, const void *data, guint len)
+{
+    guint8 len_bytes[4];
+
+    /* Length-prefix each part so that the concatenation is unambiguous. */
+    phton32(len_bytes, len);
+    g_byte_array_append(key, len_bytes, 4);
+    if (len) {
+        g_byte_array_append(key, (const guint8 *)data, len);
+    }
+}
+
+static GHashTable *
+tls_cache_table_new(void)
+{
+    return g_hash_table_new_full(g_bytes_hash, g_bytes_equal,
+            (GDestroyNotify)g_bytes_unref, (GDestroyNotify)g_bytes_unref);
+}
+
+static GBytes *
+tls_key_cache_lookup(GBytes *key, guint len)
+{
+    GBytes *value;
+
+    if (!tls_key_cache) {
+        return NULL;
+    }
+    value = (GBytes *)g_hash_table_lookup(tls_key_cache, key);
+    if (value && g_bytes_get_size(value) != len) {
+        return NULL;
+    }
+    return value;
+}
+
+/* Takes ownership of key. */
+static void
+tls_key_cache_insert(GBytes *key, const guchar *data, guint len)
+{
+    if (!tls_key_cache) {
+        tls_key_cache = tls_cache_table_new();
+    }
+    if (g_hash_table_size(tls_key_cache) >= TLS_KEY_CACHE_MAX_ENTRIES) {
+        g_bytes_unref(key);
+        return;
+    }
+    g_hash_table_insert(tls_key_cache, key, g_bytes_new(data, len));
+}
+
+#ifdef HAVE_LIBGCRYPT_AEAD
+/* Simple multiply-xorshift hash over the record key, eight bytes at a time. */
+static guint
+tls_record_cache_hash(gconstpointer key)
+{
+    gsize         len;
+    const guchar *data = (const guchar *)g_bytes_get_data((GBytes *)key, &len);
+    guint64       h = G_GUINT64_CONSTANT(0x9E3779B97F4A7C15) ^ len;
+    gsize         i;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        h ^= pletoh64(data + i);
+        h *= G_GUINT64_CONSTANT(0xBF58476D1CE4E5B9);
+        h ^= h >> 31;
+    }
+    for (; i < len; i++) {
+        h ^= data[i];
+        h *= G_GUINT64_CONSTANT(0x94D049BB133111EB);
+    }
+    h ^= h >> 29;
+    return (guint)(h ^ (h >> 32));
+}
+
+static guint
+tls_record_cache_put(guchar *key, guint offset, const guchar *data, guint len)
+{
+    phton32(key + offset, len);
+    memcpy(key + offset + 4, data, len);
+    return offset + 4 + len;
+}
+
+/*
+ * Builds the lookup key for a record in packet scope and returns its length.
+ * The key holds the write key and every input of the decryption, including
+ * the whole ciphertext and the tag, so a cached plaintext is only returned
+ * for a record that decrypts and authenticates exactly like the cached one.
+ */
+static guint
+tls_record_cache_key(guchar **key, const SslDecoder *decoder, const guchar *nonce, const guchar *aad, guint aad_len,
+        const guchar *ciphertext, guint ciphertext_len, const guchar *auth_tag, guint auth_tag_len)
+{
+    guint offset = 0;
+
+    *key = (guchar *)wmem_alloc(wmem_packet_scope(), 6 * 4 + decoder->write_key.data_len +
+            decoder->write_iv.data_len + 12 + aad_len + auth_tag_len + ciphertext_len);
+    offset = tls_record_cache_put(*key, offset, decoder->write_key.data, decoder->write_key.data_len);
+    offset = tls_record_cache_put(*key, offset, decoder->write_iv.data, decoder->write_iv.data_len);
+    offset = tls_record_cache_put(*key, offset, nonce, 12);
+    offset = tls_record_cache_put(*key, offset, aad, aad_len);
+    offset = tls_record_cache_put(*key, offset, auth_tag, auth_tag_len);
+    offset = tls_record_cache_put(*key, offset, ciphertext, ciphertext_len);
+    return offset;
+}
+
+static GBytes *
+tls_record_cache_lookup(const guchar *key, guint key_len)
+{
+    GBytes *lookup_key, *value;
+
+    if (!tls_record_cache) {
+        return NULL;
+    }
+    if (tls_record_cache_used > (gsize)tls_decryption_cache_size * 1024 * 1024) {
+        /* The budget was lowered; start over. */
+        g_hash_table_remove_all(tls_record_cache);
+        tls_record_cache_used = 0;
+        return NULL;
+    }
+    lookup_key = g_bytes_new_static(key, key_len);
+    value = (GBytes *)g_hash_table_lookup(tls_record_cache, lookup_key);
+    g_bytes_unref(lookup_key);
+    return value;
+}
+
+static void
+tls_record_cache_insert(const guchar *key, guint key_len, const guchar *plaintext, guint len)
+{
+    gsize cost = len + key_len + 64;    /* rough per-entry overhead */
+
+    if (tls_record_cache_used + cost > (gsize)tls_decryption_cache_size * 1024 * 1024) {
+        return;
+    }
+    if (!tls_record_cache) {
+        tls_record_cache = g_hash_table_new_full(tls_record_cache_hash, g_bytes_equal,
+                (GDestroyNotify)g_bytes_unref, (GDestroyNotify)g_bytes_unref);
+    }
+    g_hash_table_insert(tls_record_cache, g_bytes_new(key, key_len), g_bytes_new(plaintext, len));
+    tls_record_cache_used += cost;
+}
+#endif /* HAVE_LIBGCRYPT_AEAD */
+
+static void
+tls_decryption_cache_clear(void)
+{
+    if (tls_key_cache) {
+        g_hash_table_destroy(tls_key_cache);
+        tls_key_cache = NULL;
+    }
+    if (tls_record_cache) {
+        g_hash_table_destroy(tls_record_cache);
+        tls_record_cache = NULL;
+    }
+    tls_record_cache_used = 0;
+}
+/* Caches for derived keys and decrypted records. }}} */
+
 /* Used for (D)TLS 1.2 and earlier versions (not with TLS 1.3). */
 int
 ssl_generate_keyring_material(SslDecryptSession*ssl_session)
@@ -3344,12 +3534,36 @@ ssl_generate_keyring_material(SslDecryptSession*ssl_session)
     needed += 2 * write_iv_len;                             /* write IV */
 
     key_block.data = (guchar *)g_malloc(needed);
-    ssl_debug_printf("%s sess key generation\n", G_STRFUNC);
-    if (!prf(ssl_session, &ssl_session->master_secret, "key expansion",
-            &ssl_session->server_random,&ssl_session->client_random,
-            &key_block, needed)) {
-        ssl_debug_printf("%s can't generate key_block\n", G_STRFUNC);
-        goto fail;
+    {
+        GByteArray *cache_key_data = g_byte_array_new();
+        GBytes     *cache_key, *cached;
+        guint8      params[4];
+
+        phton16(params, ssl_session->session.version);
+        phton16(params + 2, cipher_suite->number);
+        tls_cache_append(cache_key_data, params, sizeof(params));
+        tls_cache_append(cache_key_data, ssl_session->master_secret.data, ssl_session->master_secret.data_len);
+        tls_cache_append(cache_key_data, ssl_session->server_random.data, ssl_session->server_random.data_len);
+        tls_cache_append(cache_key_data, ssl_session->client_random.data, ssl_session->client_random.data_len);
+        cache_key = g_byte_array_free_to_bytes(cache_key_data);
+
+        cached = tls_key_cache_lookup(cache_key, needed);
+        if (cached) {
+            ssl_debug_printf("%s sess key found in cache\n", G_STRFUNC);
+            memcpy(key_block.data, g_bytes_get_data(cached, NULL), needed);
+            key_block.data_len = needed;
+            g_bytes_unref(cache_key);
+        } else {
+            ssl_debug_printf("%s sess key generation\n", G_STRFUNC);
+            if (!prf(ssl_session, &ssl_session->master_secret, "key expansion",
+                    &ssl_session->server_random,&ssl_session->client_random,
+                    &key_block, needed)) {
+                ssl_debug_printf("%s can't generate key_block\n", G_STRFUNC);
+                g_bytes_unref(cache_key);
+                goto fail;
+            }
+            tls_key_cache_insert(cache_key, key_block.data, needed);
+        }
     }
     ssl_print_string("key expansion", &key_block);
 
@@ -3569,13 +3783,44 @@ tls13_generate_keys(SslDecryptSession *ssl_session, const StringInfo *secret, gb
     ssl_debug_printf("%s key_length %u iv_length %u\n", G_STRFUNC, key_length, iv_length);
 
     const char *label_prefix = tls13_hkdf_label_prefix(ssl_session->session.tls13_draft_version);
-    if (!tls13_hkdf_expand_label(hash_algo, secret, label_prefix, "key", key_length, &write_key)) {
-        ssl_debug_printf("%s write_key expansion failed\n", G_STRFUNC);
-        return FALSE;
-    }
-    if (!tls13_hkdf_expand_label(hash_algo, secret, label_prefix, "iv", iv_length, &write_iv)) {
-        ssl_debug_printf("%s write_iv expansion failed\n", G_STRFUNC);
-        goto end;
+    GByteArray *cache_key_data = g_byte_array_new();
+    GBytes     *cache_key, *cached;
+    guint8      params[8];
+
+    phton32(params, hash_algo);
+    phton32(params + 4, key_length);
+    tls_cache_append(cache_key_data, params, sizeof(params));
+    tls_cache_append(cache_key_data, label_prefix, (guint)strlen(label_prefix));
+    tls_cache_append(cache_key_data, secret->data, secret->data_len);
+    cache_key = g_byte_array_free_to_bytes(cache_key_data);
+
+    cached = tls_key_cache_lookup(cache_key, key_length + iv_length);
+    if (cached) {
+        const guchar *cached_data = (const guchar *)g_bytes_get_data(cached, NULL);
+
+        ssl_debug_printf("%s write key and IV found in cache\n", G_STRFUNC);
+        write_key = (guchar *)wmem_memdup(NULL, cached_data, key_length);
+        write_iv = (guchar *)wmem_memdup(NULL, cached_data + key_length, iv_length);
+        g_bytes_unref(cache_key);
+    } else {
+        guchar *key_and_iv;
+
+        if (!tls13_hkdf_expand_label(hash_algo, secret, label_prefix, "key", key_length, &write_key)) {
+            ssl_debug_printf("%s write_key expansion failed\n", G_STRFUNC);
+            g_bytes_unref(cache_key);
+            return FALSE;
+        }
+        if (!tls13_hkdf_expand_label(hash_algo, secret, label_prefix, "iv", iv_length, &write_iv)) {
+            ssl_debug_printf("%s write_iv expansion failed\n", G_STRFUNC);
+            g_bytes_unref(cache_key);
+            goto end;
+        }
+
+        key_and_iv = (guchar *)g_malloc(key_length + iv_length);
+        memcpy(key_and_iv, write_key, key_length);
+        memcpy(key_and_iv + key_length, write_iv, iv_length);
+        tls_key_cache_insert(cache_key, key_and_iv, key_length + iv_length);
+        g_free(key_and_iv);
     }
 
     ssl_print_data(is_from_server ? "Server Write Key" : "Client Write Key", write_key, key_length);
@@ -3878,6 +4123,8 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
     const guint8    draft_version = ssl->session.tls13_draft_version;
     const guchar   *auth_tag_wire;
     guchar          auth_tag_calc[16];
+    guchar         *cache_key = NULL;
+    guint           cache_key_len = 0;
 #else
     guchar          nonce_with_counter[16] = { 0 };
 #endif
@@ -3965,6 +4212,27 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
 
     /* Set nonce and additional authentication data */
 #ifdef HAVE_LIBGCRYPT_AEAD
+    if (tls_decryption_cache_size) {
+        guchar  aad_fields[16];
+        GBytes *cached;
+
+        /* Everything the tag covers, apart from the ciphertext itself. */
+        phton64(aad_fields, decoder->seq);
+        phton16(aad_fields + 8, decoder->epoch);
+        aad_fields[10] = ct;
+        phton16(aad_fields + 11, record_version);
+        phton16(aad_fields + 13, inl);
+        aad_fields[15] = draft_version;
+        cache_key_len = tls_record_cache_key(&cache_key, decoder, nonce, aad_fields, sizeof(aad_fields),
+                ciphertext, ciphertext_len, auth_tag_wire, auth_tag_len);
+        cached = tls_record_cache_lookup(cache_key, cache_key_len);
+        if (cached && g_bytes_get_size(cached) == ciphertext_len && out_str->data_len >= ciphertext_len) {
+            ssl_debug_printf("%s record found in cache\n", G_STRFUNC);
+            memcpy(out_str->data, g_bytes_get_data(cached, NULL), ciphertext_len);
+            goto decrypted;
+        }
+    }
+
     gcry_cipher_reset(decoder->evp);
     ssl_print_data("nonce", nonce, 12);
     err = gcry_cipher_setiv(decoder->evp, nonce, 12);
@@ -4027,6 +4295,9 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
     err = gcry_cipher_gettag(decoder->evp, auth_tag_calc, auth_tag_len);
     if (err == 0 && !memcmp(auth_tag_calc, auth_tag_wire, auth_tag_len)) {
         ssl_print_data("auth_tag(OK)", auth_tag_calc, auth_tag_len);
+        if (cache_key_len) {
+            tls_record_cache_insert(cache_key, cache_key_len, out_str->data, ciphertext_len);
+        }
     } else {
         if (err) {
             ssl_debug_printf("%s cannot obtain tag: %s\n", G_STRFUNC, gcry_strerror(err));
@@ -4041,6 +4312,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
             return FALSE;
         }
     }
+decrypted:
 #else
     ssl_debug_printf("Libgcrypt is older than 1.6, unable to verify auth tag!\n");
 #endif
@@ -9022,6 +9294,13 @@ ssl_common_register_options(module_t *module, ssl_common_options_t *options, gbo
              "\n"
              "(All fields are in hex notation)",
              &(options->keylog_filename), FALSE);
+
+        prefs_register_uint_preference(module, "decryption_cache_size", "Decryption cache size (MB)",
+             "Memory used to keep decrypted records when the capture is dissected again, "
+             "for example after changing preferences. 0 disables the cache.",
+             10, &tls_decryption_cache_size);
+        register_file_close_routine(tls_decryption_cache_clear);
+        register_shutdown_routine(tls_decryption_cache_clear);
 }
 
 void
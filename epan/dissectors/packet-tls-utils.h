@@ -300,8 +300,10 @@ typedef struct _SslDecoder {
     const SslCipherSuite *cipher_suite;
     gint compression;
     guchar _mac_key_or_write_iv[48];
+    guchar _write_key[32];
     StringInfo mac_key; /* for block and stream ciphers */
     StringInfo write_iv; /* for AEAD ciphers (at least GCM, CCM) */
+    StringInfo write_key; /* for AEAD ciphers, part of the decryption cache key */
     SSL_CIPHER_CTX evp;
     SslDecompress *decomp;
     guint64 seq;    /**< Implicit (TLS) or explicit (DTLS) record sequence number. */
@@ -26,6 +26,7 @@
 
 #include "epan.h"
 #include "epan/frame_data.h"
+#include "epan/proto_data.h"
 
 #include "dfilter/dfilter.h"
 #include "epan_dissect.h"
@@ -409,6 +410,24 @@ epan_get_user_comment(const epan_t *session, const frame_data *fd)
 	return NULL;
 }
 
+void
+epan_get_frame_shift(const epan_t *session, guint32 frame_num, nstime_t *shift)
+{
+	if (session->funcs.get_frame_shift)
+		session->funcs.get_frame_shift(session->prov, frame_num, shift);
+	else
+		nstime_set_zero(shift);
+}
+
+gint64
+epan_get_frame_file_off(const epan_t *session, const frame_data *fd)
+{
+	if (session->funcs.get_frame_file_off)
+		return session->funcs.get_frame_file_off(session->prov, fd);
+
+	return -1;
+}
+
 const char *
 epan_get_interface_name(const epan_t *session, guint32 interface_id)
 {
@@ -447,6 +466,17 @@ epan_free(epan_t *session)
 	if (session) {
 		/* XXX, it should take session as param */
 		cleanup_dissection();
+		close_file_dissection();
+
+		g_slice_free(epan_t, session);
+	}
+}
+
+void
+epan_free_for_redissection(epan_t *session)
+{
+	if (session) {
+		cleanup_dissection();
 
 		g_slice_free(epan_t, session);
 	}
@@ -512,7 +542,7 @@ epan_dissect_reset(epan_dissect_t *edt)
 
 	g_assert(edt);
 
-	g_slist_free(edt->pi.proto_data);
+	p_free_proto_data_table(edt->pi.proto_data);
 	g_slist_free(edt->pi.dependent_frames);
 
 	/* Free the data sources list. */
@@ -617,7 +647,7 @@ epan_dissect_cleanup(epan_dissect_t* edt)
 	g_slist_foreach(epan_plugins, epan_plugin_dissect_cleanup, edt);
 #endif
 
-	g_slist_free(edt->pi.proto_data);
+	p_free_proto_data_table(edt->pi.proto_data);
 	g_slist_free(edt->pi.dependent_frames);
 
 	/* Free the data sources list. */
@@ -44,6 +44,8 @@ struct packet_provider_funcs {
 	const char *(*get_interface_name)(struct packet_provider_data *prov, guint32 interface_id);
 	const char *(*get_interface_description)(struct packet_provider_data *prov, guint32 interface_id);
 	const char *(*get_user_comment)(struct packet_provider_data *prov, const frame_data *fd);
+	void (*get_frame_shift)(struct packet_provider_data *prov, guint32 frame_num, nstime_t *shift);
+	gint64 (*get_frame_file_off)(const struct packet_provider_data *prov, const frame_data *fd);
 };
 
 #ifdef HAVE_PLUGINS
@@ -147,6 +149,18 @@ WS_DLL_PUBLIC epan_t *epan_new(struct packet_provider_data *prov,
 
 WS_DLL_PUBLIC const char *epan_get_user_comment(const epan_t *session, const frame_data *fd);
 
+/**
+ * Get how much the time stamp of a frame has been shifted by the user;
+ * zero if it hasn't been, or if the session's packets can't be shifted.
+ */
+WS_DLL_PUBLIC void epan_get_frame_shift(const epan_t *session, guint32 frame_num, nstime_t *shift);
+
+/**
+ * Get the offset in the capture file of the record for a frame; -1 if
+ * it isn't known.
+ */
+WS_DLL_PUBLIC gint64 epan_get_frame_file_off(const epan_t *session, const frame_data *fd);
+
 WS_DLL_PUBLIC const char *epan_get_interface_name(const epan_t *session, guint32 interface_id);
 
 WS_DLL_PUBLIC const char *epan_get_interface_description(const epan_t *session, guint32 interface_id);
@@ -155,6 +169,13 @@ const nstime_t *epan_get_frame_ts(const epan_t *session, guint32 frame_num);
 
 WS_DLL_PUBLIC void epan_free(epan_t *session);
 
+/**
+ * Like epan_free(), for a session that is freed only so that the same
+ * capture file can be dissected again; routines registered with
+ * register_file_close_routine() are not called.
+ */
+WS_DLL_PUBLIC void epan_free_for_redissection(epan_t *session);
+
 WS_DLL_PUBLIC const gchar*
 epan_get_version(void);
 
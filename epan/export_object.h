@@ -98,6 +98,22 @@ WS_DLL_PUBLIC tap_packet_cb get_eo_packet_func(register_eo_t* eo);
  */
 WS_DLL_PUBLIC export_object_gui_reset_cb get_eo_reset_func(register_eo_t* eo);
 
+/** Mark the Export Object of a protocol as one whose tap function gets
+ * each object whole, in a single packet, without keeping any state between
+ * packets of its own.  Such an object's payload can be dropped once it's
+ * been listed, and got back later by dissecting the packet again.
+ *
+ * @param proto_id protocol passed to register_export_object()
+ */
+WS_DLL_PUBLIC void set_eo_single_packet(const int proto_id);
+
+/** Is each object of an Export Object tapped whole from a single packet?
+ *
+ * @param eo Registered Export Object
+ * @return TRUE if set_eo_single_packet() was called for it
+ */
+WS_DLL_PUBLIC gboolean get_eo_single_packet(register_eo_t* eo);
+
 /** Get Export Object by its short protocol name
  *
  * @param name short protocol name to fetch.
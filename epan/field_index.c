@@ -0,0 +1,272 @@
+/* field_index.c
+ * An index from field values to the frames that have them
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/proto.h>
+#include <epan/tap.h>
+
+#include "field_index.h"
+
+/* One indexed field */
+typedef struct {
+    header_field_info *hfinfo;  /* the first field with the name */
+    GHashTable *values;         /* string representation -> frame_set_t * */
+} field_index_field_t;
+
+struct _field_index {
+    GPtrArray *fields;          /* field_index_field_t * */
+    GArray    *hfids;           /* the ids of all the fields with the names */
+    guint32    count;           /* frames 1 to count have been added */
+};
+
+static gboolean
+field_index_type_ok(ftenum_t type)
+{
+    return IS_FT_INT(type) || IS_FT_UINT(type) || IS_FT_STRING(type) ||
+           type == FT_ETHER || type == FT_IPv4 || type == FT_IPv6;
+}
+
+static void
+field_index_field_free(gpointer data)
+{
+    field_index_field_t *field = (field_index_field_t *)data;
+
+    g_hash_table_destroy(field->values);
+    g_free(field);
+}
+
+field_index_t *
+field_index_new(const char *fields)
+{
+    field_index_t *fi = g_new(field_index_t, 1);
+    field_index_field_t *field;
+    header_field_info *hfinfo, *same;
+    gchar **names;
+    guint i, j;
+
+    fi->fields = g_ptr_array_new_with_free_func(field_index_field_free);
+    fi->hfids = g_array_new(FALSE, FALSE, sizeof(int));
+    fi->count = 0;
+
+    names = g_strsplit_set(fields ? fields : "", " ,", -1);
+    for (i = 0; names[i] != NULL; i++) {
+        if (names[i][0] == '\0')
+            continue;
+        hfinfo = proto_registrar_get_byname(names[i]);
+        if (hfinfo == NULL || !field_index_type_ok(hfinfo->type))
+            continue;
+        for (j = 0; j < fi->fields->len; j++) {
+            if (((field_index_field_t *)g_ptr_array_index(fi->fields, j))->hfinfo == hfinfo)
+                break;
+        }
+        if (j < fi->fields->len)
+            continue;
+
+        field = g_new(field_index_field_t, 1);
+        field->hfinfo = hfinfo;
+        field->values = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify)frame_set_free);
+        g_ptr_array_add(fi->fields, field);
+        for (same = hfinfo; same != NULL; same = same->same_name_next)
+            g_array_append_val(fi->hfids, same->id);
+    }
+    g_strfreev(names);
+    return fi;
+}
+
+void
+field_index_free(field_index_t *fi)
+{
+    if (fi == NULL)
+        return;
+
+    g_ptr_array_free(fi->fields, TRUE);
+    g_array_free(fi->hfids, TRUE);
+    g_free(fi);
+}
+
+void
+field_index_clear(field_index_t *fi)
+{
+    guint i;
+
+    for (i = 0; i < fi->fields->len; i++)
+        g_hash_table_remove_all(((field_index_field_t *)g_ptr_array_index(fi->fields, i))->values);
+    fi->count = 0;
+}
+
+gboolean
+field_index_wants(field_index_t *fi, guint32 num, guint32 count)
+{
+    return fi->count < count && (num == 1 || num == fi->count + 1);
+}
+
+void
+field_index_prime_edt(field_index_t *fi, epan_dissect_t *edt)
+{
+    epan_dissect_prime_with_hfid_array(edt, fi->hfids);
+}
+
+void
+field_index_add(field_index_t *fi, epan_dissect_t *edt, guint32 num)
+{
+    field_index_field_t *field;
+    header_field_info *hfinfo;
+    GPtrArray *finfos;
+    field_info *finfo;
+    frame_set_t *set;
+    char *repr;
+    guint i, j;
+
+    if (edt->tree == NULL)
+        return;
+    if (num == 1)
+        field_index_clear(fi);
+    else if (num != fi->count + 1)
+        return;
+    fi->count = num;
+
+    for (i = 0; i < fi->fields->len; i++) {
+        field = (field_index_field_t *)g_ptr_array_index(fi->fields, i);
+        for (hfinfo = field->hfinfo; hfinfo != NULL; hfinfo = hfinfo->same_name_next) {
+            finfos = proto_get_finfo_ptr_array(edt->tree, hfinfo->id);
+            if (finfos == NULL)
+                continue;
+            for (j = 0; j < finfos->len; j++) {
+                finfo = (field_info *)g_ptr_array_index(finfos, j);
+                repr = fvalue_to_string_repr(NULL, &finfo->value, FTREPR_DFILTER, BASE_NONE);
+                if (repr == NULL)
+                    continue;
+                set = (frame_set_t *)g_hash_table_lookup(field->values, repr);
+                if (set == NULL) {
+                    set = frame_set_new();
+                    g_hash_table_insert(field->values, repr, set);
+                } else {
+                    g_free(repr);
+                }
+                /* The same value twice in a frame only adds it once. */
+                frame_set_add(set, num);
+            }
+        }
+    }
+}
+
+typedef struct {
+    field_index_t *fi;
+    frame_set_t *frames;        /* NULL until we've found an indexed comparison */
+} field_index_lookup_t;
+
+static void
+field_index_lookup_equality(header_field_info *hfinfo, fvalue_t *value, void *user_data)
+{
+    field_index_lookup_t *lookup = (field_index_lookup_t *)user_data;
+    field_index_field_t *field = NULL;
+    const frame_set_t *set;
+    frame_set_t *frames;
+    ftenum_t type;
+    char *repr;
+    guint i;
+
+    for (i = 0; i < lookup->fi->fields->len; i++) {
+        field = (field_index_field_t *)g_ptr_array_index(lookup->fi->fields, i);
+        if (strcmp(field->hfinfo->abbrev, hfinfo->abbrev) == 0)
+            break;
+    }
+    if (i == lookup->fi->fields->len)
+        return;
+
+    /* A subnet, or a value of another type, can't be looked up by its
+     * string; leave it to the filter. */
+    type = fvalue_type_ftenum(value);
+    if (type != field->hfinfo->type)
+        return;
+    if (type == FT_IPv4 && value->value.ipv4.nmask != 0xFFFFFFFF)
+        return;
+    if (type == FT_IPv6 && value->value.ipv6.prefix != 128)
+        return;
+
+    repr = fvalue_to_string_repr(NULL, value, FTREPR_DFILTER, BASE_NONE);
+    if (repr == NULL)
+        return;
+    set = (const frame_set_t *)g_hash_table_lookup(field->values, repr);
+    g_free(repr);
+
+    if (set == NULL) {
+        frames = frame_set_new();
+    } else if (lookup->frames == NULL) {
+        frames = frame_set_new();
+        frame_set_union(frames, set);
+    } else {
+        frames = frame_set_intersect(lookup->frames, set);
+    }
+    frame_set_free(lookup->frames);
+    lookup->frames = frames;
+}
+
+frame_set_t *
+field_index_lookup(field_index_t *fi, const dfilter_t *df, guint32 count)
+{
+    field_index_lookup_t lookup;
+
+    if (fi == NULL || df == NULL || fi->count < count)
+        return NULL;
+
+    lookup.fi = fi;
+    lookup.frames = NULL;
+    dfilter_foreach_required_equality(df, field_index_lookup_equality, &lookup);
+    return lookup.frames;
+}
+
+frame_set_t *
+field_index_lookup_taps(field_index_t *fi, guint32 count)
+{
+    GPtrArray *codes;
+    frame_set_t *frames, *set;
+    guint i;
+
+    if (fi == NULL || fi->count < count)
+        return NULL;
+
+    codes = get_tap_listener_dfilters();
+    if (codes == NULL)
+        return NULL;
+
+    frames = frame_set_new();
+    for (i = 0; i < codes->len; i++) {
+        set = field_index_lookup(fi, (const dfilter_t *)g_ptr_array_index(codes, i), count);
+        if (set == NULL) {
+            frame_set_free(frames);
+            frames = NULL;
+            break;
+        }
+        frame_set_union(frames, set);
+        frame_set_free(set);
+    }
+    g_ptr_array_free(codes, TRUE);
+    return frames;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
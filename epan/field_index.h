@@ -0,0 +1,121 @@
+/* field_index.h
+ * An index from field values to the frames that have them
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __FIELD_INDEX_H__
+#define __FIELD_INDEX_H__
+
+#include <glib.h>
+
+#include <epan/epan_dissect.h>
+#include <epan/dfilter/dfilter.h>
+#include <epan/frame_set.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * For a few fields, such as tcp.stream or ip.addr, remember which frames
+ * have each value. A display or tap filter that can only match frames
+ * with particular values of those fields then only has to be run on those
+ * frames, which saves reading and dissecting the rest of a large capture
+ * when following a stream or graphing one.
+ *
+ * Some fields, such as dns.response_in or tcp.analysis.*, are only added,
+ * or only get their final values, once a frame has been dissected before,
+ * so the values are taken from the first pass over all the frames after
+ * the one that reads them in, such as the first refilter. Until then the
+ * index doesn't answer lookups.
+ *
+ * Only fields whose values are equal exactly when their string
+ * representations are can be indexed: integers, strings, and Ethernet,
+ * IPv4 and IPv6 addresses.
+ */
+
+typedef struct _field_index field_index_t;
+
+/**
+ * Create an index.
+ *
+ * @param fields the names of the fields to index, separated by spaces or
+ * commas; names that aren't fields we can index are ignored
+ * @return the index
+ */
+WS_DLL_PUBLIC field_index_t *field_index_new(const char *fields);
+
+/** Free an index. */
+WS_DLL_PUBLIC void field_index_free(field_index_t *fi);
+
+/** Forget all the frames, e.g. because they're going to be redissected. */
+WS_DLL_PUBLIC void field_index_clear(field_index_t *fi);
+
+/**
+ * Should a frame about to be dissected be added to the index? That's
+ * until all the frames of the capture are in it, and only for frames
+ * dissected in order from frame 1, each of which has already been
+ * dissected once (fdata->visited is set).
+ *
+ * @param fi the index
+ * @param num the frame number
+ * @param count the number of frames in the capture
+ */
+WS_DLL_PUBLIC gboolean field_index_wants(field_index_t *fi, guint32 num, guint32 count);
+
+/**
+ * Make sure a dissection will have the indexed fields in its tree. Call
+ * before dissecting a frame to be passed to field_index_add(); the
+ * dissection has to have a protocol tree.
+ */
+WS_DLL_PUBLIC void field_index_prime_edt(field_index_t *fi, epan_dissect_t *edt);
+
+/**
+ * Add a dissected frame that field_index_wants() wanted to the index.
+ * Frame 1 starts the index again; any other frame that isn't the one
+ * after the last one added is ignored.
+ */
+WS_DLL_PUBLIC void field_index_add(field_index_t *fi, epan_dissect_t *edt, guint32 num);
+
+/**
+ * Find the frames that a filter could match.
+ *
+ * @param fi the index
+ * @param df the filter
+ * @param count the number of frames in the capture
+ * @return the frames, to be freed with frame_set_free(), or NULL if the
+ * filter could match any frame, or not all count frames are in the index
+ */
+WS_DLL_PUBLIC frame_set_t *field_index_lookup(field_index_t *fi, const dfilter_t *df,
+                                              guint32 count);
+
+/**
+ * Find the frames that any of the registered tap listeners could want,
+ * as field_index_lookup() does for a single filter.
+ */
+WS_DLL_PUBLIC frame_set_t *field_index_lookup_taps(field_index_t *fi, guint32 count);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FIELD_INDEX_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
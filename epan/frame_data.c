@@ -16,6 +16,7 @@
 #include <epan/epan.h>
 #include <wiretap/wtap.h>
 #include <epan/frame_data.h>
+#include <epan/proto_data.h>
 #include <epan/column-utils.h>
 #include <epan/timestamp.h>
 
@@ -152,11 +153,10 @@ frame_data_compare(const struct epan_session *epan, const frame_data *fdata1, co
 
 void
 frame_data_init(frame_data *fdata, guint32 num, const wtap_rec *rec,
-                gint64 offset, guint32 cum_bytes)
+                guint32 cum_bytes)
 {
   fdata->pfd = NULL;
   fdata->num = num;
-  fdata->file_off = offset;
   fdata->subnum = 0;
   fdata->passed_dfilter = 0;
   fdata->dependent_of_displayed = 0;
@@ -202,8 +202,6 @@ frame_data_init(frame_data *fdata, guint32 num, const wtap_rec *rec,
   fdata->has_user_comment = 0;
   fdata->need_colorize = 0;
   fdata->color_filter = NULL;
-  fdata->shift_offset.secs = 0;
-  fdata->shift_offset.nsecs = 0;
   fdata->frame_ref_num = 0;
   fdata->prev_dis_num = 0;
 }
@@ -265,7 +263,7 @@ frame_data_reset(frame_data *fdata)
   fdata->subnum = 0;
 
   if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
+    p_free_proto_data_table(fdata->pfd);
     fdata->pfd = NULL;
   }
 }
@@ -274,7 +272,7 @@ void
 frame_data_destroy(frame_data *fdata)
 {
   if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
+    p_free_proto_data_table(fdata->pfd);
     fdata->pfd = NULL;
   }
 }
@@ -51,26 +51,29 @@ typedef enum {
 
    There is one of these structures for every frame in the capture.
    That means a lot of memory if we have a lot of frames.
-   They are packed into power-of-2 chunks, so their size is effectively
-   rounded up to a power of 2.
-   Try to keep it close to, and less than or equal to, a power of 2.
-   "Smaller than a power of 2" is OK for ILP32 platforms.
+   They are stored in arrays of 1024 of them (see frame_data_sequence.c),
+   so every byte here is a byte per frame; anything that only a few
+   frames or captures ever have, such as user comments or time shifts,
+   is kept elsewhere (cf->frames_user_comments,
+   frame_data_sequence_get_shift()), as is the file offset, which the
+   frame_data_sequence stores more compactly
+   (frame_data_sequence_get_file_off()).
 
    XXX - shuffle the fields to try to keep the most commonly-accessed
    fields within the first 16 or 32 bytes, so they all fit in a cache
    line? */
 struct _color_filter; /* Forward */
+struct _proto_data_table; /* Forward */
 DIAG_OFF_PEDANTIC
 typedef struct _frame_data {
   guint32      num;          /**< Frame number */
   guint32      pkt_len;      /**< Packet length */
   guint32      cap_len;      /**< Amount actually captured */
   guint32      cum_bytes;    /**< Cumulative bytes into the capture */
-  gint64       file_off;     /**< File offset */
   /* These two are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
      LLP64 (64-bit Windows) platforms.  Put them here, one after the
      other, so they don't require padding between them. */
-  GSList      *pfd;          /**< Per frame proto data */
+  struct _proto_data_table *pfd; /**< Per frame proto data */
   const struct _color_filter *color_filter;  /**< Per-packet matching color_filter_t object */
   guint16      subnum;       /**< subframe number, for protocols that require this */
   /* Keep the bitfields below to 16 bits, so this plus the previous field
@@ -89,7 +92,6 @@ typedef struct _frame_data {
   unsigned int need_colorize    : 1; /**< 1 = need to (re-)calculate packet color */
   unsigned int tsprec           : 4; /**< Time stamp precision -2^tsprec gives up to femtoseconds */
   nstime_t     abs_ts;       /**< Absolute timestamp */
-  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
   guint32      frame_ref_num; /**< Previous reference frame (0 if this is one) */
   guint32      prev_dis_num; /**< Previous displayed frame (0 if first one) */
 } frame_data;
@@ -103,8 +105,7 @@ WS_DLL_PUBLIC void frame_data_reset(frame_data *fdata);
 WS_DLL_PUBLIC void frame_data_destroy(frame_data *fdata);
 
 WS_DLL_PUBLIC void frame_data_init(frame_data *fdata, guint32 num,
-                const wtap_rec *rec, gint64 offset,
-                guint32 cum_bytes);
+                const wtap_rec *rec, guint32 cum_bytes);
 
 extern void frame_delta_abs_time(const struct epan_session *epan, const frame_data *fdata,
                 guint32 prev_num, nstime_t *delta);
@@ -29,9 +29,29 @@
 #define LOG2_NODES_PER_LEVEL    10
 #define NODES_PER_LEVEL         (1<<LOG2_NODES_PER_LEVEL)
 
+/*
+ * A leaf node holds the frame_data structures of NODES_PER_LEVEL frames,
+ * and their file offsets, which aren't in the frame_data structures.
+ * Records are usually read one after another, so rather than 8 bytes per
+ * frame we keep the offset of the first frame in the leaf and, for every
+ * frame, how far past that it is.  A frame that is before the first one,
+ * or 4 GB or more past it, gets DELTA_WIDE instead, and its full offset
+ * goes into wide_offs, which is allocated when that first happens.
+ */
+#define DELTA_WIDE              G_MAXUINT32
+
+typedef struct {
+  frame_data   frames[NODES_PER_LEVEL];
+  guint32      off_deltas[NODES_PER_LEVEL];
+  gint64       base_off;        /* File offset of the first frame */
+  gint64      *wide_offs;       /* Offsets that don't fit in off_deltas */
+} frame_data_leaf;
+
 struct _frame_data_sequence {
   guint32      count;           /* Total number of frames */
   void        *ptree_root;      /* Pointer to the root node */
+  GArray      *shifts;          /* nstime_t time shifts, indexed by frame
+                                   number - 1; NULL until a frame is shifted */
 };
 
 /*
@@ -55,20 +75,74 @@ new_frame_data_sequence(void)
   fds = (frame_data_sequence *)g_malloc(sizeof *fds);
   fds->count = 0;
   fds->ptree_root = NULL;
+  fds->shifts = NULL;
   return fds;
 }
 
+static frame_data_leaf *
+new_leaf(void)
+{
+  frame_data_leaf *leaf;
+
+  leaf = (frame_data_leaf *)g_malloc(sizeof *leaf);
+  leaf->wide_offs = NULL;
+  return leaf;
+}
+
+static void
+leaf_set_file_off(frame_data_leaf *leaf, guint idx, gint64 file_off)
+{
+  gint64 delta = file_off - leaf->base_off;
+
+  if (delta >= 0 && delta < DELTA_WIDE) {
+    leaf->off_deltas[idx] = (guint32)delta;
+  } else {
+    if (leaf->wide_offs == NULL)
+      leaf->wide_offs = (gint64 *)g_malloc((sizeof *leaf->wide_offs)*NODES_PER_LEVEL);
+    leaf->wide_offs[idx] = file_off;
+    leaf->off_deltas[idx] = DELTA_WIDE;
+  }
+}
+
+static gint64
+leaf_get_file_off(const frame_data_leaf *leaf, guint idx)
+{
+  if (leaf->off_deltas[idx] == DELTA_WIDE)
+    return leaf->wide_offs[idx];
+  return leaf->base_off + leaf->off_deltas[idx];
+}
+
+
 /*
- * Add a new frame_data structure to a frame_data_sequence.
+ * Make the offsets of the first count frames in a leaf relative to a new
+ * base offset.
+ */
+static void
+leaf_rebase(frame_data_leaf *leaf, guint count, gint64 base_off)
+{
+  gint64 offs[NODES_PER_LEVEL];
+  guint i;
+
+  for (i = 0; i < count; i++)
+    offs[i] = leaf_get_file_off(leaf, i);
+  leaf->base_off = base_off;
+  for (i = 0; i < count; i++)
+    leaf_set_file_off(leaf, i, offs[i]);
+}
+
+/*
+ * Add a new frame_data structure, read from the specified file offset,
+ * to a frame_data_sequence.
  */
 frame_data *
-frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
+frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata,
+    gint64 file_off)
 {
-  frame_data *leaf;
-  frame_data **level1;
-  frame_data ***level2;
-  frame_data ****level3;
-  frame_data *node;
+  frame_data_leaf *leaf;
+  frame_data_leaf **level1;
+  frame_data_leaf ***level2;
+  frame_data_leaf ****level3;
+  guint idx;
 
   /*
    * The current value of fds->count is the index value for the new frame,
@@ -80,65 +154,65 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
   if (fds->count == 0) {
     /* The tree is empty; allocate the first leaf node, which will be
        the root node. */
-    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
-    node = &leaf[0];
+    leaf = new_leaf();
+    idx = 0;
     fds->ptree_root = leaf;
   } else if (fds->count < NODES_PER_LEVEL) {
     /* It's a 1-level tree, and is going to stay that way for now. */
-    leaf = (frame_data *)fds->ptree_root;
-    node = &leaf[fds->count];
+    leaf = (frame_data_leaf *)fds->ptree_root;
+    idx = fds->count;
   } else if (fds->count == NODES_PER_LEVEL) {
     /* It's a 1-level tree that will turn into a 2-level tree. */
-    level1 = (frame_data **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
-    level1[0] = (frame_data *)fds->ptree_root;
-    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+    level1 = (frame_data_leaf **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
+    level1[0] = (frame_data_leaf *)fds->ptree_root;
+    leaf = new_leaf();
     level1[1] = leaf;
-    node = &leaf[0];
+    idx = 0;
     fds->ptree_root = level1;
   } else if (fds->count < NODES_PER_LEVEL*NODES_PER_LEVEL) {
     /* It's a 2-level tree, and is going to stay that way for now. */
-    level1 = (frame_data **)fds->ptree_root;
+    level1 = (frame_data_leaf **)fds->ptree_root;
     leaf = level1[fds->count >> LOG2_NODES_PER_LEVEL];
     if (leaf == NULL) {
-      leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+      leaf = new_leaf();
       level1[fds->count >> LOG2_NODES_PER_LEVEL] = leaf;
     }
-    node = &leaf[LEAF_INDEX(fds->count)];
+    idx = LEAF_INDEX(fds->count);
   } else if (fds->count == NODES_PER_LEVEL*NODES_PER_LEVEL) {
     /* It's a 2-level tree that will turn into a 3-level tree */
-    level2 = (frame_data ***)g_malloc0((sizeof *level2)*NODES_PER_LEVEL);
-    level2[0] = (frame_data **)fds->ptree_root;
-    level1 = (frame_data **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
+    level2 = (frame_data_leaf ***)g_malloc0((sizeof *level2)*NODES_PER_LEVEL);
+    level2[0] = (frame_data_leaf **)fds->ptree_root;
+    level1 = (frame_data_leaf **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
     level2[1] = level1;
-    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+    leaf = new_leaf();
     level1[0] = leaf;
-    node = &leaf[0];
+    idx = 0;
     fds->ptree_root = level2;
   } else if (fds->count < NODES_PER_LEVEL*NODES_PER_LEVEL*NODES_PER_LEVEL) {
     /* It's a 3-level tree, and is going to stay that way for now. */
-    level2 = (frame_data ***)fds->ptree_root;
+    level2 = (frame_data_leaf ***)fds->ptree_root;
     level1 = level2[fds->count >> (LOG2_NODES_PER_LEVEL+LOG2_NODES_PER_LEVEL)];
     if (level1 == NULL) {
-      level1 = (frame_data **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
+      level1 = (frame_data_leaf **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
       level2[fds->count >> (LOG2_NODES_PER_LEVEL+LOG2_NODES_PER_LEVEL)] = level1;
     }
     leaf = level1[LEVEL_1_INDEX(fds->count)];
     if (leaf == NULL) {
-      leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+      leaf = new_leaf();
       level1[LEVEL_1_INDEX(fds->count)] = leaf;
     }
-    node = &leaf[LEAF_INDEX(fds->count)];
+    idx = LEAF_INDEX(fds->count);
   } else if (fds->count == NODES_PER_LEVEL*NODES_PER_LEVEL*NODES_PER_LEVEL) {
     /* It's a 3-level tree that will turn into a 4-level tree */
-    level3 = (frame_data ****)g_malloc0((sizeof *level3)*NODES_PER_LEVEL);
-    level3[0] = (frame_data ***)fds->ptree_root;
-    level2 = (frame_data ***)g_malloc0((sizeof *level2)*NODES_PER_LEVEL);
+    level3 = (frame_data_leaf ****)g_malloc0((sizeof *level3)*NODES_PER_LEVEL);
+    level3[0] = (frame_data_leaf ***)fds->ptree_root;
+    level2 = (frame_data_leaf ***)g_malloc0((sizeof *level2)*NODES_PER_LEVEL);
     level3[1] = level2;
-    level1 = (frame_data **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
+    level1 = (frame_data_leaf **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
     level2[0] = level1;
-    leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+    leaf = new_leaf();
     level1[0] = leaf;
-    node = &leaf[0];
+    idx = 0;
     fds->ptree_root = level3;
   } else {
     /* fds->count is 2^32-1 at most, and NODES_PER_LEVEL^4
@@ -149,79 +223,159 @@ frame_data_sequence_add(frame_data_sequence *fds, frame_data *fdata)
        make the frame numbers 64-bit and just let users run
        themselves out of address space or swap space. :-) */
     /* It's a 4-level tree, and is going to stay that way forever. */
-    level3 = (frame_data ****)fds->ptree_root;
+    level3 = (frame_data_leaf ****)fds->ptree_root;
     level2 = level3[LEVEL_3_INDEX(fds->count)];
     if (level2 == NULL) {
-      level2 = (frame_data ***)g_malloc0((sizeof *level2)*NODES_PER_LEVEL);
+      level2 = (frame_data_leaf ***)g_malloc0((sizeof *level2)*NODES_PER_LEVEL);
       level3[LEVEL_3_INDEX(fds->count)] = level2;
     }
     level1 = level2[LEVEL_2_INDEX(fds->count)];
     if (level1 == NULL) {
-      level1 = (frame_data **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
+      level1 = (frame_data_leaf **)g_malloc0((sizeof *level1)*NODES_PER_LEVEL);
       level2[LEVEL_2_INDEX(fds->count)] = level1;
     }
     leaf = level1[LEVEL_1_INDEX(fds->count)];
     if (leaf == NULL) {
-      leaf = (frame_data *)g_malloc((sizeof *leaf)*NODES_PER_LEVEL);
+      leaf = new_leaf();
       level1[LEVEL_1_INDEX(fds->count)] = leaf;
     }
-    node = &leaf[LEAF_INDEX(fds->count)];
+    idx = LEAF_INDEX(fds->count);
   }
-  *node = *fdata;
+  leaf->frames[idx] = *fdata;
+  if (idx == 0)
+    leaf->base_off = file_off;
+  leaf_set_file_off(leaf, idx, file_off);
   fds->count++;
-  return node;
+  return &leaf->frames[idx];
 }
 
 /*
- * Find the frame_data for the specified frame number.
+ * Find the leaf node with the frame that has the specified index, i.e.
+ * frame number - 1.
  */
-frame_data *
-frame_data_sequence_find(frame_data_sequence *fds, guint32 num)
+static frame_data_leaf *
+find_leaf(const frame_data_sequence *fds, guint32 num)
 {
-  frame_data *leaf;
-  frame_data **level1;
-  frame_data ***level2;
-  frame_data ****level3;
-
-  if (num == 0) {
-    /* There is no frame number 0 */
-    return NULL;
-  }
-
-  /* Convert it into an index number. */
-  num--;
-  if (num >= fds->count) {
-    /* There aren't that many frames. */
-    return NULL;
-  }
+  frame_data_leaf **level1;
+  frame_data_leaf ***level2;
+  frame_data_leaf ****level3;
 
   if (fds->count <= NODES_PER_LEVEL) {
     /* It's a 1-level tree. */
-    leaf = (frame_data *)fds->ptree_root;
-    return &leaf[num];
+    return (frame_data_leaf *)fds->ptree_root;
   }
   if (fds->count <= NODES_PER_LEVEL*NODES_PER_LEVEL) {
     /* It's a 2-level tree. */
-    level1 = (frame_data **)fds->ptree_root;
-    leaf = level1[num >> LOG2_NODES_PER_LEVEL];
-    return &leaf[LEAF_INDEX(num)];
+    level1 = (frame_data_leaf **)fds->ptree_root;
+    return level1[num >> LOG2_NODES_PER_LEVEL];
   }
   if (fds->count <= NODES_PER_LEVEL*NODES_PER_LEVEL*NODES_PER_LEVEL) {
     /* It's a 3-level tree. */
-    level2 = (frame_data ***)fds->ptree_root;
+    level2 = (frame_data_leaf ***)fds->ptree_root;
     level1 = level2[num >> (LOG2_NODES_PER_LEVEL+LOG2_NODES_PER_LEVEL)];
-    leaf = level1[(num >> LOG2_NODES_PER_LEVEL) & (NODES_PER_LEVEL - 1)];
-    return &leaf[LEAF_INDEX(num)];
+    return level1[(num >> LOG2_NODES_PER_LEVEL) & (NODES_PER_LEVEL - 1)];
   }
   /* fds->count is 2^32-1 at most, and NODES_PER_LEVEL^4
      2^(LOG2_NODES_PER_LEVEL*4), and LOG2_NODES_PER_LEVEL is 10,
      so fds->count is always less < NODES_PER_LEVEL^4. */
   /* It's a 4-level tree, and is going to stay that way forever. */
-  level3 = (frame_data ****)fds->ptree_root;
+  level3 = (frame_data_leaf ****)fds->ptree_root;
   level2 = level3[num >> (LOG2_NODES_PER_LEVEL+LOG2_NODES_PER_LEVEL+LOG2_NODES_PER_LEVEL)];
   level1 = level2[(num >> (LOG2_NODES_PER_LEVEL+LOG2_NODES_PER_LEVEL)) & (NODES_PER_LEVEL - 1)];
-  leaf = level1[(num >> LOG2_NODES_PER_LEVEL) & (NODES_PER_LEVEL - 1)];
-  return &leaf[LEAF_INDEX(num)];
+  return level1[(num >> LOG2_NODES_PER_LEVEL) & (NODES_PER_LEVEL - 1)];
+}
+
+/*
+ * Find the frame_data for the specified frame number.
+ */
+frame_data *
+frame_data_sequence_find(frame_data_sequence *fds, guint32 num)
+{
+  if (num == 0) {
+    /* There is no frame number 0 */
+    return NULL;
+  }
+
+  /* Convert it into an index number. */
+  num--;
+  if (num >= fds->count) {
+    /* There aren't that many frames. */
+    return NULL;
+  }
+
+  return &find_leaf(fds, num)->frames[LEAF_INDEX(num)];
+}
+
+/*
+ * Get the file offset of the specified frame.
+ */
+gint64
+frame_data_sequence_get_file_off(const frame_data_sequence *fds, guint32 num)
+{
+  if (num == 0 || num > fds->count)
+    return -1;
+
+  num--;
+  return leaf_get_file_off(find_leaf(fds, num), LEAF_INDEX(num));
+}
+
+/*
+ * Set the file offset of the specified frame, e.g. after the frames
+ * have been written to a new file.
+ */
+void
+frame_data_sequence_set_file_off(frame_data_sequence *fds, guint32 num,
+    gint64 file_off)
+{
+  frame_data_leaf *leaf;
+
+  if (num == 0 || num > fds->count)
+    return;
+
+  num--;
+  leaf = find_leaf(fds, num);
+  if (LEAF_INDEX(num) == 0) {
+    /* The frames are usually all given new offsets, in order; keep the
+       rest of the leaf close to the first one. */
+    leaf_rebase(leaf, MIN(fds->count - num, NODES_PER_LEVEL), file_off);
+  }
+  leaf_set_file_off(leaf, LEAF_INDEX(num), file_off);
+}
+
+/*
+ * Get how much the time stamp of a frame has been shifted.
+ */
+void
+frame_data_sequence_get_shift(const frame_data_sequence *fds, guint32 num,
+    nstime_t *shift)
+{
+  if (fds->shifts != NULL && num >= 1 && num <= fds->shifts->len)
+    *shift = g_array_index(fds->shifts, nstime_t, num - 1);
+  else
+    nstime_set_zero(shift);
+}
+
+/*
+ * Set how much the time stamp of a frame has been shifted.
+ */
+void
+frame_data_sequence_set_shift(frame_data_sequence *fds, guint32 num,
+    const nstime_t *shift)
+{
+  gboolean is_zero = (shift->secs == 0 && shift->nsecs == 0);
+
+  if (num == 0 || num > fds->count)
+    return;
+
+  if (fds->shifts == NULL || num > fds->shifts->len) {
+    /* Frames that aren't in the array yet aren't shifted. */
+    if (is_zero)
+      return;
+    if (fds->shifts == NULL)
+      fds->shifts = g_array_sized_new(FALSE, TRUE, sizeof(nstime_t), fds->count);
+    g_array_set_size(fds->shifts, fds->count);
+  }
+  g_array_index(fds->shifts, nstime_t, num - 1) = *shift;
 }
 
 /* recursively frees a frame_data radix level */
@@ -252,7 +406,7 @@ free_frame_data_array(void *array, guint count, guint level, gboolean last)
   if (level > 1) {
     /* recurse on every sub-array, passing on our own 'last' value
      * specially to our last child */
-    frame_data **real_array = (frame_data **) array;
+    frame_data_leaf **real_array = (frame_data_leaf **) array;
 
     for (i=0; i < level_count-1; i++) {
       free_frame_data_array(real_array[i], count, level-1, FALSE);
@@ -262,11 +416,12 @@ free_frame_data_array(void *array, guint count, guint level, gboolean last)
   }
   else if (level == 1) {
     /* bottom level, so just clean up all the frame data */
-    frame_data *real_array = (frame_data *) array;
+    frame_data_leaf *leaf = (frame_data_leaf *) array;
 
     for (i=0; i < level_count; i++) {
-      frame_data_destroy(&real_array[i]);
+      frame_data_destroy(&leaf->frames[i]);
     }
+    g_free(leaf->wide_offs);
   }
 
   /* free the array itself */
@@ -307,6 +462,9 @@ free_frame_data_sequence(frame_data_sequence *fds)
     free_frame_data_array(fds->ptree_root, fds->count, levels, TRUE);
   }
 
+  if (fds->shifts != NULL)
+    g_array_free(fds->shifts, TRUE);
+
   /* free the header struct */
   g_free(fds);
 }
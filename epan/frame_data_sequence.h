@@ -20,7 +20,7 @@ typedef struct _frame_data_sequence frame_data_sequence;
 WS_DLL_PUBLIC frame_data_sequence *new_frame_data_sequence(void);
 
 WS_DLL_PUBLIC frame_data *frame_data_sequence_add(frame_data_sequence *fds,
-    frame_data *fdata);
+    frame_data *fdata, gint64 file_off);
 
 /*
  * Find the frame_data for the specified frame number.
@@ -28,6 +28,28 @@ WS_DLL_PUBLIC frame_data *frame_data_sequence_add(frame_data_sequence *fds,
 WS_DLL_PUBLIC frame_data *frame_data_sequence_find(frame_data_sequence *fds,
     guint32 num);
 
+/*
+ * Get and set the offset in the file of the record for the specified
+ * frame. The offsets of a run of frames are stored as differences from
+ * the offset of the first one, rather than in every frame_data. Getting
+ * the offset of a frame that isn't in the sequence returns -1.
+ */
+WS_DLL_PUBLIC gint64 frame_data_sequence_get_file_off(const frame_data_sequence *fds,
+    guint32 num);
+WS_DLL_PUBLIC void frame_data_sequence_set_file_off(frame_data_sequence *fds,
+    guint32 num, gint64 file_off);
+
+/*
+ * Get and set how much the time stamp of a frame has been shifted, e.g.
+ * by the Time Shift dialog. Hardly any captures are ever shifted, so
+ * this is kept here, and only once a frame is shifted, rather than in
+ * every frame_data.
+ */
+WS_DLL_PUBLIC void frame_data_sequence_get_shift(const frame_data_sequence *fds,
+    guint32 num, nstime_t *shift);
+WS_DLL_PUBLIC void frame_data_sequence_set_shift(frame_data_sequence *fds,
+    guint32 num, const nstime_t *shift);
+
 /*
  * Free a frame_data_sequence and all the frame_data structures in it.
  */
@@ -0,0 +1,302 @@
+/* frame_set.c
+ * A compressed set of frame numbers
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/bits_ctz.h>
+
+#include "frame_set.h"
+
+/*
+ * A group larger than this is kept as a bitmap; at this size the sorted
+ * array takes as much memory as the bitmap does.
+ */
+#define FRAME_SET_ARRAY_MAX     4096
+#define FRAME_SET_BITMAP_WORDS  (65536 / 64)
+
+/* The frame numbers with the same upper 16 bits */
+typedef struct {
+    guint16  key;           /* upper 16 bits */
+    guint32  count;         /* number of members */
+    guint32  alloc;         /* entries allocated in array */
+    guint16 *array;         /* sorted lower 16 bits, if bitmap is NULL */
+    guint64 *bitmap;        /* FRAME_SET_BITMAP_WORDS words, or NULL */
+} frame_set_group_t;
+
+struct _frame_set {
+    GArray  *groups;        /* frame_set_group_t, sorted by key */
+    guint32  count;
+};
+
+frame_set_t *
+frame_set_new(void)
+{
+    frame_set_t *set = g_new(frame_set_t, 1);
+
+    set->groups = g_array_new(FALSE, FALSE, sizeof(frame_set_group_t));
+    set->count = 0;
+    return set;
+}
+
+void
+frame_set_free(frame_set_t *set)
+{
+    frame_set_group_t *group;
+    guint i;
+
+    if (set == NULL)
+        return;
+
+    for (i = 0; i < set->groups->len; i++) {
+        group = &g_array_index(set->groups, frame_set_group_t, i);
+        g_free(group->array);
+        g_free(group->bitmap);
+    }
+    g_array_free(set->groups, TRUE);
+    g_free(set);
+}
+
+/* Find the first group whose key is >= key. */
+static guint
+frame_set_find_group(const frame_set_t *set, guint16 key)
+{
+    guint lo = 0, hi = set->groups->len, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (g_array_index(set->groups, frame_set_group_t, mid).key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Find the first entry in a group's array that's >= low. */
+static guint32
+frame_set_find_low(const frame_set_group_t *group, guint16 low)
+{
+    guint32 lo = 0, hi = group->count, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (group->array[mid] < low)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void
+frame_set_group_to_bitmap(frame_set_group_t *group)
+{
+    guint32 i;
+
+    group->bitmap = g_new0(guint64, FRAME_SET_BITMAP_WORDS);
+    for (i = 0; i < group->count; i++)
+        group->bitmap[group->array[i] >> 6] |= G_GUINT64_CONSTANT(1) << (group->array[i] & 63);
+    g_free(group->array);
+    group->array = NULL;
+    group->alloc = 0;
+}
+
+/* Add to a group; returns TRUE if low wasn't already there. */
+static gboolean
+frame_set_group_add(frame_set_group_t *group, guint16 low)
+{
+    guint64 bit;
+    guint32 pos;
+
+    if (group->bitmap == NULL) {
+        /* Appending is what happens while a file is read. */
+        if (group->count == 0 || group->array[group->count - 1] < low) {
+            pos = group->count;
+        } else {
+            pos = frame_set_find_low(group, low);
+            if (group->array[pos] == low)
+                return FALSE;
+        }
+        if (group->count < FRAME_SET_ARRAY_MAX) {
+            if (group->count == group->alloc) {
+                group->alloc = group->alloc ? group->alloc * 2 : 4;
+                group->array = g_renew(guint16, group->array, group->alloc);
+            }
+            memmove(&group->array[pos + 1], &group->array[pos],
+                    (group->count - pos) * sizeof(guint16));
+            group->array[pos] = low;
+            group->count++;
+            return TRUE;
+        }
+        frame_set_group_to_bitmap(group);
+    }
+
+    bit = G_GUINT64_CONSTANT(1) << (low & 63);
+    if (group->bitmap[low >> 6] & bit)
+        return FALSE;
+    group->bitmap[low >> 6] |= bit;
+    group->count++;
+    return TRUE;
+}
+
+void
+frame_set_add(frame_set_t *set, guint32 num)
+{
+    frame_set_group_t new_group;
+    frame_set_group_t *group = NULL;
+    guint16 key = (guint16)(num >> 16);
+    guint i = 0;
+
+    if (set->groups->len > 0) {
+        group = &g_array_index(set->groups, frame_set_group_t, set->groups->len - 1);
+        if (group->key != key) {
+            if (group->key > key) {
+                i = frame_set_find_group(set, key);
+                group = &g_array_index(set->groups, frame_set_group_t, i);
+                if (group->key != key)
+                    group = NULL;
+            } else {
+                i = set->groups->len;
+                group = NULL;
+            }
+        }
+    }
+
+    if (group == NULL) {
+        memset(&new_group, 0, sizeof new_group);
+        new_group.key = key;
+        g_array_insert_val(set->groups, i, new_group);
+        group = &g_array_index(set->groups, frame_set_group_t, i);
+    }
+
+    if (frame_set_group_add(group, (guint16)(num & 0xFFFF)))
+        set->count++;
+}
+
+gboolean
+frame_set_contains(const frame_set_t *set, guint32 num)
+{
+    const frame_set_group_t *group;
+    guint16 key = (guint16)(num >> 16);
+    guint16 low = (guint16)(num & 0xFFFF);
+    guint32 pos;
+    guint i;
+
+    i = frame_set_find_group(set, key);
+    if (i >= set->groups->len)
+        return FALSE;
+    group = &g_array_index(set->groups, frame_set_group_t, i);
+    if (group->key != key)
+        return FALSE;
+
+    if (group->bitmap != NULL)
+        return (group->bitmap[low >> 6] >> (low & 63)) & 1;
+    pos = frame_set_find_low(group, low);
+    return pos < group->count && group->array[pos] == low;
+}
+
+guint32
+frame_set_count(const frame_set_t *set)
+{
+    return set->count;
+}
+
+/* Find the first member of a group that's >= low; returns FALSE if none is. */
+static gboolean
+frame_set_group_next(const frame_set_group_t *group, guint32 low, guint16 *found)
+{
+    guint32 pos, word;
+    guint64 bits;
+
+    if (group->bitmap == NULL) {
+        pos = frame_set_find_low(group, (guint16)low);
+        if (pos >= group->count)
+            return FALSE;
+        *found = group->array[pos];
+        return TRUE;
+    }
+
+    word = low >> 6;
+    bits = group->bitmap[word] & (G_GUINT64_CONSTANT(0xFFFFFFFFFFFFFFFF) << (low & 63));
+    for (;;) {
+        if (bits != 0) {
+            *found = (guint16)((word << 6) + ws_ctz(bits));
+            return TRUE;
+        }
+        if (++word >= FRAME_SET_BITMAP_WORDS)
+            return FALSE;
+        bits = group->bitmap[word];
+    }
+}
+
+guint32
+frame_set_next(const frame_set_t *set, guint32 num)
+{
+    const frame_set_group_t *group;
+    guint16 key, found;
+    guint i;
+
+    if (num == G_MAXUINT32)
+        return 0;
+    num++;
+    key = (guint16)(num >> 16);
+
+    for (i = frame_set_find_group(set, key); i < set->groups->len; i++) {
+        group = &g_array_index(set->groups, frame_set_group_t, i);
+        if (frame_set_group_next(group, group->key == key ? num & 0xFFFF : 0, &found))
+            return ((guint32)group->key << 16) | found;
+    }
+    return 0;
+}
+
+void
+frame_set_union(frame_set_t *dst, const frame_set_t *src)
+{
+    guint32 num = 0;
+
+    while ((num = frame_set_next(src, num)) != 0)
+        frame_set_add(dst, num);
+}
+
+frame_set_t *
+frame_set_intersect(const frame_set_t *a, const frame_set_t *b)
+{
+    frame_set_t *set = frame_set_new();
+    guint32 num = 0;
+
+    /* Go through the smaller one. */
+    if (a->count > b->count) {
+        const frame_set_t *tmp = a;
+        a = b;
+        b = tmp;
+    }
+    while ((num = frame_set_next(a, num)) != 0) {
+        if (frame_set_contains(b, num))
+            frame_set_add(set, num);
+    }
+    return set;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,82 @@
+/* frame_set.h
+ * A compressed set of frame numbers
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __FRAME_SET_H__
+#define __FRAME_SET_H__
+
+#include <glib.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * A set of frame numbers, stored the way "Roaring" bitmaps are: the
+ * numbers are grouped by their upper 16 bits, and each group is kept as
+ * a sorted array of the lower 16 bits while it's small and as a bitmap
+ * once it isn't. A set of a few frames scattered through a large capture
+ * stays small, and so does a set of most of them.
+ *
+ * Frame numbers start at 1; 0 can't be a member.
+ */
+
+typedef struct _frame_set frame_set_t;
+
+/** Create an empty set. */
+WS_DLL_PUBLIC frame_set_t *frame_set_new(void);
+
+/** Free a set. */
+WS_DLL_PUBLIC void frame_set_free(frame_set_t *set);
+
+/**
+ * Add a frame number to a set. Adding numbers in increasing order, as a
+ * capture file is read, is the fast case.
+ */
+WS_DLL_PUBLIC void frame_set_add(frame_set_t *set, guint32 num);
+
+/** Is a frame number in a set? */
+WS_DLL_PUBLIC gboolean frame_set_contains(const frame_set_t *set, guint32 num);
+
+/** Get the number of frames in a set. */
+WS_DLL_PUBLIC guint32 frame_set_count(const frame_set_t *set);
+
+/**
+ * Get the smallest frame number in a set that's greater than num, or 0
+ * if there isn't one. Start with num 0 to go through the whole set.
+ */
+WS_DLL_PUBLIC guint32 frame_set_next(const frame_set_t *set, guint32 num);
+
+/** Add all the frame numbers in src to dst. */
+WS_DLL_PUBLIC void frame_set_union(frame_set_t *dst, const frame_set_t *src);
+
+/** Create a set of the frame numbers that are in both a and b. */
+WS_DLL_PUBLIC frame_set_t *frame_set_intersect(const frame_set_t *a,
+    const frame_set_t *b);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FRAME_SET_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
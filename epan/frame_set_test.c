@@ -0,0 +1,280 @@
+/* frame_set_test.c
+ * Standalone program to test the frame_set.h API
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "frame_set.h"
+
+/* Must match frame_set.c: a group with more members than this is a bitmap */
+#define FRAME_SET_ARRAY_MAX     4096
+
+/* Frame numbers used by the tests that compare against a plain array */
+#define MODEL_MAX               (5 * 65536)
+
+/* A repeatable sequence of numbers, so a failure can be reproduced */
+static guint32
+next_random(guint32 *state)
+{
+    *state = *state * 1103515245 + 12345;
+    return *state >> 8;
+}
+
+/* Check that a set has exactly the members marked in model. */
+static void
+check_against_model(const frame_set_t *set, const gboolean *model)
+{
+    guint32 num, next, count = 0;
+
+    next = frame_set_next(set, 0);
+    for (num = 1; num < MODEL_MAX; num++) {
+        g_assert(frame_set_contains(set, num) == model[num]);
+        if (model[num]) {
+            g_assert_cmpuint(next, ==, num);
+            next = frame_set_next(set, num);
+            count++;
+        }
+    }
+    g_assert_cmpuint(next, ==, 0);
+    g_assert_cmpuint(frame_set_count(set), ==, count);
+}
+
+static void
+frame_set_test_empty(void)
+{
+    frame_set_t *set = frame_set_new();
+
+    g_assert_cmpuint(frame_set_count(set), ==, 0);
+    g_assert(!frame_set_contains(set, 1));
+    g_assert(!frame_set_contains(set, G_MAXUINT32));
+    g_assert_cmpuint(frame_set_next(set, 0), ==, 0);
+    g_assert_cmpuint(frame_set_next(set, G_MAXUINT32), ==, 0);
+
+    frame_set_free(set);
+    frame_set_free(NULL);
+}
+
+static void
+frame_set_test_add(void)
+{
+    frame_set_t *set = frame_set_new();
+
+    frame_set_add(set, 1);
+    frame_set_add(set, 2);
+    frame_set_add(set, 10);
+    g_assert_cmpuint(frame_set_count(set), ==, 3);
+
+    /* Adding a member again changes nothing. */
+    frame_set_add(set, 2);
+    frame_set_add(set, 10);
+    g_assert_cmpuint(frame_set_count(set), ==, 3);
+
+    g_assert(frame_set_contains(set, 1));
+    g_assert(frame_set_contains(set, 2));
+    g_assert(frame_set_contains(set, 10));
+    g_assert(!frame_set_contains(set, 3));
+    g_assert(!frame_set_contains(set, 9));
+    g_assert(!frame_set_contains(set, 11));
+    /* Same lower 16 bits, different group */
+    g_assert(!frame_set_contains(set, 65536 + 2));
+
+    /* Each end of the range of frame numbers */
+    frame_set_add(set, G_MAXUINT32);
+    g_assert(frame_set_contains(set, G_MAXUINT32));
+    g_assert_cmpuint(frame_set_count(set), ==, 4);
+    g_assert_cmpuint(frame_set_next(set, 10), ==, G_MAXUINT32);
+    g_assert_cmpuint(frame_set_next(set, G_MAXUINT32), ==, 0);
+
+    frame_set_free(set);
+}
+
+static void
+frame_set_test_order(void)
+{
+    static const guint32 added[] = {
+        70000, 5, 200000, 65536, 65535, 3, 131072, 65537, 4, 199999
+    };
+    static const guint32 sorted[] = {
+        3, 4, 5, 65535, 65536, 65537, 70000, 131072, 199999, 200000
+    };
+    frame_set_t *set = frame_set_new();
+    guint32 num = 0;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(added); i++)
+        frame_set_add(set, added[i]);
+    g_assert_cmpuint(frame_set_count(set), ==, G_N_ELEMENTS(sorted));
+
+    /* Members come out in increasing order, whatever order they went in. */
+    for (i = 0; i < G_N_ELEMENTS(sorted); i++) {
+        num = frame_set_next(set, num);
+        g_assert_cmpuint(num, ==, sorted[i]);
+    }
+    g_assert_cmpuint(frame_set_next(set, num), ==, 0);
+
+    /* Starting between members, and across empty groups */
+    g_assert_cmpuint(frame_set_next(set, 6), ==, 65535);
+    g_assert_cmpuint(frame_set_next(set, 65535), ==, 65536);
+    g_assert_cmpuint(frame_set_next(set, 70000), ==, 131072);
+    g_assert_cmpuint(frame_set_next(set, 140000), ==, 199999);
+
+    frame_set_free(set);
+}
+
+static void
+frame_set_test_dense(void)
+{
+    frame_set_t *set;
+    guint32 num;
+
+    /* Exactly as many as an array holds, then one more. */
+    set = frame_set_new();
+    for (num = 1; num <= FRAME_SET_ARRAY_MAX; num++)
+        frame_set_add(set, num * 2);
+    g_assert_cmpuint(frame_set_count(set), ==, FRAME_SET_ARRAY_MAX);
+    frame_set_add(set, 1);
+    g_assert_cmpuint(frame_set_count(set), ==, FRAME_SET_ARRAY_MAX + 1);
+
+    /* Everything added before the switch is still there, and only that. */
+    g_assert(frame_set_contains(set, 1));
+    for (num = 2; num <= 2 * FRAME_SET_ARRAY_MAX + 1; num++)
+        g_assert(frame_set_contains(set, num) == (num % 2 == 0));
+    g_assert_cmpuint(frame_set_next(set, 0), ==, 1);
+    g_assert_cmpuint(frame_set_next(set, 1), ==, 2);
+    g_assert_cmpuint(frame_set_next(set, 2), ==, 4);
+    g_assert_cmpuint(frame_set_next(set, 2 * FRAME_SET_ARRAY_MAX), ==, 0);
+
+    /* Adding members again doesn't count them twice. */
+    frame_set_add(set, 1);
+    frame_set_add(set, 2 * FRAME_SET_ARRAY_MAX);
+    g_assert_cmpuint(frame_set_count(set), ==, FRAME_SET_ARRAY_MAX + 1);
+
+    /* A whole group, up to the next one */
+    for (num = 1; num < 65536; num++)
+        frame_set_add(set, num);
+    frame_set_add(set, 65536);
+    g_assert_cmpuint(frame_set_count(set), ==, 65536);
+    for (num = 0; num < 65536; num++)
+        g_assert_cmpuint(frame_set_next(set, num), ==, num + 1);
+    g_assert_cmpuint(frame_set_next(set, 65536), ==, 0);
+
+    frame_set_free(set);
+}
+
+static void
+frame_set_test_random(void)
+{
+    frame_set_t *set = frame_set_new();
+    gboolean *model = g_new0(gboolean, MODEL_MAX);
+    guint32 state = 1;
+    guint32 num;
+    guint i;
+
+    /*
+     * A sparse group, a group that only just turns into a bitmap, and a
+     * very dense one, all filled in no particular order.
+     */
+    for (i = 0; i < 200; i++) {
+        num = 1 + next_random(&state) % 65535;
+        frame_set_add(set, num);
+        model[num] = TRUE;
+    }
+    for (i = 0; i < 6000; i++) {
+        num = 65536 + next_random(&state) % 65536;
+        frame_set_add(set, num);
+        model[num] = TRUE;
+    }
+    for (i = 0; i < 100000; i++) {
+        num = 3 * 65536 + next_random(&state) % 65536;
+        frame_set_add(set, num);
+        model[num] = TRUE;
+    }
+    check_against_model(set, model);
+
+    frame_set_free(set);
+    g_free(model);
+}
+
+static void
+frame_set_test_union_intersect(void)
+{
+    frame_set_t *a = frame_set_new();
+    frame_set_t *b = frame_set_new();
+    frame_set_t *both;
+    gboolean *in_a = g_new0(gboolean, MODEL_MAX);
+    gboolean *in_b = g_new0(gboolean, MODEL_MAX);
+    gboolean *model = g_new0(gboolean, MODEL_MAX);
+    guint32 state = 7;
+    guint32 num;
+
+    /* a is sparse everywhere; b is dense in its second group only. */
+    for (num = 1; num < MODEL_MAX; num++) {
+        if (next_random(&state) % 64 == 0) {
+            frame_set_add(a, num);
+            in_a[num] = TRUE;
+        }
+        if ((num >> 16) == 1 ? next_random(&state) % 2 == 0 :
+                               next_random(&state) % 256 == 0) {
+            frame_set_add(b, num);
+            in_b[num] = TRUE;
+        }
+    }
+
+    for (num = 1; num < MODEL_MAX; num++)
+        model[num] = in_a[num] && in_b[num];
+    both = frame_set_intersect(a, b);
+    check_against_model(both, model);
+    frame_set_free(both);
+
+    /* The same, with the larger set first */
+    both = frame_set_intersect(b, a);
+    check_against_model(both, model);
+    frame_set_free(both);
+
+    for (num = 1; num < MODEL_MAX; num++)
+        model[num] = in_a[num] || in_b[num];
+    frame_set_union(a, b);
+    check_against_model(a, model);
+
+    frame_set_free(a);
+    frame_set_free(b);
+    g_free(in_a);
+    g_free(in_b);
+    g_free(model);
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/frame_set/empty",           frame_set_test_empty);
+    g_test_add_func("/frame_set/add",             frame_set_test_add);
+    g_test_add_func("/frame_set/order",           frame_set_test_order);
+    g_test_add_func("/frame_set/dense",           frame_set_test_dense);
+    g_test_add_func("/frame_set/random",          frame_set_test_random);
+    g_test_add_func("/frame_set/union_intersect", frame_set_test_union_intersect);
+
+    return g_test_run();
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
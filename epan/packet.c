@@ -28,6 +28,7 @@
 #include "addr_resolv.h"
 #include "tvbuff.h"
 #include "epan_dissect.h"
+#include "dissector_prof.h"
 
 #include "wmem/wmem.h"
 
@@ -231,10 +232,11 @@ packet_cache_proto_handles(void)
 }
 
 /* List of routines that are called before we make a pass through a capture file
- * and dissect all its packets. See register_init_routine, register_cleanup_routine
- * and register_shutdown_routine in packet.h */
+ * and dissect all its packets. See register_init_routine, register_cleanup_routine,
+ * register_file_close_routine and register_shutdown_routine in packet.h */
 static GSList *init_routines = NULL;
 static GSList *cleanup_routines = NULL;
+static GSList *file_close_routines = NULL;
 static GSList *shutdown_routines = NULL;
 
 typedef void (*void_func_t)(void);
@@ -252,6 +254,7 @@ packet_cleanup(void)
 {
 	g_slist_free(init_routines);
 	g_slist_free(cleanup_routines);
+	g_slist_free(file_close_routines);
 	g_slist_free(postseq_cleanup_routines);
 	g_hash_table_destroy(dissector_tables);
 	g_hash_table_destroy(dissector_table_aliases);
@@ -259,6 +262,7 @@ packet_cleanup(void)
 	g_hash_table_destroy(depend_dissector_lists);
 	g_hash_table_destroy(heur_dissector_lists);
 	g_hash_table_destroy(heuristic_short_names);
+	dissector_prof_cleanup();
 	g_slist_foreach(shutdown_routines, &call_routine, NULL);
 	g_slist_free(shutdown_routines);
 	if (postdissectors) {
@@ -301,6 +305,13 @@ register_cleanup_routine(void (*func)(void))
 	cleanup_routines = g_slist_prepend(cleanup_routines, (gpointer)func);
 }
 
+/* register a new file close routine */
+void
+register_file_close_routine(void (*func)(void))
+{
+	file_close_routines = g_slist_prepend(file_close_routines, (gpointer)func);
+}
+
 /* register a new shutdown routine */
 void
 register_shutdown_routine(void (*func)(void))
@@ -356,6 +367,12 @@ cleanup_dissection(void)
 	 */
 }
 
+void
+close_file_dissection(void)
+{
+	g_slist_foreach(file_close_routines, &call_routine, NULL);
+}
+
 void
 register_postseq_cleanup_routine(void_func_t func)
 {
@@ -569,6 +586,8 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype,
 	frame_dissector_data.file_type_subtype = file_type_subtype;
 	frame_dissector_data.color_edt = edt; /* Used strictly for "coloring rules" */
 
+	dissector_prof_begin_packet();
+
 	TRY {
 		/* Add this tvbuffer into the data_src list */
 		add_new_data_source(&edt->pi, edt->tvb, record_type);
@@ -626,6 +645,7 @@ dissect_file(epan_dissect_t *edt, wtap_rec *rec,
 
 	frame_delta_abs_time(edt->session, fd, fd->frame_ref_num, &edt->pi.rel_ts);
 
+	dissector_prof_begin_packet();
 
 	TRY {
 		/* pkt comment use first user, later from rec */
@@ -676,8 +696,57 @@ struct dissector_handle {
 	void		*dissector_func;
 	void		*dissector_data;
 	protocol_t	*protocol;
+	dissector_prof_entry_t *prof_entry;	/* profiler bookkeeping, or NULL */
 };
 
+/*
+ * Call a dissector whose call the profiler is timing. Its frame is closed
+ * whether the dissector returns or throws, so that the time and memory
+ * used until the exception is caught further up aren't charged to it.
+ */
+static int
+call_dissector_profiled(dissector_handle_t handle, int prof_token,
+			tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data)
+{
+	volatile int len = 0;
+
+	TRY {
+		if (handle->dissector_type == DISSECTOR_TYPE_SIMPLE) {
+			len = ((dissector_t)handle->dissector_func)(tvb, pinfo, tree, data);
+		}
+		else if (handle->dissector_type == DISSECTOR_TYPE_CALLBACK) {
+			len = ((dissector_cb_t)handle->dissector_func)(tvb, pinfo, tree, data, handle->dissector_data);
+		}
+		else {
+			g_assert_not_reached();
+		}
+	}
+	FINALLY {
+		dissector_prof_leave(prof_token);
+	}
+	ENDTRY;
+
+	return len;
+}
+
+/* The same, for a heuristic dissector. */
+static int
+call_heur_dissector_profiled(heur_dissector_t dissector, int prof_token,
+			     tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data)
+{
+	volatile int len = 0;
+
+	TRY {
+		len = (*dissector)(tvb, pinfo, tree, data);
+	}
+	FINALLY {
+		dissector_prof_leave(prof_token);
+	}
+	ENDTRY;
+
+	return len;
+}
+
 /* This function will return
  * old style dissector :
  *   length of the payload or 1 of the payload is empty
@@ -694,6 +763,7 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 {
 	const char *saved_proto;
 	int         len;
+	int         prof_token = -1;
 
 	saved_proto = pinfo->current_proto;
 
@@ -702,7 +772,15 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 			proto_get_protocol_short_name(handle->protocol);
 	}
 
-	if (handle->dissector_type == DISSECTOR_TYPE_SIMPLE) {
+	if (handle->protocol != NULL && dissector_prof_is_enabled()) {
+		prof_token = dissector_prof_enter(&handle->prof_entry,
+		    proto_get_id(handle->protocol));
+	}
+
+	if (prof_token >= 0) {
+		len = call_dissector_profiled(handle, prof_token, tvb, pinfo, tree, data);
+	}
+	else if (handle->dissector_type == DISSECTOR_TYPE_SIMPLE) {
 		len = ((dissector_t)handle->dissector_func)(tvb, pinfo, tree, data);
 	}
 	else if (handle->dissector_type == DISSECTOR_TYPE_CALLBACK) {
@@ -2727,6 +2805,7 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	int                proto_id;
 	int                len;
 	int                saved_tree_count = tree ? tree->tree_data->count : 0;
+	int                prof_token = -1;
 
 	/* can_desegment is set to 2 by anyone which offers this api/service.
 	   then everytime a subdissector is called it is decremented by one.
@@ -2781,7 +2860,14 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 
 		pinfo->heur_list_name = hdtbl_entry->list_name;
 
-		len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+		prof_token = -1;
+		if (hdtbl_entry->protocol != NULL && dissector_prof_is_enabled()) {
+			prof_token = dissector_prof_enter(NULL, proto_id);
+		}
+		if (prof_token >= 0)
+			len = call_heur_dissector_profiled(hdtbl_entry->dissector, prof_token, tvb, pinfo, tree, data);
+		else
+			len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
 		if (hdtbl_entry->protocol != NULL &&
 			(len == 0 || (tree && saved_tree_count == tree->tree_data->count))) {
 			/*
@@ -3069,6 +3155,7 @@ new_dissector_handle(enum dissector_e type, void *dissector, const int proto, co
 	handle->dissector_func	= dissector;
 	handle->dissector_data	= cb_data;
 	handle->protocol	= find_protocol_by_id(proto);
+	handle->prof_entry	= NULL;
 	return handle;
 }
 
@@ -3229,6 +3316,8 @@ void call_heur_dissector_direct(heur_dtbl_entry_t *heur_dtbl_entry, tvbuff_t *tv
 	const char        *saved_heur_list_name;
 	guint16            saved_can_desegment;
 	guint              saved_layers_len = 0;
+	int                prof_token = -1;
+	int                len;
 
 	DISSECTOR_ASSERT(heur_dtbl_entry);
 
@@ -3267,8 +3356,16 @@ void call_heur_dissector_direct(heur_dtbl_entry_t *heur_dtbl_entry, tvbuff_t *tv
 
 	pinfo->heur_list_name = heur_dtbl_entry->list_name;
 
+	if (heur_dtbl_entry->protocol != NULL && dissector_prof_is_enabled()) {
+		prof_token = dissector_prof_enter(NULL, proto_get_id(heur_dtbl_entry->protocol));
+	}
+
 	/* call the dissector, in case of failure call data handle (might happen with exported PDUs) */
-	if (!(*heur_dtbl_entry->dissector)(tvb, pinfo, tree, data)) {
+	if (prof_token >= 0)
+		len = call_heur_dissector_profiled(heur_dtbl_entry->dissector, prof_token, tvb, pinfo, tree, data);
+	else
+		len = (*heur_dtbl_entry->dissector)(tvb, pinfo, tree, data);
+	if (!len) {
 		call_dissector_work(data_handle, tvb, pinfo, tree, TRUE, NULL);
 
 		/*
@@ -678,6 +678,14 @@ WS_DLL_PUBLIC void register_init_routine(void (*func)(void));
  */
 WS_DLL_PUBLIC void register_cleanup_routine(void (*func)(void));
 
+/**
+ * Allows protocols to register "file close" routines which are called
+ * after the cleanup routines when a capture file is closed, but not when
+ * it is dissected again after a preference change. They can release
+ * state that is kept across such redissections of the same file.
+ */
+WS_DLL_PUBLIC void register_file_close_routine(void (*func)(void));
+
 /*
  * Register a shutdown routine to call once just before program exit
  */
@@ -689,6 +697,9 @@ void init_dissection(void);
 /* Free data structures allocated for dissection. */
 void cleanup_dissection(void);
 
+/* Free data structures kept for the capture file across redissections. */
+void close_file_dissection(void);
+
 /* Allow protocols to register a "cleanup" routine to be
  * run after the initial sequential run through the packets.
  * Note that the file can still be open after this; this is not
@@ -3223,6 +3223,41 @@ prefs_register_modules(void)
                                    10,
                                    &prefs.gui_recent_df_entries_max);
 
+    prefs_register_uint_preference(gui_module, "conversation_table_entries.max",
+                                   "The max. number of entries in the Conversations and Endpoints tables",
+                                   "The max. number of entries kept in each Conversations and Endpoints table, "
+                                   "keeping the ones with the most packets. Packet counts of entries that replaced "
+                                   "others are approximate and shown with an upper bound. 0 for no limit.",
+                                   10,
+                                   &prefs.gui_conversation_table_max_entries);
+
+    prefs_register_bool_preference(gui_module, "field_index",
+                                   "Index field values when reading a capture file",
+                                   "Remember which packets have each value of the fields below while "
+                                   "reading a capture file, so that following a stream, graphing it, "
+                                   "or filtering on one of those values only dissects the packets that "
+                                   "have it. Uses more memory and makes reading slower.",
+                                   &prefs.gui_field_index);
+
+    register_string_like_preference(gui_module, "field_index.fields", "Indexed fields",
+        "Fields to index, separated by spaces. Integer, string and address "
+        "fields can be indexed; fields whose value depends on later packets shouldn't be.",
+        &prefs.gui_field_index_fields, PREF_STRING, NULL, TRUE);
+
+    prefs_register_bool_preference(gui_module, "export_objects.defer_payloads",
+                                   "Don't keep exported objects in memory",
+                                   "Keep only the names and sizes of HTTP and IMF objects in the "
+                                   "Export Objects dialogs, and dissect the packet an object came "
+                                   "from again when it's saved.",
+                                   &prefs.gui_eo_defer_payloads);
+
+    prefs_register_bool_preference(gui_module, "voip_calls.incremental",
+                                   "Find VoIP calls when reading a capture file",
+                                   "Collect the VoIP calls while a capture file is read or captured, "
+                                   "so that the VoIP Calls dialog and its flow sequence open without "
+                                   "reading the file again. Makes reading slower.",
+                                   &prefs.gui_voip_calls_incremental);
+
     register_string_like_preference(gui_module, "fileopen.dir", "Start Directory",
         "Directory to start in when opening File Open dialog.",
         &prefs.gui_fileopen_dir, PREF_DIRNAME, NULL, TRUE);
@@ -4083,6 +4118,12 @@ pre_init_prefs(void)
     prefs.gui_fileopen_style         = FO_STYLE_LAST_OPENED;
     prefs.gui_recent_df_entries_max  = 10;
     prefs.gui_recent_files_count_max = 10;
+    prefs.gui_conversation_table_max_entries = 0;
+    prefs.gui_field_index = FALSE;
+    g_free(prefs.gui_field_index_fields);
+    prefs.gui_field_index_fields = g_strdup("tcp.stream udp.stream ip.addr ipv6.addr eth.addr frame.protocols");
+    prefs.gui_eo_defer_payloads = FALSE;
+    prefs.gui_voip_calls_incremental = FALSE;
     g_free(prefs.gui_fileopen_dir);
     prefs.gui_fileopen_dir           = g_strdup(get_persdatafile_dir());
     prefs.gui_fileopen_preview       = 3;
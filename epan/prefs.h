@@ -161,6 +161,11 @@ typedef struct _e_prefs {
   console_open_e gui_console_open;
   guint        gui_recent_df_entries_max;
   guint        gui_recent_files_count_max;
+  guint        gui_conversation_table_max_entries;
+  gboolean     gui_field_index;
+  gchar       *gui_field_index_fields;
+  gboolean     gui_eo_defer_payloads;
+  gboolean     gui_voip_calls_incremental;
   guint        gui_fileopen_style;
   gchar       *gui_fileopen_dir;
   guint        gui_fileopen_preview;
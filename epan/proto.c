@@ -343,9 +343,24 @@ static GPtrArray *deregistered_data = NULL;
 static GHashTable* prefixes = NULL;
 
 /* Contains information about a field when a dissector calls
- * proto_tree_add_item.  */
-#define FIELD_INFO_NEW(pool, fi)  fi = wmem_new(pool, field_info)
-#define FIELD_INFO_FREE(pool, fi) wmem_free(pool, fi)
+ * proto_tree_add_item.
+ *
+ * A field_info is allocated together with the proto_node that will hold
+ * it, in one chunk of the pinfo pool: that's one allocation per item
+ * rather than two, the node and its field end up next to each other in
+ * memory, and both go when the pool is emptied at the end of the
+ * dissection.  Every field_info comes from new_field_info(), and only
+ * proto_tree_add_node() puts one in the tree, using the node that came
+ * with it. */
+typedef struct {
+	proto_node node;
+	field_info finfo;
+} field_node_t;
+
+#define FIELD_INFO_NEW(pool, fi)  fi = &wmem_new(pool, field_node_t)->finfo
+#define FIELD_INFO_FREE(pool, fi) wmem_free(pool, FIELD_INFO_NODE(fi))
+#define FIELD_INFO_NODE(fi) \
+	((proto_node *)((guint8 *)(fi) - G_STRUCT_OFFSET(field_node_t, finfo)))
 
 /* Contains the space for proto_nodes. */
 #define PROTO_NODE_INIT(node)			\
@@ -5503,7 +5518,7 @@ proto_tree_add_node(proto_tree *tree, field_info *fi)
 		/* XXX - is it safe to continue here? */
 	}
 
-	pnode = wmem_new(PNODE_POOL(tree), proto_node);
+	pnode = FIELD_INFO_NODE(fi);
 	PROTO_NODE_INIT(pnode);
 	pnode->parent = tnode;
 	PNODE_FINFO(pnode) = fi;
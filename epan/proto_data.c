@@ -10,6 +10,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #if 0
@@ -35,73 +37,238 @@ typedef struct _proto_data {
   void *proto_data;
 } proto_data_t;
 
-static gint
-p_compare(gconstpointer a, gconstpointer b)
+/*
+ * Most frames only carry a handful of proto data items, so the first
+ * PROTO_DATA_DENSE_MAX of them are kept in an array inside the table
+ * itself and looked up with a linear scan. Frames with more items (TCP
+ * with TLS, HTTP/2 and friends on top, SMB2 compounds, ...) switch to an
+ * open-addressed hash table with linear probing, keyed on (proto, key).
+ *
+ * Adding an item with a (proto, key) pair that is already present hides
+ * the old one until the new one is removed again, as the list this
+ * replaced did: nested dissections (IP in IP, say) add and remove the same
+ * key in turn. The hidden items are kept on a separate stack, which is
+ * only allocated by a frame that needs it, so lookups still see at most
+ * one item per (proto, key).
+ */
+#define PROTO_DATA_DENSE_MAX  4
+#define PROTO_DATA_HASH_MIN   16
+
+/* Marks an unused hash slot; never a valid protocol id. */
+#define PROTO_DATA_EMPTY      G_MININT
+
+struct _proto_data_table {
+  guint         count;
+  guint         capacity;   /* number of hash slots, 0 while dense */
+  proto_data_t *slots;      /* hash slots, NULL while dense */
+  proto_data_t  dense[PROTO_DATA_DENSE_MAX];
+  guint         hidden_count;
+  guint         hidden_size;
+  proto_data_t *hidden;     /* items hidden by a newer one, oldest first */
+};
+
+static inline guint
+p_hash(int proto, guint32 key)
+{
+  guint32 h = ((guint32)proto * 0x9E3779B1U) ^ (key * 0x85EBCA77U);
+
+  return h ^ (h >> 15);
+}
+
+static void
+p_hash_insert(proto_data_t *slots, guint capacity, const proto_data_t *item)
 {
-  const proto_data_t *ap = (const proto_data_t *)a;
-  const proto_data_t *bp = (const proto_data_t *)b;
-
-  if (ap -> proto > bp -> proto) {
-    return 1;
-  } else if (ap -> proto == bp -> proto) {
-    if (ap->key > bp->key){
-      return 1;
-    } else if (ap -> key == bp -> key) {
-      return 0;
+  guint mask = capacity - 1;
+  guint i = p_hash(item->proto, item->key) & mask;
+
+  while (slots[i].proto != PROTO_DATA_EMPTY)
+    i = (i + 1) & mask;
+
+  slots[i] = *item;
+}
+
+static void
+p_table_grow(proto_data_table_t *table)
+{
+  proto_data_t *old_slots = table->slots;
+  guint old_capacity = table->capacity;
+  guint capacity = old_capacity ? old_capacity * 2 : PROTO_DATA_HASH_MIN;
+  proto_data_t *slots = g_new(proto_data_t, capacity);
+  guint i;
+
+  for (i = 0; i < capacity; i++)
+    slots[i].proto = PROTO_DATA_EMPTY;
+
+  if (old_slots) {
+    for (i = 0; i < old_capacity; i++) {
+      if (old_slots[i].proto != PROTO_DATA_EMPTY)
+        p_hash_insert(slots, capacity, &old_slots[i]);
     }
-    return -1;
+    g_free(old_slots);
   } else {
-    return -1;
+    for (i = 0; i < table->count; i++)
+      p_hash_insert(slots, capacity, &table->dense[i]);
   }
+
+  table->slots = slots;
+  table->capacity = capacity;
 }
 
-void
-p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, guint32 key, void *proto_data)
+static proto_data_t *
+p_table_find(proto_data_table_t *table, int proto, guint32 key)
 {
-  proto_data_t     *p1;
-  GSList          **proto_list;
-  wmem_allocator_t *scope;
-
-  if (tmp_scope == pinfo->pool) {
-    scope = tmp_scope;
-    proto_list = &pinfo->proto_data;
-  } else if (tmp_scope == wmem_file_scope()) {
-    scope = wmem_file_scope();
-    proto_list = &pinfo->fd->pfd;
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+  guint i;
+
+  if (!table)
+    return NULL;
+
+  if (!table->slots) {
+    for (i = 0; i < table->count; i++) {
+      if (table->dense[i].proto == proto && table->dense[i].key == key)
+        return &table->dense[i];
+    }
+    return NULL;
   }
 
-  p1 = (proto_data_t *)wmem_alloc(scope, sizeof(proto_data_t));
+  for (i = p_hash(proto, key) & (table->capacity - 1);
+       table->slots[i].proto != PROTO_DATA_EMPTY;
+       i = (i + 1) & (table->capacity - 1)) {
+    if (table->slots[i].proto == proto && table->slots[i].key == key)
+      return &table->slots[i];
+  }
+  return NULL;
+}
+
+static void
+p_table_remove(proto_data_table_t *table, proto_data_t *item)
+{
+  guint mask, i, j, home;
 
-  p1->proto = proto;
-  p1->key = key;
-  p1->proto_data = proto_data;
+  if (!table->slots) {
+    /* Keep the dense array packed, preserving insertion order. */
+    guint idx = (guint)(item - table->dense);
+
+    memmove(&table->dense[idx], &table->dense[idx + 1],
+            (table->count - idx - 1) * sizeof(proto_data_t));
+    table->count--;
+    return;
+  }
 
-  /* Add it to the GSLIST */
-  *proto_list = g_slist_prepend(*proto_list, p1);
+  /*
+   * Backward-shift deletion: move later members of the probe run into
+   * the hole so that lookups never need tombstones.
+   */
+  mask = table->capacity - 1;
+  i = (guint)(item - table->slots);
+  j = i;
+  for (;;) {
+    j = (j + 1) & mask;
+    if (table->slots[j].proto == PROTO_DATA_EMPTY)
+      break;
+    home = p_hash(table->slots[j].proto, table->slots[j].key) & mask;
+    /* Can slot j move to i, i.e. is its home not cyclically in (i, j]? */
+    if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+      table->slots[i] = table->slots[j];
+      i = j;
+    }
+  }
+  table->slots[i].proto = PROTO_DATA_EMPTY;
+  table->count--;
 }
 
-void *
-p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
+/* Hide an item under a newer one with the same (proto, key). */
+static void
+p_table_hide(proto_data_table_t *table, const proto_data_t *item)
 {
-  proto_data_t  temp, *p1;
-  GSList       *item;
+  if (table->hidden_count == table->hidden_size) {
+    table->hidden_size = table->hidden_size ? table->hidden_size * 2 : 4;
+    table->hidden = g_renew(proto_data_t, table->hidden, table->hidden_size);
+  }
+  table->hidden[table->hidden_count++] = *item;
+}
 
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+/*
+ * The item for (proto, key) has been removed; bring back the one it hid,
+ * if any. Returns TRUE if there was one.
+ */
+static gboolean
+p_table_unhide(proto_data_table_t *table, int proto, guint32 key, void **proto_data)
+{
+  guint i = table->hidden_count;
 
+  while (i-- > 0) {
+    if (table->hidden[i].proto == proto && table->hidden[i].key == key) {
+      *proto_data = table->hidden[i].proto_data;
+      memmove(&table->hidden[i], &table->hidden[i + 1],
+              (table->hidden_count - i - 1) * sizeof(proto_data_t));
+      table->hidden_count--;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+static proto_data_table_t **
+p_get_table_ptr(wmem_allocator_t *scope, struct _packet_info* pinfo)
+{
   if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
+    return &pinfo->proto_data;
   } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
+    return &pinfo->fd->pfd;
   } else {
     DISSECTOR_ASSERT(!"invalid wmem scope");
   }
+  return NULL;
+}
+
+void
+p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, guint32 key, void *proto_data)
+{
+  proto_data_table_t **table_ptr = p_get_table_ptr(tmp_scope, pinfo);
+  proto_data_table_t  *table = *table_ptr;
+  proto_data_t        *p1;
+  proto_data_t         item;
+
+  p1 = p_table_find(table, proto, key);
+  if (p1) {
+    p_table_hide(table, p1);
+    p1->proto_data = proto_data;
+    return;
+  }
+
+  if (!table) {
+    table = g_new(proto_data_table_t, 1);
+    table->count = 0;
+    table->capacity = 0;
+    table->slots = NULL;
+    table->hidden_count = 0;
+    table->hidden_size = 0;
+    table->hidden = NULL;
+    *table_ptr = table;
+  }
+
+  item.proto = proto;
+  item.key = key;
+  item.proto_data = proto_data;
+
+  if (!table->slots && table->count < PROTO_DATA_DENSE_MAX) {
+    table->dense[table->count] = item;
+  } else {
+    /* Keep the load factor at or below 1/2. */
+    if (!table->slots || (table->count + 1) * 2 > table->capacity)
+      p_table_grow(table);
+    p_hash_insert(table->slots, table->capacity, &item);
+  }
+  table->count++;
+}
+
+void *
+p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
+{
+  proto_data_t *p1;
 
-  if (item) {
-    p1 = (proto_data_t *)item->data;
+  p1 = p_table_find(*p_get_table_ptr(scope, pinfo), proto, key);
+  if (p1) {
     return p1->proto_data;
   }
 
@@ -111,44 +278,62 @@ p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto,
 void
 p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
 {
-  proto_data_t  temp;
-  GSList       *item;
-  GSList      **proto_list;
-
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  proto_data_table_t *table = *p_get_table_ptr(scope, pinfo);
+  proto_data_t       *p1;
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
-    proto_list = &pinfo->proto_data;
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-    proto_list = &pinfo->fd->pfd;
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+  p1 = p_table_find(table, proto, key);
+  if (p1) {
+    /* Hidden items aren't counted in the table, so it's just replaced. */
+    if (table->hidden_count == 0 || !p_table_unhide(table, proto, key, &p1->proto_data))
+      p_table_remove(table, p1);
   }
+}
 
-  if (item) {
-    *proto_list = g_slist_remove(*proto_list, item->data);
-  }
+guint
+p_get_proto_data_count(wmem_allocator_t *scope, struct _packet_info* pinfo)
+{
+  proto_data_table_t *table = *p_get_table_ptr(scope, pinfo);
+
+  return table ? table->count + table->hidden_count : 0;
 }
 
 gchar *
 p_get_proto_name_and_key(wmem_allocator_t *scope, struct _packet_info* pinfo, guint pfd_index){
-  proto_data_t  *temp;
+  proto_data_table_t *table = *p_get_table_ptr(scope, pinfo);
+  proto_data_t       *temp = NULL;
+  guint               i, n;
 
-  if (scope == pinfo->pool) {
-    temp = (proto_data_t *)g_slist_nth_data(pinfo->proto_data, pfd_index);
-  } else if (scope == wmem_file_scope()) {
-    temp = (proto_data_t *)g_slist_nth_data(pinfo->fd->pfd, pfd_index);
+  DISSECTOR_ASSERT(table && pfd_index < table->count + table->hidden_count);
+
+  /* The items that lookups see, then the hidden ones, newest first */
+  if (pfd_index >= table->count) {
+    temp = &table->hidden[table->hidden_count - 1 - (pfd_index - table->count)];
+  } else if (!table->slots) {
+    temp = &table->dense[pfd_index];
   } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+    for (i = 0, n = 0; i < table->capacity; i++) {
+      if (table->slots[i].proto == PROTO_DATA_EMPTY)
+        continue;
+      if (n++ == pfd_index) {
+        temp = &table->slots[i];
+        break;
+      }
+    }
   }
 
   return wmem_strdup_printf(wmem_packet_scope(),"[%s, key %u]",proto_get_protocol_name(temp->proto), temp->key);
 }
 
+void
+p_free_proto_data_table(proto_data_table_t *table)
+{
+  if (table) {
+    g_free(table->slots);
+    g_free(table->hidden);
+    g_free(table);
+  }
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
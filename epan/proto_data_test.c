@@ -0,0 +1,327 @@
+/* proto_data_test.c
+ * Standalone program to test the proto_data.h API
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/proto_data.h>
+#include <epan/wmem/wmem.h>
+
+#include <wsutil/time_util.h>
+
+/* More items than the table keeps in its array, so it switches to hashing */
+#define MANY_ITEMS              40
+
+static packet_info pinfo;
+static frame_data  fd;
+
+/* A distinct pointer for each (proto, key), so lookups can be checked */
+#define ITEM_DATA(proto, key)   GUINT_TO_POINTER(((proto) << 16) + (key) + 1)
+
+/* Start each test with an empty frame. */
+static void
+reset_frame(void)
+{
+    p_free_proto_data_table(fd.pfd);
+    fd.pfd = NULL;
+    pinfo.fd = &fd;
+}
+
+static void
+proto_data_test_add_get(void)
+{
+    guint n, i;
+
+    for (n = 1; n <= MANY_ITEMS; n++) {
+        reset_frame();
+        for (i = 0; i < n; i++)
+            p_add_proto_data(wmem_file_scope(), &pinfo, 100 + i % 7, i, ITEM_DATA(100 + i % 7, i));
+        g_assert_cmpuint(p_get_proto_data_count(wmem_file_scope(), &pinfo), ==, n);
+
+        for (i = 0; i < n; i++)
+            g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100 + i % 7, i) == ITEM_DATA(100 + i % 7, i));
+        /* Right key, wrong protocol, and the other way round */
+        g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 99, 0) == NULL);
+        g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, n) == NULL);
+    }
+    reset_frame();
+    g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, 0) == NULL);
+    g_assert_cmpuint(p_get_proto_data_count(wmem_file_scope(), &pinfo), ==, 0);
+}
+
+static void
+proto_data_test_remove(void)
+{
+    guint n, i, removed;
+
+    for (n = 1; n <= MANY_ITEMS; n++) {
+        reset_frame();
+        for (i = 0; i < n; i++)
+            p_add_proto_data(wmem_file_scope(), &pinfo, 100, i, ITEM_DATA(100, i));
+
+        /* Every third item, then one that isn't there */
+        for (i = 0, removed = 0; i < n; i += 3, removed++)
+            p_remove_proto_data(wmem_file_scope(), &pinfo, 100, i);
+        p_remove_proto_data(wmem_file_scope(), &pinfo, 100, n);
+        g_assert_cmpuint(p_get_proto_data_count(wmem_file_scope(), &pinfo), ==, n - removed);
+
+        for (i = 0; i < n; i++) {
+            if (i % 3 == 0)
+                g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, i) == NULL);
+            else
+                g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, i) == ITEM_DATA(100, i));
+        }
+    }
+    reset_frame();
+}
+
+static void
+proto_data_test_hide(void)
+{
+    guint others, i;
+
+    /* With the table still an array, and once it's hashed */
+    for (others = 0; others <= MANY_ITEMS; others += MANY_ITEMS) {
+        reset_frame();
+        for (i = 0; i < others; i++)
+            p_add_proto_data(wmem_file_scope(), &pinfo, 200, i, ITEM_DATA(200, i));
+
+        /* An outer and an inner dissection add the same key in turn. */
+        p_add_proto_data(wmem_file_scope(), &pinfo, 100, 1, GUINT_TO_POINTER(1));
+        p_add_proto_data(wmem_file_scope(), &pinfo, 100, 1, GUINT_TO_POINTER(2));
+        p_add_proto_data(wmem_file_scope(), &pinfo, 100, 1, GUINT_TO_POINTER(3));
+        g_assert_cmpuint(p_get_proto_data_count(wmem_file_scope(), &pinfo), ==, others + 3);
+        g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, 1) == GUINT_TO_POINTER(3));
+
+        /* Removing the newest brings back the one it hid. */
+        p_remove_proto_data(wmem_file_scope(), &pinfo, 100, 1);
+        g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, 1) == GUINT_TO_POINTER(2));
+        p_add_proto_data(wmem_file_scope(), &pinfo, 100, 2, GUINT_TO_POINTER(4));
+        p_remove_proto_data(wmem_file_scope(), &pinfo, 100, 1);
+        g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, 1) == GUINT_TO_POINTER(1));
+        p_remove_proto_data(wmem_file_scope(), &pinfo, 100, 1);
+        g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, 1) == NULL);
+
+        g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 100, 2) == GUINT_TO_POINTER(4));
+        for (i = 0; i < others; i++)
+            g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, 200, i) == ITEM_DATA(200, i));
+        g_assert_cmpuint(p_get_proto_data_count(wmem_file_scope(), &pinfo), ==, others + 1);
+    }
+    reset_frame();
+}
+
+/*
+ * The list p_add_proto_data() and friends used to keep, as a reference:
+ * items are pushed on the front and lookups return the first match.
+ */
+typedef struct {
+    int      proto;
+    guint32  key;
+    void    *proto_data;
+} list_item_t;
+
+static GSList *
+list_add(GSList *list, int proto, guint32 key, void *proto_data)
+{
+    list_item_t *item = g_new(list_item_t, 1);
+
+    item->proto = proto;
+    item->key = key;
+    item->proto_data = proto_data;
+    return g_slist_prepend(list, item);
+}
+
+static gint
+list_compare(gconstpointer a, gconstpointer b)
+{
+    const list_item_t *ap = (const list_item_t *)a;
+    const list_item_t *bp = (const list_item_t *)b;
+
+    if (ap->proto != bp->proto)
+        return ap->proto > bp->proto ? 1 : -1;
+    if (ap->key != bp->key)
+        return ap->key > bp->key ? 1 : -1;
+    return 0;
+}
+
+static GSList *
+list_find(GSList *list, int proto, guint32 key)
+{
+    list_item_t temp;
+
+    temp.proto = proto;
+    temp.key = key;
+    temp.proto_data = NULL;
+    return g_slist_find_custom(list, &temp, list_compare);
+}
+
+static void
+proto_data_test_random(void)
+{
+#define RANDOM_PROTOS   5
+#define RANDOM_KEYS     8
+#define RANDOM_OPS      100000
+    GSList *model = NULL;
+    GSList *found;
+    guint32 state = 1;
+    guint   i, count = 0;
+
+    reset_frame();
+    for (i = 0; i < RANDOM_OPS; i++) {
+        int     proto;
+        guint32 key, op;
+
+        state = state * 1103515245 + 12345;
+        op = (state >> 8) % 8;
+        proto = 100 + (int)((state >> 12) % RANDOM_PROTOS);
+        key = (state >> 20) % RANDOM_KEYS;
+
+        /* Adds a bit more often than removes, so the table fills up. */
+        if (op < 3) {
+            model = list_add(model, proto, key, GUINT_TO_POINTER(i + 1));
+            p_add_proto_data(wmem_file_scope(), &pinfo, proto, key, GUINT_TO_POINTER(i + 1));
+            count++;
+        } else if (op < 5) {
+            found = list_find(model, proto, key);
+            if (found) {
+                g_free(found->data);
+                model = g_slist_delete_link(model, found);
+                count--;
+            }
+            p_remove_proto_data(wmem_file_scope(), &pinfo, proto, key);
+        } else {
+            found = list_find(model, proto, key);
+            g_assert(p_get_proto_data(wmem_file_scope(), &pinfo, proto, key) ==
+                     (found ? ((list_item_t *)found->data)->proto_data : NULL));
+        }
+        g_assert_cmpuint(p_get_proto_data_count(wmem_file_scope(), &pinfo), ==, count);
+    }
+    g_slist_free_full(model, g_free);
+    reset_frame();
+}
+
+#define RESOURCE_USAGE_START get_resource_usage(&start_utime, &start_stime)
+
+#define RESOURCE_USAGE_END \
+    get_resource_usage(&end_utime, &end_stime); \
+    utime_ms = (end_utime - start_utime) * 1000.0; \
+    stime_ms = (end_stime - start_stime) * 1000.0
+
+/*
+ * What a retap or a filter rescan does to the proto data: every frame's
+ * items were added on the first pass, and on each later pass every
+ * dissector looks its own up a couple of times. Compare with the list.
+ *
+ * NOTE: You have to run "proto_data_test --verbose" to see results.
+ */
+static void
+proto_data_test_revisitperf(void)
+{
+#define PERF_FRAMES     100000
+#define PERF_PASSES     5
+#define PERF_LOOKUPS    2
+    static const guint items_per_frame[] = { 2, 6, 12 };
+    frame_data *frames = g_new0(frame_data, PERF_FRAMES);
+    GSList    **lists = g_new0(GSList *, PERF_FRAMES);
+    guint       n, f, pass, i, j;
+    void       *sink = NULL;
+    double      start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    for (n = 0; n < G_N_ELEMENTS(items_per_frame); n++) {
+        guint items = items_per_frame[n];
+
+        for (f = 0; f < PERF_FRAMES; f++) {
+            pinfo.fd = &frames[f];
+            for (i = 0; i < items; i++) {
+                p_add_proto_data(wmem_file_scope(), &pinfo, 100 + i, 0, ITEM_DATA(100 + i, 0));
+                lists[f] = list_add(lists[f], 100 + i, 0, ITEM_DATA(100 + i, 0));
+            }
+        }
+
+        RESOURCE_USAGE_START;
+        for (pass = 0; pass < PERF_PASSES; pass++) {
+            for (f = 0; f < PERF_FRAMES; f++) {
+                pinfo.fd = &frames[f];
+                for (i = 0; i < items; i++) {
+                    for (j = 0; j < PERF_LOOKUPS; j++)
+                        sink = p_get_proto_data(wmem_file_scope(), &pinfo, 100 + i, 0);
+                }
+            }
+        }
+        RESOURCE_USAGE_END;
+        g_assert(sink == ITEM_DATA(100 + items - 1, 0));
+        g_test_minimized_result(utime_ms + stime_ms,
+            "table, %u items per frame, %u passes: u %.3f ms s %.3f ms", items, PERF_PASSES, utime_ms, stime_ms);
+
+        RESOURCE_USAGE_START;
+        for (pass = 0; pass < PERF_PASSES; pass++) {
+            for (f = 0; f < PERF_FRAMES; f++) {
+                for (i = 0; i < items; i++) {
+                    for (j = 0; j < PERF_LOOKUPS; j++)
+                        sink = ((list_item_t *)list_find(lists[f], 100 + i, 0)->data)->proto_data;
+                }
+            }
+        }
+        RESOURCE_USAGE_END;
+        g_assert(sink == ITEM_DATA(100 + items - 1, 0));
+        g_test_minimized_result(utime_ms + stime_ms,
+            "list,  %u items per frame, %u passes: u %.3f ms s %.3f ms", items, PERF_PASSES, utime_ms, stime_ms);
+
+        for (f = 0; f < PERF_FRAMES; f++) {
+            p_free_proto_data_table(frames[f].pfd);
+            frames[f].pfd = NULL;
+            g_slist_free_full(lists[f], g_free);
+            lists[f] = NULL;
+        }
+    }
+
+    g_free(lists);
+    g_free(frames);
+    reset_frame();
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    wmem_init();
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/proto_data/add_get",     proto_data_test_add_get);
+    g_test_add_func("/proto_data/remove",      proto_data_test_remove);
+    g_test_add_func("/proto_data/hide",        proto_data_test_hide);
+    g_test_add_func("/proto_data/random",      proto_data_test_random);
+    if (!g_test_perf ()) {
+        g_test_add_func("/proto_data/revisitperf", proto_data_test_revisitperf);
+    }
+
+    ret = g_test_run();
+
+    wmem_cleanup();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
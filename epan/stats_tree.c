@@ -25,6 +25,9 @@
 
 #include <epan/stats_tree_priv.h>
 #include <epan/prefs.h>
+#include <epan/address.h>
+#include <epan/to_str.h>
+#include <epan/value_string.h>
 #include <math.h>
 #include <string.h>
 
@@ -106,6 +109,7 @@ free_stat_node(stat_node *node)
     }
 
     if (node->hash) g_hash_table_destroy(node->hash);
+    if (node->key_hash) g_hash_table_destroy(node->key_hash);
 
     while (node->bh) {
         bucket = node->bh;
@@ -114,6 +118,7 @@ free_stat_node(stat_node *node)
     }
 
     g_free(node->rng);
+    g_free(node->key);
     g_free(node->name);
     g_free(node);
 }
@@ -131,6 +136,7 @@ stats_tree_free(stats_tree *st)
     g_hash_table_destroy(st->names);
     g_ptr_array_free(st->parents,TRUE);
     g_free(st->display_name);
+    if (st->root.key_hash) g_hash_table_destroy(st->root.key_hash);
 
     for (child = st->root.children; child; child = next ) {
         /* child->next will be gone after free_stat_node, so cache it here */
@@ -215,6 +221,11 @@ stats_tree_reinit(void *p)
     }
 
     st->root.children = NULL;
+    st->root.last_child = NULL;
+    if (st->root.key_hash) {
+        g_hash_table_destroy(st->root.key_hash);
+        st->root.key_hash = NULL;
+    }
     st->root.counter = 0;
     switch (st->root.datatype)
     {
@@ -463,7 +474,6 @@ new_stat_node(stats_tree *st, const gchar *name, int parent_id, stat_node_dataty
 {
 
     stat_node *node = (stat_node *)g_malloc0(sizeof(stat_node));
-    stat_node *last_chld = NULL;
 
     node->datatype = datatype;
     switch (datatype)
@@ -508,17 +518,12 @@ new_stat_node(stats_tree *st, const gchar *name, int parent_id, stat_node_dataty
 
     if (node->parent->children) {
         /* insert as last child */
-
-        for (last_chld = node->parent->children;
-             last_chld->next;
-             last_chld = last_chld->next ) ;
-
-        last_chld->next = node;
-
+        node->parent->last_child->next = node;
     } else {
         /* insert as first child */
         node->parent->children = node;
     }
+    node->parent->last_child = node;
 
     if(node->parent->hash) {
         g_hash_table_insert(node->parent->hash,node->name,node);
@@ -640,32 +645,10 @@ update_burst_calc(stat_node *node, gint value)
     }
 }
 
-/*
- * Increases by delta the counter of the node whose name is given
- * if the node does not exist yet it's created (with counter=1)
- * using parent_name as parent node.
- * with_hash=TRUE to indicate that the created node will have a parent
- */
-int
-stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name,
-              int parent_id, gboolean with_hash, gint value)
+/* Does what stats_tree_manip_node_int() does to a node it's found */
+static void
+manip_stat_node_int(manip_node_mode mode, stat_node *node, gint value)
 {
-    stat_node *node = NULL;
-    stat_node *parent = NULL;
-
-    g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
-
-    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
-
-    if( parent->hash ) {
-        node = (stat_node *)g_hash_table_lookup(parent->hash,name);
-    } else {
-        node = (stat_node *)g_hash_table_lookup(st->names,name);
-    }
-
-    if ( node == NULL )
-        node = new_stat_node(st,name,parent_id,STAT_DT_INT,with_hash,with_hash);
-
     switch (mode) {
         case MN_INCREASE:
             node->counter += value;
@@ -695,6 +678,35 @@ stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name
             node->st_flags &= ~value;
             break;
     }
+}
+
+/*
+ * Increases by delta the counter of the node whose name is given
+ * if the node does not exist yet it's created (with counter=1)
+ * using parent_name as parent node.
+ * with_hash=TRUE to indicate that the created node will have a parent
+ */
+int
+stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name,
+              int parent_id, gboolean with_hash, gint value)
+{
+    stat_node *node = NULL;
+    stat_node *parent = NULL;
+
+    g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
+
+    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
+
+    if( parent->hash ) {
+        node = (stat_node *)g_hash_table_lookup(parent->hash,name);
+    } else {
+        node = (stat_node *)g_hash_table_lookup(st->names,name);
+    }
+
+    if ( node == NULL )
+        node = new_stat_node(st,name,parent_id,STAT_DT_INT,with_hash,with_hash);
+
+    manip_stat_node_int(mode, node, value);
 
     if (node)
         return node->id;
@@ -756,6 +768,177 @@ stats_tree_manip_node_float(manip_node_mode mode, stats_tree *st, const char *na
         return -1;
 }
 
+/* Hashes a node's key, for its parent's key_hash (FNV-1a) */
+static guint
+stat_node_key_hash(gconstpointer k)
+{
+    const stat_node *node = (const stat_node *)k;
+    guint32 hash = 2166136261U;
+    guint i;
+
+    for (i = 0; i < node->key_len; i++) {
+        hash ^= node->key[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static gboolean
+stat_node_key_equal(gconstpointer a, gconstpointer b)
+{
+    const stat_node *node_a = (const stat_node *)a;
+    const stat_node *node_b = (const stat_node *)b;
+
+    return node_a->key_len == node_b->key_len &&
+           memcmp(node_a->key, node_b->key, node_a->key_len) == 0;
+}
+
+/*
+ * Finds the child of a parent that has a key, creating it, named by
+ * name_cb, if there isn't one yet. A node found by key is always put in
+ * st->parents, so that its id can be used to get straight to it again.
+ */
+static stat_node *
+stat_node_by_key(stats_tree *st, int parent_id, const void *key, guint key_len,
+                 stat_node_name_cb name_cb, const void *name_data,
+                 stat_node_datatype datatype, gboolean with_children)
+{
+    stat_node *parent;
+    stat_node *node;
+    stat_node probe;
+    gchar *name;
+
+    g_assert(parent_id >= 0 && parent_id < (int) st->parents->len);
+
+    parent = (stat_node *)g_ptr_array_index(st->parents, parent_id);
+
+    probe.key = (guint8 *)key;
+    probe.key_len = key_len;
+    if (parent->key_hash) {
+        node = (stat_node *)g_hash_table_lookup(parent->key_hash, &probe);
+        if (node)
+            return node;
+    } else {
+        parent->key_hash = g_hash_table_new(stat_node_key_hash, stat_node_key_equal);
+    }
+
+    /* The name is only made once, not for every packet. */
+    name = name_cb(key, key_len, name_data);
+    node = new_stat_node(st, name, parent_id, datatype, with_children, FALSE);
+    g_free(name);
+
+    node->key = (guint8 *)g_memdup(key, key_len);
+    node->key_len = key_len;
+    g_hash_table_insert(parent->key_hash, node, node);
+
+    g_ptr_array_add(st->parents, node);
+    node->id = st->parents->len - 1;
+
+    return node;
+}
+
+int
+stats_tree_manip_node_by_key(manip_node_mode mode, stats_tree *st, int parent_id,
+                             const void *key, guint key_len,
+                             stat_node_name_cb name_cb, const void *name_data,
+                             gboolean with_children, gint value)
+{
+    stat_node *node = stat_node_by_key(st, parent_id, key, key_len, name_cb, name_data,
+                                       STAT_DT_INT, with_children);
+
+    manip_stat_node_int(mode, node, value);
+    return node->id;
+}
+
+int
+stats_tree_manip_node_by_id(manip_node_mode mode, stats_tree *st, int node_id, gint value)
+{
+    stat_node *node;
+
+    g_assert(node_id >= 0 && node_id < (int) st->parents->len);
+
+    node = (stat_node *)g_ptr_array_index(st->parents, node_id);
+    manip_stat_node_int(mode, node, value);
+    return node_id;
+}
+
+/* What a node with an unsigned integer key is named from */
+typedef struct {
+    const value_string *vs;
+    const char *unknown_fmt;
+} uint_node_name_t;
+
+static gchar *
+uint_node_name(const void *key, guint key_len _U_, const void *name_data)
+{
+    const uint_node_name_t *uint_name = (const uint_node_name_t *)name_data;
+    guint32 value;
+
+    memcpy(&value, key, sizeof value);
+    if (uint_name->vs == NULL)
+        return g_strdup_printf("%u", value);
+    return val_to_str_wmem(NULL, value, uint_name->vs, uint_name->unknown_fmt);
+}
+
+int
+stats_tree_tick_node_uint(stats_tree *st, int parent_id, guint32 value,
+                          const value_string *vs, const char *unknown_fmt,
+                          gboolean with_children)
+{
+    uint_node_name_t uint_name;
+
+    uint_name.vs = vs;
+    uint_name.unknown_fmt = unknown_fmt;
+    return stats_tree_manip_node_by_key(MN_INCREASE, st, parent_id, &value, sizeof value,
+                                        uint_node_name, &uint_name, with_children, 1);
+}
+
+static gchar *
+address_node_name(const void *key, guint key_len, const void *name_data _U_)
+{
+    address addr;
+    int type;
+
+    /* The key is the address type followed by its data. */
+    memcpy(&type, key, sizeof type);
+    set_address(&addr, type, key_len - (int)sizeof type, (const guint8 *)key + sizeof type);
+    return address_to_str(NULL, &addr);
+}
+
+int
+stats_tree_tick_node_address(stats_tree *st, int parent_id, const address *addr,
+                             gboolean with_children)
+{
+    guint8 buf[64];
+    guint8 *key = buf;
+    guint key_len = (guint)sizeof addr->type + addr->len;
+    int type = addr->type;
+    int id;
+
+    if (key_len > sizeof buf)
+        key = (guint8 *)g_malloc(key_len);
+    memcpy(key, &type, sizeof type);
+    if (addr->len > 0)
+        memcpy(key + sizeof type, addr->data, addr->len);
+
+    id = stats_tree_manip_node_by_key(MN_INCREASE, st, parent_id, key, key_len,
+                                      address_node_name, NULL, with_children, 1);
+
+    if (key != buf)
+        g_free(key);
+    return id;
+}
+
+extern int
+stats_tree_tick_pivot_uint(stats_tree *st, int pivot_id, guint32 pivot_value,
+                           const value_string *vs, const char *unknown_fmt)
+{
+    tick_stat_node_by_id(st, pivot_id);
+    stats_tree_tick_node_uint(st, pivot_id, pivot_value, vs, unknown_fmt, FALSE);
+
+    return pivot_id;
+}
+
 extern char*
 stats_tree_get_abbr(const char *opt_arg)
 {
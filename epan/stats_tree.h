@@ -16,6 +16,7 @@
 #include <epan/packet_info.h>
 #include <epan/tap.h>
 #include <epan/stat_groups.h>
+#include <epan/value_string.h>
 #include "ws_symbol_export.h"
 
 #ifdef __cplusplus
@@ -245,6 +246,61 @@ WS_DLL_PUBLIC int stats_tree_manip_node_float(manip_node_mode mode,
 #define stat_node_clear_flags(st,name,parent_id,with_children,flags)    \
     (stats_tree_manip_node_int(MN_CLEAR_FLAGS,(st),(name),(parent_id),(with_children),flags))
 
+/*
+ * Nodes looked up by key rather than by name.
+ *
+ * A node can be looked up by a key of any bytes, such as an address, a port
+ * or a status code, instead of by a name that has to be formatted for every
+ * packet. Its name is made by name_cb only when the node is created, and the
+ * returned id always refers to it, so it can be updated again by id without
+ * any lookup. A parent's children should all be looked up by key or all by
+ * name; a node looked up one way isn't found the other way.
+ */
+
+/* returns the name of a node with the given key, allocated with g_malloc() */
+typedef gchar *(*stat_node_name_cb)(const void *key, guint key_len, const void *name_data);
+
+WS_DLL_PUBLIC int stats_tree_manip_node_by_key(manip_node_mode mode,
+                                               stats_tree *st,
+                                               int parent_id,
+                                               const void *key,
+                                               guint key_len,
+                                               stat_node_name_cb name_cb,
+                                               const void *name_data,
+                                               gboolean with_children,
+                                               gint value);
+
+/* manipulates the value of a node by the id returned when it was created or looked up */
+WS_DLL_PUBLIC int stats_tree_manip_node_by_id(manip_node_mode mode,
+                                              stats_tree *st,
+                                              int node_id,
+                                              gint value);
+
+#define tick_stat_node_by_id(st,node_id)                                \
+    (stats_tree_manip_node_by_id(MN_INCREASE,(st),(node_id),1))
+
+/* ticks the node for an unsigned integer, named with val_to_str(value, vs,
+ * unknown_fmt), or just its value if vs is NULL */
+WS_DLL_PUBLIC int stats_tree_tick_node_uint(stats_tree *st,
+                                            int parent_id,
+                                            guint32 value,
+                                            const value_string *vs,
+                                            const char *unknown_fmt,
+                                            gboolean with_children);
+
+/* ticks the node for an address, named with address_to_str() */
+WS_DLL_PUBLIC int stats_tree_tick_node_address(stats_tree *st,
+                                               int parent_id,
+                                               const address *addr,
+                                               gboolean with_children);
+
+/* stats_tree_tick_pivot() for an unsigned integer, named as stats_tree_tick_node_uint() names it */
+WS_DLL_PUBLIC int stats_tree_tick_pivot_uint(stats_tree *st,
+                                             int pivot_id,
+                                             guint32 pivot_value,
+                                             const value_string *vs,
+                                             const char *unknown_fmt);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -84,12 +84,20 @@ struct _stat_node {
 	/** children nodes by name */
 	GHashTable		*hash;
 
+	/** children nodes by key, for those looked up by key */
+	GHashTable		*key_hash;
+
+	/** the key this node is looked up by, if it is */
+	guint8			*key;
+	guint			key_len;
+
 	/** the owner of this node */
 	stats_tree		*st;
 
 	/** relatives */
 	stat_node		*parent;
 	stat_node		*children;
+	stat_node		*last_child;
 	stat_node		*next;
 
 	/** used to check if value is within range */
@@ -84,6 +84,9 @@ typedef struct _tap_listener_t {
 	guint flags;
 	gchar *fstring;
 	dfilter_t *code;
+	struct _tap_listener_t *same_filter;	/* a listener with the same filter, whose result we use */
+	int filter_state;	/* TAP_FILTER_xxx, for the packet being pushed */
+	GArray *hfids;		/* fields the packet routine looks at */
 	void *tapdata;
 	tap_reset_cb reset;
 	tap_packet_cb packet;
@@ -91,8 +94,22 @@ typedef struct _tap_listener_t {
 	tap_finish_cb finish;
 } tap_listener_t;
 
+#define TAP_FILTER_UNKNOWN	0	/* not applied to this packet yet */
+#define TAP_FILTER_PASSED	1
+#define TAP_FILTER_FAILED	2
+
 static tap_listener_t *tap_listener_queue=NULL;
 
+/* if set, the only listener that tapped packets are pushed to, and the
+   only one that is reset, drawn and asked for its filter and flags */
+static void *tap_listener_only=NULL;
+
+static inline gboolean
+tap_listener_selected(const tap_listener_t *tl)
+{
+	return !tap_listener_only || tl->tapdata==tap_listener_only;
+}
+
 #ifdef HAVE_PLUGINS
 static GSList *tap_plugins = NULL;
 
@@ -253,9 +270,15 @@ void tap_build_interesting (epan_dissect_t *edt)
 	/* loop over all tap listeners and build the list of all
 	   interesting hf_fields */
 	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(!tap_listener_selected(tl)){
+			continue;
+		}
 		if(tl->code){
 			epan_dissect_prime_with_dfilter(edt, tl->code);
 		}
+		if(tl->hfids){
+			epan_dissect_prime_with_hfid_array(edt, tl->hfids);
+		}
 	}
 }
 
@@ -278,6 +301,20 @@ tap_queue_init(epan_dissect_t *edt)
 	tap_build_interesting (edt);
 }
 
+/* Apply a listener's filter, or get the result we got for it, or for a
+   listener with the same filter, earlier in this packet. */
+static gboolean
+tap_listener_filter_passes(tap_listener_t *tl, epan_dissect_t *edt)
+{
+	tap_listener_t *owner=tl->same_filter ? tl->same_filter : tl;
+
+	if(owner->filter_state==TAP_FILTER_UNKNOWN){
+		owner->filter_state=dfilter_apply_edt(owner->code, edt) ?
+		    TAP_FILTER_PASSED : TAP_FILTER_FAILED;
+	}
+	return owner->filter_state==TAP_FILTER_PASSED;
+}
+
 /* this function is called after a packet has been fully dissected to push the tapped
    data to all extensions that has callbacks registered.
 */
@@ -300,61 +337,71 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 		return;
 	}
 
+	/* A filter is applied at most once per packet, however many times
+	   its tap is queued and however many listeners have the same one. */
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		tl->filter_state=TAP_FILTER_UNKNOWN;
+	}
+
 	/* loop over all tap listeners and call the listener callback
 	   for all packets that match the filter. */
 	for(i=0;i<tap_packet_index;i++){
+		tp=&tap_packet_array[i];
 		for(tl=tap_listener_queue;tl;tl=tl->next){
-			tp=&tap_packet_array[i];
+			if(tp->tap_id!=tl->tap_id){
+				continue;
+			}
+			if(!tap_listener_selected(tl)){
+				continue;
+			}
 			/* Don't tap the packet if it's an "error packet"
 			 * unless the listener has requested that we do so.
 			 */
 			if (!(tp->flags & TAP_PACKET_IS_ERROR_PACKET) || (tl->flags & TL_REQUIRES_ERROR_PACKETS))
 			{
-				if(tp->tap_id==tl->tap_id){
-					if(!tl->packet){
-						/* There isn't a per-packet
-						 * routine for this tap.
-						 */
-						continue;
-					}
-					if(tl->failed){
-						/* A previous call failed,
-						 * meaning "stop running this
-						 * tap", so don't call the
-						 * packet routine.
-						 */
-						continue;
-					}
-
-					/* If we have a filter, see if the
-					 * packet passes.
+				if(!tl->packet){
+					/* There isn't a per-packet
+					 * routine for this tap.
+					 */
+					continue;
+				}
+				if(tl->failed){
+					/* A previous call failed,
+					 * meaning "stop running this
+					 * tap", so don't call the
+					 * packet routine.
 					 */
-					if(tl->code){
-						if (!dfilter_apply_edt(tl->code, edt)){
-							/* The packet didn't
-							 * pass the filter. */
-							continue;
-						}
+					continue;
+				}
+
+				/* If we have a filter, see if the
+				 * packet passes.
+				 */
+				if(tl->code){
+					if (!tap_listener_filter_passes(tl, edt)){
+						/* The packet didn't
+						 * pass the filter. */
+						continue;
 					}
+				}
 
-					/* So call the per-packet routine. */
-					tap_packet_status status;
+				/* So call the per-packet routine. */
+				tap_packet_status status;
 
-					status = tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
+				status = tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
 
-					switch (status) {
+				switch (status) {
 
-					case TAP_PACKET_DONT_REDRAW:
-						break;
+				case TAP_PACKET_DONT_REDRAW:
+					break;
 
-					case TAP_PACKET_REDRAW:
-						tl->needs_redraw=TRUE;
-						break;
+				case TAP_PACKET_REDRAW:
+					tl->needs_redraw=TRUE;
+					break;
 
-					case TAP_PACKET_FAILED:
-						tl->failed=TRUE;
-						break;
-					}
+				case TAP_PACKET_FAILED:
+					tl->failed=TRUE;
+					break;
 				}
 			}
 		}
@@ -414,6 +461,9 @@ reset_tap_listeners(void)
 	tap_listener_t *tl;
 
 	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(!tap_listener_selected(tl)){
+			continue;
+		}
 		if(tl->reset){
 			tl->reset(tl->tapdata);
 		}
@@ -437,6 +487,9 @@ draw_tap_listeners(gboolean draw_all)
 	tap_listener_t *tl;
 
 	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(!tap_listener_selected(tl)){
+			continue;
+		}
 		if(tl->needs_redraw || draw_all){
 			if(tl->draw){
 				tl->draw(tl->tapdata);
@@ -500,9 +553,36 @@ free_tap_listener(tap_listener_t *tl)
 	}
 	dfilter_free(tl->code);
 	g_free(tl->fstring);
+	if (tl->hfids) {
+		g_array_free(tl->hfids, TRUE);
+	}
 	g_free(tl);
 }
 
+/* Point each listener with a filter at the first listener with the same
+   filter string, if that isn't itself, so that tap_push_tapped_queue()
+   applies the filter once for all of them. Call whenever a listener or
+   a filter is added, changed or removed.
+ */
+static void
+tap_listeners_share_filters(void)
+{
+	tap_listener_t *tl, *tl2;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		tl->same_filter=NULL;
+		if(!tl->code){
+			continue;
+		}
+		for(tl2=tap_listener_queue;tl2!=tl;tl2=tl2->next){
+			if(tl2->code && strcmp(tl2->fstring, tl->fstring)==0){
+				tl->same_filter=tl2;
+				break;
+			}
+		}
+	}
+}
+
 /* this function attaches the tap_listener to the named tap.
  * function returns :
  *     NULL: ok.
@@ -554,6 +634,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	tl->next=tap_listener_queue;
 
 	tap_listener_queue=tl;
+	tap_listeners_share_filters();
 
 	return NULL;
 }
@@ -594,6 +675,7 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 		if(fstring){
 			if(!dfilter_compile(fstring, &code, &err_msg)){
 				tl->fstring=NULL;
+				tap_listeners_share_filters();
 				error_string = g_string_new("");
 				g_string_printf(error_string,
 						 "Filter \"%s\" is invalid - %s",
@@ -604,6 +686,7 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 		}
 		tl->fstring=g_strdup(fstring);
 		tl->code=code;
+		tap_listeners_share_filters();
 	}
 
 	return NULL;
@@ -636,6 +719,7 @@ tap_listeners_dfilter_recompile(void)
 		}
 		tl->code=code;
 	}
+	tap_listeners_share_filters();
 }
 
 /* this function removes a tap listener
@@ -667,6 +751,43 @@ remove_tap_listener(void *tapdata)
 		}
 	}
 	free_tap_listener(tl);
+	tap_listeners_share_filters();
+}
+
+/* this function makes sure the protocol tree has a field that the tap
+   listener with tapdata looks at in its packet routine
+ */
+void
+add_tap_listener_hfid(void *tapdata, int hfid)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->tapdata==tapdata){
+			if(!tl->hfids){
+				tl->hfids=g_array_new(FALSE, FALSE, sizeof(int));
+			}
+			g_array_append_val(tl->hfids, hfid);
+			return;
+		}
+	}
+	g_warning("add_tap_listener_hfid(): no listener found with that tap data");
+}
+
+/* this function makes tapped packets go only to one tap listener, e.g.
+   while a single packet is redissected to get back what it tapped or
+   while a statistics dialog retaps the file for itself, or to all of
+   them again if tapdata is NULL. The other listeners aren't reset or
+   drawn, and their filters and flags don't add to the dissection.
+   Returns the previous setting, for the caller to put back.
+ */
+void *
+set_tap_listener_only(void *tapdata)
+{
+	void *prev=tap_listener_only;
+
+	tap_listener_only=tapdata;
+	return prev;
 }
 
 /*
@@ -706,7 +827,8 @@ have_tap_listener(int tap_id)
 }
 
 /*
- * Return TRUE if we have any tap listeners with filters, FALSE otherwise.
+ * Return TRUE if we have any tap listeners with filters, or with fields
+ * they look at, FALSE otherwise.
  */
 gboolean
 have_filtering_tap_listeners(void)
@@ -714,12 +836,39 @@ have_filtering_tap_listeners(void)
 	tap_listener_t *tl;
 
 	for(tl=tap_listener_queue;tl;tl=tl->next){
-		if(tl->code)
+		if((tl->code || tl->hfids) && tap_listener_selected(tl))
 			return TRUE;
 	}
 	return FALSE;
 }
 
+/*
+ * Return the filters of all the tap listeners, or NULL if there aren't
+ * any listeners or any of them hasn't got a filter.
+ */
+GPtrArray *
+get_tap_listener_dfilters(void)
+{
+	tap_listener_t *tl;
+	GPtrArray *codes;
+
+	if(!tap_listener_queue)
+		return NULL;
+
+	codes=g_ptr_array_new();
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(!tap_listener_selected(tl)){
+			continue;
+		}
+		if(!tl->code){
+			g_ptr_array_free(codes, TRUE);
+			return NULL;
+		}
+		g_ptr_array_add(codes, tl->code);
+	}
+	return codes;
+}
+
 /*
  * Get the union of all the flags for all the tap listeners; that gives
  * an indication of whether the protocol tree, or the columns, are
@@ -732,7 +881,8 @@ union_of_tap_listener_flags(void)
 	guint flags = 0;
 
 	for(tl=tap_listener_queue;tl;tl=tl->next){
-		flags|=tl->flags;
+		if(tap_listener_selected(tl))
+			flags|=tl->flags;
 	}
 	return flags;
 }
@@ -183,6 +183,9 @@ WS_DLL_PUBLIC void draw_tap_listeners(gboolean draw_all);
  *                   		2) the tap-specific data passed to it is constructed only if
  *                   		   the protocol tree is being built.
  *
+ *                   	If it only looks up a few fields in edt->tree, use
+ *                   	add_tap_listener_hfid() for them instead.
+ *
  *                      TL_REQUIRES_COLUMNS
  *
  *                   	set if your tap listener "packet" routine requires the column
@@ -232,6 +235,23 @@ WS_DLL_PUBLIC void tap_listeners_dfilter_recompile(void);
 /** this function removes a tap listener */
 WS_DLL_PUBLIC void remove_tap_listener(void *tapdata);
 
+/** This function makes sure that the protocol tree has the field hfid in
+ * it whenever the tap listener with tapdata is called, e.g. because its
+ * packet routine looks the field up with proto_get_finfo_ptr_array().
+ * A listener that only looks at a few fields should do this rather than
+ * set TL_REQUIRES_PROTO_TREE; a tree is then built only with the fields
+ * something wants, as it is for filters. */
+WS_DLL_PUBLIC void add_tap_listener_hfid(void *tapdata, int hfid);
+
+/** This function makes tapped packets go only to the tap listener with
+ * tapdata, or to all tap listeners again if tapdata is NULL. While it's
+ * set, only that listener is reset and drawn, and only its filter and
+ * flags count in have_filtering_tap_listeners(),
+ * get_tap_listener_dfilters() and union_of_tap_listener_flags().
+ * Returns the previous setting, which the caller should restore when
+ * it's done, so that a restriction made by an outer caller survives. */
+WS_DLL_PUBLIC void *set_tap_listener_only(void *tapdata);
+
 /**
  * Return TRUE if we have one or more tap listeners that require dissection,
  * FALSE otherwise.
@@ -244,6 +264,14 @@ WS_DLL_PUBLIC gboolean have_tap_listener(int tap_id);
 /** Return TRUE if we have any tap listeners with filters, FALSE otherwise. */
 WS_DLL_PUBLIC gboolean have_filtering_tap_listeners(void);
 
+/**
+ * Get the filters of all the tap listeners, so a caller can work out
+ * which packets any of them can want; the array must be freed with
+ * g_ptr_array_free(), the filters belong to the listeners. Returns NULL
+ * if there aren't any listeners or any of them hasn't got a filter.
+ */
+WS_DLL_PUBLIC GPtrArray *get_tap_listener_dfilters(void);
+
 /**
  * Get the union of all the flags for all the tap listeners; that gives
  * an indication of whether the protocol tree, or the columns, are
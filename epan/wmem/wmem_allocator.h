@@ -15,6 +15,8 @@
 #include <glib.h>
 #include <string.h>
 
+#include "wmem_core.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -41,8 +43,20 @@ struct _wmem_allocator_t {
     void                        *private_data;
     enum _wmem_allocator_type_t  type;
     gboolean                     in_scope;
+
+    /* Statistics, see wmem_get_allocator_stats() */
+    wmem_allocator_stats_t       stats;
 };
 
+/* The big blocks that the block allocators serve allocations out of. A
+ * block an allocator is done with is kept for the next allocator, in
+ * whatever thread, that wants one of the same size. */
+void *
+wmem_block_cache_get(const size_t size);
+
+void
+wmem_block_cache_put(void *block, const size_t size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -762,7 +762,7 @@ wmem_block_new_block(wmem_block_allocator_t *allocator)
     wmem_block_hdr_t *block;
 
     /* allocate the new block and add it to the block list */
-    block = (wmem_block_hdr_t *)wmem_alloc(NULL, WMEM_BLOCK_SIZE);
+    block = (wmem_block_hdr_t *)wmem_block_cache_get(WMEM_BLOCK_SIZE);
     wmem_block_add_to_block_list(allocator, block);
 
     /* initialize it */
@@ -1048,7 +1048,8 @@ wmem_block_gc(void *private_data)
         if (!chunk->jumbo && !chunk->used && chunk->last) {
             /* If the first chunk is also the last, and is unused, then
              * the block as a whole is entirely unused, so return it to
-             * the OS and remove it from whatever lists it is in. */
+             * the block cache (or the OS) and remove it from whatever
+             * lists it is in. */
             free_chunk = WMEM_GET_FREE(chunk);
             if (free_chunk->next) {
                 WMEM_GET_FREE(free_chunk->next)->prev = free_chunk->prev;
@@ -1067,7 +1068,7 @@ wmem_block_gc(void *private_data)
             else if (allocator->master_head == chunk) {
                 allocator->master_head = free_chunk->next;
             }
-            wmem_free(NULL, cur);
+            wmem_block_cache_put(cur, WMEM_BLOCK_SIZE);
         }
         else {
             /* part of this block is used, so add it to the new block list */
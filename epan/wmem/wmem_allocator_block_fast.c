@@ -72,7 +72,7 @@ wmem_block_fast_new_block(wmem_block_fast_allocator_t *allocator)
     wmem_block_fast_hdr_t *block;
 
     /* allocate/initialize the new block and add it to the block list */
-    block = (wmem_block_fast_hdr_t *)wmem_alloc(NULL, WMEM_BLOCK_SIZE);
+    block = (wmem_block_fast_hdr_t *)wmem_block_cache_get(WMEM_BLOCK_SIZE);
 
     block->pos  = WMEM_BLOCK_HEADER_SIZE;
     block->next = allocator->block_list;
@@ -190,7 +190,7 @@ wmem_block_fast_free_all(void *private_data)
 
     while (cur) {
         nxt  = cur->next;
-        wmem_free(NULL, cur);
+        wmem_block_cache_put(cur, WMEM_BLOCK_SIZE);
         cur = nxt;
     }
 
@@ -217,7 +217,9 @@ wmem_block_fast_allocator_cleanup(void *private_data)
 
     /* wmem guarantees that free_all() is called directly before this, so
      * simply free the first block */
-    wmem_free(NULL, allocator->block_list);
+    if (allocator->block_list) {
+        wmem_block_cache_put(allocator->block_list, WMEM_BLOCK_SIZE);
+    }
 
     /* then just free the allocator structs */
     wmem_free(NULL, private_data);
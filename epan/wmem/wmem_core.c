@@ -28,6 +28,67 @@
 static gboolean do_override = FALSE;
 static wmem_allocator_type_t override_type;
 
+/* Running total of bytes requested from all pools. Never reset; consumers
+ * such as the dissector profiler take the difference between two readings.
+ * Pools may be used from several threads at once, so it is only ever
+ * accessed through the atomic helpers below. */
+static volatile guint64 total_allocated = 0;
+
+#if defined(__GNUC__)
+#define TOTAL_ALLOCATED_ADD(n) \
+    __atomic_fetch_add(&total_allocated, (guint64)(n), __ATOMIC_RELAXED)
+#define TOTAL_ALLOCATED_GET() \
+    __atomic_load_n(&total_allocated, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define TOTAL_ALLOCATED_ADD(n) \
+    _InterlockedExchangeAdd64((volatile __int64 *)&total_allocated, (__int64)(n))
+#define TOTAL_ALLOCATED_GET() \
+    ((guint64)_InterlockedCompareExchange64((volatile __int64 *)&total_allocated, 0, 0))
+#else
+static GMutex total_allocated_mutex;
+static void
+total_allocated_add(size_t n)
+{
+    g_mutex_lock(&total_allocated_mutex);
+    total_allocated += n;
+    g_mutex_unlock(&total_allocated_mutex);
+}
+
+static guint64
+total_allocated_get(void)
+{
+    guint64 total;
+
+    g_mutex_lock(&total_allocated_mutex);
+    total = total_allocated;
+    g_mutex_unlock(&total_allocated_mutex);
+    return total;
+}
+#define TOTAL_ALLOCATED_ADD(n) total_allocated_add(n)
+#define TOTAL_ALLOCATED_GET()  total_allocated_get()
+#endif
+
+/* Blocks kept for reuse, one of each size: one for the block allocator and
+ * one for the fast block allocator. That is enough for pools that are
+ * created and destroyed in turn, such as pinfo pools, or emptied and filled
+ * again, such as the packet scopes, without holding on to much. A slot is
+ * claimed, filled and emptied with a single compare-and-exchange, so no
+ * thread ever waits for another: one that finds the slot full frees its
+ * block, one that finds it empty allocates a new one. A slot holds a single
+ * block and no link to any other, so a thread whose exchange succeeds always
+ * gets a block that is free, even if it was taken and put back meanwhile. */
+#define WMEM_BLOCK_CACHE_SIZES  2
+
+typedef struct {
+    volatile gint   size;
+    void * volatile block;
+} wmem_block_cache_t;
+
+static wmem_block_cache_t block_cache[WMEM_BLOCK_CACHE_SIZES];
+
+static void wmem_block_cache_release(void);
+
 void *
 wmem_alloc(wmem_allocator_t *allocator, const size_t size)
 {
@@ -41,6 +102,10 @@ wmem_alloc(wmem_allocator_t *allocator, const size_t size)
         return NULL;
     }
 
+    TOTAL_ALLOCATED_ADD(size);
+    allocator->stats.allocs++;
+    allocator->stats.bytes += size;
+
     return allocator->walloc(allocator->private_data, size);
 }
 
@@ -72,6 +137,7 @@ wmem_free(wmem_allocator_t *allocator, void *ptr)
         return;
     }
 
+    allocator->stats.frees++;
     allocator->wfree(allocator->private_data, ptr);
 }
 
@@ -93,14 +159,31 @@ wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 
     g_assert(allocator->in_scope);
 
+    TOTAL_ALLOCATED_ADD(size);
+    allocator->stats.reallocs++;
+    allocator->stats.bytes += size;
+
     return allocator->wrealloc(allocator->private_data, ptr, size);
 }
 
+guint64
+wmem_get_total_allocated(void)
+{
+    return TOTAL_ALLOCATED_GET();
+}
+
+void
+wmem_get_allocator_stats(wmem_allocator_t *allocator, wmem_allocator_stats_t *stats)
+{
+    *stats = allocator->stats;
+}
+
 static void
 wmem_free_all_real(wmem_allocator_t *allocator, gboolean final)
 {
     wmem_call_callbacks(allocator,
             final ? WMEM_CB_DESTROY_EVENT : WMEM_CB_FREE_EVENT);
+    allocator->stats.free_alls++;
     allocator->free_all(allocator->private_data);
 }
 
@@ -114,6 +197,9 @@ void
 wmem_gc(wmem_allocator_t *allocator)
 {
     allocator->gc(allocator->private_data);
+
+    /* the blocks the pool gave back are to be returned to the OS too */
+    wmem_block_cache_release();
 }
 
 void
@@ -138,7 +224,7 @@ wmem_allocator_new(const wmem_allocator_type_t type)
         real_type = type;
     }
 
-    allocator = wmem_new(NULL, wmem_allocator_t);
+    allocator = wmem_new0(NULL, wmem_allocator_t);
     allocator->type      = real_type;
     allocator->callbacks = NULL;
     allocator->in_scope  = TRUE;
@@ -205,10 +291,69 @@ wmem_init(void)
     wmem_init_hashing();
 }
 
+void *
+wmem_block_cache_get(const size_t size)
+{
+    void *block;
+    guint i;
+
+    for (i = 0; i < WMEM_BLOCK_CACHE_SIZES; i++) {
+        if (g_atomic_int_get(&block_cache[i].size) == (gint)size) {
+            block = g_atomic_pointer_get(&block_cache[i].block);
+            if (block != NULL &&
+                    g_atomic_pointer_compare_and_exchange(&block_cache[i].block, block, NULL)) {
+                return block;
+            }
+            break;
+        }
+    }
+
+    return wmem_alloc(NULL, size);
+}
+
+void
+wmem_block_cache_put(void *block, const size_t size)
+{
+    guint i;
+
+    g_assert(size <= G_MAXINT);
+
+    for (i = 0; i < WMEM_BLOCK_CACHE_SIZES; i++) {
+        /* claim the first unused slot for this size, unless another
+         * thread has just claimed one */
+        g_atomic_int_compare_and_exchange(&block_cache[i].size, 0, (gint)size);
+        if (g_atomic_int_get(&block_cache[i].size) == (gint)size) {
+            if (g_atomic_pointer_compare_and_exchange(&block_cache[i].block, NULL, block)) {
+                return;
+            }
+            break;
+        }
+    }
+
+    /* the slot is full */
+    wmem_free(NULL, block);
+}
+
+static void
+wmem_block_cache_release(void)
+{
+    void *block;
+    guint i;
+
+    for (i = 0; i < WMEM_BLOCK_CACHE_SIZES; i++) {
+        do {
+            block = g_atomic_pointer_get(&block_cache[i].block);
+        } while (block != NULL &&
+                !g_atomic_pointer_compare_and_exchange(&block_cache[i].block, block, NULL));
+        wmem_free(NULL, block);
+    }
+}
+
 void
 wmem_cleanup(void)
 {
     wmem_cleanup_scopes();
+    wmem_block_cache_release();
 }
 
 /*
@@ -155,6 +155,41 @@ void *
 wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 G_GNUC_MALLOC;
 
+/** Returns the total number of bytes requested through wmem_alloc() and
+ * wmem_realloc() from any pool since the program started. The value only
+ * ever grows, so callers interested in a particular span of work should
+ * subtract two readings. Each wmem_realloc() counts its full new size, not
+ * just the growth, so a buffer that is enlarged repeatedly (a wmem_strbuf_t,
+ * say) is counted once per call; the total measures allocator traffic rather
+ * than memory held. The total is updated atomically and covers all threads;
+ * use wmem_get_allocator_stats() to look at a single pool.
+ *
+ * @return The running allocation total in bytes.
+ */
+WS_DLL_PUBLIC
+guint64
+wmem_get_total_allocated(void);
+
+/** What has been done with a pool since it was created. */
+typedef struct _wmem_allocator_stats_t {
+    guint64 allocs;     /**< Calls to wmem_alloc() and the functions using it */
+    guint64 reallocs;   /**< Calls to wmem_realloc() */
+    guint64 frees;      /**< Calls to wmem_free() */
+    guint64 free_alls;  /**< Calls to wmem_free_all() */
+    guint64 bytes;      /**< Bytes requested by allocs and reallocs */
+} wmem_allocator_stats_t;
+
+/** Gets the statistics of a pool, such as wmem_packet_scope() or
+ * wmem_file_scope(). Each pool keeps its own, so this can be used for a
+ * pool that belongs to another thread once that thread is done with it.
+ *
+ * @param allocator The allocator to get the statistics of.
+ * @param stats Filled in with the statistics.
+ */
+WS_DLL_PUBLIC
+void
+wmem_get_allocator_stats(wmem_allocator_t *allocator, wmem_allocator_stats_t *stats);
+
 /** Frees all the memory allocated in a pool. Depending on the allocator
  * implementation used this can be significantly cheaper than calling
  * wmem_free() on all the individual blocks. It also doesn't require you to have
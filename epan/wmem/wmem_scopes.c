@@ -35,39 +35,98 @@
  * perfect, but it should stop most of the bad behaviour that emem permitted.
  */
 
-/* TODO: Make these thread-local */
+/* The packet and file scopes are per thread. The thread that calls
+ * wmem_init_scopes() uses the pools below; any other thread gets pools of its
+ * own the first time it asks for a scope:
+ *
+ * - A packet scope, which it enters and leaves on its own and which is
+ *   destroyed when the thread exits.
+ * - An arena of the file scope. The file scope as a whole is entered and left
+ *   by the main thread, and leaving it empties every arena, so whatever a
+ *   thread allocates there lives exactly as long as what the main thread does.
+ *   The arena of a thread that exits is kept for the next thread that wants
+ *   one. The main thread must not enter or leave the file scope while another
+ *   thread is using it.
+ *
+ * The epan scope is shared by all threads, and is only to be allocated in by
+ * the main thread. Other threads must be done with their scopes before
+ * wmem_cleanup_scopes() is called.
+ */
 static wmem_allocator_t *packet_scope = NULL;
 static wmem_allocator_t *file_scope   = NULL;
 static wmem_allocator_t *epan_scope   = NULL;
 
+static void thread_packet_scope_free(gpointer scope);
+static void thread_file_arena_release(gpointer arena);
+
+static GPrivate thread_packet_scope = G_PRIVATE_INIT(thread_packet_scope_free);
+static GPrivate thread_file_arena   = G_PRIVATE_INIT(thread_file_arena_release);
+
+/* The file scope arenas of the other threads, and those of them that no
+ * thread is using */
+static GMutex  file_arenas_mutex;
+static GSList *file_arenas       = NULL;
+static GSList *spare_file_arenas = NULL;
+
+static void
+thread_packet_scope_free(gpointer scope)
+{
+    if (scope != packet_scope) {
+        wmem_destroy_allocator((wmem_allocator_t *)scope);
+    }
+}
+
+static void
+thread_file_arena_release(gpointer arena)
+{
+    g_mutex_lock(&file_arenas_mutex);
+    /* unless the scopes have been cleaned up already */
+    if (g_slist_find(file_arenas, arena)) {
+        spare_file_arenas = g_slist_prepend(spare_file_arenas, arena);
+    }
+    g_mutex_unlock(&file_arenas_mutex);
+}
+
 /* Packet Scope */
 
 wmem_allocator_t *
 wmem_packet_scope(void)
 {
-    g_assert(packet_scope);
+    wmem_allocator_t *scope;
+
+    scope = (wmem_allocator_t *)g_private_get(&thread_packet_scope);
+
+    if (G_UNLIKELY(scope == NULL)) {
+        g_assert(packet_scope);
+
+        scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+        scope->in_scope = FALSE;
+        g_private_set(&thread_packet_scope, scope);
+    }
 
-    return packet_scope;
+    return scope;
 }
 
 void
 wmem_enter_packet_scope(void)
 {
-    g_assert(packet_scope);
+    wmem_allocator_t *scope = wmem_packet_scope();
+
     g_assert(file_scope->in_scope);
-    g_assert(!packet_scope->in_scope);
+    g_assert(!scope->in_scope);
 
-    packet_scope->in_scope = TRUE;
+    scope->in_scope = TRUE;
 }
 
 void
 wmem_leave_packet_scope(void)
 {
-    g_assert(packet_scope);
-    g_assert(packet_scope->in_scope);
+    wmem_allocator_t *scope = wmem_packet_scope();
 
-    wmem_free_all(packet_scope);
-    packet_scope->in_scope = FALSE;
+    g_assert(scope->in_scope);
+
+    wmem_free_all(scope);
+    scope->in_scope = FALSE;
 }
 
 /* File Scope */
@@ -75,33 +134,73 @@ wmem_leave_packet_scope(void)
 wmem_allocator_t *
 wmem_file_scope(void)
 {
-    g_assert(file_scope);
+    wmem_allocator_t *arena;
+
+    arena = (wmem_allocator_t *)g_private_get(&thread_file_arena);
+
+    if (G_UNLIKELY(arena == NULL)) {
+        g_assert(file_scope);
 
-    return file_scope;
+        g_mutex_lock(&file_arenas_mutex);
+        if (spare_file_arenas) {
+            arena = (wmem_allocator_t *)spare_file_arenas->data;
+            spare_file_arenas = g_slist_delete_link(spare_file_arenas,
+                    spare_file_arenas);
+        }
+        else {
+            arena = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+            arena->in_scope = file_scope->in_scope;
+            file_arenas = g_slist_prepend(file_arenas, arena);
+        }
+        g_mutex_unlock(&file_arenas_mutex);
+
+        g_private_set(&thread_file_arena, arena);
+    }
+
+    return arena;
 }
 
 void
 wmem_enter_file_scope(void)
 {
+    GSList *cur;
+
     g_assert(file_scope);
     g_assert(!file_scope->in_scope);
 
+    g_mutex_lock(&file_arenas_mutex);
     file_scope->in_scope = TRUE;
+    for (cur = file_arenas; cur; cur = cur->next) {
+        ((wmem_allocator_t *)cur->data)->in_scope = TRUE;
+    }
+    g_mutex_unlock(&file_arenas_mutex);
 }
 
 void
 wmem_leave_file_scope(void)
 {
+    wmem_allocator_t *arena;
+    GSList           *cur;
+
     g_assert(file_scope);
     g_assert(file_scope->in_scope);
-    g_assert(!packet_scope->in_scope);
+    g_assert(!wmem_packet_scope()->in_scope);
 
     wmem_free_all(file_scope);
+
+    g_mutex_lock(&file_arenas_mutex);
     file_scope->in_scope = FALSE;
+    for (cur = file_arenas; cur; cur = cur->next) {
+        arena = (wmem_allocator_t *)cur->data;
+        wmem_free_all(arena);
+        arena->in_scope = FALSE;
+        wmem_gc(arena);
+    }
+    g_mutex_unlock(&file_arenas_mutex);
 
     /* this seems like a good time to do garbage collection */
     wmem_gc(file_scope);
-    wmem_gc(packet_scope);
+    wmem_gc(wmem_packet_scope());
 }
 
 /* Epan Scope */
@@ -130,6 +229,10 @@ wmem_init_scopes(void)
     /* Scopes are initialized to TRUE by default on creation */
     packet_scope->in_scope = FALSE;
     file_scope->in_scope   = FALSE;
+
+    /* this is the main thread */
+    g_private_set(&thread_packet_scope, packet_scope);
+    g_private_set(&thread_file_arena, file_scope);
 }
 
 void
@@ -142,6 +245,16 @@ wmem_cleanup_scopes(void)
     g_assert(packet_scope->in_scope == FALSE);
     g_assert(file_scope->in_scope   == FALSE);
 
+    g_private_set(&thread_packet_scope, NULL);
+    g_private_set(&thread_file_arena, NULL);
+
+    g_mutex_lock(&file_arenas_mutex);
+    g_slist_free_full(file_arenas, (GDestroyNotify)wmem_destroy_allocator);
+    g_slist_free(spare_file_arenas);
+    file_arenas       = NULL;
+    spare_file_arenas = NULL;
+    g_mutex_unlock(&file_arenas_mutex);
+
     wmem_destroy_allocator(packet_scope);
     wmem_destroy_allocator(file_scope);
     wmem_destroy_allocator(epan_scope);
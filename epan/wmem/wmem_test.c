@@ -22,6 +22,7 @@
 #include "wmem_allocator_simple.h"
 #include "wmem_allocator_strict.h"
 
+#include <wsutil/cpu_info.h>
 #include <wsutil/time_util.h>
 
 #define STRING_80               "12345678901234567890123456789012345678901234567890123456789012345678901234567890"
@@ -39,7 +40,7 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
 {
     wmem_allocator_t *allocator;
 
-    allocator = wmem_new(NULL, wmem_allocator_t);
+    allocator = wmem_new0(NULL, wmem_allocator_t);
     allocator->type = type;
     allocator->callbacks = NULL;
     allocator->in_scope = TRUE;
@@ -369,6 +370,73 @@ wmem_test_allocator_strict(void)
     wmem_test_allocator_jumbo(WMEM_ALLOCATOR_STRICT, &wmem_strict_check_canaries);
 }
 
+/* SCOPE TESTING FUNCTIONS (/wmem/scopes/) */
+
+static wmem_allocator_t *thread_file_arena;
+
+static gpointer
+wmem_test_scopes_thread(gpointer data)
+{
+    static gboolean   f = FALSE;
+    wmem_allocator_t *packet;
+    char             *str;
+
+    /* a packet scope of its own, entered and left on its own */
+    packet = wmem_packet_scope();
+    g_assert(packet != (wmem_allocator_t *)data);
+    g_assert(packet == wmem_packet_scope());
+    g_assert(!packet->in_scope);
+
+    wmem_enter_packet_scope();
+    wmem_strdup(packet, STRING_80);
+
+    /* and an arena of the file scope, which the main thread has entered */
+    thread_file_arena = wmem_file_scope();
+    g_assert(thread_file_arena->in_scope);
+    str = wmem_strdup(thread_file_arena, STRING_80);
+    wmem_register_callback(thread_file_arena, &wmem_test_cb, &f);
+
+    wmem_leave_packet_scope();
+    g_assert(!packet->in_scope);
+
+    return str;
+}
+
+static void
+wmem_test_scopes_threads(void)
+{
+    wmem_allocator_t *arena;
+    char             *str1, *str2;
+
+    wmem_enter_file_scope();
+
+    str1 = (char *)g_thread_join(g_thread_new("wmem test",
+                wmem_test_scopes_thread, wmem_packet_scope()));
+    arena = thread_file_arena;
+    g_assert(arena != wmem_file_scope());
+
+    /* the next thread gets the arena that the first one left behind */
+    str2 = (char *)g_thread_join(g_thread_new("wmem test",
+                wmem_test_scopes_thread, wmem_packet_scope()));
+    g_assert(thread_file_arena == arena);
+
+    /* what they allocated in the file scope outlives them... */
+    g_assert_cmpstr(str1, ==, STRING_80);
+    g_assert_cmpstr(str2, ==, STRING_80);
+
+    /* ...until the file scope is left */
+    expected_allocator = arena;
+    expected_event     = WMEM_CB_FREE_EVENT;
+    cb_called_count    = 0;
+    wmem_leave_file_scope();
+    g_assert(cb_called_count == 2);
+    g_assert(!arena->in_scope);
+
+    wmem_enter_file_scope();
+    g_assert(arena->in_scope);
+    wmem_leave_file_scope();
+}
+
 /* UTILITY TESTING FUNCTIONS (/wmem/utils/) */
 
 static void
@@ -631,6 +699,84 @@ wmem_test_stringperf(void)
     g_free(str_ptr);
 }
 
+#define THREADPERF_PACKETS      20000
+#define THREADPERF_ALLOCS       100
+#define THREADPERF_MAX_THREADS  8
+
+/* Does what a dissection thread would: allocates in its packet scope, which
+ * is left after each packet, and in its arena of the file scope, which
+ * isn't. */
+static gpointer
+wmem_test_threadperf_worker(gpointer data _U_)
+{
+    wmem_allocator_stats_t  packet_before, packet_after;
+    wmem_allocator_stats_t  file_before, file_after;
+    int                     i, j;
+
+    wmem_get_allocator_stats(wmem_packet_scope(), &packet_before);
+    wmem_get_allocator_stats(wmem_file_scope(), &file_before);
+
+    for (i = 0; i < THREADPERF_PACKETS; i++) {
+        wmem_enter_packet_scope();
+        for (j = 0; j < THREADPERF_ALLOCS; j++) {
+            wmem_alloc(wmem_packet_scope(), 8 + (j * 37) % 256);
+        }
+        wmem_alloc(wmem_file_scope(), 64);
+        wmem_leave_packet_scope();
+    }
+
+    wmem_get_allocator_stats(wmem_packet_scope(), &packet_after);
+    g_assert(packet_after.allocs - packet_before.allocs ==
+            THREADPERF_PACKETS * THREADPERF_ALLOCS);
+    g_assert(packet_after.free_alls - packet_before.free_alls ==
+            THREADPERF_PACKETS);
+
+    wmem_get_allocator_stats(wmem_file_scope(), &file_after);
+    g_assert(file_after.allocs - file_before.allocs == THREADPERF_PACKETS);
+    g_assert(file_after.free_alls == file_before.free_alls);
+
+    return NULL;
+}
+
+/* NOTE: You have to run "wmem_test --verbose" to see results. */
+static void
+wmem_test_threadperf(void)
+{
+    GThread *threads[THREADPERF_MAX_THREADS];
+    guint    max_threads, n, i;
+    gint64   start, elapsed_us;
+    double   allocs;
+    guint64  total_before, thread_bytes = 0;
+
+    max_threads = MIN(get_num_processors(), THREADPERF_MAX_THREADS);
+
+    /* What each worker requests, to check that no update of the running
+     * total is lost when several threads allocate at once. */
+    for (i = 0; i < THREADPERF_ALLOCS; i++) {
+        thread_bytes += 8 + (i * 37) % 256;
+    }
+    thread_bytes = (thread_bytes + 64) * THREADPERF_PACKETS;
+
+    for (n = 1; n <= max_threads; n++) {
+        wmem_enter_file_scope();
+        total_before = wmem_get_total_allocated();
+        start = g_get_monotonic_time();
+        for (i = 0; i < n; i++) {
+            threads[i] = g_thread_new("wmem test", wmem_test_threadperf_worker, NULL);
+        }
+        for (i = 0; i < n; i++) {
+            g_thread_join(threads[i]);
+        }
+        elapsed_us = MAX(g_get_monotonic_time() - start, 1);
+        wmem_leave_file_scope();
+        g_assert(wmem_get_total_allocated() - total_before == n * thread_bytes);
+
+        allocs = (double)n * THREADPERF_PACKETS * (THREADPERF_ALLOCS + 1);
+        g_test_maximized_result(allocs / elapsed_us,
+            "%u threads: %.1f M allocations/s", n, allocs / elapsed_us);
+    }
+}
+
 /* DATA STRUCTURE TESTING FUNCTIONS (/wmem/datastruct/) */
 
 static void
@@ -1440,11 +1586,14 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
 
+    g_test_add_func("/wmem/scopes/threads", wmem_test_scopes_threads);
+
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);
 
     if (!g_test_perf ()) {
         g_test_add_func("/wmem/utils/stringperf", wmem_test_stringperf);
+        g_test_add_func("/wmem/allocator/threadperf", wmem_test_threadperf);
     }
 
     g_test_add_func("/wmem/datastruct/array",  wmem_test_array);
@@ -22,6 +22,7 @@
 #include <wsutil/file_util.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/json_dumper.h>
+#include <wsutil/cpu_info.h>
 #include <version_info.h>
 
 #include <wiretap/merge.h>
@@ -35,6 +36,7 @@
 #include <epan/prefs.h>
 #include <epan/dfilter/dfilter.h>
 #include <epan/epan_dissect.h>
+#include <epan/field_index.h>
 #include <epan/tap.h>
 #include <epan/dissectors/packet-ber.h>
 #include <epan/timestamp.h>
@@ -53,6 +55,8 @@
 #include "ui/simple_dialog.h"
 #include "ui/main_statusbar.h"
 #include "ui/progress_dlg.h"
+#include "ui/record_prefetch.h"
+#include "ui/voip_calls.h"
 #include "ui/ws_ui_util.h"
 
 /* Needed for addrinfo */
@@ -109,6 +113,8 @@ static gboolean find_packet(capture_file *cf, ws_match_function match_function,
 
 static void cf_rename_failure_alert_box(const char *filename, int err);
 static void ref_time_packets(capture_file *cf);
+static void cf_prefetch_start(capture_file *cf);
+static void cf_prefetch_stop(capture_file *cf);
 
 /* Seconds spent processing packets between pushing UI updates. */
 #define PROGBAR_UPDATE_INTERVAL 0.150
@@ -233,7 +239,9 @@ ws_epan_new(capture_file *cf)
     ws_get_frame_ts,
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
-    cap_file_provider_get_user_comment
+    cap_file_provider_get_user_comment,
+    cap_file_provider_get_frame_shift,
+    cap_file_provider_get_frame_file_off
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -306,6 +314,14 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
    */
   cf->epan = ws_epan_new(cf);
 
+  /* Index some field values as the packets are read, if asked to. */
+  if (prefs.gui_field_index)
+    cf->field_index = field_index_new(prefs.gui_field_index_fields);
+
+  /* Find the VoIP calls as the packets are read, if asked to. */
+  if (prefs.gui_voip_calls_incremental)
+    voip_calls_collector_start(cf->epan);
+
   packet_list_queue_draw();
   cf_callback_invoke(cf_cb_file_opened, cf);
 
@@ -358,6 +374,7 @@ cf_close(capture_file *cf)
   /* close things, if not already closed before */
   color_filters_cleanup();
 
+  cf_prefetch_stop(cf);
   if (cf->provider.wth) {
     wtap_close(cf->provider.wth);
     cf->provider.wth = NULL;
@@ -384,6 +401,8 @@ cf_close(capture_file *cf)
 
   dfilter_free(cf->rfcode);
   cf->rfcode = NULL;
+  field_index_free(cf->field_index);
+  cf->field_index = NULL;
   if (cf->provider.frames != NULL) {
     free_frame_data_sequence(cf->provider.frames);
     cf->provider.frames = NULL;
@@ -416,6 +435,7 @@ cf_close(capture_file *cf)
   cf->f_datalen = 0;
   nstime_set_zero(&cf->elapsed_time);
 
+  voip_calls_collector_stop();
   reset_tap_listeners();
 
   epan_free(cf->epan);
@@ -652,6 +672,7 @@ cf_read(capture_file *cf, gboolean reloading)
 
   /* We're done reading sequentially through the file. */
   cf->state = FILE_READ_DONE;
+  cf_prefetch_start(cf);
 
   /* Destroy the progress bar if it was created. */
   if (progbar != NULL)
@@ -964,6 +985,7 @@ cf_finish_tail(capture_file *cf, wtap_rec *rec, Buffer *buf, int *err)
 
   /* We're done reading sequentially through the file. */
   cf->state = FILE_READ_DONE;
+  cf_prefetch_start(cf);
 
   /* We're done reading sequentially through the file; close the
      sequential I/O side, to free up memory it requires. */
@@ -1146,6 +1168,9 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
     epan_dissect_t *edt, dfilter_t *dfcode, column_info *cinfo,
     wtap_rec *rec, Buffer *buf, gboolean add_to_packet_list)
 {
+  gboolean first_pass;
+  gboolean index_frame;
+
   frame_data_set_before_dissect(fdata, &cf->elapsed_time,
                                 &cf->provider.ref, cf->provider.prev_dis);
   cf->provider.prev_cap = fdata;
@@ -1163,17 +1188,28 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
   }
 #endif
 
-  if (!fdata->visited) {
+  first_pass = !fdata->visited;
+  if (first_pass) {
     /* This is the first pass, so prime the epan_dissect_t with the
        hfids postdissectors want on the first pass. */
     prime_epan_dissect_with_postdissector_wanted_hfids(edt);
   }
 
+  /* Fields some dissectors only add after the first pass are in the
+     tree now, so the field index takes its values from this pass. */
+  index_frame = !first_pass && cf->field_index != NULL &&
+                field_index_wants(cf->field_index, fdata->num, cf->count);
+  if (index_frame)
+    field_index_prime_edt(cf->field_index, edt);
+
   /* Dissect the frame. */
   epan_dissect_run_with_taps(edt, cf->cd_t, rec,
                              frame_tvbuff_new_buffer(&cf->provider, fdata, buf),
                              fdata, cinfo);
 
+  if (index_frame)
+    field_index_add(cf->field_index, edt, fdata->num);
+
   /* If we don't have a display filter, set "passed_dfilter" to 1. */
   if (dfcode != NULL) {
     fdata->passed_dfilter = dfilter_apply_edt(dfcode, edt) ? 1 : 0;
@@ -1238,7 +1274,8 @@ read_record(capture_file *cf, wtap_rec *rec, Buffer *buf, dfilter_t *dfcode,
 
   /* The frame number of this packet, if we add it to the set of frames,
      would be one more than the count of frames in the file so far. */
-  frame_data_init(&fdlocal, cf->count + 1, rec, offset, cf->cum_bytes);
+  frame_data_init(&fdlocal, cf->count + 1, rec, cf->cum_bytes);
+  cf->provider.cur_file_off = offset;
 
   if (cf->rfcode) {
     epan_dissect_t rf_edt;
@@ -1256,7 +1293,7 @@ read_record(capture_file *cf, wtap_rec *rec, Buffer *buf, dfilter_t *dfcode,
     added = TRUE;
 
     /* This does a shallow copy of fdlocal, which is good enough. */
-    fdata = frame_data_sequence_add(cf->provider.frames, &fdlocal);
+    fdata = frame_data_sequence_add(cf->provider.frames, &fdlocal, offset);
 
     cf->count++;
     if (rec->opt_comment != NULL)
@@ -1551,6 +1588,47 @@ cf_redissect_packets(capture_file *cf)
   }
 }
 
+/*
+ * Number of records the background reader keeps; enough for a few
+ * screenfuls of packet list in each direction and then some.
+ */
+#define CF_PREFETCH_RECORDS 8192
+
+/*
+ * Start reading records in the background for random access, once we've
+ * read through the file and it won't change underneath us.
+ */
+static void
+cf_prefetch_start(capture_file *cf)
+{
+  record_prefetch_free(cf->prefetch);
+  cf->prefetch = NULL;
+  if (cf->provider.wth == NULL || cf->state != FILE_READ_DONE || cf->filename == NULL)
+    return;
+  cf->prefetch = record_prefetch_new(cf->provider.wth, cf->filename, cf->open_type,
+                                    CF_PREFETCH_RECORDS);
+}
+
+static void
+cf_prefetch_stop(capture_file *cf)
+{
+  record_prefetch_free(cf->prefetch);
+  cf->prefetch = NULL;
+}
+
+void
+cf_prefetch_records(capture_file *cf, frame_data **frames, guint count)
+{
+  if (cf->prefetch != NULL)
+    record_prefetch_request(cf->prefetch, cf->provider.frames, frames, count);
+}
+
+gboolean
+cf_record_is_pending(capture_file *cf, const frame_data *fdata)
+{
+  return cf->prefetch != NULL && record_prefetch_is_pending(cf->prefetch, fdata);
+}
+
 gboolean
 cf_read_record(capture_file *cf, const frame_data *fdata,
                  wtap_rec *rec, Buffer *buf)
@@ -1558,7 +1636,12 @@ cf_read_record(capture_file *cf, const frame_data *fdata,
   int    err;
   gchar *err_info;
 
-  if (!wtap_seek_read(cf->provider.wth, fdata->file_off, rec, buf, &err, &err_info)) {
+  if (cf->prefetch != NULL && record_prefetch_get(cf->prefetch, fdata, rec, buf))
+    return TRUE;
+
+  if (!wtap_seek_read(cf->provider.wth,
+                      frame_data_sequence_get_file_off(cf->provider.frames, fdata->num),
+                      rec, buf, &err, &err_info)) {
     cfile_read_failure_alert_box(cf->filename, err, err_info);
     return FALSE;
   }
@@ -1609,6 +1692,8 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   gboolean    compiled;
   guint32     frames_count;
   gboolean    queued_rescan_type = RESCAN_NONE;
+  frame_set_t *candidates = NULL;
+  gboolean    skip;
 
   /* Rescan in progress, clear pending actions. */
   cf->redissection_queued = RESCAN_NONE;
@@ -1625,6 +1710,11 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   compiled = dfilter_compile(cf->dfilter, &dfcode, NULL);
   g_assert(!cf->dfilter || (compiled && dfcode));
 
+  /* The VoIP calls collector has seen these packets already, unless
+     they're about to be redissected; then it starts over below. */
+  if (!redissect)
+    voip_calls_collector_pause();
+
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
 
@@ -1642,12 +1732,16 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
    *    one of the tap listeners requires a protocol tree;
    *
    *    we're redissecting and a postdissector wants field
-   *    values or protocols on the first pass.
+   *    values or protocols on the first pass;
+   *
+   *    we're refiltering and the field index is to be built.
    */
   create_proto_tree =
     (dfcode != NULL || have_filtering_tap_listeners() ||
      (tap_flags & TL_REQUIRES_PROTO_TREE) ||
-     (redissect && postdissectors_want_hfids()));
+     (redissect && postdissectors_want_hfids()) ||
+     (!redissect && cf->field_index != NULL &&
+      field_index_wants(cf->field_index, 1, cf->count)));
 
   reset_tap_listeners();
   /* Which frame, if any, is the currently selected frame?
@@ -1674,7 +1768,7 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
     cf->redissecting = TRUE;
 
     /* 'reset' dissection session */
-    epan_free(cf->epan);
+    epan_free_for_redissection(cf->epan);
     if (cf->edt && cf->edt->pi.fd) {
       /* All pointers in "per frame proto data" for the currently selected
          packet are allocated in wmem_file_scope() and deallocated in epan_free().
@@ -1683,6 +1777,7 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
     }
     cf->epan = ws_epan_new(cf);
     cf->cinfo.epan = cf->epan;
+    voip_calls_collector_restart(cf->epan);
 
     /* A new Lua tap listener may be registered in lua_prime_all_fields()
        called via epan_new() / init_dissection() when reloading Lua plugins. */
@@ -1694,6 +1789,10 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
      * packet list store. */
     packet_list_clear();
     add_to_packet_list = TRUE;
+
+    /* The field values may come out differently this time. */
+    if (cf->field_index != NULL)
+      field_index_clear(cf->field_index);
   }
 
   /* We don't yet know which will be the first and last frames displayed. */
@@ -1735,6 +1834,12 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
 
   frames_count = cf->count;
 
+  /* If we're only refiltering, and no tap wants to see every packet,
+     we needn't dissect the packets the field index says the filter
+     can't match. */
+  if (!redissect && !tap_listeners_require_dissection())
+    candidates = field_index_lookup(cf->field_index, dfcode, frames_count);
+
   epan_dissect_init(&edt, cf->epan, create_proto_tree, FALSE);
 
   if (redissect) {
@@ -1821,7 +1926,11 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
     /* Frame dependencies from the previous dissection/filtering are no longer valid. */
     fdata->dependent_of_displayed = 0;
 
-    if (!cf_read_record(cf, fdata, &rec, &buf))
+    /* Reference time frames are displayed whether or not they match. */
+    skip = candidates != NULL && !fdata->ref_time &&
+           !frame_set_contains(candidates, fdata->num);
+
+    if (!skip && !cf_read_record(cf, fdata, &rec, &buf))
       break; /* error reading the frame */
 
     /* If the previous frame is displayed, and we haven't yet seen the
@@ -1832,9 +1941,18 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
       preceding_frame = prev_frame;
     }
 
-    add_packet_to_packet_list(fdata, cf, &edt, dfcode,
-                                    cinfo, &rec, &buf,
-                                    add_to_packet_list);
+    if (skip) {
+      /* It can't pass the filter; just do what adding it would have
+         done to the time references. */
+      frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                                    &cf->provider.ref, cf->provider.prev_dis);
+      cf->provider.prev_cap = fdata;
+      fdata->passed_dfilter = 0;
+    } else {
+      add_packet_to_packet_list(fdata, cf, &edt, dfcode,
+                                      cinfo, &rec, &buf,
+                                      add_to_packet_list);
+    }
 
     /* If this frame is displayed, and this is the first frame we've
        seen displayed after the selected frame, remember this frame -
@@ -1859,6 +1977,9 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   epan_dissect_cleanup(&edt);
   wtap_rec_cleanup(&rec);
   ws_buffer_free(&buf);
+  frame_set_free(candidates);
+  if (!redissect)
+    voip_calls_collector_resume();
 
   /* We are done redissecting the packet list. */
   cf->redissecting = FALSE;
@@ -2062,6 +2183,7 @@ typedef enum {
 
 static psp_return_t
 process_specified_records(capture_file *cf, packet_range_t *range,
+    const frame_set_t *frames,
     const char *string1, const char *string2, gboolean terminate_is_stop,
     gboolean (*callback)(capture_file *, frame_data *,
                          wtap_rec *, Buffer *, void *),
@@ -2080,6 +2202,7 @@ process_specified_records(capture_file *cf, packet_range_t *range,
   float            progbar_val;
   gchar            progbar_status_str[100];
   range_process_e  process_this;
+  guint32          total = frames != NULL ? frame_set_count(frames) : cf->count;
 
   wtap_rec_init(&rec);
   ws_buffer_init(&buf, 1514);
@@ -2101,9 +2224,12 @@ process_specified_records(capture_file *cf, packet_range_t *range,
   if (range != NULL)
     packet_range_process_init(range);
 
-  /* Iterate through all the packets, printing the packets that
-     were selected by the current display filter.  */
-  for (framenum = 1; framenum <= cf->count; framenum++) {
+  /* Iterate through all the packets, or just the ones we were given,
+     printing the packets that were selected by the current display
+     filter.  */
+  for (framenum = frames != NULL ? frame_set_next(frames, 0) : 1;
+       framenum != 0 && framenum <= cf->count;
+       framenum = frames != NULL ? frame_set_next(frames, framenum) : framenum + 1) {
     fdata = frame_data_sequence_find(cf->provider.frames, framenum);
 
     /* Create the progress bar if necessary.
@@ -2127,11 +2253,11 @@ process_specified_records(capture_file *cf, packet_range_t *range,
       /* let's not divide by zero. I should never be started
        * with count == 0, so let's assert that
        */
-      g_assert(cf->count > 0);
-      progbar_val = (gfloat) progbar_count / cf->count;
+      g_assert(total > 0);
+      progbar_val = (gfloat) progbar_count / total;
 
       g_snprintf(progbar_status_str, sizeof(progbar_status_str),
-                  "%4u of %u packets", progbar_count, cf->count);
+                  "%4u of %u packets", progbar_count, total);
       update_progress_dlg(progbar, progbar_val, progbar_status_str);
 
       g_timer_start(prog_timer);
@@ -2214,6 +2340,7 @@ cf_retap_packets(capture_file *cf)
   retap_callback_args_t callback_args;
   gboolean              create_proto_tree;
   guint                 tap_flags;
+  frame_set_t          *frames;
   psp_return_t          ret;
 
   /* Presumably the user closed the capture file. */
@@ -2223,6 +2350,9 @@ cf_retap_packets(capture_file *cf)
 
   cf_callback_invoke(cf_cb_file_retap_started, cf);
 
+  /* The VoIP calls collector has seen all the packets already. */
+  voip_calls_collector_pause();
+
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
 
@@ -2245,17 +2375,24 @@ cf_retap_packets(capture_file *cf)
 
   epan_dissect_init(&callback_args.edt, cf->epan, create_proto_tree, FALSE);
 
+  /* If all the tap listeners filter on values we've indexed, such as
+     a stream being followed, only the packets with those values can
+     get to them. */
+  frames = field_index_lookup_taps(cf->field_index, cf->count);
+
   /* Iterate through the list of packets, dissecting all packets and
      re-running the taps. */
   packet_range_init(&range, cf);
   packet_range_process_init(&range);
 
-  ret = process_specified_records(cf, &range, "Recalculating statistics on",
+  ret = process_specified_records(cf, &range, frames, "Recalculating statistics on",
                                   "all packets", TRUE, retap_packet,
                                   &callback_args, TRUE);
 
   packet_range_cleanup(&range);
+  frame_set_free(frames);
   epan_dissect_cleanup(&callback_args.edt);
+  voip_calls_collector_resume();
 
   cf_callback_invoke(cf_cb_file_retap_finished, cf);
 
@@ -2278,6 +2415,21 @@ cf_retap_packets(capture_file *cf)
   return CF_READ_OK;
 }
 
+cf_read_status_t
+cf_retap_listener(capture_file *cf, void *tapdata)
+{
+  cf_read_status_t status;
+  void *prev_only;
+
+  /* The other listeners keep what they have, and don't make us build
+     trees or columns, or run filters, for them. */
+  prev_only = set_tap_listener_only(tapdata);
+  status = cf_retap_packets(cf);
+  set_tap_listener_only(prev_only);
+
+  return status;
+}
+
 typedef struct {
   print_args_t *print_args;
   gboolean      print_header_line;
@@ -2587,7 +2739,7 @@ cf_print_packets(capture_file *cf, print_args_t *print_args,
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range, "Printing",
+  ret = process_specified_records(cf, &print_args->range, NULL, "Printing",
                                   "selected packets", TRUE, print_packet,
                                   &callback_args, show_progress_bar);
   epan_dissect_cleanup(&callback_args.edt);
@@ -2682,7 +2834,7 @@ cf_write_pdml_packets(capture_file *cf, print_args_t *print_args)
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range, "Writing PDML",
+  ret = process_specified_records(cf, &print_args->range, NULL, "Writing PDML",
                                   "selected packets", TRUE,
                                   write_pdml_packet, &callback_args, TRUE);
 
@@ -2766,7 +2918,7 @@ cf_write_psml_packets(capture_file *cf, print_args_t *print_args)
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range, "Writing PSML",
+  ret = process_specified_records(cf, &print_args->range, NULL, "Writing PSML",
                                   "selected packets", TRUE,
                                   write_psml_packet, &callback_args, TRUE);
 
@@ -2848,7 +3000,7 @@ cf_write_csv_packets(capture_file *cf, print_args_t *print_args)
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range, "Writing CSV",
+  ret = process_specified_records(cf, &print_args->range, NULL, "Writing CSV",
                                   "selected packets", TRUE,
                                   write_csv_packet, &callback_args, TRUE);
 
@@ -2914,7 +3066,7 @@ cf_write_carrays_packets(capture_file *cf, print_args_t *print_args)
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range,
+  ret = process_specified_records(cf, &print_args->range, NULL,
                                   "Writing C Arrays",
                                   "selected packets", TRUE,
                                   carrays_write_packet, &callback_args, TRUE);
@@ -2983,7 +3135,7 @@ cf_write_json_packets(capture_file *cf, print_args_t *print_args)
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range, "Writing PDML",
+  ret = process_specified_records(cf, &print_args->range, NULL, "Writing PDML",
                                   "selected packets", TRUE,
                                   write_json_packet, &callback_args, TRUE);
 
@@ -4243,10 +4395,10 @@ rescan_file(capture_file *cf, const char *fname, gboolean is_tempfile)
   gint64               start_time;
   gchar                status_str[100];
   guint32              framenum;
-  frame_data          *fdata;
   int                  count          = 0;
 
   /* Close the old handle. */
+  cf_prefetch_stop(cf);
   wtap_close(cf->provider.wth);
 
   /* Open the new file. */
@@ -4303,8 +4455,7 @@ rescan_file(capture_file *cf, const char *fname, gboolean is_tempfile)
   while ((wtap_read(cf->provider.wth, &rec, &buf, &err, &err_info,
           &data_offset))) {
     framenum++;
-    fdata = frame_data_sequence_find(cf->provider.frames, framenum);
-    fdata->file_off = data_offset;
+    frame_data_sequence_set_file_off(cf->provider.frames, framenum, data_offset);
     if (size >= 0) {
       count++;
       cf->f_datalen = wtap_read_so_far(cf->provider.wth);
@@ -4362,6 +4513,7 @@ rescan_file(capture_file *cf, const char *fname, gboolean is_tempfile)
 
   /* We're done reading sequentially through the file. */
   cf->state = FILE_READ_DONE;
+  cf_prefetch_start(cf);
 
   /* Close the sequential I/O side, to free up memory it requires. */
   wtap_sequential_close(cf->provider.wth);
@@ -4423,6 +4575,9 @@ cf_save_records(capture_file *cf, const char *fname, guint save_format,
 
   cf_callback_invoke(cf_cb_file_save_started, (gpointer)fname);
 
+  /* The file may be moved or replaced; stop reading it in the background. */
+  cf_prefetch_stop(cf);
+
   addr_lists = get_addrinfo_list();
 
   if (save_format == cf->cd_t && compression_type == cf->compression_type
@@ -4522,6 +4677,9 @@ cf_save_records(capture_file *cf, const char *fname, guint save_format,
     /* Use the snaplen from cf (XXX - does wtap_dump_params_init handle that?) */
     params.snaplen = cf->snap;
 
+    /* If we're compressing, use all our processors. */
+    params.compress_threads = get_num_processors();
+
     if (file_exists(fname)) {
       /* We're overwriting an existing file; write out to a new file,
          and, if that succeeds, rename the new file on top of the
@@ -4552,7 +4710,7 @@ cf_save_records(capture_file *cf, const char *fname, guint save_format,
     callback_args.pdh = pdh;
     callback_args.fname = fname;
     callback_args.file_type = save_format;
-    switch (process_specified_records(cf, NULL, "Saving", "packets",
+    switch (process_specified_records(cf, NULL, NULL, "Saving", "packets",
                                       TRUE, save_record, &callback_args, TRUE)) {
 
     case PSP_FINISHED:
@@ -4639,6 +4797,7 @@ cf_save_records(capture_file *cf, const char *fname, guint save_format,
       g_free(cf->filename);
       cf->filename = g_strdup(fname);
       cf->is_tempfile = FALSE;
+      cf_prefetch_start(cf);
       cf_callback_invoke(cf_cb_file_fast_save_finished, cf);
       break;
 
@@ -4659,6 +4818,7 @@ cf_save_records(capture_file *cf, const char *fname, guint save_format,
         g_free(cf->filename);
         cf->filename = g_strdup(fname);
         cf->is_tempfile = FALSE;
+        cf_prefetch_start(cf);
       }
       cf_callback_invoke(cf_cb_file_fast_save_finished, cf);
       break;
@@ -4746,6 +4906,7 @@ fail:
     ws_unlink(fname_new);
     g_free(fname_new);
   }
+  cf_prefetch_start(cf);
   cf_callback_invoke(cf_cb_file_save_failed, NULL);
   return CF_WRITE_ERROR;
 }
@@ -4779,6 +4940,9 @@ cf_export_specified_packets(capture_file *cf, const char *fname,
   /* Use the snaplen from cf (XXX - does wtap_dump_params_init handle that?) */
   params.snaplen = cf->snap;
 
+  /* If we're compressing, use all our processors. */
+  params.compress_threads = get_num_processors();
+
   if (file_exists(fname)) {
     /* We're overwriting an existing file; write out to a new file,
        and, if that succeeds, rename the new file on top of the
@@ -4815,7 +4979,7 @@ cf_export_specified_packets(capture_file *cf, const char *fname,
   callback_args.pdh = pdh;
   callback_args.fname = fname;
   callback_args.file_type = save_format;
-  switch (process_specified_records(cf, range, "Writing", "specified records",
+  switch (process_specified_records(cf, range, NULL, "Writing", "specified records",
                                     TRUE, save_record, &callback_args, TRUE)) {
 
   case PSP_FINISHED:
@@ -163,6 +163,28 @@ gboolean cf_read_record(capture_file *cf, const frame_data *fdata,
  */
 gboolean cf_read_current_record(capture_file *cf);
 
+/**
+ * Tell the background reader which records will be wanted soon, most
+ * urgent first, so that cf_read_record() can return them without doing
+ * any I/O.  Does nothing if the file isn't being read in the background.
+ *
+ * @param cf the capture file
+ * @param frames the frame_data structures for the records
+ * @param count the number of entries in frames
+ */
+void cf_prefetch_records(capture_file *cf, frame_data **frames, guint count);
+
+/**
+ * Check whether the background reader is still reading a record that
+ * has been asked for; reading it with cf_read_record() now would wait
+ * for I/O.
+ *
+ * @param cf the capture file
+ * @param fdata the frame_data structure for the record
+ * @return TRUE if the record is on its way
+ */
+gboolean cf_record_is_pending(capture_file *cf, const frame_data *fdata);
+
 /**
  * Read packets from the "end" of a capture file.
  *
@@ -408,6 +430,16 @@ void cf_redissect_packets(capture_file *cf);
  */
 cf_read_status_t cf_retap_packets(capture_file *cf);
 
+/**
+ * Rescan all packets and just run one tap listener, leaving the others
+ * as they are.
+ *
+ * @param cf the capture file
+ * @param tapdata the tapdata the listener was registered with
+ * @return one of cf_read_status_t
+ */
+cf_read_status_t cf_retap_listener(capture_file *cf, void *tapdata);
+
 /**
  * Adjust timestamp precision if auto is selected.
  *
@@ -79,6 +79,29 @@ cap_file_provider_get_user_comment(struct packet_provider_data *prov, const fram
   return NULL;
 }
 
+void
+cap_file_provider_get_frame_shift(struct packet_provider_data *prov, guint32 frame_num, nstime_t *shift)
+{
+  if (prov->frames)
+    frame_data_sequence_get_shift(prov->frames, frame_num, shift);
+  else
+    nstime_set_zero(shift);
+}
+
+gint64
+cap_file_provider_get_frame_file_off(const struct packet_provider_data *prov, const frame_data *fd)
+{
+  gint64 file_off = -1;
+
+  if (prov->frames)
+    file_off = frame_data_sequence_get_file_off(prov->frames, fd->num);
+
+  /* A frame that's being read for the first time isn't in frames yet. */
+  if (file_off < 0)
+    file_off = prov->cur_file_off;
+  return file_off;
+}
+
 void
 cap_file_provider_set_user_comment(struct packet_provider_data *prov, frame_data *fd, const char *new_comment)
 {
@@ -207,7 +207,7 @@ frame_tvbuff_new(const struct packet_provider_data *prov, const frame_data *fd,
 	/* XXX, wtap_can_seek() */
 	if (prov->wth && prov->wth->random_fh) {
 		frame_tvb->prov = prov;
-		frame_tvb->file_off = fd->file_off;
+		frame_tvb->file_off = cap_file_provider_get_frame_file_off(prov, fd);
 		frame_tvb->offset = 0;
 	} else
 		frame_tvb->prov = NULL;
@@ -312,7 +312,7 @@ file_tvbuff_new(const struct packet_provider_data *prov, const frame_data *fd,
 	/* XXX, wtap_can_seek() */
 	if (prov->wth && prov->wth->random_fh) {
 		frame_tvb->prov = prov;
-		frame_tvb->file_off = fd->file_off;
+		frame_tvb->file_off = cap_file_provider_get_frame_file_off(prov, fd);
 		frame_tvb->offset = 0;
 	} else
 		frame_tvb->prov = NULL;
@@ -130,6 +130,8 @@ fuzzshark_epan_new(void)
 		fuzzshark_get_frame_ts,
 		NULL,
 		NULL,
+		NULL,
+		NULL,
 		NULL
 	};
 
@@ -376,7 +378,7 @@ LLVMFuzzerTestOneInput(const guint8 *buf, size_t real_len)
 	rec.rec_header.packet_header.pkt_encap = G_MAXINT16;
 	rec.presence_flags = WTAP_HAS_TS | WTAP_HAS_CAP_LEN; /* most common flags... */
 
-	frame_data_init(&fdlocal, ++framenum, &rec, /* offset */ 0, /* cum_bytes */ 0);
+	frame_data_init(&fdlocal, ++framenum, &rec, /* cum_bytes */ 0);
 	/* frame_data_set_before_dissect() not needed */
 	epan_dissect_run(edt, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, &rec, tvb_new_real_data(buf, len, len), &fdlocal, NULL /* &fuzz_cinfo */);
 	frame_data_destroy(&fdlocal);
@@ -106,19 +106,19 @@ static void ipv6_hosts_stats_tree_init(stats_tree *st) {
 	st_node_ipv6 = stats_tree_create_node(st, st_str_ipv6, 0, STAT_DT_INT, TRUE);
 }
 
-static tap_packet_status ip_hosts_stats_tree_packet(stats_tree *st, packet_info *pinfo, int st_node, const gchar *st_str) {
-	tick_stat_node(st, st_str, 0, FALSE);
-	tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_src), st_node, FALSE);
-	tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_dst), st_node, FALSE);
+static tap_packet_status ip_hosts_stats_tree_packet(stats_tree *st, packet_info *pinfo, int st_node) {
+	tick_stat_node_by_id(st, st_node);
+	stats_tree_tick_node_address(st, st_node, &pinfo->net_src, FALSE);
+	stats_tree_tick_node_address(st, st_node, &pinfo->net_dst, FALSE);
 	return TAP_PACKET_REDRAW;
 }
 
 static tap_packet_status ipv4_hosts_stats_tree_packet(stats_tree *st, packet_info *pinfo, epan_dissect_t *edt _U_, const void *p _U_) {
-	return ip_hosts_stats_tree_packet(st, pinfo, st_node_ipv4, st_str_ipv4);
+	return ip_hosts_stats_tree_packet(st, pinfo, st_node_ipv4);
 }
 
 static tap_packet_status ipv6_hosts_stats_tree_packet(stats_tree *st, packet_info *pinfo, epan_dissect_t *edt _U_, const void *p _U_) {
-	return ip_hosts_stats_tree_packet(st, pinfo, st_node_ipv6, st_str_ipv6);
+	return ip_hosts_stats_tree_packet(st, pinfo, st_node_ipv6);
 }
 
 /* ip host stats_tree -- separate source and dest, test stats_tree flags */
@@ -157,24 +157,22 @@ static void ipv6_srcdst_stats_tree_init(stats_tree *st) {
 static tap_packet_status ip_srcdst_stats_tree_packet(stats_tree *st,
 						     packet_info *pinfo,
 				                     int st_node_src,
-				                     const gchar *st_str_src,
-						     int st_node_dst,
-						     const gchar *st_str_dst) {
+						     int st_node_dst) {
 	/* update source branch */
-	tick_stat_node(st, st_str_src, 0, FALSE);
-	tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_src), st_node_src, FALSE);
+	tick_stat_node_by_id(st, st_node_src);
+	stats_tree_tick_node_address(st, st_node_src, &pinfo->net_src, FALSE);
 	/* update destination branch */
-	tick_stat_node(st, st_str_dst, 0, FALSE);
-	tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_dst), st_node_dst, FALSE);
+	tick_stat_node_by_id(st, st_node_dst);
+	stats_tree_tick_node_address(st, st_node_dst, &pinfo->net_dst, FALSE);
 	return TAP_PACKET_REDRAW;
 }
 
 static tap_packet_status ipv4_srcdst_stats_tree_packet(stats_tree *st, packet_info *pinfo, epan_dissect_t *edt _U_, const void *p _U_) {
-	return ip_srcdst_stats_tree_packet(st, pinfo, st_node_ipv4_src, st_str_ipv4_src, st_node_ipv4_dst, st_str_ipv4_dst);
+	return ip_srcdst_stats_tree_packet(st, pinfo, st_node_ipv4_src, st_node_ipv4_dst);
 }
 
 static tap_packet_status ipv6_srcdst_stats_tree_packet(stats_tree *st, packet_info *pinfo, epan_dissect_t *edt _U_, const void *p _U_) {
-	return ip_srcdst_stats_tree_packet(st, pinfo, st_node_ipv6_src, st_str_ipv6_src, st_node_ipv6_dst, st_str_ipv6_dst);
+	return ip_srcdst_stats_tree_packet(st, pinfo, st_node_ipv6_src, st_node_ipv6_dst);
 }
 
 /* packet type stats_tree -- test pivot node */
@@ -220,25 +218,23 @@ static void ipv6_dsts_stats_tree_init(stats_tree *st) {
 	st_node_ipv6_dsts = stats_tree_create_node(st, st_str_ipv6_dsts, 0, STAT_DT_INT, TRUE);
 }
 
-static tap_packet_status dsts_stats_tree_packet(stats_tree *st, packet_info *pinfo, int st_node, const gchar *st_str) {
-	static gchar str[128];
+static tap_packet_status dsts_stats_tree_packet(stats_tree *st, packet_info *pinfo, int st_node) {
 	int ip_dst_node;
 	int protocol_node;
 
-	tick_stat_node(st, st_str, 0, FALSE);
-	ip_dst_node = tick_stat_node(st, address_to_str(pinfo->pool, &pinfo->net_dst), st_node, TRUE);
+	tick_stat_node_by_id(st, st_node);
+	ip_dst_node = stats_tree_tick_node_address(st, st_node, &pinfo->net_dst, TRUE);
 	protocol_node = tick_stat_node(st, port_type_to_str(pinfo->ptype), ip_dst_node, TRUE);
-	g_snprintf(str, sizeof(str) - 1, "%u", pinfo->destport);
-	tick_stat_node(st, str, protocol_node, TRUE);
+	stats_tree_tick_node_uint(st, protocol_node, pinfo->destport, NULL, NULL, TRUE);
 	return TAP_PACKET_REDRAW;
 }
 
 static tap_packet_status ipv4_dsts_stats_tree_packet(stats_tree *st, packet_info *pinfo, epan_dissect_t *edt _U_, const void *p _U_) {
-	return dsts_stats_tree_packet(st, pinfo, st_node_ipv4_dsts, st_str_ipv4_dsts);
+	return dsts_stats_tree_packet(st, pinfo, st_node_ipv4_dsts);
 }
 
 static tap_packet_status ipv6_dsts_stats_tree_packet(stats_tree *st, packet_info *pinfo, epan_dissect_t *edt _U_, const void *p _U_) {
-	return dsts_stats_tree_packet(st, pinfo, st_node_ipv6_dsts, st_str_ipv6_dsts);
+	return dsts_stats_tree_packet(st, pinfo, st_node_ipv6_dsts);
 }
 
 /* packet length stats_tree -- test range node */
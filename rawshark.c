@@ -979,7 +979,8 @@ process_packet(capture_file *cf, epan_dissect_t *edt, gint64 offset,
     /* If we're going to print packet information, or we're going to
        run a read filter, or we're going to process taps, set up to
        do a dissection and do so. */
-    frame_data_init(&fdata, cf->count, rec, offset, cum_bytes);
+    frame_data_init(&fdata, cf->count, rec, cum_bytes);
+    cf->provider.cur_file_off = offset;
 
     passed = TRUE;
 
@@ -1454,6 +1455,8 @@ raw_epan_new(capture_file *cf)
         cap_file_provider_get_interface_name,
         cap_file_provider_get_interface_description,
         NULL,
+        NULL,
+        cap_file_provider_get_frame_file_off,
     };
 
     return epan_new(&cf->provider, &funcs);
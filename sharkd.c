@@ -39,6 +39,7 @@
 #include "frame_tvbuff.h"
 #include <epan/disabled_protos.h>
 #include <epan/prefs.h>
+#include <epan/field_index.h>
 #include <epan/column.h>
 #include <epan/print.h>
 #include <epan/addr_resolv.h>
@@ -225,7 +226,9 @@ sharkd_epan_new(capture_file *cf)
     sharkd_get_frame_ts,
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
-    cap_file_provider_get_user_comment
+    cap_file_provider_get_user_comment,
+    cap_file_provider_get_frame_shift,
+    cap_file_provider_get_frame_file_off
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -245,7 +248,8 @@ process_packet(capture_file *cf, epan_dissect_t *edt,
 
   /* The frame number of this packet, if we add it to the set of frames,
      would be one more than the count of frames in the file so far. */
-  frame_data_init(&fdlocal, cf->count + 1, rec, offset, cum_bytes);
+  frame_data_init(&fdlocal, cf->count + 1, rec, cum_bytes);
+  cf->provider.cur_file_off = offset;
 
   /* If we're going to print packet information, or we're going to
      run a read filter, or display filter, or we're going to process taps, set up to
@@ -286,7 +290,7 @@ process_packet(capture_file *cf, epan_dissect_t *edt,
 
   if (passed) {
     frame_data_set_after_dissect(&fdlocal, &cum_bytes);
-    cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal);
+    cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal, offset);
 
     /* If we're not doing dissection then there won't be any dependent frames.
      * More importantly, edt.pi.dependent_frames won't be initialized because
@@ -434,6 +438,10 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   epan_free(cf->epan);
   cf->epan = sharkd_epan_new(cf);
 
+  /* Index some field values, if asked to. */
+  field_index_free(cf->field_index);
+  cf->field_index = prefs.gui_field_index ? field_index_new(prefs.gui_field_index_fields) : NULL;
+
   cf->state = FILE_READ_IN_PROGRESS;
 
   wtap_set_cb_new_ipv4(cf->provider.wth, add_ipv4_name);
@@ -518,6 +526,12 @@ sharkd_get_frame(guint32 framenum)
   return frame_data_sequence_find(cfile.provider.frames, framenum);
 }
 
+static gint64
+sharkd_get_file_off(const frame_data *fdata)
+{
+  return frame_data_sequence_get_file_off(cfile.provider.frames, fdata->num);
+}
+
 int
 sharkd_dissect_request(guint32 framenum, guint32 frame_ref_num, guint32 prev_dis_num, sharkd_dissect_func_t cb, guint32 dissect_flags, void *data)
 {
@@ -538,7 +552,7 @@ sharkd_dissect_request(guint32 framenum, guint32 frame_ref_num, guint32 prev_dis
   wtap_rec_init(&rec);
   ws_buffer_init(&buf, 1514);
 
-  if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info)) {
+  if (!wtap_seek_read(cfile.provider.wth, sharkd_get_file_off(fdata), &rec, &buf, &err, &err_info)) {
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
     return -1; /* error reading the record */
@@ -598,7 +612,7 @@ sharkd_dissect_columns(frame_data *fdata, guint32 frame_ref_num, guint32 prev_di
   wtap_rec_init(&rec);
   ws_buffer_init(&buf, 1514);
 
-  if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info)) {
+  if (!wtap_seek_read(cfile.provider.wth, sharkd_get_file_off(fdata), &rec, &buf, &err, &err_info)) {
     col_fill_in_error(cinfo, fdata, FALSE, FALSE /* fill_fd_columns */);
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
@@ -653,6 +667,7 @@ sharkd_retap(void)
   gboolean      create_proto_tree;
   epan_dissect_t edt;
   column_info   *cinfo;
+  frame_set_t   *frames;
 
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
@@ -677,10 +692,16 @@ sharkd_retap(void)
 
   reset_tap_listeners();
 
-  for (framenum = 1; framenum <= cfile.count; framenum++) {
+  /* If all the taps filter on values we've indexed, only the packets
+     with those values can get to them. */
+  frames = field_index_lookup_taps(cfile.field_index, cfile.count);
+
+  for (framenum = frames ? frame_set_next(frames, 0) : 1;
+       framenum != 0 && framenum <= cfile.count;
+       framenum = frames ? frame_set_next(frames, framenum) : framenum + 1) {
     fdata = sharkd_get_frame(framenum);
 
-    if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info))
+    if (!wtap_seek_read(cfile.provider.wth, sharkd_get_file_off(fdata), &rec, &buf, &err, &err_info))
       break;
 
     fdata->ref_time = FALSE;
@@ -692,6 +713,7 @@ sharkd_retap(void)
     epan_dissect_reset(&edt);
   }
 
+  frame_set_free(frames);
   wtap_rec_cleanup(&rec);
   ws_buffer_free(&buf);
   epan_dissect_cleanup(&edt);
@@ -717,6 +739,8 @@ sharkd_filter(const char *dftext, guint8 **result)
   guint8  passed_bits;
 
   epan_dissect_t edt;
+  frame_set_t   *candidates;
+  gboolean       index_frame;
 
   if (!dfilter_compile(dftext, &dfcode, &err_info)) {
     g_free(err_info);
@@ -731,6 +755,9 @@ sharkd_filter(const char *dftext, guint8 **result)
 
   frames_count = cfile.count;
 
+  /* Frames the field index says can't match needn't be dissected. */
+  candidates = field_index_lookup(cfile.field_index, dfcode, frames_count);
+
   wtap_rec_init(&rec);
   ws_buffer_init(&buf, 1514);
   epan_dissect_init(&edt, cfile.epan, TRUE, FALSE);
@@ -746,12 +773,22 @@ sharkd_filter(const char *dftext, guint8 **result)
       passed_bits = 0;
     }
 
-    if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info))
+    if (candidates && !frame_set_contains(candidates, framenum))
+      continue;
+
+    if (!wtap_seek_read(cfile.provider.wth, sharkd_get_file_off(fdata), &rec, &buf, &err, &err_info))
       break;
 
     /* frame_data_set_before_dissect */
     epan_dissect_prime_with_dfilter(&edt, dfcode);
 
+    /* Every frame has been dissected once, so the fields that are only
+       added on later passes are there; build the field index from them. */
+    index_frame = cfile.field_index != NULL &&
+                  field_index_wants(cfile.field_index, framenum, frames_count);
+    if (index_frame)
+      field_index_prime_edt(cfile.field_index, &edt);
+
     fdata->ref_time = FALSE;
     fdata->frame_ref_num = (framenum != 1) ? 1 : 0;
     fdata->prev_dis_num = prev_dis_num;
@@ -759,6 +796,9 @@ sharkd_filter(const char *dftext, guint8 **result)
                      frame_tvbuff_new_buffer(&cfile.provider, fdata, &buf),
                      fdata, NULL);
 
+    if (index_frame)
+      field_index_add(cfile.field_index, &edt, framenum);
+
     if (dfilter_apply_edt(dfcode, &edt)) {
       passed_bits |= (1 << (framenum % 8));
       prev_dis_num = framenum;
@@ -776,6 +816,7 @@ sharkd_filter(const char *dftext, guint8 **result)
   wtap_rec_cleanup(&rec);
   ws_buffer_free(&buf);
   epan_dissect_cleanup(&edt);
+  frame_set_free(candidates);
 
   dfilter_free(dfcode);
 
@@ -46,6 +46,7 @@
 #include <epan/follow.h>
 #include <epan/rtd_table.h>
 #include <epan/srt_table.h>
+#include <epan/dissector_prof.h>
 
 #include <epan/dissectors/packet-h225.h>
 #include <epan/rtp_pt.h>
@@ -605,6 +606,86 @@ sharkd_session_process_status(void)
 	json_dumper_finish(&dumper);
 }
 
+/**
+ * sharkd_session_process_dissector_prof()
+ *
+ * Process dissector_prof request
+ *
+ * Input:
+ *   (o) enable - "1" to start collecting a dissector profile, "0" to stop
+ *   (o) sample - when enabling, time only one packet out of this many, default: 1
+ *   (o) reset  - "1" to discard everything collected so far
+ *
+ * Profiling covers all dissection done after it was enabled, e.g. by a following "load" or "tap" request.
+ *
+ * Output object with attributes:
+ *   (m) enabled - 1 if profiling is on, 0 otherwise
+ *   (m) packets - number of packets dissected while profiling
+ *   (m) sampled - number of those packets which were timed
+ *   (m) protos  - array of protocols, sorted by exclusive time, with attributes:
+ *                  proto      - protocol filter name
+ *                  calls      - number of dissector calls
+ *                  incl_us    - estimated time spent in dissector and its subdissectors, in microseconds
+ *                  excl_us    - estimated time spent in dissector itself, in microseconds
+ *                  incl_bytes - estimated wmem allocations by dissector and its subdissectors
+ *                  excl_bytes - estimated wmem allocations by dissector itself
+ */
+static void
+sharkd_session_process_dissector_prof(char *buf, const jsmntok_t *tokens, int count)
+{
+	const char *tok_enable = json_find_attr(buf, tokens, count, "enable");
+	const char *tok_sample = json_find_attr(buf, tokens, count, "sample");
+	const char *tok_reset  = json_find_attr(buf, tokens, count, "reset");
+	guint32 sample_interval = 1;
+	guint64 packets, sampled_packets;
+	GArray *stats;
+	guint i;
+
+	if (tok_sample)
+	{
+		if (!ws_strtou32(tok_sample, NULL, &sample_interval) || sample_interval == 0)
+		{
+			sharkd_json_simple_reply(1, "Invalid sample parameter");
+			return;
+		}
+	}
+
+	if (tok_enable)
+		dissector_prof_enable(!strcmp(tok_enable, "1"), sample_interval);
+
+	if (tok_reset && !strcmp(tok_reset, "1"))
+		dissector_prof_reset();
+
+	stats = dissector_prof_snapshot();
+	dissector_prof_get_packet_counts(&packets, &sampled_packets);
+
+	json_dumper_begin_object(&dumper);
+	sharkd_json_value_anyf("enabled", "%d", dissector_prof_is_enabled() ? 1 : 0);
+	sharkd_json_value_anyf("packets", "%" G_GINT64_MODIFIER "u", packets);
+	sharkd_json_value_anyf("sampled", "%" G_GINT64_MODIFIER "u", sampled_packets);
+
+	sharkd_json_array_open("protos");
+	for (i = 0; i < stats->len; i++)
+	{
+		const dissector_prof_stat_t *stat = &g_array_index(stats, dissector_prof_stat_t, i);
+
+		json_dumper_begin_object(&dumper);
+		sharkd_json_value_string("proto", stat->proto_name);
+		sharkd_json_value_anyf("calls", "%" G_GINT64_MODIFIER "u", stat->calls);
+		sharkd_json_value_anyf("incl_us", "%.3f", stat->incl_usec);
+		sharkd_json_value_anyf("excl_us", "%.3f", stat->excl_usec);
+		sharkd_json_value_anyf("incl_bytes", "%" G_GINT64_MODIFIER "u", stat->incl_bytes);
+		sharkd_json_value_anyf("excl_bytes", "%" G_GINT64_MODIFIER "u", stat->excl_bytes);
+		json_dumper_end_object(&dumper);
+	}
+	sharkd_json_array_close();
+
+	json_dumper_end_object(&dumper);
+	json_dumper_finish(&dumper);
+
+	g_array_free(stats, TRUE);
+}
+
 struct sharkd_analyse_data
 {
 	GHashTable *protocols_set;
@@ -1515,6 +1596,7 @@ sharkd_session_process_tap_rtp_analyse_cb(void *tapdata)
  *                  (m) rxb   - RX bytes
  *                  (m) start - (relative) first packet time
  *                  (m) stop  - (relative) last packet time
+ *                  (o) errf  - maximum number of uncounted frames, when ctlimit is used
  *                  (o) filter - conversation filter
  *
  *   (o) hosts      - array of object with attributes:
@@ -1524,6 +1606,9 @@ sharkd_session_process_tap_rtp_analyse_cb(void *tapdata)
  *                  (m) txb  - TX bytes
  *                  (m) rxf  - RX frame count
  *                  (m) rxb  - RX bytes
+ *                  (o) errf - maximum number of uncounted frames, when ctlimit is used
+ *
+ *   (o) evicted    - number of entries replaced to stay within ctlimit
  */
 static void
 sharkd_session_process_tap_conv_cb(void *arg)
@@ -1591,6 +1676,9 @@ sharkd_session_process_tap_conv_cb(void *arg)
 			sharkd_json_value_anyf("start", "%.9f", nstime_to_sec(&iui->start_time));
 			sharkd_json_value_anyf("stop", "%.9f", nstime_to_sec(&iui->stop_time));
 
+			if (iui->error_frames)
+				sharkd_json_value_anyf("errf", "%" G_GUINT64_FORMAT, iui->error_frames);
+
 			filter_str = get_conversation_filter(iui, CONV_DIR_A_TO_FROM_B);
 			if (filter_str)
 			{
@@ -1634,6 +1722,9 @@ sharkd_session_process_tap_conv_cb(void *arg)
 			sharkd_json_value_anyf("txf", "%" G_GUINT64_FORMAT, host->tx_frames);
 			sharkd_json_value_anyf("txb", "%" G_GUINT64_FORMAT, host->tx_bytes);
 
+			if (host->error_frames)
+				sharkd_json_value_anyf("errf", "%" G_GUINT64_FORMAT, host->error_frames);
+
 			filter_str = get_hostlist_filter(host);
 			if (filter_str)
 			{
@@ -1652,6 +1743,8 @@ sharkd_session_process_tap_conv_cb(void *arg)
 
 	sharkd_json_value_string("proto", proto);
 	sharkd_json_value_anyf("geoip", with_geoip ? "true" : "false");
+	if (iu->hash.max_entries)
+		sharkd_json_value_anyf("evicted", "%" G_GUINT64_FORMAT, iu->hash.evicted);
 
 	json_dumper_end_object(&dumper);
 }
@@ -2153,6 +2246,8 @@ sharkd_session_process_tap_rtp_cb(void *arg)
  * Input:
  *   (m) tap0         - First tap request
  *   (o) tap1...tap15 - Other tap requests
+ *   (o) ctlimit      - maximum number of entries kept by conv: and endpt: taps, keeping
+ *                      the ones with most frames (default: no limit)
  *
  * Output object with attributes:
  *   (m) taps  - array of object with attributes:
@@ -2184,6 +2279,15 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
 	rtpstream_tapinfo_t rtp_tapinfo =
 		{ NULL, NULL, NULL, NULL, 0, NULL, 0, TAP_ANALYSE, NULL, NULL, NULL, FALSE };
 
+	const char *tok_ctlimit = json_find_attr(buf, tokens, count, "ctlimit");
+	guint32 ct_max_entries = 0;
+
+	if (tok_ctlimit && !ws_strtou32(tok_ctlimit, NULL, &ct_max_entries))
+	{
+		fprintf(stderr, "sharkd_session_process_tap() invalid ctlimit %s\n", tok_ctlimit);
+		ct_max_entries = 0;
+	}
+
 	for (i = 0; i < 16; i++)
 	{
 		char tapbuf[32];
@@ -2299,6 +2403,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
 			ct_data = (struct sharkd_conv_tap_data *) g_malloc0(sizeof(struct sharkd_conv_tap_data));
 			ct_data->type = tok_tap;
 			ct_data->hash.user_data = ct_data;
+			conversation_table_set_max_entries(&ct_data->hash, ct_max_entries);
 
 			/* XXX: make configurable */
 			ct_data->resolve_name = TRUE;
@@ -4195,6 +4300,8 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
 			sharkd_session_process_load(buf, tokens, count);
 		else if (!strcmp(tok_req, "status"))
 			sharkd_session_process_status();
+		else if (!strcmp(tok_req, "dissector_prof"))
+			sharkd_session_process_dissector_prof(buf, tokens, count);
 		else if (!strcmp(tok_req, "analyse"))
 			sharkd_session_process_analyse();
 		else if (!strcmp(tok_req, "info"))
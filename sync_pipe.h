@@ -47,12 +47,33 @@
 #define SP_DROPS        'D'     /* count of packets dropped in capture */
 #define SP_SUCCESS      'S'     /* success indication, no extra data */
 #define SP_TOOLBAR_CTRL 'T'     /* interface toolbar control packet */
+#define SP_SHM_RING     'R'     /* the name of the shared memory packet ring */
 /*
  * Win32 only: Indications sent out on the signal pipe (from parent to child)
  * (UNIX-like sends signals for this)
  */
 #define SP_QUIT         'Q'     /* "gracefully" capture quit message (SIGUSR1) */
 
+/*
+ * With --shm-ring, dumpcap also puts each packet it writes to the capture
+ * file into a shared memory ring (see wsutil/shm_ring.h) whose name it
+ * sends in an SP_SHM_RING message before the SP_FILE message, so that the
+ * parent can dissect packets without reading them back from the file.
+ * SP_PACKET_COUNT messages still say when packets are available. Each
+ * record in the ring is this header followed by the packet data, in the
+ * host's byte order.
+ */
+typedef struct {
+    gint64  ts_secs;
+    guint32 ts_nsecs;
+    guint32 interface_id;
+    guint32 caplen;
+    guint32 len;
+} sp_ring_packet_hdr;
+
+/* Size of the ring dumpcap creates */
+#define SP_SHM_RING_SIZE (32 * 1024 * 1024)
+
 /* write a single message header to the recipient pipe */
 extern ssize_t
 pipe_write_header(int pipe_fd, char indicator, int length);
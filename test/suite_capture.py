@@ -14,6 +14,7 @@ import glob
 import hashlib
 import os
 import socket
+import struct
 import subprocess
 import subprocesstest
 import sys
@@ -468,6 +469,81 @@ def check_dumpcap_pcapng_sections(cmd_dumpcap, cmd_tshark, capture_file):
     return check_dumpcap_pcapng_sections_real
 
 
+@fixtures.fixture
+def check_tshark_shm_ring(cmd_tshark, capture_file, test_env):
+    if sys.platform == 'win32':
+        fixtures.skip('Test requires OS fifo support.')
+    def check_tshark_shm_ring_real(self, in_files_l, ring_size=None):
+        # Capture with TShark from one fifo per list of files, asking
+        # dumpcap for the shared memory ring. A small ring makes dumpcap
+        # overflow it, so that TShark falls back to the capture file.
+        env = test_env.copy()
+        if ring_size:
+            env['WIRESHARK_SHM_RING_SIZE'] = str(ring_size)
+        fifo_files = []
+        fifo_procs = []
+        for in_files in in_files_l:
+            fifo_file = self.filename_from_id('tshark_shm_ring_{}.fifo'.format(len(fifo_files) + 1))
+            fifo_files.append(fifo_file)
+            # If a previous test left its fifo laying around, e.g. from a failure, remove it.
+            try:
+                os.unlink(fifo_file)
+            except: pass
+            os.mkfifo(fifo_file)
+            cat_cmd = subprocesstest.cat_cap_file_command([capture_file(f) for f in in_files])
+            fifo_procs.append(self.startProcess(('{0} > {1}'.format(cat_cmd, fifo_file)), shell=True))
+
+        capture_cmd_args = ['--shm-ring']
+        for fifo_file in fifo_files:
+            capture_cmd_args += ['-i', fifo_file]
+        capture_cmd_args += ['-T', 'fields', '-e', 'frame.len']
+        capture_proc = self.assertRun(capture_command(cmd_tshark, *capture_cmd_args), env=env)
+        for fifo_proc in fifo_procs: fifo_proc.kill()
+
+        # Every packet must be dissected once, in the order it was written.
+        expected = []
+        for in_files in in_files_l:
+            for in_file in in_files:
+                read_proc = self.assertRun((cmd_tshark,
+                    '-r', capture_file(in_file),
+                    '-T', 'fields', '-e', 'frame.len'
+                    ), env=env)
+                expected += read_proc.stdout_str.split()
+        captured = capture_proc.stdout_str.split()
+        if len(in_files_l) > 1:
+            # Packets from several fifos are interleaved.
+            expected.sort()
+            captured.sort()
+        self.assertEqual(captured, expected)
+    return check_tshark_shm_ring_real
+
+
+@fixtures.fixture
+def check_dumpcap_index(cmd_dumpcap, cmd_capinfos, capture_file):
+    def check_dumpcap_index_real(self, in_file, indexed):
+        # dumpcap ends the pcapng files it writes with a packet index
+        # block, unless it passes pcapng blocks from its source through.
+        testout_file = self.filename_from_id(testout_pcapng)
+        cat_cmd = subprocesstest.cat_cap_file_command(capture_file(in_file))
+        capture_cmd = capture_command(cmd_dumpcap, '-i', '-', '-w', testout_file, shell=True)
+        self.assertRun(cat_cmd + ' | ' + capture_cmd, shell=True)
+        with open(testout_file, 'rb') as f:
+            # dumpcap writes in host byte order.
+            f.seek(-4, os.SEEK_END)
+            trailer_len, = struct.unpack('=I', f.read(4))
+            f.seek(-trailer_len, os.SEEK_END)
+            block_type, block_len, flags = struct.unpack('=III', f.read(12))
+        self.assertEqual(block_type == 0x80574958 and (flags & 1) == 1, indexed)
+
+        # capinfos takes the count from the index, and it must be right.
+        counts = []
+        for cap_file in (capture_file(in_file), testout_file):
+            proc = self.assertRun((cmd_capinfos, '-T', '-r', '-c', cap_file))
+            counts.append(proc.stdout_str.split()[-1])
+        self.assertEqual(counts[0], counts[1])
+    return check_dumpcap_index_real
+
+
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
 class case_wireshark_capture(subprocesstest.SubprocessTestCase):
@@ -520,6 +596,22 @@ class case_tshark_capture(subprocesstest.SubprocessTestCase):
         '''Capture truncated packets using TShark'''
         check_capture_snapshot_len(self, cmd=cmd_tshark)
 
+    def test_tshark_capture_shm_ring(self, check_tshark_shm_ring):
+        '''Capture from a pcap fifo using TShark and the shared memory ring'''
+        check_tshark_shm_ring(self, [ [ 'http2-data-reassembly.pcap' ] ])
+
+    def test_tshark_capture_shm_ring_fall_back(self, check_tshark_shm_ring):
+        '''Capture using TShark and a shared memory ring that overflows'''
+        # The capture has packets bigger than the ring.
+        check_tshark_shm_ring(self, [ [ 'http2-data-reassembly.pcap' ] ], ring_size=4096)
+
+    def test_tshark_capture_shm_ring_pcapng_sources(self, check_tshark_shm_ring):
+        '''Capture from pcap and pcapng fifos using TShark and --shm-ring'''
+        check_tshark_shm_ring(self, [
+            [ 'http2-data-reassembly.pcap' ],
+            [ 'many_interfaces.pcapng.1', 'many_interfaces.pcapng.2' ]
+            ])
+
 
 @fixtures.mark_usefixtures('base_env')
 @fixtures.uses_fixtures
@@ -544,6 +636,14 @@ class case_dumpcap_capture(subprocesstest.SubprocessTestCase):
         '''Capture truncated packets using Dumpcap'''
         check_capture_snapshot_len(self, cmd=cmd_dumpcap)
 
+    def test_dumpcap_capture_index(self, check_dumpcap_index):
+        '''Dumpcap indexes the packets it writes'''
+        check_dumpcap_index(self, 'dhcp.pcap', True)
+
+    def test_dumpcap_capture_index_pcapng_source(self, check_dumpcap_index):
+        '''Dumpcap doesn't index pcapng blocks it passes through'''
+        check_dumpcap_index(self, 'dhcp.pcapng', False)
+
 
 @fixtures.mark_usefixtures('base_env')
 @fixtures.uses_fixtures
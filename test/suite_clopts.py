@@ -9,6 +9,7 @@
 #
 '''Command line option tests'''
 
+import hashlib
 import json
 import sys
 import os.path
@@ -16,6 +17,7 @@ import subprocess
 import subprocesstest
 import fixtures
 import shutil
+import struct
 
 #glossaries = ('fields', 'protocols', 'values', 'decodes', 'defaultprefs', 'currentprefs')
 
@@ -284,6 +286,57 @@ class case_tshark_z_expert(subprocesstest.SubprocessTestCase):
         self.assertFalse(self.grepOutput('Chats'))
 
 
+@fixtures.uses_fixtures
+class case_capinfos_options(subprocesstest.SubprocessTestCase):
+    def test_capinfos_table_multiple_files(self, cmd_capinfos, capture_file):
+        # Files are processed in parallel but must be reported in order.
+        cap_files = [capture_file(name) for name in (
+            'dhcp.pcap', 'http.pcap', 'dns+icmp.pcapng.gz', 'sip.pcapng',
+            'dhcp.pcapng', 'http-ooo.pcap')]
+        proc = self.assertRun([cmd_capinfos, '-T', '-r', '-c', '-H', '-m'] + cap_files)
+        rows = [line.split(',') for line in proc.stdout_str.splitlines()]
+        self.assertEqual([row[0] for row in rows], cap_files)
+        for row, cap_file in zip(rows, cap_files):
+            with open(cap_file, 'rb') as f:
+                data = f.read()
+            self.assertEqual(row[2], hashlib.sha256(data).hexdigest())
+            self.assertEqual(row[4], hashlib.sha1(data).hexdigest())
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_tshark_first_pass_chunks(subprocesstest.SubprocessTestCase):
+    def write_big_pcap(self, path):
+        # Big enough for the file to be split into several 16 MB chunks.
+        with open(path, 'wb') as f:
+            f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+            for i in range(50000):
+                length = 600 + (i * 7919) % 1400
+                f.write(struct.pack('<IIII', 1500000000 + i // 100, (i % 100) * 10000, length, length))
+                f.write(bytes([i % 256]) * length)
+
+    def test_tshark_two_pass_chunked_matches_sequential(self, cmd_tshark, cmd_capinfos):
+        # Without dissection the first pass reads the file in chunks on
+        # several threads; a packet count limit makes it read sequentially.
+        # (With a single processor, both read sequentially.)
+        big_pcap = self.filename_from_id('big.pcap')
+        self.write_big_pcap(big_pcap)
+        chunked_pcap = self.filename_from_id('chunked.pcap')
+        sequential_pcap = self.filename_from_id('sequential.pcap')
+        self.assertRun((cmd_tshark, '-2', '-r', big_pcap, '-w', chunked_pcap))
+        self.assertRun((cmd_tshark, '-2', '-c', '1000000', '-r', big_pcap, '-w', sequential_pcap))
+        summaries = []
+        for out_pcap in (chunked_pcap, sequential_pcap):
+            proc = self.assertRun((cmd_capinfos, '-T', '-r', '-m', '-c', '-d', '-u', '-a', '-e', out_pcap))
+            summaries.append(proc.stdout_str.split(',', 1)[1])
+        self.assertEqual(summaries[0], summaries[1])
+        self.assertTrue(summaries[0].startswith('50000,'))
+        with open(chunked_pcap, 'rb') as f:
+            chunked_data = f.read()
+        with open(sequential_pcap, 'rb') as f:
+            self.assertEqual(chunked_data, f.read())
+
+
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
 class case_tshark_extcap(subprocesstest.SubprocessTestCase):
@@ -10,6 +10,7 @@
 '''File format conversion tests'''
 
 import os.path
+import struct
 import subprocesstest
 import unittest
 import fixtures
@@ -29,6 +30,34 @@ def fileformats_baseline_str(dirs):
         return f.read()
 
 
+def write_timed_pcap(path, count, per_second, length):
+    '''Write a pcap file whose packets are in time order, starting at
+    2017-07-14 02:40:00 UTC, with per_second packets in each second.'''
+    with open(path, 'wb') as f:
+        f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+        for i in range(count):
+            usecs = (i % per_second) * (1000000 // per_second)
+            f.write(struct.pack('<IIII', 1500000000 + i // per_second, usecs, length, length))
+            f.write(bytes([i % 256]) * length)
+
+
+def write_timed_pcapng(path, untimed, count, per_second, length):
+    '''Write a pcapng file with untimed Simple Packet Blocks, which have no
+    time stamps, followed by count Enhanced Packet Blocks in time order,
+    starting at 2017-07-14 02:40:00 UTC, with per_second in each second.'''
+    padded = (length + 3) & ~3
+    data = bytes(length) + bytes(padded - length)
+    with open(path, 'wb') as f:
+        f.write(struct.pack('<IIIHHqI', 0x0a0d0d0a, 28, 0x1a2b3c4d, 1, 0, -1, 28))
+        f.write(struct.pack('<IIHHII', 1, 20, 1, 0, 65535, 20))
+        for i in range(untimed):
+            f.write(struct.pack('<III', 3, 16 + padded, length) + data + struct.pack('<I', 16 + padded))
+        for i in range(count):
+            usecs = (1500000000 + i // per_second) * 1000000 + (i % per_second) * (1000000 // per_second)
+            f.write(struct.pack('<IIIIIII', 6, 32 + padded, 0, usecs >> 32, usecs & 0xffffffff, length, length))
+            f.write(data + struct.pack('<I', 32 + padded))
+
+
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
 class case_fileformat_pcap(subprocesstest.SubprocessTestCase):
@@ -247,3 +276,137 @@ class case_fileformat_mime(subprocesstest.SubprocessTestCase):
                 '-Tfields', '-e', 'frame.len', '-e', 'pcapng.block.length',
             ))
         self.assertEqual(proc.stdout_str.strip(), '480\t128,128,88,88,132,132,132,132')
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_fileformat_time_window(subprocesstest.SubprocessTestCase):
+    def read_frame_numbers(self, cmd_tshark, cap_file, rfilter, *args):
+        proc = self.assertRun((cmd_tshark, '-2', '-r', cap_file, '-R', rfilter)
+            + args + ('-Tfields', '-e', 'frame.number'))
+        return [int(n) for n in proc.stdout_str.split()]
+
+    def test_read_time_window_and(self, cmd_tshark):
+        '''Both bounds of an "and" are used; frames are numbered from the window.'''
+        cap_file = self.filename_from_id('timed.pcap')
+        write_timed_pcap(cap_file, 100, 1, 60)
+        rfilter = 'frame.time >= "Jul 14, 2017 02:40:10" && frame.time < "Jul 14, 2017 02:40:20"'
+        self.assertEqual(self.read_frame_numbers(cmd_tshark, cap_file, rfilter),
+            list(range(11, 21)))
+        self.assertEqual(self.read_frame_numbers(cmd_tshark, cap_file, rfilter, '--read-time-window'),
+            list(range(1, 11)))
+
+    def test_read_time_window_constant_first(self, cmd_tshark):
+        cap_file = self.filename_from_id('timed.pcap')
+        write_timed_pcap(cap_file, 100, 1, 60)
+        rfilter = '"Jul 14, 2017 02:41:30" <= frame.time && frame.time <= "Jul 14, 2017 02:41:35"'
+        self.assertEqual(self.read_frame_numbers(cmd_tshark, cap_file, rfilter, '--read-time-window'),
+            list(range(1, 7)))
+
+    def test_read_time_window_or(self, cmd_tshark):
+        '''Neither side of an "or" has to hold, so nothing is skipped.'''
+        cap_file = self.filename_from_id('timed.pcap')
+        write_timed_pcap(cap_file, 100, 1, 60)
+        rfilter = 'frame.time < "Jul 14, 2017 02:40:05" || frame.time >= "Jul 14, 2017 02:41:35"'
+        expected = list(range(1, 6)) + list(range(96, 101))
+        self.assertEqual(self.read_frame_numbers(cmd_tshark, cap_file, rfilter), expected)
+        self.assertEqual(self.read_frame_numbers(cmd_tshark, cap_file, rfilter, '--read-time-window'),
+            expected)
+
+    def test_read_time_window_not(self, cmd_tshark):
+        '''A negated comparison doesn't bound the window.'''
+        cap_file = self.filename_from_id('timed.pcap')
+        write_timed_pcap(cap_file, 100, 1, 60)
+        rfilter = '!(frame.time < "Jul 14, 2017 02:40:10") && frame.time < "Jul 14, 2017 02:40:20"'
+        expected = list(range(11, 21))
+        self.assertEqual(self.read_frame_numbers(cmd_tshark, cap_file, rfilter), expected)
+        self.assertEqual(self.read_frame_numbers(cmd_tshark, cap_file, rfilter, '--read-time-window'),
+            expected)
+
+    def test_read_time_window_requires_read_filter(self, cmd_tshark, capture_file):
+        self.assertRun((cmd_tshark, '-2', '-r', capture_file('dhcp.pcap'), '--read-time-window'),
+            expected_return=self.exit_command_line)
+
+    def test_editcap_time_ordered_seek(self, cmd_editcap, cmd_capinfos):
+        '''--time-ordered lets editcap binary search a pcap file for -A.'''
+        # Well over the size below which the search reads linearly.
+        cap_file = self.filename_from_id('timed.pcap')
+        write_timed_pcap(cap_file, 3000, 10, 600)
+        for start, stop, count in (
+                ('2017-07-14 02:41:00', '2017-07-14 02:42:00', 600),
+                ('2017-07-14 02:39:00', '2017-07-14 02:40:01', 10),
+                ('2017-07-14 02:44:50', '2017-07-14 02:46:00', 100),
+                ('2017-07-14 02:46:00', '2017-07-14 02:47:00', 0)):
+            searched_pcap = self.filename_from_id('searched.pcap')
+            read_pcap = self.filename_from_id('read.pcap')
+            self.assertRun((cmd_editcap, '--time-ordered', '-A', start, '-B', stop,
+                cap_file, searched_pcap))
+            self.assertRun((cmd_editcap, '-A', start, '-B', stop, cap_file, read_pcap))
+            with open(searched_pcap, 'rb') as f:
+                searched_data = f.read()
+            with open(read_pcap, 'rb') as f:
+                self.assertEqual(searched_data, f.read())
+            proc = self.assertRun((cmd_capinfos, '-T', '-r', '-c', searched_pcap))
+            self.assertEqual(proc.stdout_str.split()[-1], str(count))
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_fileformat_pcapng_index(subprocesstest.SubprocessTestCase):
+    def write_indexed(self, cmd_editcap):
+        plain_pcapng = self.filename_from_id('plain.pcapng')
+        indexed_pcapng = self.filename_from_id('indexed.pcapng')
+        # Several runs of records, the first starting with records that
+        # have no time stamps.
+        write_timed_pcapng(plain_pcapng, 5, 3000, 10, 200)
+        self.assertRun((cmd_editcap, '--write-index', plain_pcapng, indexed_pcapng))
+        return plain_pcapng, indexed_pcapng
+
+    def test_pcapng_index_summary(self, cmd_editcap, cmd_capinfos):
+        '''capinfos takes its totals from the index, ignoring records without time stamps.'''
+        plain_pcapng, indexed_pcapng = self.write_indexed(cmd_editcap)
+        proc = self.assertRun((cmd_capinfos, '-T', '-r', '-m', '-S', '-c', '-d', '-a', '-e', indexed_pcapng))
+        summary = proc.stdout_str.strip().split(',')[1:]
+        self.assertEqual(summary[0], '3005')
+        self.assertEqual(summary[1], str(3005 * 200))
+        self.assertTrue(summary[2].startswith('1500000000.'))
+        self.assertTrue(summary[3].startswith('1500000299.9'))
+
+    def test_pcapng_index_read(self, cmd_tshark, cmd_editcap):
+        '''The index block isn't taken for a record.'''
+        plain_pcapng, indexed_pcapng = self.write_indexed(cmd_editcap)
+        packets = []
+        for cap_file in (plain_pcapng, indexed_pcapng):
+            proc = self.assertRun((cmd_tshark, '-r', cap_file,
+                '-Tfields', '-e', 'frame.number', '-e', 'frame.len'))
+            packets.append(proc.stdout_str)
+        self.assertEqual(packets[0], packets[1])
+        self.assertEqual(len(packets[1].splitlines()), 3005)
+
+    def test_pcapng_index_editcap_time_range(self, cmd_tshark, cmd_editcap):
+        '''editcap -A/-B skip runs using the index and keep the same packets.'''
+        plain_pcapng, indexed_pcapng = self.write_indexed(cmd_editcap)
+        packets = []
+        for cap_file in (plain_pcapng, indexed_pcapng):
+            out_pcapng = self.filename_from_id('out.pcapng')
+            self.assertRun((cmd_editcap, '-A', '2017-07-14 02:44:00', '-B', '2017-07-14 02:45:00',
+                cap_file, out_pcapng))
+            proc = self.assertRun((cmd_tshark, '-r', out_pcapng,
+                '-Tfields', '-e', 'frame.time_epoch', '-e', 'frame.len'))
+            packets.append(proc.stdout_str)
+        self.assertEqual(packets[0], packets[1])
+        self.assertEqual(len(packets[1].splitlines()), 600)
+
+    def test_pcapng_index_editcap_skip(self, cmd_tshark, cmd_editcap):
+        '''With packet numbers selected, editcap seeks with the index and says how far.'''
+        plain_pcapng, indexed_pcapng = self.write_indexed(cmd_editcap)
+        out_pcapng = self.filename_from_id('out.pcapng')
+        # Records are indexed in runs of 1024; the third run is the first
+        # with packets from 02:44:00 on.
+        self.assertRun((cmd_editcap, '-v', '-r', '-A', '2017-07-14 02:44:00', '-B', '2017-07-14 02:45:00',
+            indexed_pcapng, out_pcapng, '1-3005'))
+        self.assertTrue(self.grepOutput('Skipped 2048 packets using the index'))
+        proc = self.assertRun((cmd_tshark, '-r', out_pcapng, '-Tfields', '-e', 'frame.time_epoch'))
+        times = proc.stdout_str.split()
+        self.assertEqual(len(times), 600)
+        self.assertTrue(times[0].startswith('1500000240.'))
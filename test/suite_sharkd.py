@@ -86,6 +86,20 @@ class case_sharkd(subprocesstest.SubprocessTestCase):
                 "filename": "dhcp.pcap", "filesize": 1400},
         ))
 
+    def test_sharkd_req_dissector_prof(self, check_sharkd_session, capture_file):
+        check_sharkd_session((
+            {"req": "dissector_prof", "enable": "1"},
+            {"req": "load", "file": capture_file('dhcp.pcap')},
+            {"req": "dissector_prof", "enable": "0"},
+            {"req": "dissector_prof", "reset": "1"},
+        ), (
+            {"enabled": 1, "packets": 0, "sampled": 0, "protos": []},
+            {"err": 0},
+            {"enabled": 0, "packets": 4, "sampled": 4, "protos": MatchList(
+                MatchObject({"proto": "dhcp", "calls": 4}), match_element=any)},
+            {"enabled": 0, "packets": 0, "sampled": 0, "protos": []},
+        ))
+
     def test_sharkd_req_analyse(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"req": "load", "file": capture_file('dhcp.pcap')},
@@ -232,6 +246,42 @@ class case_sharkd(subprocesstest.SubprocessTestCase):
             },
         ))
 
+    def test_sharkd_req_tap_conv_limit(self, check_sharkd_session, capture_file):
+        # With room for one entry the two alternating conversations keep
+        # replacing each other; the survivor carries the error bound.
+        check_sharkd_session((
+            {"req": "load", "file": capture_file('dhcp.pcap')},
+            {"req": "tap", "tap0": "conv:Ethernet", "ctlimit": "1"},
+        ), (
+            {"err": 0},
+            {
+                "err": 0,
+                "taps": [
+                    {
+                        "tap": "conv:Ethernet",
+                        "type": "conv",
+                        "proto": "Ethernet",
+                        "geoip": MatchAny(bool),
+                        "evicted": 3,
+                        "convs": [
+                            {
+                                "saddr": MatchAny(str),
+                                "daddr": MatchAny(str),
+                                "rxf": 0,
+                                "rxb": 0,
+                                "txf": 1,
+                                "txb": MatchAny(int),
+                                "start": 0.070345,
+                                "stop": 0.070345,
+                                "errf": 3,
+                                "filter": "eth.addr==00:08:74:ad:f1:9b && eth.addr==00:0b:82:01:fc:42",
+                            }
+                        ],
+                    },
+                ]
+            },
+        ))
+
     def test_sharkd_req_follow_bad(self, check_sharkd_session, capture_file):
         # Unrecognized taps currently produce no output (not even err).
         check_sharkd_session((
@@ -459,4 +509,31 @@ class case_sharkd(subprocesstest.SubprocessTestCase):
         ), (
             {"err": 0},
             MatchAny(),
-        ))
\ No newline at end of file
+        ))
+    def test_sharkd_field_index(self, run_sharkd_session, capture_file):
+        '''The field index leaves out only frames filters and taps can't match.'''
+        def run_session(with_index):
+            commands = []
+            if with_index:
+                commands += [
+                    {"req": "setconf", "name": "gui.field_index", "value": "TRUE"},
+                    # dns.response_in is only added after the first pass.
+                    {"req": "setconf", "name": "gui.field_index.fields",
+                        "value": "udp.stream dns.response_in"},
+                ]
+            commands += [
+                {"req": "load", "file": capture_file('dns+icmp.pcapng.gz')},
+                # The first filter builds the index, and the rest use it.
+                {"req": "frames", "filter": "dns.response_in == 17"},
+                {"req": "frames", "filter": "dns.response_in == 17"},
+                {"req": "frames", "filter": "udp.stream == 2"},
+                {"req": "follow", "follow": "UDP", "filter": "udp.stream eq 2"},
+            ]
+            outputs = run_sharkd_session([json.dumps(x) for x in commands])
+            return outputs[len(commands) - 5:]
+
+        plain_outputs = run_session(False)
+        indexed_outputs = run_session(True)
+        self.assertEqual([frame["num"] for frame in indexed_outputs[1]], [16])
+        self.assertEqual(indexed_outputs[1], indexed_outputs[2])
+        self.assertEqual(indexed_outputs, plain_outputs)
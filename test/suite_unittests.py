@@ -24,10 +24,18 @@ class case_unittests(subprocesstest.SubprocessTestCase):
         '''exntest'''
         self.assertRun(program('exntest'), env=base_env)
 
+    def test_unit_frame_set_test(self, program, base_env):
+        '''frame_set_test'''
+        self.assertRun(program('frame_set_test'), env=base_env)
+
     def test_unit_oids_test(self, program, base_env):
         '''oids_test'''
         self.assertRun(program('oids_test'), env=base_env)
 
+    def test_unit_proto_data_test(self, program, base_env):
+        '''proto_data_test'''
+        self.assertRun(program('proto_data_test'), env=base_env)
+
     def test_unit_reassemble_test(self, program, base_env):
         '''reassemble_test'''
         self.assertRun(program('reassemble_test'), env=base_env)
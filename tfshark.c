@@ -1016,6 +1016,8 @@ tfshark_epan_new(capture_file *cf)
     no_interface_name,
     NULL,
     NULL,
+    NULL,
+    cap_file_provider_get_frame_file_off,
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -1039,7 +1041,8 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
      that all packets can be marked as 'passed'. */
   passed = TRUE;
 
-  frame_data_init(&fdlocal, framenum, rec, offset, cum_bytes);
+  frame_data_init(&fdlocal, framenum, rec, cum_bytes);
+  cf->provider.cur_file_off = offset;
 
   /* If we're going to print packet information, or we're going to
      run a read filter, or display filter, or we're going to process taps, set up to
@@ -1072,7 +1075,7 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
 
   if (passed) {
     frame_data_set_after_dissect(&fdlocal, &cum_bytes);
-    cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal);
+    cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal, offset);
 
     /* If we're not doing dissection then there won't be any dependent frames.
      * More importantly, edt.pi.dependent_frames won't be initialized because
@@ -1369,7 +1372,8 @@ process_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
     for (framenum = 1; err == 0 && framenum <= cf->count; framenum++) {
       fdata = frame_data_sequence_find(cf->provider.frames, framenum);
 #if 0
-      if (wtap_seek_read(cf->provider.wth, fdata->file_off,
+      if (wtap_seek_read(cf->provider.wth,
+          frame_data_sequence_get_file_off(cf->provider.frames, framenum),
           &buf, fdata->cap_len, &err, &err_info)) {
         process_packet_second_pass(cf, edt, fdata, &cf->rec, &buf, tap_flags);
       }
@@ -1553,7 +1557,8 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
      that all packets can be marked as 'passed'. */
   passed = TRUE;
 
-  frame_data_init(&fdata, cf->count, rec, offset, cum_bytes);
+  frame_data_init(&fdata, cf->count, rec, cum_bytes);
+  cf->provider.cur_file_off = offset;
 
   /* If we're going to print packet information, or we're going to
      run a read filter, or we're going to process taps, set up to
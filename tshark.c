@@ -47,6 +47,7 @@
 
 #include <ui/clopts_common.h>
 #include <ui/cmdarg_err.h>
+#include <wsutil/cpu_info.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/file_util.h>
 #include <wsutil/socket.h>
@@ -144,6 +145,7 @@
 #define LONGOPT_COLOR (65536+1000)
 #define LONGOPT_NO_DUPLICATE_KEYS (65536+1001)
 #define LONGOPT_ELASTIC_MAPPING_FILTER (65536+1002)
+#define LONGOPT_READ_TIME_WINDOW (65536+1003)
 
 #if 0
 #define tshark_debug(...) g_warning(__VA_ARGS__)
@@ -185,6 +187,7 @@ static gboolean line_buffered;
 static gboolean really_quiet = FALSE;
 static gchar* delimiter_char = " ";
 static gboolean dissect_color = FALSE;
+static gboolean read_time_window = FALSE;
 
 static print_format_e print_format = PR_FMT_TEXT;
 static print_stream_t *print_stream = NULL;
@@ -243,7 +246,7 @@ typedef enum {
 static process_file_status_t process_cap_file(capture_file *, char *, int, gboolean, int, gint64);
 
 static gboolean process_packet_single_pass(capture_file *cf,
-    epan_dissect_t *edt, gint64 offset, wtap_rec *rec, Buffer *buf,
+    epan_dissect_t *edt, gint64 offset, wtap_rec *rec, const guint8 *pd,
     guint tap_flags);
 static void show_print_file_io_error(int err);
 static gboolean write_preamble(capture_file *cf);
@@ -360,6 +363,7 @@ print_usage(FILE *output)
   fprintf(output, "                           interval:NUM - create time intervals of NUM secs\n");
   fprintf(output, "                           filesize:NUM - switch to next file after NUM KB\n");
   fprintf(output, "                              files:NUM - ringbuffer: replace after NUM files\n");
+  fprintf(output, "  --shm-ring               get packets from dumpcap through shared memory\n");
 #endif  /* HAVE_LIBPCAP */
 #ifdef HAVE_PCAP_REMOTE
   fprintf(output, "RPCAP options:\n");
@@ -375,6 +379,8 @@ print_usage(FILE *output)
   fprintf(output, "  -M <packet count>        perform session auto reset\n");
   fprintf(output, "  -R <read filter>         packet Read filter in Wireshark display filter syntax\n");
   fprintf(output, "                           (requires -2)\n");
+  fprintf(output, "  --read-time-window       skip packets outside the frame.time range the read\n");
+  fprintf(output, "                           filter allows without dissecting them\n");
   fprintf(output, "  -Y <display filter>      packet displaY filter in Wireshark display filter\n");
   fprintf(output, "                           syntax\n");
   fprintf(output, "  -n                       disable all name resolutions (def: all enabled)\n");
@@ -694,6 +700,10 @@ main(int argc, char *argv[])
     {"color", no_argument, NULL, LONGOPT_COLOR},
     {"no-duplicate-keys", no_argument, NULL, LONGOPT_NO_DUPLICATE_KEYS},
     {"elastic-mapping-filter", required_argument, NULL, LONGOPT_ELASTIC_MAPPING_FILTER},
+    {"read-time-window", no_argument, NULL, LONGOPT_READ_TIME_WINDOW},
+#ifdef HAVE_LIBPCAP
+    {"shm-ring", no_argument, NULL, LONGOPT_SHM_RING},
+#endif
     {0, 0, 0, 0 }
   };
   gboolean             arg_error = FALSE;
@@ -1447,6 +1457,14 @@ main(int argc, char *argv[])
       no_duplicate_keys = TRUE;
       node_children_grouper = proto_node_group_children_by_json_key;
       break;
+    case LONGOPT_READ_TIME_WINDOW:
+      read_time_window = TRUE;
+      break;
+#ifdef HAVE_LIBPCAP
+    case LONGOPT_SHM_RING:
+      global_capture_opts.use_shm_ring = TRUE;
+      break;
+#endif
     default:
     case '?':        /* Bad flag - print usage message */
       switch(optopt) {
@@ -1604,6 +1622,12 @@ main(int argc, char *argv[])
     goto clean_exit;
   }
 
+  if (read_time_window && rfilter == NULL) {
+    cmdarg_err("--read-time-window requires a read filter (-R).");
+    exit_status = INVALID_OPTION;
+    goto clean_exit;
+  }
+
 #ifdef HAVE_LIBPCAP
   if (caps_queries) {
     /* We're supposed to list the link-layer/timestamp types for an interface;
@@ -2012,6 +2036,22 @@ main(int argc, char *argv[])
       goto clean_exit;
     }
 
+    /* If asked to, and the read filter only matches packets in a time
+       range, have wiretap skip the records outside it, using the file's
+       packet index if it has one.  It isn't done by default: those
+       records are never dissected, so state that dissectors build up
+       from earlier packets, such as TCP sequence analysis or TLS
+       sessions, can differ. */
+    if (rfcode != NULL && read_time_window) {
+      nstime_t start_ts, stop_ts;
+
+      if (dfilter_get_time_bounds(rfcode, "frame.time", &start_ts, &stop_ts))
+        wtap_set_time_window(cfile.provider.wth,
+                             nstime_is_unset(&start_ts) ? NULL : &start_ts,
+                             nstime_is_unset(&stop_ts) ? NULL : &stop_ts,
+                             FALSE);
+    }
+
     /* Start statistics taps; we do so after successfully opening the
        capture file, so we know we have something to compute stats
        on, and after registering all dissectors, so that MATE will
@@ -2207,6 +2247,10 @@ main(int argc, char *argv[])
        starting the statistics taps. */
     do_dissection = must_do_dissection(rfcode, dfcode, pdu_export_arg);
 
+    /* If we aren't reading the packets, nobody would drain the ring. */
+    if (!do_dissection)
+      global_capture_opts.use_shm_ring = FALSE;
+
     /*
      * XXX - this returns FALSE if an error occurred, but it also
      * returns FALSE if the capture stops because a time limit
@@ -2409,6 +2453,8 @@ tshark_epan_new(capture_file *cf)
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
     NULL,
+    NULL,
+    cap_file_provider_get_frame_file_off,
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -2652,6 +2698,8 @@ capture_input_new_file(capture_session *cap_session, gchar *new_file)
     /* Attempt to open the capture file and set up to read from it. */
     switch(cf_open(cap_session->cf, capture_opts->save_file, WTAP_TYPE_AUTO, is_tempfile, &err)) {
     case CF_OK:
+      /* Take the packets from dumpcap's ring if we can. */
+      sync_pipe_ring_accept(cap_session, cap_session->cf->provider.wth);
       break;
     case CF_ERROR:
       /* Don't unlink (delete) the save file - leave it around,
@@ -2736,8 +2784,15 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
     ws_buffer_init(&buf, 1514);
 
     while (to_read-- && cf->provider.wth) {
-      wtap_cleareof(cf->provider.wth);
-      ret = wtap_read(cf->provider.wth, &rec, &buf, &err, &err_info, &data_offset);
+      if (sync_pipe_ring_read(cap_session, cf->provider.wth, &rec, &buf)) {
+        /* We don't read packets from the file again, so where they are in
+           it doesn't matter. */
+        ret = TRUE;
+        data_offset = 0;
+      } else {
+        wtap_cleareof(cf->provider.wth);
+        ret = wtap_read(cf->provider.wth, &rec, &buf, &err, &err_info, &data_offset);
+      }
       reset_epan_mem(cf, edt, create_proto_tree, print_packet_info && print_details);
       if (ret == FALSE) {
         /* read from file failed, tell the capture child to stop */
@@ -2745,8 +2800,8 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
         wtap_close(cf->provider.wth);
         cf->provider.wth = NULL;
       } else {
-        ret = process_packet_single_pass(cf, edt, data_offset, &rec, &buf,
-                                         tap_flags);
+        ret = process_packet_single_pass(cf, edt, data_offset, &rec,
+                                         ws_buffer_start_ptr(&buf), tap_flags);
       }
       if (ret != FALSE) {
         /* packet successfully read and gone through the "Read Filter" */
@@ -2921,7 +2976,7 @@ capture_cleanup(int signum _U_)
 
 static gboolean
 process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
-                          gint64 offset, wtap_rec *rec, Buffer *buf)
+                          gint64 offset, wtap_rec *rec, const guint8 *pd)
 {
   frame_data     fdlocal;
   guint32        framenum;
@@ -2936,7 +2991,8 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
      that all packets can be marked as 'passed'. */
   passed = TRUE;
 
-  frame_data_init(&fdlocal, framenum, rec, offset, cum_bytes);
+  frame_data_init(&fdlocal, framenum, rec, cum_bytes);
+  cf->provider.cur_file_off = offset;
 
   /* If we're going to run a read filter or a display filter, set up to
      do a dissection and do so.  (This is the first pass of two passes
@@ -2964,7 +3020,7 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
     }
 
     epan_dissect_run(edt, cf->cd_t, rec,
-                     frame_tvbuff_new_buffer(&cf->provider, &fdlocal, buf),
+                     frame_tvbuff_new(&cf->provider, &fdlocal, pd),
                      &fdlocal, NULL);
 
     /* Run the read filter if we have one. */
@@ -2974,7 +3030,7 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
 
   if (passed) {
     frame_data_set_after_dissect(&fdlocal, &cum_bytes);
-    cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal);
+    cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal, offset);
 
     /* If we're not doing dissection then there won't be any dependent frames.
      * More importantly, edt.pi.dependent_frames won't be initialized because
@@ -3053,12 +3109,81 @@ typedef enum {
   PASS_INTERRUPTED
 } pass_status_t;
 
+/* A frame read by one of the threads, and where it was read from */
+typedef struct {
+  frame_data fdata;
+  gint64     offset;
+} chunk_frame_t;
+
+/* wtap_read_chunks() callbacks; each chunk's data is a GArray of chunk_frame_t */
+static void
+first_pass_chunk_record(void *chunk_data, gint64 offset, wtap_rec *rec,
+                        const guint8 *pd _U_)
+{
+  chunk_frame_t frame;
+
+  frame_data_init(&frame.fdata, 0, rec, 0);
+  frame.offset = offset;
+  g_array_append_val((GArray *)chunk_data, frame);
+}
+
+static void
+first_pass_chunk_reset(void *chunk_data)
+{
+  g_array_set_size((GArray *)chunk_data, 0);
+}
+
+/*
+ * If we're not dissecting on the first pass, all it does is build the
+ * frame table, so have threads read different parts of the file at the
+ * same time and then number the frames here.  Returns FALSE, with *err
+ * set to 0, if the file can't be read that way.  If we're interrupted,
+ * no frames are added and read_interrupted is left set for the caller.
+ */
+static gboolean
+process_cap_file_first_pass_chunked(capture_file *cf, int *err, gchar **err_info)
+{
+  guint num_chunks = get_num_processors();
+  GArray **chunks;
+  chunk_frame_t *frame;
+  gboolean ok;
+  guint i, j;
+
+  if (num_chunks < 2)
+    return FALSE;
+
+  chunks = g_new(GArray *, num_chunks);
+  for (i = 0; i < num_chunks; i++)
+    chunks[i] = g_array_new(FALSE, FALSE, sizeof(chunk_frame_t));
+
+  ok = wtap_read_chunks(cf->provider.wth, cf->filename, num_chunks,
+                        (void **)chunks, first_pass_chunk_record,
+                        first_pass_chunk_reset, &read_interrupted,
+                        err, err_info);
+  for (i = 0; i < num_chunks; i++) {
+    /* On a read error we keep what came before it, as wtap_read() would. */
+    if (ok || *err != 0) {
+      for (j = 0; j < chunks[i]->len; j++) {
+        frame = &g_array_index(chunks[i], chunk_frame_t, j);
+        frame->fdata.num = cf->count + 1;
+        frame_data_set_after_dissect(&frame->fdata, &cum_bytes);
+        cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &frame->fdata, frame->offset);
+        cf->count++;
+      }
+    }
+    g_array_free(chunks[i], TRUE);
+  }
+  g_free(chunks);
+  return ok || *err != 0 || read_interrupted;
+}
+
 static pass_status_t
 process_cap_file_first_pass(capture_file *cf, int max_packet_count,
                             gint64 max_byte_count, int *err, gchar **err_info)
 {
   wtap_rec        rec;
   Buffer          buf;
+  const guint8   *pd;
   epan_dissect_t *edt = NULL;
   gint64          data_offset;
   pass_status_t   status = PASS_SUCCEEDED;
@@ -3095,24 +3220,30 @@ process_cap_file_first_pass(capture_file *cf, int max_packet_count,
 
   tshark_debug("tshark: reading records for first pass");
   *err = 0;
-  while (wtap_read(cf->provider.wth, &rec, &buf, err, err_info, &data_offset)) {
-    if (read_interrupted) {
-      status = PASS_INTERRUPTED;
-      break;
-    }
-    if (process_packet_first_pass(cf, edt, data_offset, &rec, &buf)) {
-      /* Stop reading if we have the maximum number of packets;
-       * When the -c option has not been used, max_packet_count
-       * starts at 0, which practically means, never stop reading.
-       * (unless we roll over max_packet_count ?)
-       */
-      if ( (--max_packet_count == 0) || (max_byte_count != 0 && data_offset >= max_byte_count)) {
-        tshark_debug("tshark: max_packet_count (%d) or max_byte_count (%" G_GINT64_MODIFIER "d/%" G_GINT64_MODIFIER "d) reached",
-                      max_packet_count, data_offset, max_byte_count);
-        *err = 0; /* This is not an error */
+  /* Without dissection, the first pass can read the file in chunks. */
+  if (do_dissection || max_packet_count != 0 || max_byte_count != 0 ||
+      !process_cap_file_first_pass_chunked(cf, err, err_info)) {
+    while (wtap_read_borrowed(cf->provider.wth, &rec, &buf, &pd, err, err_info, &data_offset)) {
+      if (read_interrupted) {
+        status = PASS_INTERRUPTED;
         break;
       }
+      if (process_packet_first_pass(cf, edt, data_offset, &rec, pd)) {
+        /* Stop reading if we have the maximum number of packets;
+         * When the -c option has not been used, max_packet_count
+         * starts at 0, which practically means, never stop reading.
+         * (unless we roll over max_packet_count ?)
+         */
+        if ( (--max_packet_count == 0) || (max_byte_count != 0 && data_offset >= max_byte_count)) {
+          tshark_debug("tshark: max_packet_count (%d) or max_byte_count (%" G_GINT64_MODIFIER "d/%" G_GINT64_MODIFIER "d) reached",
+                        max_packet_count, data_offset, max_byte_count);
+          *err = 0; /* This is not an error */
+          break;
+        }
+      }
     }
+  } else if (read_interrupted) {
+    status = PASS_INTERRUPTED;
   }
   if (*err != 0)
     status = PASS_READ_ERROR;
@@ -3139,7 +3270,7 @@ process_cap_file_first_pass(capture_file *cf, int max_packet_count,
 static gboolean
 process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
                            frame_data *fdata, wtap_rec *rec,
-                           Buffer *buf, guint tap_flags)
+                           const guint8 *pd, guint tap_flags)
 {
   column_info    *cinfo;
   gboolean        passed;
@@ -3186,7 +3317,7 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
     }
 
     epan_dissect_run_with_taps(edt, cf->cd_t, rec,
-                               frame_tvbuff_new_buffer(&cf->provider, fdata, buf),
+                               frame_tvbuff_new(&cf->provider, fdata, pd),
                                fdata, cinfo);
 
     /* Run the read/display filter if we have one. */
@@ -3230,6 +3361,7 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
 {
   wtap_rec        rec;
   Buffer          buf;
+  const guint8   *pd;
   guint32         framenum;
   frame_data     *fdata;
   gboolean        filtering_tap_listeners;
@@ -3287,20 +3419,21 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
       break;
     }
     fdata = frame_data_sequence_find(cf->provider.frames, framenum);
-    if (!wtap_seek_read(cf->provider.wth, fdata->file_off, &rec, &buf, err,
-                        err_info)) {
+    if (!wtap_seek_read_borrowed(cf->provider.wth,
+                                 frame_data_sequence_get_file_off(cf->provider.frames, framenum),
+                                 &rec, &buf, &pd, err, err_info)) {
       /* Error reading from the input file. */
       status = PASS_READ_ERROR;
       break;
     }
     tshark_debug("tshark: invoking process_packet_second_pass() for frame #%d", framenum);
-    if (process_packet_second_pass(cf, edt, fdata, &rec, &buf, tap_flags)) {
+    if (process_packet_second_pass(cf, edt, fdata, &rec, pd, tap_flags)) {
       /* Either there's no read filtering or this packet passed the
          filter, so, if we're writing to a capture file, write
          this packet out. */
       if (pdh != NULL) {
         tshark_debug("tshark: writing packet #%d to outfile", framenum);
-        if (!wtap_dump(pdh, &rec, ws_buffer_start_ptr(&buf), err, err_info)) {
+        if (!wtap_dump(pdh, &rec, pd, err, err_info)) {
           /* Error writing to the output file. */
           tshark_debug("tshark: error writing to a capture file (%d)", *err);
           *err_framenum = framenum;
@@ -3328,6 +3461,7 @@ process_cap_file_single_pass(capture_file *cf, wtap_dumper *pdh,
 {
   wtap_rec        rec;
   Buffer          buf;
+  const guint8   *pd;
   gboolean create_proto_tree = FALSE;
   gboolean        filtering_tap_listeners;
   guint           tap_flags;
@@ -3390,7 +3524,7 @@ process_cap_file_single_pass(capture_file *cf, wtap_dumper *pdh,
   set_resolution_synchrony(TRUE);
 
   *err = 0;
-  while (wtap_read(cf->provider.wth, &rec, &buf, err, err_info, &data_offset)) {
+  while (wtap_read_borrowed(cf->provider.wth, &rec, &buf, &pd, err, err_info, &data_offset)) {
     if (read_interrupted) {
       status = PASS_INTERRUPTED;
       break;
@@ -3401,13 +3535,13 @@ process_cap_file_single_pass(capture_file *cf, wtap_dumper *pdh,
 
     reset_epan_mem(cf, edt, create_proto_tree, print_packet_info && print_details);
 
-    if (process_packet_single_pass(cf, edt, data_offset, &rec, &buf, tap_flags)) {
+    if (process_packet_single_pass(cf, edt, data_offset, &rec, pd, tap_flags)) {
       /* Either there's no read filtering or this packet passed the
          filter, so, if we're writing to a capture file, write
          this packet out. */
       if (pdh != NULL) {
         tshark_debug("tshark: writing packet #%d to outfile", framenum);
-        if (!wtap_dump(pdh, &rec, ws_buffer_start_ptr(&buf), err, err_info)) {
+        if (!wtap_dump(pdh, &rec, pd, err, err_info)) {
           /* Error writing to the output file. */
           tshark_debug("tshark: error writing to a capture file (%d)", *err);
           *err_framenum = framenum;
@@ -3688,7 +3822,7 @@ out:
 
 static gboolean
 process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
-                           wtap_rec *rec, Buffer *buf, guint tap_flags)
+                           wtap_rec *rec, const guint8 *pd, guint tap_flags)
 {
   frame_data      fdata;
   column_info    *cinfo;
@@ -3702,7 +3836,8 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
      that all packets can be marked as 'passed'. */
   passed = TRUE;
 
-  frame_data_init(&fdata, cf->count, rec, offset, cum_bytes);
+  frame_data_init(&fdata, cf->count, rec, cum_bytes);
+  cf->provider.cur_file_off = offset;
 
   /* If we're going to print packet information, or we're going to
      run a read filter, or we're going to process taps, set up to
@@ -3746,7 +3881,7 @@ process_packet_single_pass(capture_file *cf, epan_dissect_t *edt, gint64 offset,
     }
 
     epan_dissect_run_with_taps(edt, cf->cd_t, rec,
-                               frame_tvbuff_new_buffer(&cf->provider, &fdata, buf),
+                               frame_tvbuff_new(&cf->provider, &fdata, pd),
                                &fdata, cinfo);
 
     /* Run the filter if we have it. */
@@ -0,0 +1,122 @@
+/* tap-dissector_prof.c
+ * Per-dissector CPU and allocation profile for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* This module provides the "-z dissector,prof" statistic for tshark */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/dissector_prof.h>
+
+#include <wsutil/strtoi.h>
+
+#include <ui/cmdarg_err.h>
+
+void register_tap_listener_dissector_prof(void);
+
+/* The tap listener only exists to get a draw callback at the end. */
+static int dissector_prof_tapdata;
+
+static void
+dissector_prof_draw(void *tapdata _U_)
+{
+	GArray *stats;
+	guint64 packets, sampled_packets;
+	gdouble total_usec = 0.0;
+	guint i;
+
+	stats = dissector_prof_snapshot();
+	dissector_prof_get_packet_counts(&packets, &sampled_packets);
+
+	for (i = 0; i < stats->len; i++)
+		total_usec += g_array_index(stats, dissector_prof_stat_t, i).excl_usec;
+
+	printf("\n");
+	printf("========================================================================================================\n");
+	printf("Dissector Profile\n");
+	printf("Packets: %" G_GINT64_MODIFIER "u (%" G_GINT64_MODIFIER "u sampled)\n\n", packets, sampled_packets);
+	printf("%-20s %12s %12s %12s %7s %14s %14s\n",
+		"Protocol", "Calls", "Incl (ms)", "Excl (ms)", "Excl %", "Incl bytes", "Excl bytes");
+	for (i = 0; i < stats->len; i++) {
+		const dissector_prof_stat_t *stat = &g_array_index(stats, dissector_prof_stat_t, i);
+
+		printf("%-20s %12" G_GINT64_MODIFIER "u %12.3f %12.3f %6.2f%% %14" G_GINT64_MODIFIER "u %14" G_GINT64_MODIFIER "u\n",
+			stat->proto_name, stat->calls,
+			stat->incl_usec / 1000.0, stat->excl_usec / 1000.0,
+			total_usec > 0.0 ? 100.0 * stat->excl_usec / total_usec : 0.0,
+			stat->incl_bytes, stat->excl_bytes);
+	}
+	printf("========================================================================================================\n");
+
+	g_array_free(stats, TRUE);
+}
+
+static void
+dissector_prof_init(const char *opt_arg, void *userdata _U_)
+{
+	guint32 sample_interval = 1;
+	GString *error_string;
+
+	if (strcmp("dissector,prof", opt_arg) == 0) {
+		/* No arguments */
+	} else if (strncmp("dissector,prof,", opt_arg, 15) == 0) {
+		if (!ws_strtou32(opt_arg + 15, NULL, &sample_interval) || sample_interval == 0) {
+			cmdarg_err("invalid \"-z dissector,prof[,<sample interval>]\" argument");
+			exit(1);
+		}
+	} else {
+		cmdarg_err("invalid \"-z dissector,prof[,<sample interval>]\" argument");
+		exit(1);
+	}
+
+	error_string = register_tap_listener("frame", &dissector_prof_tapdata, NULL, 0, NULL, NULL, dissector_prof_draw, NULL);
+	if (error_string) {
+		cmdarg_err("Couldn't register dissector,prof tap: %s",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+
+	dissector_prof_enable(TRUE, sample_interval);
+}
+
+static stat_tap_ui dissector_prof_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"dissector,prof",
+	dissector_prof_init,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_dissector_prof(void)
+{
+	register_stat_tap_ui(&dissector_prof_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
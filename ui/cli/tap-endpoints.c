@@ -18,6 +18,7 @@
 #include <epan/tap.h>
 #include <epan/stat_tap_ui.h>
 #include <epan/conversation_table.h>
+#include <wsutil/strtoi.h>
 #include <ui/cmdarg_err.h>
 #include <ui/cli/tshark-tap.h>
 
@@ -40,6 +41,10 @@ endpoints_draw(void *arg)
 	printf("================================================================================\n");
 	printf("%s Endpoints\n", iu->type);
 	printf("Filter:%s\n", iu->filter ? iu->filter : "<No Filter>");
+	if (iu->hash.max_entries) {
+		printf("Top %u endpoints, %" G_GINT64_MODIFIER "u replaced; (+N) is the maximum number of uncounted packets\n",
+			iu->hash.max_entries, iu->hash.evicted);
+	}
 
 	printf("                       |  %sPackets  | |  Bytes  | | Tx Packets | | Tx Bytes | | Rx Packets | | Rx Bytes |\n",
 		display_port ? "Port  ||  " : "");
@@ -73,7 +78,7 @@ endpoints_draw(void *arg)
 					port_str = get_conversation_port(NULL, host->port, host->etype, TRUE);
 					printf("%-20s      %5s     %6" G_GINT64_MODIFIER "u     %9" G_GINT64_MODIFIER
 					       "u     %6" G_GINT64_MODIFIER "u       %9" G_GINT64_MODIFIER "u      %6"
-					       G_GINT64_MODIFIER "u       %9" G_GINT64_MODIFIER "u   \n",
+					       G_GINT64_MODIFIER "u       %9" G_GINT64_MODIFIER "u   ",
 						conversation_str,
 						port_str,
 						host->tx_frames+host->rx_frames, host->tx_bytes+host->rx_bytes,
@@ -83,7 +88,7 @@ endpoints_draw(void *arg)
 				} else {
 					printf("%-20s      %6" G_GINT64_MODIFIER "u     %9" G_GINT64_MODIFIER
 					       "u     %6" G_GINT64_MODIFIER "u       %9" G_GINT64_MODIFIER "u      %6"
-					       G_GINT64_MODIFIER "u       %9" G_GINT64_MODIFIER "u   \n",
+					       G_GINT64_MODIFIER "u       %9" G_GINT64_MODIFIER "u   ",
 						/* XXX - TODO: make name resolution configurable (through gbl_resolv_flags?) */
 						conversation_str,
 						host->tx_frames+host->rx_frames, host->tx_bytes+host->rx_bytes,
@@ -91,6 +96,9 @@ endpoints_draw(void *arg)
 						host->rx_frames, host->rx_bytes);
 
 				}
+				if (host->error_frames)
+					printf(" (+%" G_GINT64_MODIFIER "u)", host->error_frames);
+				printf("\n");
 				wmem_free(NULL, conversation_str);
 			}
 		}
@@ -99,15 +107,35 @@ endpoints_draw(void *arg)
 	printf("================================================================================\n");
 }
 
+/* Strip an optional "top=<entries>" in front of the filter. */
+static const char *
+endpoints_parse_top(const char *filter, guint32 *max_entries)
+{
+	const char *end;
+
+	if (!filter || strncmp(filter, "top=", 4) != 0)
+		return filter;
+
+	if (!ws_strtou32(filter + 4, &end, max_entries) || (*end != '\0' && *end != ',')) {
+		cmdarg_err("invalid \"-z endpoints,<type>[,top=<entries>][,<filter>]\" argument");
+		exit(1);
+	}
+	return *end == ',' ? end + 1 : NULL;
+}
+
 void init_hostlists(struct register_ct *ct, const char *filter)
 {
 	endpoints_t *iu;
 	GString *error_string;
+	guint32 max_entries = 0;
+
+	filter = endpoints_parse_top(filter, &max_entries);
 
 	iu = g_new0(endpoints_t, 1);
 	iu->type = proto_get_protocol_short_name(find_protocol_by_id(get_conversation_proto_id(ct)));
 	iu->filter = g_strdup(filter);
 	iu->hash.user_data = iu;
+	conversation_table_set_max_entries(&iu->hash, max_entries);
 
 	error_string = register_tap_listener(proto_get_protocol_filter_name(get_conversation_proto_id(ct)), &iu->hash, filter, 0, NULL, get_hostlist_packet_func(ct), endpoints_draw, NULL);
 	if (error_string) {
@@ -29,6 +29,9 @@
 typedef struct _export_object_list_gui_t {
     GSList *entries;
     register_eo_t* eo;
+    eo_writer_t *writer;        /* NULL until an object is saved */
+    gboolean dir_checked;       /* have we made sure the directory exists? */
+    gboolean dir_ok;            /* ...and does it? */
 } export_object_list_gui_t;
 
 static GHashTable* eo_opts = NULL;
@@ -82,12 +85,74 @@ gboolean eo_tap_opt_add(const char *option_string)
     return FALSE;
 }
 
+/* Make sure the directory to save objects in exists, once. */
+static gboolean
+object_list_check_dir(export_object_list_gui_t *object_list, const gchar *save_in_path)
+{
+    if (object_list->dir_checked)
+        return object_list->dir_ok;
+    object_list->dir_checked = TRUE;
+
+    if (!g_file_test(save_in_path, G_FILE_TEST_IS_DIR)) {
+        /* If the destination directory (or its parents) do not exist, create them. */
+        if (g_mkdir_with_parents(save_in_path, 0755) == -1) {
+            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
+                    save_in_path, g_strerror(errno));
+            return FALSE;
+        }
+    }
+    object_list->dir_ok = TRUE;
+    return TRUE;
+}
+
+/* Give an object a file name that isn't taken yet and start writing it;
+ * the writer takes its payload. */
+static void
+object_list_save_entry(export_object_list_gui_t *object_list, export_object_entry_t *entry)
+{
+    gchar* save_in_path = (gchar*)g_hash_table_lookup(eo_opts, proto_get_protocol_filter_name(get_eo_proto_id(object_list->eo)));
+    GString *safe_filename = NULL;
+    gchar *save_as_fullpath = NULL;
+    int count = 0;
+
+    if (!object_list_check_dir(object_list, save_in_path))
+        return;
+
+    do {
+        g_free(save_as_fullpath);
+        if (entry->filename) {
+            safe_filename = eo_massage_str(entry->filename,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        } else {
+            char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
+            const char *ext;
+            ext = eo_ct2ext(entry->content_type);
+            g_snprintf(generic_name, sizeof(generic_name),
+                "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
+            safe_filename = eo_massage_str(generic_name,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        }
+        save_as_fullpath = g_build_filename(save_in_path, safe_filename->str, NULL);
+        g_string_free(safe_filename, TRUE);
+    } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < 1000);
+
+    if (object_list->writer == NULL)
+        object_list->writer = eo_writer_new();
+    eo_writer_save_entry(object_list->writer, save_as_fullpath, entry, TRUE);
+    g_free(save_as_fullpath);
+}
+
 static void
 object_list_add_entry(void *gui_data, export_object_entry_t *entry)
 {
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)gui_data;
 
     object_list->entries = g_slist_append(object_list->entries, entry);
+
+    /* An object that's whole when it's tapped can be written out now,
+     * rather than keeping all of them in memory until the end. */
+    if (get_eo_single_packet(object_list->eo))
+        object_list_save_entry(object_list, entry);
 }
 
 static export_object_entry_t*
@@ -103,46 +168,17 @@ eo_draw(void *tapdata)
 {
     export_object_list_t *tap_object = (export_object_list_t *)tapdata;
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
-    GSList *slist = object_list->entries;
-    export_object_entry_t *entry;
-    gchar* save_in_path = (gchar*)g_hash_table_lookup(eo_opts, proto_get_protocol_filter_name(get_eo_proto_id(object_list->eo)));
-    GString *safe_filename = NULL;
-    gchar *save_as_fullpath = NULL;
-    int count = 0;
+    GSList *slist;
 
-    if (!g_file_test(save_in_path, G_FILE_TEST_IS_DIR)) {
-        /* If the destination directory (or its parents) do not exist, create them. */
-        if (g_mkdir_with_parents(save_in_path, 0755) == -1) {
-            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
-                    save_in_path, g_strerror(errno));
-            return;
-        }
+    /* Objects that can still grow once they're listed are written now. */
+    if (!get_eo_single_packet(object_list->eo)) {
+        for (slist = object_list->entries; slist; slist = slist->next)
+            object_list_save_entry(object_list, (export_object_entry_t *)slist->data);
     }
 
-    while (slist) {
-        entry = (export_object_entry_t *)slist->data;
-        do {
-            g_free(save_as_fullpath);
-            if (entry->filename) {
-                safe_filename = eo_massage_str(entry->filename,
-                    EXPORT_OBJECT_MAXFILELEN, count);
-            } else {
-                char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
-                const char *ext;
-                ext = eo_ct2ext(entry->content_type);
-                g_snprintf(generic_name, sizeof(generic_name),
-                    "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
-                safe_filename = eo_massage_str(generic_name,
-                    EXPORT_OBJECT_MAXFILELEN, count);
-            }
-            save_as_fullpath = g_build_filename(save_in_path, safe_filename->str, NULL);
-            g_string_free(safe_filename, TRUE);
-        } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < 1000);
-        count = 0;
-        eo_save_entry(save_as_fullpath, entry);
-        g_free(save_as_fullpath);
-        save_as_fullpath = NULL;
-        slist = slist->next;
+    if (object_list->writer != NULL) {
+        eo_writer_finish(object_list->writer);
+        object_list->writer = NULL;
     }
 }
 
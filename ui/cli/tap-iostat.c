@@ -1371,7 +1371,9 @@ register_io_tap(io_stat_t *io, int i, const char *filter)
     }
     g_free(field);
 
-    error_string = register_tap_listener("frame", &io->items[i], flt, TL_REQUIRES_PROTO_TREE, NULL,
+    /* We only look at the field, if any, so rather than have the whole
+       tree built, just have it put in. */
+    error_string = register_tap_listener("frame", &io->items[i], flt, TL_REQUIRES_NOTHING, NULL,
                                        iostat_packet, i ? NULL : iostat_draw, NULL);
     if (error_string) {
         g_free(io->items);
@@ -1381,6 +1383,9 @@ register_io_tap(io_stat_t *io, int i, const char *filter)
         g_string_free(error_string, TRUE);
         exit(1);
     }
+    if (hfi) {
+        add_tap_listener_hfid(&io->items[i], hfi->id);
+    }
 }
 
 static void
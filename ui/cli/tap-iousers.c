@@ -16,6 +16,7 @@
 #include <string.h>
 #include <epan/packet.h>
 #include <epan/timestamp.h>
+#include <wsutil/strtoi.h>
 #include <ui/cmdarg_err.h>
 #include <ui/cli/tshark-tap.h>
 
@@ -39,6 +40,10 @@ iousers_draw(void *arg)
 	printf("================================================================================\n");
 	printf("%s Conversations\n", iu->type);
 	printf("Filter:%s\n", iu->filter ? iu->filter : "<No Filter>");
+	if (iu->hash.max_entries) {
+		printf("Top %u conversations, %" G_GINT64_MODIFIER "u replaced; (+N) is the maximum number of uncounted frames\n",
+			iu->hash.max_entries, iu->hash.evicted);
+	}
 
 	switch (timestamp_get_type()) {
 	case TS_ABSOLUTE:
@@ -204,8 +209,11 @@ iousers_draw(void *arg)
 						nstime_to_sec(&iui->start_time));
 					break;
 				}
-				printf("   %12.4f\n",
+				printf("   %12.4f",
 					 nstime_to_sec(&iui->stop_time) - nstime_to_sec(&iui->start_time));
+				if (iui->error_frames)
+					printf(" (+%" G_GINT64_MODIFIER "u)", iui->error_frames);
+				printf("\n");
 			}
 		}
 		max_frames = last_frames;
@@ -213,15 +221,35 @@ iousers_draw(void *arg)
 	printf("================================================================================\n");
 }
 
+/* Strip an optional "top=<entries>" in front of the filter. */
+static const char *
+iousers_parse_top(const char *filter, guint32 *max_entries)
+{
+	const char *end;
+
+	if (!filter || strncmp(filter, "top=", 4) != 0)
+		return filter;
+
+	if (!ws_strtou32(filter + 4, &end, max_entries) || (*end != '\0' && *end != ',')) {
+		cmdarg_err("invalid \"-z conv,<type>[,top=<entries>][,<filter>]\" argument");
+		exit(1);
+	}
+	return *end == ',' ? end + 1 : NULL;
+}
+
 void init_iousers(struct register_ct *ct, const char *filter)
 {
 	io_users_t *iu;
 	GString *error_string;
+	guint32 max_entries = 0;
+
+	filter = iousers_parse_top(filter, &max_entries);
 
 	iu = g_new0(io_users_t, 1);
 	iu->type = proto_get_protocol_short_name(find_protocol_by_id(get_conversation_proto_id(ct)));
 	iu->filter = g_strdup(filter);
 	iu->hash.user_data = iu;
+	conversation_table_set_max_entries(&iu->hash, max_entries);
 
 	error_string = register_tap_listener(proto_get_protocol_filter_name(get_conversation_proto_id(ct)), &iu->hash, filter, 0, NULL, get_conversation_packet_func(ct), iousers_draw, NULL);
 	if (error_string) {
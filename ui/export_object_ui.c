@@ -18,31 +18,26 @@
 #include <glib.h>
 
 #include <epan/packet_info.h>
+#include <epan/epan_dissect.h>
+#include <epan/frame_data_sequence.h>
 #include <epan/tap.h>
 
 #include <wiretap/wtap.h>
 
+#include "frame_tvbuff.h"
+
+#include <wsutil/cpu_info.h>
 #include <wsutil/file_util.h>
 #include <wsutil/report_message.h>
 
 #include "export_object_ui.h"
 
-void
-eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry)
+/* Write a payload to a file; returns 0 or an error. */
+static int
+eo_write_payload(int to_fd, const guint8 *ptr, gint64 bytes_left)
 {
-    int to_fd;
-    gint64 bytes_left;
     int bytes_to_write;
     ssize_t bytes_written;
-    guint8 *ptr;
-    int err;
-
-    to_fd = ws_open(save_as_filename, O_WRONLY | O_CREAT | O_EXCL |
-             O_BINARY, 0644);
-    if(to_fd == -1) { /* An error occurred */
-        report_open_failure(save_as_filename, errno, TRUE);
-        return;
-    }
 
     /*
      * The third argument to _write() on Windows is an unsigned int,
@@ -57,8 +52,6 @@ eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry)
      * payload_len can be passed to ws_write(), so we write in
      * chunks of, at most 2^31 bytes.
      */
-    ptr = entry->payload_data;
-    bytes_left = entry->payload_len;
     while (bytes_left != 0) {
         if (bytes_left > 0x40000000)
             bytes_to_write = 0x40000000;
@@ -67,20 +60,298 @@ eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry)
         bytes_written = ws_write(to_fd, ptr, bytes_to_write);
         if (bytes_written <= 0) {
             if (bytes_written < 0)
-                err = errno;
+                return errno;
             else
-                err = WTAP_ERR_SHORT_WRITE;
-            report_write_failure(save_as_filename, err);
-            ws_close(to_fd);
-            return;
+                return WTAP_ERR_SHORT_WRITE;
         }
         bytes_left -= bytes_written;
         ptr += bytes_written;
     }
+    return 0;
+}
+
+void
+eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry)
+{
+    int to_fd;
+    int err;
+
+    to_fd = ws_open(save_as_filename, O_WRONLY | O_CREAT | O_EXCL |
+             O_BINARY, 0644);
+    if(to_fd == -1) { /* An error occurred */
+        report_open_failure(save_as_filename, errno, TRUE);
+        return;
+    }
+
+    err = eo_write_payload(to_fd, entry->payload_data, entry->payload_len);
+    if (err != 0) {
+        report_write_failure(save_as_filename, err);
+        ws_close(to_fd);
+        return;
+    }
     if (ws_close(to_fd) < 0)
         report_write_failure(save_as_filename, errno);
 }
 
+/* What a tap listener looking for one object's payload keeps */
+typedef struct {
+    const export_object_entry_t *entry;     /* the object we want */
+    guint8 *payload_data;                   /* its payload, once found */
+} eo_load_t;
+
+static void
+eo_load_add_entry(void *gui_data, export_object_entry_t *found)
+{
+    eo_load_t *load = (eo_load_t *)gui_data;
+
+    /* A packet can have more than one object in it. */
+    if (load->payload_data == NULL &&
+        found->payload_len == load->entry->payload_len &&
+        g_strcmp0(found->hostname, load->entry->hostname) == 0 &&
+        g_strcmp0(found->content_type, load->entry->content_type) == 0 &&
+        g_strcmp0(found->filename, load->entry->filename) == 0) {
+        load->payload_data = found->payload_data;
+        found->payload_data = NULL;
+    }
+    eo_free_entry(found);
+}
+
+static export_object_entry_t *
+eo_load_get_entry(void *gui_data _U_, int row _U_)
+{
+    return NULL;
+}
+
+gboolean
+eo_load_payload(capture_file *cf, register_eo_t *eo, export_object_entry_t *entry)
+{
+    export_object_list_t tap_object;
+    eo_load_t load;
+    frame_data *fdata;
+    epan_dissect_t edt;
+    wtap_rec rec;
+    Buffer buf;
+    GString *error_msg;
+    int err;
+    gchar *err_info;
+    void *prev_only;
+
+    if (entry->payload_data != NULL || entry->payload_len == 0)
+        return TRUE;
+
+    if (cf == NULL || cf->provider.wth == NULL ||
+        (fdata = frame_data_sequence_find(cf->provider.frames, entry->pkt_num)) == NULL) {
+        report_failure("The capture file with packet %u is no longer open.", entry->pkt_num);
+        return FALSE;
+    }
+
+    load.entry = entry;
+    load.payload_data = NULL;
+    memset(&tap_object, 0, sizeof(tap_object));
+    tap_object.add_entry = eo_load_add_entry;
+    tap_object.get_entry = eo_load_get_entry;
+    tap_object.gui_data = &load;
+
+    error_msg = register_tap_listener(get_eo_tap_listener_name(eo), &tap_object, NULL, 0,
+                                      NULL, get_eo_packet_func(eo), NULL, NULL);
+    if (error_msg) {
+        report_failure("Can't register %s tap: %s",
+                       proto_get_protocol_filter_name(get_eo_proto_id(eo)), error_msg->str);
+        g_string_free(error_msg, TRUE);
+        return FALSE;
+    }
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1500);
+    if (wtap_seek_read(cf->provider.wth,
+                       frame_data_sequence_get_file_off(cf->provider.frames, fdata->num),
+                       &rec, &buf, &err, &err_info)) {
+        /*
+         * The packet has already been dissected, so anything it needs from
+         * the packets before it, such as the reassembled body of a response,
+         * is still in the conversation and reassembly tables. Other
+         * listeners, including the one that listed the object, mustn't see
+         * it a second time.
+         */
+        prev_only = set_tap_listener_only(&tap_object);
+        epan_dissect_init(&edt, cf->epan, TRUE, FALSE);
+        epan_dissect_run_with_taps(&edt, cf->cd_t, &rec,
+                                   frame_tvbuff_new_buffer(&cf->provider, fdata, &buf),
+                                   fdata, NULL);
+        epan_dissect_cleanup(&edt);
+        set_tap_listener_only(prev_only);
+    } else {
+        report_read_failure(cf->filename, err);
+        g_free(err_info);
+    }
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    remove_tap_listener(&tap_object);
+
+    if (load.payload_data == NULL) {
+        report_failure("The object in packet %u couldn't be found again.", entry->pkt_num);
+        return FALSE;
+    }
+    entry->payload_data = load.payload_data;
+    return TRUE;
+}
+
+/*
+ * Don't let more than this many bytes of payloads wait to be written,
+ * so that saving objects whose payloads are loaded one at a time doesn't
+ * end up with all of them in memory after all.
+ */
+#define EO_WRITER_MAX_PENDING   (256 * 1024 * 1024)
+#define EO_WRITER_MAX_THREADS   8
+
+typedef struct {
+    eo_writer_t *writer;
+    int fd;
+    gchar *filename;
+    guint8 *payload_data;
+    gint64 payload_len;
+    gboolean free_payload;
+    int err;
+} eo_write_job_t;
+
+struct _eo_writer {
+    GThreadPool *pool;
+    GMutex mutex;
+    GCond cond;
+    gint64 pending;             /* bytes pushed but not written yet */
+    GSList *failed;             /* jobs that failed, newest first */
+};
+
+static void
+eo_write_job_free(eo_write_job_t *job)
+{
+    if (job->free_payload)
+        g_free(job->payload_data);
+    g_free(job->filename);
+    g_free(job);
+}
+
+static void
+eo_write_job_run(eo_write_job_t *job)
+{
+    job->err = eo_write_payload(job->fd, job->payload_data, job->payload_len);
+    if (ws_close(job->fd) < 0 && job->err == 0)
+        job->err = errno;
+}
+
+static void
+eo_writer_thread(gpointer data, gpointer user_data _U_)
+{
+    eo_write_job_t *job = (eo_write_job_t *)data;
+    eo_writer_t *writer = job->writer;
+
+    eo_write_job_run(job);
+
+    /* Errors are reported by eo_writer_finish(), in the thread that's
+     * allowed to put up dialogs. */
+    g_mutex_lock(&writer->mutex);
+    writer->pending -= job->payload_len;
+    if (job->err != 0) {
+        if (job->free_payload) {
+            g_free(job->payload_data);
+            job->payload_data = NULL;
+        }
+        writer->failed = g_slist_prepend(writer->failed, job);
+        job = NULL;
+    }
+    g_cond_broadcast(&writer->cond);
+    g_mutex_unlock(&writer->mutex);
+
+    if (job != NULL)
+        eo_write_job_free(job);
+}
+
+eo_writer_t *
+eo_writer_new(void)
+{
+    eo_writer_t *writer = g_new0(eo_writer_t, 1);
+    guint threads = get_num_processors();
+
+    if (threads > EO_WRITER_MAX_THREADS)
+        threads = EO_WRITER_MAX_THREADS;
+
+    g_mutex_init(&writer->mutex);
+    g_cond_init(&writer->cond);
+    /* If we can't have threads, objects are written as they're saved. */
+    writer->pool = g_thread_pool_new(eo_writer_thread, NULL, threads, FALSE, NULL);
+    return writer;
+}
+
+gboolean
+eo_writer_save_entry(eo_writer_t *writer, const gchar *save_as_filename,
+                     export_object_entry_t *entry, gboolean take_payload)
+{
+    eo_write_job_t *job;
+    int to_fd;
+
+    /* Open the file here, so that the caller can tell which names are
+     * taken and we can report a failure to open it straight away. */
+    to_fd = ws_open(save_as_filename, O_WRONLY | O_CREAT | O_EXCL |
+             O_BINARY, 0644);
+    if (to_fd == -1) {
+        report_open_failure(save_as_filename, errno, TRUE);
+        if (take_payload) {
+            g_free(entry->payload_data);
+            entry->payload_data = NULL;
+        }
+        return FALSE;
+    }
+
+    job = g_new0(eo_write_job_t, 1);
+    job->writer = writer;
+    job->fd = to_fd;
+    job->filename = g_strdup(save_as_filename);
+    job->payload_data = entry->payload_data;
+    job->payload_len = entry->payload_len;
+    job->free_payload = take_payload;
+    if (take_payload)
+        entry->payload_data = NULL;
+
+    if (writer->pool == NULL) {
+        eo_write_job_run(job);
+        if (job->err != 0)
+            report_write_failure(job->filename, job->err);
+        eo_write_job_free(job);
+        return TRUE;
+    }
+
+    g_mutex_lock(&writer->mutex);
+    while (writer->pending > 0 && writer->pending + job->payload_len > EO_WRITER_MAX_PENDING)
+        g_cond_wait(&writer->cond, &writer->mutex);
+    writer->pending += job->payload_len;
+    g_mutex_unlock(&writer->mutex);
+
+    g_thread_pool_push(writer->pool, job, NULL);
+    return TRUE;
+}
+
+void
+eo_writer_finish(eo_writer_t *writer)
+{
+    GSList *failed;
+    eo_write_job_t *job;
+
+    if (writer->pool != NULL)
+        g_thread_pool_free(writer->pool, FALSE, TRUE);
+
+    writer->failed = g_slist_reverse(writer->failed);
+    for (failed = writer->failed; failed != NULL; failed = failed->next) {
+        job = (eo_write_job_t *)failed->data;
+        report_write_failure(job->filename, job->err);
+        eo_write_job_free(job);
+    }
+    g_slist_free(writer->failed);
+
+    g_mutex_clear(&writer->mutex);
+    g_cond_clear(&writer->cond);
+    g_free(writer);
+}
+
 /*
  * Editor modelines
  *
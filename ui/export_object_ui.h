@@ -18,10 +18,49 @@ extern "C" {
 
 #include <epan/export_object.h>
 
+#include "cfile.h"
+
 /* Common between protocols */
 
 void eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry);
 
+/** Get back the payload of an object whose payload was dropped after it
+ * was listed, by dissecting the packet it came from again.  Only objects
+ * of an Export Object for which get_eo_single_packet() is TRUE can be got
+ * back.
+ *
+ * @param cf the capture file the object came from
+ * @param eo the Export Object that listed it
+ * @param entry the object; its payload_data is set if this succeeds
+ * @return TRUE if it succeeded; if not, the failure has been reported
+ */
+gboolean eo_load_payload(capture_file *cf, register_eo_t *eo, export_object_entry_t *entry);
+
+/** Writes objects to files in background threads, so that saving many of
+ * them doesn't wait for each one in turn. */
+typedef struct _eo_writer eo_writer_t;
+
+eo_writer_t *eo_writer_new(void);
+
+/** Create a file and start writing an object to it.  A failure to create
+ * the file is reported straight away; a failure to write it is reported
+ * by eo_writer_finish().  This waits if too much is waiting to be written.
+ *
+ * @param writer the writer
+ * @param save_as_filename the file to create
+ * @param entry the object
+ * @param take_payload if TRUE, the writer takes the object's payload and
+ *  frees it once it's written; if FALSE, the payload has to stay around
+ *  until eo_writer_finish() returns
+ * @return TRUE if the file was created
+ */
+gboolean eo_writer_save_entry(eo_writer_t *writer, const gchar *save_as_filename,
+                              export_object_entry_t *entry, gboolean take_payload);
+
+/** Wait for all the objects to be written, report any failures to write
+ * them, and free the writer. */
+void eo_writer_finish(eo_writer_t *writer);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
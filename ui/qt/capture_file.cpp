@@ -221,6 +221,13 @@ void CaptureFile::retapPackets()
     }
 }
 
+void CaptureFile::retapListener(void *tapdata)
+{
+    if (cap_file_) {
+        cf_retap_listener(cap_file_, tapdata);
+    }
+}
+
 void CaptureFile::delayedRetapPackets()
 {
     QTimer::singleShot(0, this, SLOT(retapPackets()));
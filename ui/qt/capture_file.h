@@ -131,6 +131,13 @@ public slots:
      */
     void retapPackets();
 
+    /** Retap the capture file for one tap listener only. Convenience
+     * wrapper for cf_retap_listener. Listeners registered by other
+     * dialogs aren't reset, and don't slow the retap down.
+     * @param tapdata The tapdata the listener was registered with.
+     */
+    void retapListener(void *tapdata);
+
     /** Retap the capture file after the current batch of application events
      * is processed. If you call this instead of retapPackets or
      * cf_retap_packets in a dialog's constructor it will be displayed before
@@ -345,7 +345,12 @@ public:
 
             switch (column) {
             case CONV_COLUMN_PACKETS:
-                return QString("%L1").arg(conv_item->tx_frames + conv_item->rx_frames);
+            {
+                QString packets = QString("%L1").arg(conv_item->tx_frames + conv_item->rx_frames);
+                // Upper bound of the packets missed by a top-K table.
+                if (conv_item->error_frames) packets.append(QString(" (+%L1)").arg(conv_item->error_frames));
+                return packets;
+            }
             case CONV_COLUMN_BYTES:
                 return gchar_free_to_qstring(format_size(conv_item->tx_bytes + conv_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
             case CONV_COLUMN_PKT_AB:
@@ -571,6 +576,7 @@ ConversationTreeWidget::ConversationTreeWidget(QWidget *parent, register_ct_t* t
 {
     setColumnCount(CONV_NUM_COLUMNS);
     setUniformRowHeights(true);
+    conversation_table_set_max_entries(&hash_, prefs.gui_conversation_table_max_entries);
 
     for (int i = 0; i < CONV_NUM_COLUMNS; i++) {
         headerItem()->setText(i, conv_column_titles[i]);
@@ -730,6 +736,9 @@ void ConversationTreeWidget::updateItems() {
     if (hash_.conv_array && hash_.conv_array->len > 0) {
         title_.append(QString(" %1 %2").arg(UTF8_MIDDLE_DOT).arg(hash_.conv_array->len));
     }
+    if (hash_.evicted > 0) {
+        title_.append(tr(" (top %1, %L2 replaced)").arg(hash_.max_entries).arg(hash_.evicted));
+    }
     emit titleChanged(this, title_);
 
     if (!hash_.conv_array) {
@@ -304,7 +304,12 @@ public:
             if (resolve_names_ptr_ && *resolve_names_ptr_) resolve_names = true;
             switch (column) {
             case ENDP_COLUMN_PACKETS:
-                return QString("%L1").arg(endp_item->tx_frames + endp_item->rx_frames);
+            {
+                QString packets = QString("%L1").arg(endp_item->tx_frames + endp_item->rx_frames);
+                // Upper bound of the packets missed by a top-K table.
+                if (endp_item->error_frames) packets.append(QString(" (+%L1)").arg(endp_item->error_frames));
+                return packets;
+            }
             case ENDP_COLUMN_BYTES:
                 return gchar_free_to_qstring(format_size(endp_item->tx_bytes + endp_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
             case ENDP_COLUMN_PKT_AB:
@@ -470,6 +475,7 @@ EndpointTreeWidget::EndpointTreeWidget(QWidget *parent, register_ct_t *table) :
 {
     setColumnCount(ENDP_NUM_COLUMNS);
     setUniformRowHeights(true);
+    conversation_table_set_max_entries(&hash_, prefs.gui_conversation_table_max_entries);
 
     QString proto_filter_name = proto_get_protocol_filter_name(get_conversation_proto_id(table_));
     if (proto_filter_name == "ip") {
@@ -586,6 +592,9 @@ void EndpointTreeWidget::updateItems()
     if (hash_.conv_array && hash_.conv_array->len > 0) {
         title_.append(QString(" %1 %2").arg(UTF8_MIDDLE_DOT).arg(hash_.conv_array->len));
     }
+    if (hash_.evicted > 0) {
+        title_.append(tr(" (top %1, %L2 replaced)").arg(hash_.max_entries).arg(hash_.evicted));
+    }
     emit titleChanged(this, title_);
 
     if (!hash_.conv_array) {
@@ -149,7 +149,7 @@ void ExpertInfoDialog::retapPackets()
         return;
     }
 
-    cap_file_.retapPackets();
+    cap_file_.retapListener(expert_info_model_);
 }
 
 void ExpertInfoDialog::captureEvent(CaptureEvent e)
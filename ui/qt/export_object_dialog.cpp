@@ -169,7 +169,7 @@ void ExportObjectDialog::saveCurrentEntry()
                                              safe_filename->str);
     g_string_free(safe_filename, TRUE);
 
-    model_.saveEntry(current, file_name);
+    model_.saveEntry(current, file_name, cap_file_.capFile());
 }
 
 void ExportObjectDialog::saveAllEntries()
@@ -194,7 +194,7 @@ void ExportObjectDialog::saveAllEntries()
     if (save_in_path.length() < 1)
         return;
 
-    model_.saveAllEntries(save_in_path);
+    model_.saveAllEntries(save_in_path, cap_file_.capFile());
 }
 
 /*
@@ -14,6 +14,8 @@
 #include <ui/qt/utils/variant_pointer.h>
 #include <ui/export_object_ui.h>
 
+#include <epan/prefs.h>
+
 #include <QDir>
 
 extern "C" {
@@ -43,7 +45,8 @@ object_list_get_entry(void *gui_data, int row) {
 
 ExportObjectModel::ExportObjectModel(register_eo_t* eo, QObject *parent) :
     QAbstractTableModel(parent),
-    eo_(eo)
+    eo_(eo),
+    defer_payloads_(prefs.gui_eo_defer_payloads && get_eo_single_packet(eo))
 {
     eo_gui_data_.model = this;
 
@@ -127,6 +130,12 @@ void ExportObjectModel::addObjectEntry(export_object_entry_t *entry)
     if (entry == NULL)
         return;
 
+    // The payload can be got back from the packet if it's saved.
+    if (defer_payloads_) {
+        g_free(entry->payload_data);
+        entry->payload_data = NULL;
+    }
+
     int count = objects_.count();
     beginInsertRows(QModelIndex(), count, count);
     objects_.append(VariantPointer<export_object_entry_t>::asQVariant(entry));
@@ -138,7 +147,7 @@ export_object_entry_t* ExportObjectModel::objectEntry(int row)
     return VariantPointer<export_object_entry_t>::asPtr(objects_.value(row));
 }
 
-bool ExportObjectModel::saveEntry(QModelIndex &index, QString filename)
+bool ExportObjectModel::saveEntry(QModelIndex &index, QString filename, capture_file *cf)
 {
     if (!index.isValid() || filename.isEmpty())
         return false;
@@ -148,19 +157,30 @@ bool ExportObjectModel::saveEntry(QModelIndex &index, QString filename)
         return false;
 
     if (filename.length() > 0) {
-        eo_save_entry(filename.toUtf8().constData(), entry);
+        if (entry->payload_data == NULL && entry->payload_len > 0) {
+            if (!eo_load_payload(cf, eo_, entry))
+                return false;
+            eo_save_entry(filename.toUtf8().constData(), entry);
+            g_free(entry->payload_data);
+            entry->payload_data = NULL;
+        } else {
+            eo_save_entry(filename.toUtf8().constData(), entry);
+        }
     }
 
     return true;
 }
 
-void ExportObjectModel::saveAllEntries(QString path)
+void ExportObjectModel::saveAllEntries(QString path, capture_file *cf)
 {
     if (path.isEmpty())
         return;
 
     QDir save_dir(path);
     export_object_entry_t *entry;
+    // Payloads that have to be got back are dissected here, one at a
+    // time, while the ones before them are written in the background.
+    eo_writer_t *writer = eo_writer_new();
 
     for (QList<QVariant>::iterator it = objects_.begin(); it != objects_.end(); ++it)
     {
@@ -190,8 +210,16 @@ void ExportObjectModel::saveAllEntries(QString path)
             filename = QString::fromUtf8(safe_filename->str);
             g_string_free(safe_filename, TRUE);
         } while (save_dir.exists(filename) && ++count < 1000);
-        eo_save_entry(save_dir.filePath(filename).toUtf8().constData(), entry);
+
+        bool loaded = false;
+        if (entry->payload_data == NULL && entry->payload_len > 0) {
+            if (!eo_load_payload(cf, eo_, entry))
+                continue;
+            loaded = true;
+        }
+        eo_writer_save_entry(writer, save_dir.filePath(filename).toUtf8().constData(), entry, loaded);
     }
+    eo_writer_finish(writer);
 }
 
 void ExportObjectModel::resetObjects()
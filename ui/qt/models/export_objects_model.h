@@ -16,6 +16,8 @@
 #include <epan/tap.h>
 #include <epan/export_object.h>
 
+#include "cfile.h"
+
 #include <QAbstractTableModel>
 #include <QSortFilterProxyModel>
 #include <QList>
@@ -44,8 +46,8 @@ public:
     export_object_entry_t *objectEntry(int row);
     void resetObjects();
 
-    bool saveEntry(QModelIndex &index, QString filename);
-    void saveAllEntries(QString path);
+    bool saveEntry(QModelIndex &index, QString filename, capture_file *cf);
+    void saveAllEntries(QString path, capture_file *cf);
 
     const char* getTapListenerName();
     void* getTapData();
@@ -65,6 +67,7 @@ private:
     export_object_list_t export_object_list_;
     export_object_list_gui_t eo_gui_data_;
     register_eo_t* eo_;
+    bool defer_payloads_;
 };
 
 class ExportObjectProxyModel : public QSortFilterProxyModel
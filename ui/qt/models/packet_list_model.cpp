@@ -35,6 +35,7 @@
 #include <QFontMetrics>
 #include <QModelIndex>
 #include <QElapsedTimer>
+#include <QTimer>
 
 // Print timing information
 //#define DEBUG_PACKET_LIST_MODEL 1
@@ -46,6 +47,14 @@
 static PacketListModel * glbl_plist_model = Q_NULLPTR;
 static const int reserved_packets_ = 100000;
 
+// How often we check for records read in the background, and how long
+// we spend dissecting them each time.
+static const int prefetch_interval_ = 10; // ms
+// Screenfuls of rows to read ahead in the direction of scrolling.
+static const int prefetch_pages_ahead_ = 4;
+// Rows to read ahead of idle dissection and of sorting.
+static const int idle_prefetch_batch_ = 512;
+
 guint
 packet_list_append(column_info *, frame_data *fdata)
 {
@@ -70,7 +79,8 @@ PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     number_to_row_(QVector<int>()),
     max_row_height_(0),
     max_line_count_(1),
-    idle_dissection_row_(0)
+    idle_dissection_row_(0),
+    idle_prefetch_row_(0)
 {
     Q_ASSERT(glbl_plist_model == Q_NULLPTR);
     glbl_plist_model = this;
@@ -114,6 +124,10 @@ PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
             this, &PacketListModel::emitItemHeightChanged,
             Qt::QueuedConnection);
     idle_dissection_timer_ = new QElapsedTimer();
+
+    prefetch_timer_ = new QTimer(this);
+    prefetch_timer_->setInterval(prefetch_interval_);
+    connect(prefetch_timer_, SIGNAL(timeout()), this, SLOT(dissectPrefetchedRows()));
 }
 
 PacketListModel::~PacketListModel()
@@ -188,6 +202,11 @@ void PacketListModel::clear() {
     max_row_height_ = 0;
     max_line_count_ = 1;
     idle_dissection_row_ = 0;
+    idle_prefetch_row_ = 0;
+    idle_dissection_timer_->invalidate();
+    prefetch_timer_->stop();
+    prefetch_rows_.clear();
+    pending_display_rows_.clear();
 }
 
 void PacketListModel::invalidateAllColumnStrings()
@@ -195,6 +214,10 @@ void PacketListModel::invalidateAllColumnStrings()
     PacketListRecord::invalidateAllRecords();
     emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
     emit headerDataChanged(Qt::Horizontal, 0, columnCount() - 1);
+    // Start filling the cache again if we were doing so.
+    if (idle_dissection_timer_->isValid() || idle_dissection_row_ > 0) {
+        dissectIdle(true);
+    }
 }
 
 void PacketListModel::resetColumns()
@@ -366,8 +389,14 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     busy_timer_.start();
     emit pushProgressStatus(tr("Dissecting"), true, true, &stop_flag);
+    // Rows already dissected in the background are skipped; have the
+    // records for the rest read ahead of us.
     int row_num = 0;
+    int prefetch_row = 0;
     foreach (PacketListRecord *row, physical_rows_) {
+        if (row_num >= prefetch_row && !row->isDissected()) {
+            prefetch_row = prefetchPhysicalRows(row_num, idle_prefetch_batch_);
+        }
         row->columnString(sort_cap_file_, column);
         row_num++;
         if (busy_timer_.elapsed() > busy_timeout_) {
@@ -645,6 +674,15 @@ QVariant PacketListModel::data(const QModelIndex &d_index, int role) const
     case Qt::DisplayRole:
     {
         int column = d_index.column();
+        if (!record->isDissected() && cf_record_is_pending(cap_file_, fdata)) {
+            // The record is on its way; don't wait for it. We'll update
+            // the row when it gets here.
+            pending_display_rows_ << d_index.row();
+            if (!prefetch_timer_->isActive()) {
+                prefetch_timer_->start();
+            }
+            return QVariant();
+        }
         QString column_string = record->columnString(cap_file_, column, true);
         // We don't know an item's sizeHint until we fetch its text here.
         // Assume each line count is 1. If the line count changes, emit
@@ -714,14 +752,23 @@ void PacketListModel::flushVisibleRows()
     }
 }
 
-// Fill our column string and colorization cache while the application is
-// idle. Try to be as conservative with the CPU and disk as possible.
+// Fill our column string and colorization cache for every row while the
+// application is idle, so that scrolling, jumping to the end, and sorting
+// don't have to dissect. Try to be as conservative with the CPU and disk
+// as possible: we work in short slices, give way to the rows on screen
+// (see dissectPrefetchedRows), and have records read ahead of us in the
+// background so that we don't wait for I/O.
 static const int idle_dissection_interval_ = 5; // ms
 void PacketListModel::dissectIdle(bool reset)
 {
     if (reset) {
 //        qDebug() << "=di reset" << idle_dissection_row_;
         idle_dissection_row_ = 0;
+        idle_prefetch_row_ = 0;
+        if (idle_dissection_timer_->isValid()) {
+            // Already running; just start again from the top.
+            return;
+        }
     } else if (!idle_dissection_timer_->isValid()) {
         return;
     }
@@ -729,14 +776,25 @@ void PacketListModel::dissectIdle(bool reset)
     idle_dissection_timer_->restart();
 
     int first = idle_dissection_row_;
-    while (idle_dissection_timer_->elapsed() < idle_dissection_interval_
-           && idle_dissection_row_ < physical_rows_.count()) {
-        ensureRowColorized(idle_dissection_row_);
+    while (prefetch_rows_.isEmpty()
+           && idle_dissection_timer_->elapsed() < idle_dissection_interval_
+           && idle_dissection_row_ < visible_rows_.count()) {
+        if (idle_prefetch_row_ - idle_dissection_row_ < idle_prefetch_batch_ / 2) {
+            idle_prefetch_row_ = prefetchVisibleRows(idle_dissection_row_, idle_prefetch_batch_);
+        }
+        PacketListRecord *record = visible_rows_[idle_dissection_row_];
+        if (!record->isDissected()) {
+            if (cf_record_is_pending(cap_file_, record->frameData())) {
+                // Come back when it's here.
+                break;
+            }
+            record->columnString(cap_file_, 0, true);
+        }
         idle_dissection_row_++;
 //        if (idle_dissection_row_ % 1000 == 0) qDebug() << "=di row" << idle_dissection_row_;
     }
 
-    if (idle_dissection_row_ < physical_rows_.count()) {
+    if (idle_dissection_row_ < visible_rows_.count()) {
         QTimer::singleShot(idle_dissection_interval_, this, SLOT(dissectIdle()));
     } else {
         idle_dissection_timer_->invalidate();
@@ -783,6 +841,137 @@ frame_data *PacketListModel::getRowFdata(int row) {
     return record->frameData();
 }
 
+void PacketListModel::addPrefetchRow(int row, QVector<frame_data *> &frames)
+{
+    if (row < 0 || row >= visible_rows_.count()) return;
+
+    PacketListRecord *record = visible_rows_[row];
+    if (!record->isDissected()) {
+        frames << record->frameData();
+        prefetch_rows_ << row;
+    }
+}
+
+void PacketListModel::prefetchRows(int first, int last, int direction)
+{
+    if (!cap_file_ || first < 0 || last < first) return;
+
+    QVector<frame_data *> frames;
+    int page = last - first + 1;
+    int row;
+
+    // Most urgent first: what's on screen, then where we're going, then
+    // a page back where we came from.
+    prefetch_rows_.clear();
+    for (row = first; row <= last; row++) {
+        addPrefetchRow(row, frames);
+    }
+    if (direction < 0) {
+        for (row = first - 1; row >= first - page * prefetch_pages_ahead_; row--) {
+            addPrefetchRow(row, frames);
+        }
+        for (row = last + 1; row <= last + page; row++) {
+            addPrefetchRow(row, frames);
+        }
+    } else {
+        for (row = last + 1; row <= last + page * prefetch_pages_ahead_; row++) {
+            addPrefetchRow(row, frames);
+        }
+        for (row = first - 1; row >= first - page; row--) {
+            addPrefetchRow(row, frames);
+        }
+    }
+
+    // This replaces the idle dissection's requests.
+    idle_prefetch_row_ = idle_dissection_row_;
+
+    if (frames.isEmpty()) return;
+
+    cf_prefetch_records(cap_file_, frames.data(), frames.count());
+    if (!prefetch_timer_->isActive()) {
+        prefetch_timer_->start();
+    }
+}
+
+// Like prefetchVisibleRows, for rows in file order, visible or not.
+int PacketListModel::prefetchPhysicalRows(int first, int count)
+{
+    QVector<frame_data *> frames;
+    int row;
+
+    for (row = first; row < physical_rows_.count() && frames.count() < count; row++) {
+        PacketListRecord *record = physical_rows_[row];
+        if (!record->isDissected()) {
+            frames << record->frameData();
+        }
+    }
+    if (!frames.isEmpty()) {
+        cf_prefetch_records(cap_file_, frames.data(), frames.count());
+    }
+    return row;
+}
+
+// Have the records read in the background for up to count rows that
+// haven't been dissected, starting at first. Returns the row after the
+// last one asked for.
+int PacketListModel::prefetchVisibleRows(int first, int count)
+{
+    QVector<frame_data *> frames;
+    int row;
+
+    for (row = first; row < visible_rows_.count() && frames.count() < count; row++) {
+        PacketListRecord *record = visible_rows_[row];
+        if (!record->isDissected()) {
+            frames << record->frameData();
+        }
+    }
+    if (!frames.isEmpty()) {
+        cf_prefetch_records(cap_file_, frames.data(), frames.count());
+    }
+    return row;
+}
+
+// Dissect records that have been read in the background into the column
+// cache, so that they're ready before they're scrolled into view, and
+// redraw rows we skipped because their records hadn't arrived yet.
+// Dissection isn't thread safe, so it happens here in small slices.
+void PacketListModel::dissectPrefetchedRows()
+{
+    QElapsedTimer slice_timer;
+    QList<int> waiting_rows;
+
+    slice_timer.start();
+    while (!prefetch_rows_.isEmpty() && slice_timer.elapsed() < prefetch_interval_) {
+        int row = prefetch_rows_.takeFirst();
+        if (row >= visible_rows_.count()) continue;
+
+        PacketListRecord *record = visible_rows_[row];
+        if (record->isDissected()) continue;
+        if (cf_record_is_pending(cap_file_, record->frameData())) {
+            waiting_rows << row;
+            continue;
+        }
+        record->columnString(cap_file_, 0, true);
+        if (record->lineCountChanged() && record->lineCount() > max_line_count_) {
+            emit maxLineCountChanged(index(row, 0));
+        }
+    }
+    prefetch_rows_ = waiting_rows + prefetch_rows_;
+
+    foreach (int row, pending_display_rows_) {
+        if (row >= visible_rows_.count()) {
+            pending_display_rows_.remove(row);
+        } else if (!cf_record_is_pending(cap_file_, visible_rows_[row]->frameData())) {
+            pending_display_rows_.remove(row);
+            emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+        }
+    }
+
+    if (prefetch_rows_.isEmpty() && pending_display_rows_.isEmpty()) {
+        prefetch_timer_->stop();
+    }
+}
+
 void PacketListModel::ensureRowColorized(int row)
 {
     if (row < 0 || row >= visible_rows_.count())
@@ -20,6 +20,7 @@
 
 #include <QAbstractItemModel>
 #include <QFont>
+#include <QSet>
 #include <QVector>
 
 #include "packet_list_record.h"
@@ -27,6 +28,7 @@
 #include "cfile.h"
 
 class QElapsedTimer;
+class QTimer;
 
 class PacketListModel : public QAbstractItemModel
 {
@@ -70,6 +72,14 @@ public:
     void applyTimeShift();
 
     void setMaximumRowHeight(int height);
+    /**
+     * @brief Have records read in the background for the rows on screen,
+     * and for the rows around them, mostly in the direction of scrolling.
+     * @param first First row on screen.
+     * @param last Last row on screen.
+     * @param direction Negative if scrolling up, positive otherwise.
+     */
+    void prefetchRows(int first, int last, int direction);
 
 signals:
     void goToPacket(int);
@@ -110,6 +120,14 @@ private:
 
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
+    int idle_prefetch_row_;
+
+    QTimer *prefetch_timer_;
+    QList<int> prefetch_rows_;
+    mutable QSet<int> pending_display_rows_;
+    void addPrefetchRow(int row, QVector<frame_data *> &frames);
+    int prefetchVisibleRows(int first, int count);
+    int prefetchPhysicalRows(int first, int count);
 
     struct _GStringChunk *string_cache_pool_;
 
@@ -117,6 +135,7 @@ private:
 
 private slots:
     void emitItemHeightChanged(const QModelIndex &ih_index);
+    void dissectPrefetchedRows();
 };
 
 #endif // PACKET_LIST_MODEL_H
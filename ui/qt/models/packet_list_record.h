@@ -38,6 +38,8 @@ public:
     // packet_list->col_to_text in gtk/packet_list_store.c
     static int textColumn(int column) { return cinfo_column_.value(column, -1); }
     bool colorized() { return colorized_; }
+    // Are the column strings and colors cached and up to date?
+    bool isDissected() const { return !col_text_.isEmpty() && data_ver_ == col_data_ver_ && colorized_; }
     unsigned int conversation() { return conv_index_; }
 
     int columnTextSize(const char *str);
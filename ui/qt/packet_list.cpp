@@ -224,7 +224,8 @@ PacketList::PacketList(QWidget *parent) :
     set_column_visibility_(false),
     frozen_row_(-1),
     cur_history_(-1),
-    in_history_(false)
+    in_history_(false),
+    prefetch_sb_value_(0)
 {
     setItemsExpandable(false);
     setRootIsDecorated(false);
@@ -266,6 +267,7 @@ PacketList::PacketList(QWidget *parent) :
             this, SLOT(sectionMoved(int,int,int)));
 
     connect(verticalScrollBar(), SIGNAL(actionTriggered(int)), this, SLOT(vScrollBarActionTriggered(int)));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(vScrollBarValueChanged(int)));
 
     connect(&proto_prefs_menu_, SIGNAL(showProtocolPreferences(QString)),
             this, SIGNAL(showProtocolPreferences(QString)));
@@ -967,10 +969,11 @@ void PacketList::setVerticalAutoScroll(bool enabled)
 void PacketList::captureFileReadFinished()
 {
     packet_list_model_->flushVisibleRows();
-    packet_list_model_->dissectIdle(true);
     // Invalidating the column strings picks up and request/response
     // tracking changes. We might just want to call it from flushVisibleRows.
     packet_list_model_->invalidateAllColumnStrings();
+    // Then fill them in again in the background.
+    packet_list_model_->dissectIdle(true);
 }
 
 void PacketList::freeze()
@@ -1594,6 +1597,21 @@ void PacketList::vScrollBarActionTriggered(int)
     scrollViewChanged(tail_at_end_);
 }
 
+// Have the records for the rows on screen, and the ones we're scrolling
+// towards, read in the background.
+void PacketList::vScrollBarValueChanged(int value)
+{
+    int direction = value < prefetch_sb_value_ ? -1 : 1;
+    prefetch_sb_value_ = value;
+
+    QModelIndex first_index = indexAt(viewport()->rect().topLeft());
+    if (!first_index.isValid()) return;
+    QModelIndex last_index = indexAt(viewport()->rect().bottomLeft());
+    int last = last_index.isValid() ? last_index.row() : packet_list_model_->rowCount() - 1;
+
+    packet_list_model_->prefetchRows(first_index.row(), last, direction);
+}
+
 void PacketList::scrollViewChanged(bool at_end)
 {
     if (capture_in_progress_ && prefs.capture_auto_scroll) {
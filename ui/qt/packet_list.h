@@ -116,6 +116,7 @@ private:
     QVector<int> selection_history_;
     int cur_history_;
     bool in_history_;
+    int prefetch_sb_value_;
 
     void setFrameReftime(gboolean set, frame_data *fdata);
     void setColumnVisibility();
@@ -168,6 +169,7 @@ private slots:
     void updateRowHeights(const QModelIndex &ih_index);
     void copySummary();
     void vScrollBarActionTriggered(int);
+    void vScrollBarValueChanged(int value);
     void drawFarOverlay();
     void drawNearOverlay();
     void updatePackets(bool redraw);
@@ -248,7 +248,7 @@ void ResponseTimeDelayDialog::fillTree()
 
     statsTreeWidget()->setSortingEnabled(false);
 
-    cap_file_.retapPackets();
+    cap_file_.retapListener(&rtd_data);
 
     tapDraw(&rtd_data);
 
@@ -29,7 +29,9 @@
 #include <QAudioFormat>
 #include <QAudioOutput>
 #include <QDir>
+#include <QRunnable>
 #include <QTemporaryFile>
+#include <QThreadPool>
 #include <QVariant>
 
 // To do:
@@ -38,9 +40,22 @@
 static spx_int16_t default_audio_sample_rate_ = 8000;
 static const spx_int16_t visual_sample_rate_ = 1000;
 
+// Runs RtpAudioStream::decodeCodecs() in a thread pool.
+class RtpDecodeTask : public QRunnable
+{
+public:
+    explicit RtpDecodeTask(RtpAudioStream *audio_stream) : audio_stream_(audio_stream) {}
+    void run() { audio_stream_->decodeCodecs(); }
+
+private:
+    RtpAudioStream *audio_stream_;
+};
+
 RtpAudioStream::RtpAudioStream(QObject *parent, rtpstream_info_t *rtpstream) :
     QObject(parent),
     decoders_hash_(rtp_decoder_hash_table_new()),
+    decoding_started_(false),
+    simulated_(false),
     global_start_rel_time_(0.0),
     start_abs_offset_(0.0),
     start_rel_time_(0.0),
@@ -64,6 +79,10 @@ RtpAudioStream::RtpAudioStream(QObject *parent, rtpstream_info_t *rtpstream) :
     tempfile_ = new QTemporaryFile(tempname, this);
     tempfile_->open();
 
+    tempname = QString("%1/wireshark_rtp_decoded").arg(QDir::tempPath());
+    decoded_file_ = new QTemporaryFile(tempname, this);
+    decoded_file_->open();
+
     // RTP_STREAM_DEBUG("Writing to %s", tempname.toUtf8().constData());
 }
 
@@ -133,9 +152,71 @@ void RtpAudioStream::addRtpPacket(const struct _packet_info *pinfo, const struct
     rtp_packets_ << rtp_packet;
 }
 
+// decode() starts over only if this or one of the playback options changed.
 void RtpAudioStream::reset(double start_rel_time)
 {
-    global_start_rel_time_ = start_rel_time;
+    if (start_rel_time != global_start_rel_time_) {
+        global_start_rel_time_ = start_rel_time;
+        simulated_ = false;
+    }
+}
+
+void RtpAudioStream::startDecoding(QThreadPool *pool)
+{
+    if (decoding_started_) return;
+
+    decoding_started_ = true;
+    pool->start(new RtpDecodeTask(this));
+}
+
+static const int sample_bytes_ = sizeof(SAMPLE) / sizeof(char);
+/* Fix for bug 4119/5902: don't insert too many silence frames.
+ * XXX - is there a better thing to do here?
+ */
+static const int max_silence_samples_ = MAX_SILENCE_FRAMES;
+
+// Called from a worker thread. Nothing else touches rtp_packets_,
+// decoders_hash_, decoded_packets_ or decoded_file_ until it's done.
+void RtpAudioStream::decodeCodecs()
+{
+    if (isDecoded()) return;
+
+    unsigned channels = 0;
+    unsigned sample_rate = 0;
+
+    decoded_packets_.clear();
+    decoded_packets_.reserve(rtp_packets_.size());
+    decoded_file_->seek(0);
+
+    for (int cur_packet = 0; cur_packet < rtp_packets_.size(); cur_packet++) {
+        if (cancel_decoding_.loadAcquire()) return;
+
+        SAMPLE *decode_buff = NULL;
+        DecodedPacket decoded;
+
+        decoded.bytes = decode_rtp_packet(rtp_packets_[cur_packet], &decode_buff, decoders_hash_, &channels, &sample_rate);
+        decoded.sample_rate = sample_rate;
+        if (decoded.bytes > 0) {
+            decoded_file_->write((const char *) decode_buff, decoded.bytes);
+        }
+        g_free(decode_buff);
+        decoded_packets_ << decoded;
+    }
+    decoded_file_->flush();
+
+    codecs_decoded_.storeRelease(1);
+    emit codecsDecoded();
+}
+
+void RtpAudioStream::decode()
+{
+    if (rtp_packets_.size() < 1 || !isDecoded()) return;
+
+    QString cur_out_name = parent()->property("currentOutputDeviceName").toString();
+    if (simulated_ && cur_out_name == simulated_out_device_) return;
+    simulated_ = true;
+    simulated_out_device_ = cur_out_name;
+
     stop_rel_time_ = start_rel_time_;
     audio_out_rate_ = 0;
     max_sample_val_ = 1;
@@ -143,6 +224,8 @@ void RtpAudioStream::reset(double start_rel_time)
     visual_samples_.clear();
     out_of_seq_timestamps_.clear();
     jitter_drop_timestamps_.clear();
+    wrong_timestamp_timestamps_.clear();
+    silence_timestamps_.clear();
 
     if (audio_resampler_) {
         speex_resampler_reset_mem(audio_resampler_);
@@ -151,26 +234,19 @@ void RtpAudioStream::reset(double start_rel_time)
         speex_resampler_reset_mem(visual_resampler_);
     }
     tempfile_->seek(0);
-}
-
-static const int sample_bytes_ = sizeof(SAMPLE) / sizeof(char);
-/* Fix for bug 4119/5902: don't insert too many silence frames.
- * XXX - is there a better thing to do here?
- */
-static const int max_silence_samples_ = MAX_SILENCE_FRAMES;
-void RtpAudioStream::decode()
-{
-    if (rtp_packets_.size() < 1) return;
+    tempfile_->resize(0);
+    decoded_file_->seek(0);
 
     // gtk/rtp_player.c:decode_rtp_stream
     // XXX This is more messy than it should be.
 
     gsize resample_buff_len = 0x1000;
     SAMPLE *resample_buff = (SAMPLE *) g_malloc(resample_buff_len);
+    gsize decode_buff_len = 0x1000;
+    SAMPLE *decode_buff = (SAMPLE *) g_malloc(decode_buff_len);
     spx_uint32_t cur_in_rate = 0, visual_out_rate = 0;
     char *write_buff = NULL;
     qint64 write_bytes = 0;
-    unsigned channels = 0;
     unsigned sample_rate = 0;
     int last_sequence = 0;
 
@@ -184,8 +260,6 @@ void RtpAudioStream::decode()
     size_t decoded_bytes_prev = 0;
 
     for (int cur_packet = 0; cur_packet < rtp_packets_.size(); cur_packet++) {
-        SAMPLE *decode_buff = NULL;
-        // XXX The GTK+ UI updates a progress bar here.
         rtp_packet_t *rtp_packet = rtp_packets_[cur_packet];
 
         stop_rel_time_ = start_rel_time_ + rtp_packet->arrive_offset;
@@ -208,7 +282,16 @@ void RtpAudioStream::decode()
             last_sequence = rtp_packet->info->info_seq_num - 1;
         }
 
-        size_t decoded_bytes = decode_rtp_packet(rtp_packet, &decode_buff, decoders_hash_, &channels, &sample_rate);
+        size_t decoded_bytes = decoded_packets_[cur_packet].bytes;
+        sample_rate = decoded_packets_[cur_packet].sample_rate;
+        if (decoded_bytes > 0) {
+            if (decoded_bytes > decode_buff_len) {
+                while (decoded_bytes > decode_buff_len)
+                    decode_buff_len *= 2;
+                decode_buff = (SAMPLE *) g_realloc(decode_buff, decode_buff_len);
+            }
+            decoded_file_->read((char *) decode_buff, decoded_bytes);
+        }
 
         unsigned rtp_clock_rate = sample_rate;
         if (rtp_packet->info->info_payload_type == PT_G722) {
@@ -219,14 +302,12 @@ void RtpAudioStream::decode()
         if (decoded_bytes == 0 || sample_rate == 0) {
             // We didn't decode anything. Clean up and prep for the next packet.
             last_sequence = rtp_packet->info->info_seq_num;
-            g_free(decode_buff);
             continue;
         }
 
         if (audio_out_rate_ == 0) {
             // Use the first non-zero rate we find. Ajust it to match our audio hardware.
             QAudioDeviceInfo cur_out_device = QAudioDeviceInfo::defaultOutputDevice();
-            QString cur_out_name = parent()->property("currentOutputDeviceName").toString();
             foreach (QAudioDeviceInfo out_device, QAudioDeviceInfo::availableDevices(QAudio::AudioOutput)) {
                 if (cur_out_name == out_device.deviceName()) {
                     cur_out_device = out_device;
@@ -381,10 +462,8 @@ void RtpAudioStream::decode()
             if (qAbs(resample_buff[i]) > max_sample_val_) max_sample_val_ = qAbs(resample_buff[i]);
             visual_samples_.append(resample_buff[i]);
         }
-
-        // Finally, write the resampled audio to our temp file and clean up.
-        g_free(decode_buff);
     }
+    g_free(decode_buff);
     g_free(resample_buff);
 }
 
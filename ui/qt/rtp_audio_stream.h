@@ -19,6 +19,7 @@
 #include <epan/address.h>
 #include <ui/rtp_stream.h>
 
+#include <QAtomicInt>
 #include <QAudio>
 #include <QColor>
 #include <QMap>
@@ -29,6 +30,7 @@
 class QAudioFormat;
 class QAudioOutput;
 class QTemporaryFile;
+class QThreadPool;
 
 struct _rtp_info;
 struct _rtp_sample;
@@ -46,6 +48,28 @@ public:
     //void addRtpStream(const rtpstream_info_t *rtpstream);
     void addRtpPacket(const struct _packet_info *pinfo, const struct _rtp_info *rtp_info);
     void reset(double start_rel_time);
+    /**
+     * @brief Run each packet through its codec. This is the slow part of
+     * decoding and doesn't depend on the playback options, so it's done
+     * once. It only uses this stream's own codec instances, so it can run
+     * in a worker thread; it emits codecsDecoded() when it's finished.
+     */
+    void decodeCodecs();
+    /**
+     * @brief Queue decodeCodecs() on a thread pool unless it already has been.
+     */
+    void startDecoding(QThreadPool *pool);
+    /**
+     * @brief Stop a queued or running decodeCodecs() as soon as possible.
+     */
+    void cancelDecoding() { cancel_decoding_.storeRelease(1); }
+    bool isDecoded() const { return codecs_decoded_.loadAcquire() != 0; }
+    /**
+     * @brief Apply the playback options to the decoded audio: simulate the
+     * jitter buffer, resample for output and collect the visual samples.
+     * Does nothing before decodeCodecs() has finished, or if the options
+     * haven't changed since the last time.
+     */
     void decode();
 
     double startRelTime() const { return start_rel_time_; }
@@ -125,10 +149,17 @@ public:
 
     QAudio::State outputState() const;
 
-    void setJitterBufferSize(int jitter_buffer_size) { jitter_buffer_size_ = jitter_buffer_size; }
-    void setTimingMode(TimingMode timing_mode) { timing_mode_ = timing_mode; }
+    void setJitterBufferSize(int jitter_buffer_size) {
+        if (jitter_buffer_size != jitter_buffer_size_) simulated_ = false;
+        jitter_buffer_size_ = jitter_buffer_size;
+    }
+    void setTimingMode(TimingMode timing_mode) {
+        if (timing_mode != timing_mode_) simulated_ = false;
+        timing_mode_ = timing_mode;
+    }
 
 signals:
+    void codecsDecoded();
     void startedPlaying();
     void processedSecs(double secs);
     void playbackError(const QString error_msg);
@@ -146,6 +177,24 @@ private:
     QVector<struct _rtp_packet *>rtp_packets_;
     QTemporaryFile *tempfile_;
     struct _GHashTable *decoders_hash_;
+
+    // Codec output for each of rtp_packets_, written by decodeCodecs().
+    // The samples go to decoded_file_ one packet after another so that
+    // long calls don't have to be kept in memory.
+    struct DecodedPacket {
+        size_t bytes;
+        unsigned sample_rate;
+    };
+    QVector<DecodedPacket> decoded_packets_;
+    QTemporaryFile *decoded_file_;
+    bool decoding_started_;
+    QAtomicInt codecs_decoded_;
+    QAtomicInt cancel_decoding_;
+
+    // The options decode() last ran with.
+    bool simulated_;
+    QString simulated_out_device_;
+
     // TODO: It is not used
     //QList<const rtpstream_info_t *>rtpstreams_;
     double global_start_rel_time_;
@@ -42,7 +42,6 @@
 // - Make streams checkable.
 // - Add silence, drop & jitter indicators to the graph.
 // - How to handle multiple channels?
-// - Threaded decoding?
 // - Play MP3s. As per Zawinski's Law we already read emails.
 // - RTP audio streams are currently keyed on src addr + src port + dst addr
 //   + dst port + ssrc. This means that we can have multiple rtp_stream_info
@@ -93,6 +92,8 @@ RtpPlayerDialog::RtpPlayerDialog(QWidget &parent, CaptureFile &cf) :
 #ifdef QT_MULTIMEDIA_LIB
     , ui(new Ui::RtpPlayerDialog)
     , start_rel_time_(0.0)
+    , rescale_when_decoded_(false)
+    , decoding_streams_(0)
 #endif // QT_MULTIMEDIA_LIB
 {
     ui->setupUi(this);
@@ -167,6 +168,10 @@ RtpPlayerDialog::RtpPlayerDialog(QWidget &parent, CaptureFile &cf) :
                 );
     ui->audioPlot->setFocus();
 
+    decoded_timer_.setSingleShot(true);
+    decoded_timer_.setInterval(100);
+    connect(&decoded_timer_, SIGNAL(timeout()), this, SLOT(rescanPackets()));
+
     QTimer::singleShot(0, this, SLOT(retapPackets()));
 #endif // QT_MULTIMEDIA_LIB
 }
@@ -184,6 +189,13 @@ QPushButton *RtpPlayerDialog::addPlayerButton(QDialogButtonBox *button_box)
 #ifdef QT_MULTIMEDIA_LIB
 RtpPlayerDialog::~RtpPlayerDialog()
 {
+    // The decoding workers use our streams, which are about to go away.
+    for (int row = 0; row < ui->streamTreeWidget->topLevelItemCount(); row++) {
+        QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
+        RtpAudioStream *audio_stream = ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>();
+        audio_stream->cancelDecoding();
+    }
+    decode_pool_.waitForDone();
     delete ui;
 }
 
@@ -214,7 +226,7 @@ void RtpPlayerDialog::retapPackets()
         g_string_free(error_string, TRUE);
         return;
     }
-    cap_file_.retapPackets();
+    cap_file_.retapListener(this);
     remove_tap_listener(this);
 
     rescanPackets(true);
@@ -236,6 +248,9 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
     bool show_legend = false;
     bool relative_timestamps = !ui->todCheckBox->isChecked();
 
+    if (rescale_axes) rescale_when_decoded_ = true;
+    decoding_streams_ = 0;
+
     ui->audioPlot->xAxis->setTickLabelType(relative_timestamps ? QCPAxis::ltNumber : QCPAxis::ltDateTime);
 
     for (int row = 0; row < row_count; row++) {
@@ -258,6 +273,12 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
         }
         audio_stream->setTimingMode(timing_mode);
 
+        if (!audio_stream->isDecoded()) {
+            // streamDecoded() will bring us back here.
+            audio_stream->startDecoding(&decode_pool_);
+            decoding_streams_++;
+            continue;
+        }
         audio_stream->decode();
 
         // Waveform
@@ -348,11 +369,22 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
     }
 
     ui->audioPlot->replot();
-    if (rescale_axes) resetXAxis();
+    if (rescale_when_decoded_) {
+        resetXAxis();
+        // Keep the axes fitted to the streams as they come in.
+        rescale_when_decoded_ = decoding_streams_ > 0;
+    }
 
     updateWidgets();
 }
 
+void RtpPlayerDialog::streamDecoded()
+{
+    if (!decoded_timer_.isActive()) {
+        decoded_timer_.start();
+    }
+}
+
 void RtpPlayerDialog::addRtpStream(rtpstream_info_t *rtpstream)
 {
     if (!rtpstream) return;
@@ -399,6 +431,7 @@ void RtpPlayerDialog::addRtpStream(rtpstream_info_t *rtpstream)
         connect(audio_stream, SIGNAL(finishedPlaying()), this, SLOT(updateWidgets()));
         connect(audio_stream, SIGNAL(playbackError(QString)), this, SLOT(setPlaybackError(QString)));
         connect(audio_stream, SIGNAL(processedSecs(double)), this, SLOT(setPlayPosition(double)));
+        connect(audio_stream, SIGNAL(codecsDecoded()), this, SLOT(streamDecoded()));
     }
     // TODO: does not do anything
     // audio_stream->addRtpStream(rtpstream);
@@ -480,6 +513,11 @@ void RtpPlayerDialog::updateWidgets()
     bool enable_stop = false;
     bool enable_timing = true;
 
+    // Streams that are still decoding can't be played.
+    if (decoding_streams_ > 0) {
+        enable_play = false;
+    }
+
     for (int row = 0; row < ui->streamTreeWidget->topLevelItemCount(); row++) {
         QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
 
@@ -524,6 +562,9 @@ void RtpPlayerDialog::updateHintLabel()
                 .arg(packet_num);
     } else if (!playback_error_.isEmpty()) {
         hint += playback_error_;
+    } else if (decoding_streams_ > 0) {
+        hint += tr("%n stream(s) left to decode" UTF8_HORIZONTAL_ELLIPSIS, "",
+                   decoding_streams_);
     }
 
     hint += "</i></small>";
@@ -19,6 +19,8 @@
 #include "wireshark_dialog.h"
 
 #include <QMap>
+#include <QThreadPool>
+#include <QTimer>
 
 namespace Ui {
 class RtpPlayerDialog;
@@ -76,9 +78,11 @@ private slots:
      * streams added using ::addRtpStream.
      */
     void retapPackets();
-    /** Clear, decode, and redraw each stream.
+    /** Clear, decode, and redraw each stream. Streams whose codecs haven't
+     * been run yet are queued on decode_pool_ and drawn once they have.
      */
     void rescanPackets(bool rescale_axes = false);
+    void streamDecoded();
     void updateWidgets();
     void graphClicked(QMouseEvent *event);
     void updateHintLabel();
@@ -112,6 +116,11 @@ private:
     double start_rel_time_;
     QCPItemStraightLine *cur_play_pos_;
     QString playback_error_;
+    QThreadPool decode_pool_;
+    // Coalesces the rescans for streams that finish decoding close together.
+    QTimer decoded_timer_;
+    bool rescale_when_decoded_;
+    int decoding_streams_;
 
 //    const QString streamKey(const rtpstream_info_t *rtpstream);
 //    const QString streamKey(const packet_info *pinfo, const struct _rtp_info *rtpinfo);
@@ -720,13 +720,27 @@ gboolean SequenceDialog::addFlowSequenceItem(const void* key, void *value, void
 
 SequenceInfo::SequenceInfo(seq_analysis_info_t *sainfo) :
     sainfo_(sainfo),
-    count_(1)
+    count_(1),
+    release_func_(NULL),
+    release_data_(NULL)
+{
+}
+
+SequenceInfo::SequenceInfo(seq_analysis_info_t *sainfo, GDestroyNotify release_func, gpointer release_data) :
+    sainfo_(sainfo),
+    count_(1),
+    release_func_(release_func),
+    release_data_(release_data)
 {
 }
 
 SequenceInfo::~SequenceInfo()
 {
-    sequence_analysis_info_free(sainfo_);
+    if (release_func_) {
+        release_func_(release_data_);
+    } else {
+        sequence_analysis_info_free(sainfo_);
+    }
 }
 
 /*
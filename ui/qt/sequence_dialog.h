@@ -34,6 +34,9 @@ class SequenceInfo
 {
 public:
     SequenceInfo(seq_analysis_info_t *sainfo = NULL);
+    // For sainfo that belongs to something else: release_func(release_data)
+    // is called instead of freeing sainfo.
+    SequenceInfo(seq_analysis_info_t *sainfo, GDestroyNotify release_func, gpointer release_data);
     seq_analysis_info_t * sainfo() { return sainfo_;}
     void ref() { count_++; }
     void unref() { if (--count_ == 0) delete this; }
@@ -41,6 +44,8 @@ private:
     ~SequenceInfo();
     seq_analysis_info_t *sainfo_;
     unsigned int count_;
+    GDestroyNotify release_func_;
+    gpointer release_data_;
 };
 
 class SequenceDialog : public WiresharkDialog
@@ -293,7 +293,7 @@ void ServiceResponseTimeDialog::fillTree()
 
     statsTreeWidget()->setSortingEnabled(false);
 
-    cap_file_.retapPackets();
+    cap_file_.retapListener(&srt_data_);
 
     // We only have one table. Move its tree items up one level.
     if (statsTreeWidget()->invisibleRootItem()->childCount() == 1) {
@@ -267,7 +267,7 @@ void SimpleStatisticsDialog::fillTree()
         return;
     }
 
-    cap_file_.retapPackets();
+    cap_file_.retapListener(&stat_data);
 
     // We only have one table. Move its tree items up one level.
     if (statsTreeWidget()->invisibleRootItem()->childCount() == 1) {
@@ -137,7 +137,7 @@ void StatsTreeDialog::fillTree()
         return;
     }
 
-    cap_file_.retapPackets();
+    cap_file_.retapListener(st_);
     drawTreeItems(st_);
 
     statsTreeWidget()->setSortingEnabled(true);
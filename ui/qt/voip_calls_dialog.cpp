@@ -78,23 +78,47 @@ VoipCallsDialog::VoipCallsDialog(QWidget &parent, CaptureFile &cf, bool all_flow
     connect(ca, SIGNAL(triggered()), this, SLOT(copyAsYAML()));
     copy_button_->setMenu(copy_menu);
 
-    memset (&tapinfo_, 0, sizeof(tapinfo_));
-    tapinfo_.tap_packet = tapPacket;
-    tapinfo_.tap_draw = tapDraw;
-    tapinfo_.tap_data = this;
-    tapinfo_.callsinfos = g_queue_new();
-    tapinfo_.h225_cstype = H225_OTHER;
-    tapinfo_.fs_option = all_flows ? FLOW_ALL : FLOW_ONLY_INVITES; /* flow show option */
-    tapinfo_.graph_analysis = sequence_analysis_info_new();
-    tapinfo_.graph_analysis->name = "voip";
-    sequence_info_ = new SequenceInfo(tapinfo_.graph_analysis);
-
-    voip_calls_init_all_taps(&tapinfo_);
+    // If the calls were collected while the file was read, show those
+    // instead of retapping, unless another dialog is already showing them.
+    tapinfo_ = NULL;
+    if (!all_flows && cap_file_.isValid()) {
+        tapinfo_ = voip_calls_collector_ref();
+        if (tapinfo_ && tapinfo_->tap_data) {
+            voip_calls_collector_unref(tapinfo_);
+            tapinfo_ = NULL;
+        }
+    }
+    shared_tapinfo_ = tapinfo_ != NULL;
+
+    if (shared_tapinfo_) {
+        tapinfo_->tap_packet = tapPacket;
+        tapinfo_->tap_draw = tapDraw;
+        tapinfo_->tap_data = this;
+        // Sequence dialogs can outlive us, so our reference goes with the
+        // graph analysis.
+        sequence_info_ = new SequenceInfo(tapinfo_->graph_analysis,
+                                          (GDestroyNotify) voip_calls_collector_unref, tapinfo_);
+    } else {
+        tapinfo_ = g_new0(voip_calls_tapinfo_t, 1);
+        tapinfo_->tap_packet = tapPacket;
+        tapinfo_->tap_draw = tapDraw;
+        tapinfo_->tap_data = this;
+        tapinfo_->callsinfos = g_queue_new();
+        tapinfo_->h225_cstype = H225_OTHER;
+        tapinfo_->fs_option = all_flows ? FLOW_ALL : FLOW_ONLY_INVITES; /* flow show option */
+        tapinfo_->graph_analysis = sequence_analysis_info_new();
+        tapinfo_->graph_analysis->name = "voip";
+        sequence_info_ = new SequenceInfo(tapinfo_->graph_analysis);
+
+        voip_calls_init_all_taps(tapinfo_);
+    }
 
     updateWidgets();
 
-    if (cap_file_.isValid()) {
-        tapinfo_.session = cap_file_.capFile()->epan;
+    if (shared_tapinfo_) {
+        updateCalls();
+    } else if (cap_file_.isValid()) {
+        tapinfo_->session = cap_file_.capFile()->epan;
         cap_file_.delayedRetapPackets();
     }
 }
@@ -103,15 +127,36 @@ VoipCallsDialog::~VoipCallsDialog()
 {
     delete ui;
 
-    voip_calls_reset_all_taps(&tapinfo_);
-    voip_calls_remove_all_tap_listeners(&tapinfo_);
-    sequence_info_->unref();
-    g_queue_free(tapinfo_.callsinfos);
+    if (shared_tapinfo_) {
+        detachTapinfo();
+        // This drops our reference to the collected calls.
+        sequence_info_->unref();
+    } else {
+        voip_calls_reset_all_taps(tapinfo_);
+        voip_calls_remove_all_tap_listeners(tapinfo_);
+        sequence_info_->unref();
+        g_queue_free(tapinfo_->callsinfos);
+        g_free(tapinfo_);
+    }
+}
+
+// The collector keeps running for the next dialog; stop calling us back.
+void VoipCallsDialog::detachTapinfo()
+{
+    if (tapinfo_->tap_data == this) {
+        tapinfo_->tap_packet = NULL;
+        tapinfo_->tap_draw = NULL;
+        tapinfo_->tap_data = NULL;
+    }
 }
 
 void VoipCallsDialog::removeTapListeners()
 {
-    voip_calls_remove_all_tap_listeners(&tapinfo_);
+    if (shared_tapinfo_) {
+        detachTapinfo();
+    } else {
+        voip_calls_remove_all_tap_listeners(tapinfo_);
+    }
     WiresharkDialog::removeTapListeners();
 }
 
@@ -121,8 +166,12 @@ void VoipCallsDialog::captureFileClosing()
     // the cache is active, the ToD cannot be modified.
     ui->todCheckBox->setEnabled(false);
     cache_model_->setSourceModel(NULL);
-    voip_calls_remove_all_tap_listeners(&tapinfo_);
-    tapinfo_.session = NULL;
+    if (shared_tapinfo_) {
+        detachTapinfo();
+    } else {
+        voip_calls_remove_all_tap_listeners(tapinfo_);
+        tapinfo_->session = NULL;
+    }
     WiresharkDialog::captureFileClosing();
 }
 
@@ -189,9 +238,17 @@ void VoipCallsDialog::tapDraw(void *tapinfo_ptr)
         return;
     }
 
-    GList *graph_item = g_queue_peek_nth_link(tapinfo->graph_analysis->items, 0);
+    VoipCallsDialog *voip_calls_dialog = static_cast<VoipCallsDialog *>(tapinfo->tap_data);
+    if (voip_calls_dialog) {
+        voip_calls_dialog->updateCalls();
+    }
+}
+
+void VoipCallsDialog::updateCalls()
+{
+    GList *graph_item = g_queue_peek_nth_link(tapinfo_->graph_analysis->items, 0);
     for (; graph_item; graph_item = g_list_next(graph_item)) {
-        for (GList *rsi_entry = g_list_first(tapinfo->rtpstream_list); rsi_entry; rsi_entry = g_list_next(rsi_entry)) {
+        for (GList *rsi_entry = g_list_first(tapinfo_->rtpstream_list); rsi_entry; rsi_entry = g_list_next(rsi_entry)) {
             seq_analysis_item_t * sai = (seq_analysis_item_t *)graph_item->data;
             rtpstream_info_t *rsi = (rtpstream_info_t *)rsi_entry->data;
 
@@ -202,18 +259,10 @@ void VoipCallsDialog::tapDraw(void *tapinfo_ptr)
         }
     }
 
-    VoipCallsDialog *voip_calls_dialog = static_cast<VoipCallsDialog *>(tapinfo->tap_data);
-    if (voip_calls_dialog) {
-        voip_calls_dialog->updateCalls();
-    }
-}
-
-void VoipCallsDialog::updateCalls()
-{
     ui->callTreeView->setSortingEnabled(false);
 
     // Add any missing items
-    call_infos_model_->updateCalls(tapinfo_.callsinfos);
+    call_infos_model_->updateCalls(tapinfo_->callsinfos);
 
     // Resize columns
     for (int i = 0; i < call_infos_model_->columnCount(); i++) {
@@ -230,7 +279,7 @@ void VoipCallsDialog::updateWidgets()
     bool selected = ui->callTreeView->selectionModel()->hasSelection();
     bool have_ga_items = false;
 
-    if (tapinfo_.graph_analysis && tapinfo_.graph_analysis->items) {
+    if (tapinfo_->graph_analysis && tapinfo_->graph_analysis->items) {
         have_ga_items = true;
     }
 
@@ -246,7 +295,7 @@ void VoipCallsDialog::updateWidgets()
 
 void VoipCallsDialog::prepareFilter()
 {
-    if (!ui->callTreeView->selectionModel()->hasSelection() || !tapinfo_.graph_analysis) {
+    if (!ui->callTreeView->selectionModel()->hasSelection() || !tapinfo_->graph_analysis) {
         return;
     }
 
@@ -263,7 +312,7 @@ void VoipCallsDialog::prepareFilter()
         selected_calls << call_info->call_num;
     }
 
-    GList *cur_ga_item = g_queue_peek_nth_link(tapinfo_.graph_analysis->items, 0);
+    GList *cur_ga_item = g_queue_peek_nth_link(tapinfo_->graph_analysis->items, 0);
     while (cur_ga_item && cur_ga_item->data) {
         seq_analysis_item_t *ga_item = (seq_analysis_item_t*) cur_ga_item->data;
         if (selected_calls.contains(ga_item->conv_num)) {
@@ -381,8 +430,8 @@ void VoipCallsDialog::showSequence()
         selected_calls << call_info->call_num;
     }
 
-    sequence_analysis_list_sort(tapinfo_.graph_analysis);
-    GList *cur_ga_item = g_queue_peek_nth_link(tapinfo_.graph_analysis->items, 0);
+    sequence_analysis_list_sort(tapinfo_->graph_analysis);
+    GList *cur_ga_item = g_queue_peek_nth_link(tapinfo_->graph_analysis->items, 0);
     while (cur_ga_item && cur_ga_item->data) {
         seq_analysis_item_t *ga_item = (seq_analysis_item_t*) cur_ga_item->data;
         ga_item->display = selected_calls.contains(ga_item->conv_num);
@@ -402,7 +451,7 @@ void VoipCallsDialog::showPlayer()
         voip_calls_info_t *vci = VoipCallsInfoModel::indexToCallInfo(index);
         if (!vci) continue;
 
-        for (GList *rsi_entry = g_list_first(tapinfo_.rtpstream_list); rsi_entry; rsi_entry = g_list_next(rsi_entry)) {
+        for (GList *rsi_entry = g_list_first(tapinfo_->rtpstream_list); rsi_entry; rsi_entry = g_list_next(rsi_entry)) {
             rtpstream_info_t *rsi = (rtpstream_info_t *)rsi_entry->data;
             if (!rsi) continue;
 
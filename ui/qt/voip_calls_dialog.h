@@ -59,7 +59,9 @@ private:
     QSortFilterProxyModel *sorted_model_;
 
     QWidget &parent_;
-    voip_calls_tapinfo_t tapinfo_;
+    voip_calls_tapinfo_t *tapinfo_;
+    // tapinfo_ is the calls collected while the file was read.
+    bool shared_tapinfo_;
     SequenceInfo *sequence_info_;
     QPushButton *prepare_button_;
     QPushButton *sequence_button_;
@@ -71,6 +73,7 @@ private:
     static tap_packet_status tapPacket(void *tapinfo_ptr, packet_info *pinfo, epan_dissect_t *, const void *data);
     static void tapDraw(void *tapinfo_ptr);
 
+    void detachTapinfo();
     void updateCalls();
     void prepareFilter();
     void showSequence();
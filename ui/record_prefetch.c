@@ -0,0 +1,298 @@
+/* record_prefetch.c
+ * Background reading of capture file records for random access
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/buffer.h>
+
+#include "record_prefetch.h"
+
+/* A record we've been asked for */
+typedef struct {
+    guint32 num;            /* frame number */
+    gint64  file_off;
+    guint32 cap_len;
+} prefetch_req_t;
+
+/* A record we've read */
+typedef struct {
+    guint32  num;
+    guint32  data_len;
+    wtap_rec rec;
+    Buffer   buf;
+} prefetch_entry_t;
+
+struct _record_prefetch {
+    wtap         *wth;          /* our own handle, used only by the worker */
+    guint         max_records;
+
+    GThread      *thread;
+    GMutex        mutex;
+    GCond         cond;
+    gboolean      quit;
+    gboolean      failed;       /* we can't read the file ourselves */
+
+    GQueue        requests;     /* prefetch_req_t *, most urgent first */
+    GHashTable   *pending;      /* frame number -> prefetch_req_t *, queued or being read */
+    GHashTable   *cache;        /* frame number -> link in lru */
+    GQueue        lru;          /* prefetch_entry_t *, most recently used first */
+};
+
+static void
+prefetch_entry_free(prefetch_entry_t *entry)
+{
+    wtap_rec_cleanup(&entry->rec);
+    ws_buffer_free(&entry->buf);
+    g_free(entry);
+}
+
+/* Forget the requests that haven't been started. Called with the lock held. */
+static void
+prefetch_clear_requests(record_prefetch_t *rp)
+{
+    prefetch_req_t *req;
+
+    while ((req = (prefetch_req_t *)g_queue_pop_head(&rp->requests)) != NULL) {
+        g_hash_table_remove(rp->pending, GUINT_TO_POINTER(req->num));
+        g_free(req);
+    }
+}
+
+/* Add a record we've read. Called with the lock held. */
+static void
+prefetch_add_entry(record_prefetch_t *rp, prefetch_entry_t *entry)
+{
+    prefetch_entry_t *old;
+
+    if (g_hash_table_lookup(rp->cache, GUINT_TO_POINTER(entry->num)) != NULL) {
+        prefetch_entry_free(entry);
+        return;
+    }
+    g_queue_push_head(&rp->lru, entry);
+    g_hash_table_insert(rp->cache, GUINT_TO_POINTER(entry->num), rp->lru.head);
+
+    while (rp->lru.length > rp->max_records) {
+        old = (prefetch_entry_t *)g_queue_pop_tail(&rp->lru);
+        g_hash_table_remove(rp->cache, GUINT_TO_POINTER(old->num));
+        prefetch_entry_free(old);
+    }
+}
+
+static gpointer
+record_prefetch_worker(gpointer data)
+{
+    record_prefetch_t *rp = (record_prefetch_t *)data;
+    prefetch_req_t *req;
+    prefetch_entry_t *entry;
+    int err;
+    gchar *err_info = NULL;
+    gboolean ok;
+
+    g_mutex_lock(&rp->mutex);
+    for (;;) {
+        while (!rp->quit && g_queue_is_empty(&rp->requests))
+            g_cond_wait(&rp->cond, &rp->mutex);
+        if (rp->quit)
+            break;
+
+        /* Leave it in pending while we read it. */
+        req = (prefetch_req_t *)g_queue_pop_head(&rp->requests);
+        g_mutex_unlock(&rp->mutex);
+
+        entry = g_new(prefetch_entry_t, 1);
+        entry->num = req->num;
+        entry->data_len = req->cap_len;
+        wtap_rec_init(&entry->rec);
+        ws_buffer_init(&entry->buf, req->cap_len);
+        ok = wtap_seek_read(rp->wth, req->file_off, &entry->rec, &entry->buf, &err, &err_info);
+        if (!ok) {
+            /*
+             * The caller will get the error, if there really is one, when
+             * it reads the record itself. This is also what happens to a
+             * record whose interface is described only later in the file;
+             * our handle hasn't read that far.
+             */
+            g_free(err_info);
+            err_info = NULL;
+        }
+
+        g_mutex_lock(&rp->mutex);
+        g_hash_table_remove(rp->pending, GUINT_TO_POINTER(req->num));
+        g_free(req);
+        if (ok)
+            prefetch_add_entry(rp, entry);
+        else
+            prefetch_entry_free(entry);
+    }
+    g_mutex_unlock(&rp->mutex);
+    return NULL;
+}
+
+record_prefetch_t *
+record_prefetch_new(wtap *wth, const char *filename, unsigned int type,
+                    guint max_records)
+{
+    record_prefetch_t *rp = g_new0(record_prefetch_t, 1);
+    int err;
+    gchar *err_info = NULL;
+
+    /*
+     * Our own handle, so we never get in the way of the UI's reads.
+     * Records in later sections of a pcapng file are read relative to
+     * the section's own header, which a freshly opened handle hasn't
+     * seen, so leave files with more than one section to the caller.
+     */
+    if (wtap_file_get_num_shbs(wth) == 1) {
+        rp->wth = wtap_open_offline(filename, type, &err, &err_info, TRUE);
+        g_free(err_info);
+    }
+    if (rp->wth != NULL)
+        wtap_copy_fast_seek(rp->wth, wth);
+    else
+        rp->failed = TRUE;
+
+    rp->max_records = max_records > 0 ? max_records : 1;
+    g_mutex_init(&rp->mutex);
+    g_cond_init(&rp->cond);
+    g_queue_init(&rp->requests);
+    rp->pending = g_hash_table_new(g_direct_hash, g_direct_equal);
+    rp->cache = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_queue_init(&rp->lru);
+    if (!rp->failed)
+        rp->thread = g_thread_new("record prefetch", record_prefetch_worker, rp);
+    return rp;
+}
+
+void
+record_prefetch_free(record_prefetch_t *rp)
+{
+    prefetch_entry_t *entry;
+
+    if (rp == NULL)
+        return;
+
+    g_mutex_lock(&rp->mutex);
+    rp->quit = TRUE;
+    prefetch_clear_requests(rp);
+    g_cond_signal(&rp->cond);
+    g_mutex_unlock(&rp->mutex);
+    if (rp->thread != NULL)
+        g_thread_join(rp->thread);
+    if (rp->wth != NULL)
+        wtap_close(rp->wth);
+
+    while ((entry = (prefetch_entry_t *)g_queue_pop_head(&rp->lru)) != NULL)
+        prefetch_entry_free(entry);
+    g_hash_table_destroy(rp->cache);
+    g_hash_table_destroy(rp->pending);
+    g_cond_clear(&rp->cond);
+    g_mutex_clear(&rp->mutex);
+    g_free(rp);
+}
+
+void
+record_prefetch_request(record_prefetch_t *rp, const frame_data_sequence *fds,
+                        frame_data **frames, guint count)
+{
+    prefetch_req_t *req;
+    GList *link;
+    guint i;
+
+    g_mutex_lock(&rp->mutex);
+    if (rp->failed) {
+        g_mutex_unlock(&rp->mutex);
+        return;
+    }
+
+    prefetch_clear_requests(rp);
+    for (i = 0; i < count; i++) {
+        link = (GList *)g_hash_table_lookup(rp->cache, GUINT_TO_POINTER(frames[i]->num));
+        if (link != NULL) {
+            /* Keep records that are still wanted from being pushed out. */
+            g_queue_unlink(&rp->lru, link);
+            g_queue_push_head_link(&rp->lru, link);
+            continue;
+        }
+        if (g_hash_table_lookup(rp->pending, GUINT_TO_POINTER(frames[i]->num)) != NULL)
+            continue;
+
+        req = g_new(prefetch_req_t, 1);
+        req->num = frames[i]->num;
+        req->file_off = frame_data_sequence_get_file_off(fds, frames[i]->num);
+        req->cap_len = frames[i]->cap_len;
+        g_queue_push_tail(&rp->requests, req);
+        g_hash_table_insert(rp->pending, GUINT_TO_POINTER(req->num), req);
+    }
+    if (!g_queue_is_empty(&rp->requests))
+        g_cond_signal(&rp->cond);
+    g_mutex_unlock(&rp->mutex);
+}
+
+gboolean
+record_prefetch_is_pending(record_prefetch_t *rp, const frame_data *fdata)
+{
+    gboolean pending;
+
+    g_mutex_lock(&rp->mutex);
+    pending = g_hash_table_lookup(rp->pending, GUINT_TO_POINTER(fdata->num)) != NULL;
+    g_mutex_unlock(&rp->mutex);
+    return pending;
+}
+
+gboolean
+record_prefetch_get(record_prefetch_t *rp, const frame_data *fdata,
+                    wtap_rec *rec, Buffer *buf)
+{
+    prefetch_entry_t *entry;
+    Buffer options_buf;
+    GList *link;
+
+    g_mutex_lock(&rp->mutex);
+    link = (GList *)g_hash_table_lookup(rp->cache, GUINT_TO_POINTER(fdata->num));
+    if (link == NULL) {
+        g_mutex_unlock(&rp->mutex);
+        return FALSE;
+    }
+    g_queue_unlink(&rp->lru, link);
+    g_queue_push_head_link(&rp->lru, link);
+    entry = (prefetch_entry_t *)link->data;
+
+    /* Copy the record, keeping the caller's own buffers. */
+    g_free(rec->opt_comment);
+    options_buf = rec->options_buf;
+    *rec = entry->rec;
+    rec->opt_comment = g_strdup(entry->rec.opt_comment);
+    rec->options_buf = options_buf;
+    ws_buffer_clean(&rec->options_buf);
+    ws_buffer_append(&rec->options_buf, ws_buffer_start_ptr(&entry->rec.options_buf),
+                     ws_buffer_length(&entry->rec.options_buf));
+
+    ws_buffer_assure_space(buf, entry->data_len);
+    memcpy(ws_buffer_start_ptr(buf), ws_buffer_start_ptr(&entry->buf), entry->data_len);
+    g_mutex_unlock(&rp->mutex);
+    return TRUE;
+}
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
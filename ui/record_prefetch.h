@@ -0,0 +1,102 @@
+/* record_prefetch.h
+ * Background reading of capture file records for random access
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __RECORD_PREFETCH_H__
+#define __RECORD_PREFETCH_H__
+
+#include <glib.h>
+
+#include <epan/frame_data.h>
+#include <epan/frame_data_sequence.h>
+#include <wiretap/wtap.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * A worker thread with its own random-access handle on a capture file,
+ * which reads the records it's asked for ahead of time and keeps the most
+ * recently used ones in memory, so that a UI scrolling through a large
+ * file on a slow or compressed medium doesn't wait for each one.
+ *
+ * Only the reading is done in the background; dissection isn't thread
+ * safe, so records are still dissected by the caller.
+ */
+
+typedef struct _record_prefetch record_prefetch_t;
+
+/**
+ * Start prefetching from a capture file. The worker's handle is opened
+ * here and given the fast seek points of the caller's handle, so that
+ * compressed files don't have to be decompressed from the start for each
+ * record. If the file can't be opened, or has more than one section, the
+ * prefetcher just never has any records.
+ *
+ * @param wth the caller's handle, which has read through the whole file
+ * @param filename the capture file, which must not change while we use it
+ * @param type open_routine index+1 used to open it, or WTAP_TYPE_AUTO
+ * @param max_records number of records to keep
+ * @return the prefetcher
+ */
+record_prefetch_t *record_prefetch_new(wtap *wth, const char *filename,
+                                       unsigned int type, guint max_records);
+
+/** Stop the worker thread and free everything. */
+void record_prefetch_free(record_prefetch_t *rp);
+
+/**
+ * Say which records will be wanted next, most urgent first. This
+ * replaces any earlier requests that haven't been read yet.
+ *
+ * @param rp the prefetcher
+ * @param fds the frame_data_sequence the frames are in, for their offsets
+ * @param frames the records' frame_data; only looked at during the call
+ * @param count number of entries in frames
+ */
+void record_prefetch_request(record_prefetch_t *rp,
+                             const frame_data_sequence *fds,
+                             frame_data **frames, guint count);
+
+/**
+ * Is the record for a frame requested but not read yet?
+ */
+gboolean record_prefetch_is_pending(record_prefetch_t *rp, const frame_data *fdata);
+
+/**
+ * Get a record if it has already been read. Never waits for I/O.
+ *
+ * @param rp the prefetcher
+ * @param fdata the frame whose record we want
+ * @param rec filled in with the record's metadata
+ * @param buf filled in with the record's data
+ * @return TRUE if we had it, FALSE if the caller has to read it itself
+ */
+gboolean record_prefetch_get(record_prefetch_t *rp, const frame_data *fdata,
+                             wtap_rec *rec, Buffer *buf);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __RECORD_PREFETCH_H__ */
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
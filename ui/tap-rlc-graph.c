@@ -101,6 +101,7 @@ rlc_lte_tap_info *select_rlc_lte_session(capture_file *cf,
 
     GString        *error_string;
     nstime_t        rel_ts;
+    void           *prev_only;
     /* Initialised to no known channels */
     th_t            th = {0, {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL}};
 
@@ -129,6 +130,8 @@ rlc_lte_tap_info *select_rlc_lte_session(capture_file *cf,
         exit(1);   /* XXX: fix this */
     }
 
+    /* Only our listener gets this packet; the others have seen it. */
+    prev_only = set_tap_listener_only(&th);
     epan_dissect_init(&edt, cf->epan, TRUE, FALSE);
     epan_dissect_prime_with_dfilter(&edt, sfcode);
     epan_dissect_run_with_taps(&edt, cf->cd_t, &cf->rec,
@@ -136,6 +139,7 @@ rlc_lte_tap_info *select_rlc_lte_session(capture_file *cf,
                                fdata, NULL);
     rel_ts = edt.pi.rel_ts;
     epan_dissect_cleanup(&edt);
+    set_tap_listener_only(prev_only);
     remove_tap_listener(&th);
 
     if (th.num_hdrs == 0){
@@ -105,6 +105,7 @@ graph_segment_list_get(capture_file *cf, struct tcp_graph *tg, gboolean stream_k
 {
     struct segment current;
     GString    *error_string;
+    gchar      *filter;
     tcp_scan_t  ts;
 
     g_log(NULL, G_LOG_LEVEL_DEBUG, "graph_segment_list_get()");
@@ -133,13 +134,16 @@ graph_segment_list_get(capture_file *cf, struct tcp_graph *tg, gboolean stream_k
     }
 
     /* rescan all the packets and pick up all interesting tcp headers.
-     * we only filter for TCP here for speed and do the actual compare
+     * we only filter for the stream here, which lets the retap skip the
+     * other packets if tcp.stream is indexed, and do the actual compare
      * in the tap listener
      */
     ts.current = &current;
     ts.tg      = tg;
     ts.last    = NULL;
-    error_string = register_tap_listener("tcp", &ts, "tcp", 0, NULL, tapall_tcpip_packet, NULL, NULL);
+    filter = g_strdup_printf("tcp.stream eq %u", tg->stream);
+    error_string = register_tap_listener("tcp", &ts, filter, 0, NULL, tapall_tcpip_packet, NULL, NULL);
+    g_free(filter);
     if (error_string) {
         fprintf(stderr, "wireshark: Couldn't register tcp_graph tap: %s\n",
                 error_string->str);
@@ -277,6 +281,7 @@ select_tcpip_session(capture_file *cf, struct segment *hdrs)
     gchar          *err_msg;
     GString        *error_string;
     nstime_t        rel_ts;
+    void           *prev_only;
     th_t th = {0, {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL}};
 
     if (!cf || !hdrs) {
@@ -305,6 +310,8 @@ select_tcpip_session(capture_file *cf, struct segment *hdrs)
         exit(1);
     }
 
+    /* Only our listener gets this packet; the others have seen it. */
+    prev_only = set_tap_listener_only(&th);
     epan_dissect_init(&edt, cf->epan, TRUE, FALSE);
     epan_dissect_prime_with_dfilter(&edt, sfcode);
     epan_dissect_run_with_taps(&edt, cf->cd_t, &cf->rec,
@@ -312,6 +319,7 @@ select_tcpip_session(capture_file *cf, struct segment *hdrs)
                                fdata, NULL);
     rel_ts = edt.pi.rel_ts;
     epan_dissect_cleanup(&edt);
+    set_tap_listener_only(prev_only);
     remove_tap_listener(&th);
 
     if (th.num_hdrs == 0) {
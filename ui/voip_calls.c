@@ -311,6 +311,110 @@ voip_calls_reset_all_taps(voip_calls_tapinfo_t *tapinfo)
     return;
 }
 
+/****************************************************************************/
+/* Calls collected while the capture file is read */
+
+typedef struct {
+    voip_calls_tapinfo_t tapinfo;   /* must be first */
+    guint                ref_count;
+    guint                pause_depth;   /* unmatched voip_calls_collector_pause() calls */
+} voip_calls_collector_t;
+
+static voip_calls_collector_t *the_collector = NULL;
+
+void
+voip_calls_collector_start(epan_t *session)
+{
+    voip_calls_tapinfo_t *tapinfo;
+    guint pause_depth = the_collector ? the_collector->pause_depth : 0;
+
+    voip_calls_collector_stop();
+
+    /* A restart can happen while paused; the pause still has to be undone. */
+    the_collector = g_new0(voip_calls_collector_t, 1);
+    the_collector->ref_count = 1;
+    the_collector->pause_depth = pause_depth;
+
+    tapinfo = &the_collector->tapinfo;
+    tapinfo->callsinfos = g_queue_new();
+    tapinfo->h225_cstype = H225_OTHER;
+    tapinfo->fs_option = FLOW_ONLY_INVITES;
+    tapinfo->graph_analysis = sequence_analysis_info_new();
+    tapinfo->graph_analysis->name = "voip";
+    tapinfo->session = session;
+
+    if (pause_depth == 0)
+        voip_calls_init_all_taps(tapinfo);
+}
+
+void
+voip_calls_collector_restart(epan_t *session)
+{
+    if (the_collector)
+        voip_calls_collector_start(session);
+}
+
+void
+voip_calls_collector_pause(void)
+{
+    if (!the_collector)
+        return;
+
+    if (the_collector->pause_depth++ == 0)
+        voip_calls_remove_all_tap_listeners(&the_collector->tapinfo);
+}
+
+void
+voip_calls_collector_resume(void)
+{
+    if (!the_collector || the_collector->pause_depth == 0)
+        return;
+
+    if (--the_collector->pause_depth == 0)
+        voip_calls_init_all_taps(&the_collector->tapinfo);
+}
+
+void
+voip_calls_collector_stop(void)
+{
+    voip_calls_collector_t *collector = the_collector;
+
+    if (!collector)
+        return;
+
+    the_collector = NULL;
+    if (collector->pause_depth == 0)
+        voip_calls_remove_all_tap_listeners(&collector->tapinfo);
+    collector->tapinfo.session = NULL;
+    voip_calls_collector_unref(&collector->tapinfo);
+}
+
+voip_calls_tapinfo_t *
+voip_calls_collector_ref(void)
+{
+    if (!the_collector)
+        return NULL;
+
+    the_collector->ref_count++;
+    return &the_collector->tapinfo;
+}
+
+void
+voip_calls_collector_unref(voip_calls_tapinfo_t *tapinfo)
+{
+    voip_calls_collector_t *collector = (voip_calls_collector_t *)tapinfo;
+
+    if (!collector || --collector->ref_count > 0)
+        return;
+
+    voip_calls_reset_all_taps(tapinfo);
+    if (tapinfo->callsinfo_hashtable[SIP_HASH])
+        g_hash_table_destroy(tapinfo->callsinfo_hashtable[SIP_HASH]);
+    sequence_analysis_info_free(tapinfo->graph_analysis);
+    g_queue_free(tapinfo->callsinfos);
+    g_free(collector);
+}
+
 /****************************************************************************/
 /* Add a new item into the graph */
 static void
@@ -245,6 +245,56 @@ void voip_calls_remove_all_tap_listeners(voip_calls_tapinfo_t *tap_id_base);
  */
 void voip_calls_reset_all_taps(voip_calls_tapinfo_t *tapinfo);
 
+/**
+ * Starts collecting the calls of a capture file in a shared tapinfo while
+ * it's read or captured, so that the calls dialog can show them without
+ * retapping the file. The calls are collected as with FLOW_ONLY_INVITES.
+ * Stops any previous collection.
+ *
+ * @param session the capture file's epan session
+ */
+void voip_calls_collector_start(epan_t *session);
+
+/**
+ * Starts collecting calls again, if they're being collected, because the
+ * capture file is about to be redissected with a new epan session.
+ */
+void voip_calls_collector_restart(epan_t *session);
+
+/**
+ * Stops the collector from seeing packets, e.g. while the capture file is
+ * refiltered or retapped, which would show it packets it's already seen.
+ * Calls nest; each one has to be matched by voip_calls_collector_resume().
+ */
+void voip_calls_collector_pause(void);
+
+/**
+ * Lets the collector see new packets again once every
+ * voip_calls_collector_pause() has been matched by a call to this.
+ */
+void voip_calls_collector_resume(void);
+
+/**
+ * Stops collecting calls, e.g. because the capture file is being closed.
+ * The calls stay around until the last reference to them is dropped.
+ */
+void voip_calls_collector_stop(void);
+
+/**
+ * Gets a reference to the calls collected so far. The tapinfo keeps being
+ * updated until voip_calls_collector_stop(); its tap_reset, tap_packet,
+ * tap_draw and tap_data members may be set by the one user that wants to
+ * be called back, if tap_data is still NULL.
+ *
+ * @return the tapinfo, or NULL if calls aren't being collected
+ */
+voip_calls_tapinfo_t *voip_calls_collector_ref(void);
+
+/**
+ * Drops a reference returned by voip_calls_collector_ref().
+ */
+void voip_calls_collector_unref(voip_calls_tapinfo_t *tapinfo);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -2375,6 +2375,8 @@ wtap_dump_init_dumper(int file_type_subtype, wtap_compression_type compression_t
 	/* Set Decryption Secrets Blocks */
 	wdh->dsbs_initial = params->dsbs_initial;
 	wdh->dsbs_growing = params->dsbs_growing;
+	wdh->compress_threads = params->compress_threads;
+	wdh->write_index = params->write_index;
 	return wdh;
 }
 
@@ -2758,7 +2760,7 @@ static WFILE_T
 wtap_dump_file_open(wtap_dumper *wdh, const char *filename)
 {
 	if (wdh->compression_type == WTAP_GZIP_COMPRESSED) {
-		return gzwfile_open(filename);
+		return gzwfile_open(filename, wdh->compress_threads);
 	} else {
 		return ws_fopen(filename, "wb");
 	}
@@ -2777,7 +2779,7 @@ static WFILE_T
 wtap_dump_file_fdopen(wtap_dumper *wdh, int fd)
 {
 	if (wdh->compression_type == WTAP_GZIP_COMPRESSED) {
-		return gzwfile_fdopen(fd);
+		return gzwfile_fdopen(fd, wdh->compress_threads);
 	} else {
 		return ws_fdopen(fd, "wb");
 	}
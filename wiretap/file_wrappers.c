@@ -21,6 +21,13 @@
 #include "wtap-int.h"
 #include "file_wrappers.h"
 #include <wsutil/file_util.h>
+#include <wsutil/cpu_info.h>
+
+#ifdef HAVE_MMAP
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* HAVE_MMAP */
 
 #ifdef HAVE_ZLIB
 #define ZLIB_CONST
@@ -152,6 +159,18 @@ struct wtap_reader {
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+#ifdef HAVE_ZLIB
+    struct zlib_readahead *readahead; /* inflating ahead on other threads, or NULL */
+#endif
+
+    guint8 *out_alloc;          /* our own output buffer; out.buf can point elsewhere */
+
+#ifdef HAVE_MMAP
+    /* memory mapping of an uncompressed regular file */
+    guint8 *map;                /* start of the mapping, or NULL if not mapped */
+    gint64 map_size;            /* size of the file when it was mapped */
+    int map_slot;               /* index of the mapping in mapped_regions */
+#endif
 };
 
 /* Current read offset within a buffer. */
@@ -240,6 +259,206 @@ fill_in_buffer(FILE_T state)
     return 0;
 }
 
+#ifdef HAVE_MMAP
+/*
+ * Uncompressed regular files at least this big are read through a
+ * memory mapping rather than with read(); that saves a system call
+ * and a copy for every buffer's worth of data.  Smaller files aren't
+ * worth it, and a file that's still being written, as in a live
+ * capture, usually starts out small.
+ */
+#define MAP_MIN_SIZE G_GINT64_CONSTANT(1048576)
+
+/* Amount of the mapping made available in the output buffer at a time. */
+#define MAP_WINDOW 1048576U
+
+/*
+ * If a mapped file is truncated, touching the pages past its new end
+ * gets us a SIGBUS, and that can happen anywhere, as pointers into the
+ * mapping are handed out by file_read_mapped().  Our SIGBUS handler
+ * puts anonymous zero-filled pages over the rest of the mapping, so the
+ * access that faulted reads zeros, and marks the mapping as truncated;
+ * the next read from it then fails with WTAP_ERR_SHORT_READ.  The
+ * handler finds the mapping in this table, which is only written with
+ * map_regions_mutex held.  If the table is full, files are read with
+ * read() instead.
+ */
+#define MAP_MAX_REGIONS 64
+
+static struct mapped_region {
+    guint8 *start;              /* start of the mapping, NULL for a free slot */
+    gsize size;
+    volatile sig_atomic_t truncated;
+} mapped_regions[MAP_MAX_REGIONS];
+
+static GMutex map_regions_mutex;
+static gboolean map_sigbus_installed;
+static struct sigaction map_prev_sigbus;
+
+static void
+map_sigbus_handler(int sig, siginfo_t *info, void *context)
+{
+    guint8 *addr = (guint8 *)info->si_addr;
+    gsize page_size = (gsize)sysconf(_SC_PAGESIZE);
+    int i;
+
+    for (i = 0; i < MAP_MAX_REGIONS; i++) {
+        guint8 *start = (guint8 *)g_atomic_pointer_get(&mapped_regions[i].start);
+        guint8 *end = start + mapped_regions[i].size;
+        guint8 *page;
+
+        if (start == NULL || addr < start || addr >= end)
+            continue;
+        page = start + ((gsize)(addr - start) & ~(page_size - 1));
+        if (mmap(page, (gsize)(end - page), PROT_READ,
+                 MAP_PRIVATE|MAP_ANONYMOUS|MAP_FIXED, -1, 0) == MAP_FAILED)
+            break;
+        mapped_regions[i].truncated = 1;
+        return;
+    }
+
+    /*
+     * Not one of ours.  Hand it to whoever had the signal before us;
+     * if that's the default action, restoring it and returning makes
+     * the access fault again and get it.
+     */
+    if (map_prev_sigbus.sa_flags & SA_SIGINFO) {
+        map_prev_sigbus.sa_sigaction(sig, info, context);
+    } else if (map_prev_sigbus.sa_handler != SIG_DFL &&
+               map_prev_sigbus.sa_handler != SIG_IGN) {
+        map_prev_sigbus.sa_handler(sig);
+    } else {
+        sigaction(SIGBUS, &map_prev_sigbus, NULL);
+    }
+}
+
+/* Returns the slot the mapping was entered in, or -1. */
+static int
+map_region_add(guint8 *start, gsize size)
+{
+    int slot = -1;
+    int i;
+
+    g_mutex_lock(&map_regions_mutex);
+    if (!map_sigbus_installed) {
+        struct sigaction sa;
+
+        memset(&sa, 0, sizeof sa);
+        sa.sa_sigaction = map_sigbus_handler;
+        sa.sa_flags = SA_SIGINFO|SA_NODEFER;
+        sigemptyset(&sa.sa_mask);
+        map_sigbus_installed = sigaction(SIGBUS, &sa, &map_prev_sigbus) == 0;
+    }
+    if (map_sigbus_installed) {
+        for (i = 0; i < MAP_MAX_REGIONS; i++) {
+            if (mapped_regions[i].start == NULL) {
+                mapped_regions[i].size = size;
+                mapped_regions[i].truncated = 0;
+                g_atomic_pointer_set(&mapped_regions[i].start, start);
+                slot = i;
+                break;
+            }
+        }
+    }
+    g_mutex_unlock(&map_regions_mutex);
+    return slot;
+}
+
+static void
+map_region_remove(int slot)
+{
+    g_mutex_lock(&map_regions_mutex);
+    g_atomic_pointer_set(&mapped_regions[slot].start, NULL);
+    g_mutex_unlock(&map_regions_mutex);
+}
+
+/*
+ * If the file was truncated under our mapping, report that; returns
+ * TRUE if it was.
+ */
+static gboolean
+map_truncated(FILE_T state)
+{
+    if (!mapped_regions[state->map_slot].truncated)
+        return FALSE;
+    state->err = WTAP_ERR_SHORT_READ;
+    state->err_info = NULL;
+    return TRUE;
+}
+
+static void
+map_file(FILE_T state)
+{
+    ws_statb64 st;
+    void *map;
+
+    if (state->map != NULL || state->is_compressed)
+        return;
+    if (ws_fstat64(state->fd, &st) < 0 || !S_ISREG(st.st_mode))
+        return;
+    if (st.st_size < MAP_MIN_SIZE || (guint64)st.st_size > G_MAXSIZE)
+        return;
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, state->fd, 0);
+    if (map == MAP_FAILED)
+        return;     /* just use read() */
+    state->map_slot = map_region_add((guint8 *)map, (gsize)st.st_size);
+    if (state->map_slot < 0) {
+        munmap(map, (size_t)st.st_size);
+        return;
+    }
+    state->map = (guint8 *)map;
+    state->map_size = st.st_size;
+}
+
+static void
+unmap_file(FILE_T state)
+{
+    if (state->map == NULL)
+        return;
+    if (state->out.buf != state->out_alloc) {
+        /* Forget what we haven't delivered from the mapping yet. */
+        state->raw_pos -= state->out.avail;
+        state->out.buf = state->out_alloc;
+        buf_reset(&state->out);
+    }
+    map_region_remove(state->map_slot);
+    munmap(state->map, (size_t)state->map_size);
+    state->map = NULL;
+    state->map_size = 0;
+}
+
+static int
+map_read(FILE_T state)
+{
+    gint64 left = state->map_size - state->raw_pos;
+
+    if (map_truncated(state))
+        return -1;
+    if (left <= 0) {
+        /*
+         * We're past the end of the mapping; the file may have
+         * grown since we mapped it, so carry on with read().
+         */
+        state->out.buf = state->out_alloc;
+        buf_reset(&state->out);
+        if (ws_lseek64(state->fd, state->raw_pos, SEEK_SET) == -1) {
+            state->err = errno;
+            state->err_info = NULL;
+            return -1;
+        }
+        return buf_read(state, &state->out);
+    }
+
+    /* Point the output buffer at the next chunk of the mapping. */
+    state->out.buf = state->map + state->raw_pos;
+    state->out.next = state->out.buf;
+    state->out.avail = left > MAP_WINDOW ? MAP_WINDOW : (guint)left;
+    state->raw_pos += state->out.avail;
+    return 0;
+}
+#endif /* HAVE_MMAP */
+
 #define ZLIB_WINSIZE 32768
 
 struct fast_seek_point {
@@ -642,6 +861,369 @@ DIAG_ON(cast-qual)
 }
 #endif
 
+#ifdef HAVE_ZLIB
+/*
+ * Once a compressed file has fast seek points, each run of data between
+ * two of them can be inflated on its own, using the window saved at the
+ * first point as the dictionary.  The random access stream, which reads
+ * the file after the sequential first pass has found the points, does
+ * that for the next few runs on worker threads, ahead of the reader, so
+ * rescanning a big gzipped capture isn't limited to one core.
+ *
+ * A run that doesn't inflate to exactly the expected length, such as one
+ * crossing the end of a gzip member, is just inflated in line instead.
+ * The gzip CRC is only checked for data inflated in line, as it was on
+ * the first pass.
+ */
+#define READAHEAD_MAX_THREADS   8
+#define READAHEAD_MAX_SPAN      (16 * 1048576)
+#define READAHEAD_IN_SLOP       64      /* extra input, in case inflate() wants to look ahead */
+
+struct zlib_segment {
+    struct zlib_readahead *ra;
+    const struct fast_seek_point *start;    /* point at which the run starts */
+    unsigned char *in;          /* compressed data */
+    guint in_len;
+    unsigned char *out;         /* uncompressed data */
+    guint out_len;              /* distance to the next point */
+    gboolean done;              /* inflated, or failed to */
+    gboolean failed;
+    gboolean abandoned;         /* no longer wanted; freed by the worker */
+};
+
+struct zlib_readahead {
+    GThreadPool *pool;
+    GMutex mutex;               /* protects done and abandoned */
+    GCond cond;                 /* signaled when a segment is done */
+    GQueue pending;             /* segments for consecutive points */
+    guint max_pending;
+    struct zlib_segment *current;   /* segment out.buf points into, if any */
+    gboolean stale;             /* strm isn't positioned at pos */
+};
+
+static void
+zlib_segment_free(struct zlib_segment *seg)
+{
+    g_free(seg->in);
+    g_free(seg->out);
+    g_free(seg);
+}
+
+static void
+zlib_segment_inflate(gpointer data, gpointer user_data _U_)
+{
+    struct zlib_segment *seg = (struct zlib_segment *)data;
+    struct zlib_readahead *ra = seg->ra;
+    gboolean abandoned;
+    z_stream strm;
+    int ret;
+
+    g_mutex_lock(&ra->mutex);
+    abandoned = seg->abandoned;
+    g_mutex_unlock(&ra->mutex);
+
+    seg->failed = TRUE;
+    if (!abandoned) {
+        memset(&strm, 0, sizeof strm);
+        if (inflateInit2(&strm, -15) == Z_OK) {     /* raw inflate */
+            strm.next_in = seg->in;
+            strm.avail_in = seg->in_len;
+#ifdef HAVE_INFLATEPRIME
+            if (seg->start->data.zlib.bits && strm.avail_in != 0) {
+                int bits = seg->start->data.zlib.bits;
+
+                (void)inflatePrime(&strm, bits, seg->in[0] >> (8 - bits));
+                strm.next_in++;
+                strm.avail_in--;
+            }
+#endif
+            (void)inflateSetDictionary(&strm, seg->start->data.zlib.window, ZLIB_WINSIZE);
+            strm.next_out = seg->out;
+            strm.avail_out = seg->out_len;
+            do {
+                ret = inflate(&strm, Z_NO_FLUSH);
+            } while (ret == Z_OK && strm.avail_out != 0);
+            seg->failed = strm.avail_out != 0 ||
+                (ret != Z_OK && ret != Z_STREAM_END);
+            inflateEnd(&strm);
+        }
+    }
+    g_free(seg->in);
+    seg->in = NULL;
+
+    g_mutex_lock(&ra->mutex);
+    seg->done = TRUE;
+    abandoned = seg->abandoned;
+    g_cond_broadcast(&ra->cond);
+    g_mutex_unlock(&ra->mutex);
+
+    if (abandoned)
+        zlib_segment_free(seg);
+}
+
+/* Get rid of a segment, leaving it to the worker if it's still busy. */
+static void
+zlib_segment_release(struct zlib_readahead *ra, struct zlib_segment *seg)
+{
+    gboolean done;
+
+    g_mutex_lock(&ra->mutex);
+    done = seg->done;
+    if (!done)
+        seg->abandoned = TRUE;
+    g_mutex_unlock(&ra->mutex);
+
+    if (done)
+        zlib_segment_free(seg);
+}
+
+static void
+zlib_readahead_drop(struct zlib_readahead *ra)
+{
+    struct zlib_segment *seg;
+
+    while ((seg = (struct zlib_segment *)g_queue_pop_head(&ra->pending)) != NULL)
+        zlib_segment_release(ra, seg);
+}
+
+static struct zlib_readahead *
+zlib_readahead_new(void)
+{
+    struct zlib_readahead *ra;
+    guint threads = get_num_processors();
+
+    if (threads < 2)
+        return NULL;
+    if (threads > READAHEAD_MAX_THREADS)
+        threads = READAHEAD_MAX_THREADS;
+
+    ra = g_new0(struct zlib_readahead, 1);
+    ra->pool = g_thread_pool_new(zlib_segment_inflate, NULL, threads, FALSE, NULL);
+    if (ra->pool == NULL) {
+        g_free(ra);
+        return NULL;
+    }
+    g_mutex_init(&ra->mutex);
+    g_cond_init(&ra->cond);
+    g_queue_init(&ra->pending);
+    ra->max_pending = 2 * threads;
+    return ra;
+}
+
+static void
+zlib_readahead_free(struct zlib_readahead *ra)
+{
+    /* Workers skip the segments they haven't started on yet. */
+    zlib_readahead_drop(ra);
+    g_thread_pool_free(ra->pool, FALSE, TRUE);
+    if (ra->current != NULL)
+        zlib_segment_free(ra->current);
+    g_mutex_clear(&ra->mutex);
+    g_cond_clear(&ra->cond);
+    g_free(ra);
+}
+
+/* Index of the first fast seek point at or after pos. */
+static guint
+fast_seek_next_index(FILE_T state, gint64 pos)
+{
+    guint low = 0, max = state->fast_seek->len, i;
+
+    while (low < max) {
+        i = (low + max) / 2;
+        if (((struct fast_seek_point *)state->fast_seek->pdata[i])->out < pos)
+            low = i + 1;
+        else
+            max = i;
+    }
+    return low;
+}
+
+/*
+ * Read compressed data for a segment.  This doesn't disturb the stream's
+ * own reading, which always picks up at raw_pos.
+ */
+static gboolean
+zlib_segment_read_input(FILE_T state, struct zlib_segment *seg, gint64 in_start)
+{
+    guint got = 0;
+    ssize_t ret;
+
+    if (ws_lseek64(state->fd, in_start, SEEK_SET) == -1)
+        return FALSE;
+    while (got < seg->in_len) {
+        ret = ws_read(state->fd, seg->in + got, seg->in_len - got);
+        if (ret <= 0)
+            break;
+        got += (guint)ret;
+    }
+    seg->in_len = got;
+    return ws_lseek64(state->fd, state->raw_pos, SEEK_SET) != -1 && got != 0;
+}
+
+/* Queue segments for the points after pos that aren't queued yet. */
+static void
+zlib_readahead_schedule(FILE_T state)
+{
+    struct zlib_readahead *ra = state->readahead;
+    struct zlib_segment *seg;
+    const struct fast_seek_point *start, *end;
+    gint64 in_start;
+    guint n;
+
+    n = fast_seek_next_index(state, state->pos);
+    seg = (struct zlib_segment *)g_queue_peek_head(&ra->pending);
+    if (seg != NULL &&
+        (n >= state->fast_seek->len || seg->start != state->fast_seek->pdata[n]))
+        zlib_readahead_drop(ra);    /* we've moved elsewhere */
+
+    for (n += g_queue_get_length(&ra->pending);
+         g_queue_get_length(&ra->pending) < ra->max_pending && n + 1 < state->fast_seek->len;
+         n++) {
+        start = (const struct fast_seek_point *)state->fast_seek->pdata[n];
+        end = (const struct fast_seek_point *)state->fast_seek->pdata[n + 1];
+        if (start->compression != ZLIB || end->compression != ZLIB ||
+            end->out - start->out > READAHEAD_MAX_SPAN ||
+            end->in - start->in > READAHEAD_MAX_SPAN)
+            break;
+
+#ifdef HAVE_INFLATEPRIME
+        in_start = start->in - (start->data.zlib.bits ? 1 : 0);
+#else
+        in_start = start->in;
+#endif
+        seg = g_new0(struct zlib_segment, 1);
+        seg->ra = ra;
+        seg->start = start;
+        seg->in_len = (guint)(end->in - in_start) + READAHEAD_IN_SLOP;
+        seg->in = (unsigned char *)g_try_malloc(seg->in_len);
+        seg->out_len = (guint)(end->out - start->out);
+        seg->out = (unsigned char *)g_try_malloc(seg->out_len);
+        if (seg->in == NULL || seg->out == NULL ||
+            !zlib_segment_read_input(state, seg, in_start)) {
+            zlib_segment_free(seg);
+            break;
+        }
+        g_queue_push_tail(&ra->pending, seg);
+        g_thread_pool_push(ra->pool, seg, NULL);
+    }
+}
+
+/*
+ * If the data at pos has been inflated ahead, make it the output buffer
+ * and return TRUE.
+ */
+static gboolean
+zlib_readahead_fill(FILE_T state)
+{
+    struct zlib_readahead *ra = state->readahead;
+    struct zlib_segment *seg;
+
+    /* We're done with the segment we were reading from, if any. */
+    state->out.buf = state->out_alloc;
+    buf_reset(&state->out);
+    if (ra->current != NULL) {
+        zlib_segment_free(ra->current);
+        ra->current = NULL;
+    }
+
+    zlib_readahead_schedule(state);
+    seg = (struct zlib_segment *)g_queue_peek_head(&ra->pending);
+    if (seg == NULL || seg->start->out != state->pos)
+        return FALSE;
+    g_queue_pop_head(&ra->pending);
+
+    g_mutex_lock(&ra->mutex);
+    while (!seg->done)
+        g_cond_wait(&ra->cond, &ra->mutex);
+    g_mutex_unlock(&ra->mutex);
+
+    if (seg->failed) {
+        zlib_segment_free(seg);
+        return FALSE;
+    }
+    ra->current = seg;
+    ra->stale = TRUE;
+    state->out.buf = seg->out;
+    state->out.next = seg->out;
+    state->out.avail = seg->out_len;
+    return TRUE;
+}
+
+/*
+ * We've delivered data inflated ahead, so the stream has to be restarted
+ * at the fast seek point we're at before inflating in line again.
+ */
+static int
+zlib_readahead_resync(FILE_T state)
+{
+    struct fast_seek_point *here = fast_seek_find(state, state->pos);
+    z_stream *strm = &state->strm;
+    gint64 off;
+
+    state->readahead->stale = FALSE;
+    if (here == NULL || here->out != state->pos || here->compression != ZLIB) {
+        state->err = WTAP_ERR_INTERNAL;
+        state->err_info = "lost position after inflating ahead";
+        return -1;
+    }
+
+#ifdef HAVE_INFLATEPRIME
+    off = here->in - (here->data.zlib.bits ? 1 : 0);
+#else
+    off = here->in;
+#endif
+    if (ws_lseek64(state->fd, off, SEEK_SET) == -1) {
+        state->err = errno;
+        state->err_info = NULL;
+        return -1;
+    }
+    fast_seek_reset(state);
+    state->raw_pos = off;
+    state->eof = FALSE;
+    buf_reset(&state->in);
+
+    inflateReset(strm);
+    strm->adler = here->data.zlib.adler;
+    strm->total_out = here->data.zlib.total_out;
+#ifdef HAVE_INFLATEPRIME
+    if (here->data.zlib.bits) {
+        int ret = GZ_GETC();
+
+        if (ret == -1) {
+            if (state->err == 0) {
+                /* EOF */
+                state->err = WTAP_ERR_SHORT_READ;
+                state->err_info = NULL;
+            }
+            return -1;
+        }
+        (void)inflatePrime(strm, here->data.zlib.bits, ret >> (8 - here->data.zlib.bits));
+    }
+#endif
+    (void)inflateSetDictionary(strm, here->data.zlib.window, ZLIB_WINSIZE);
+    return 0;
+}
+
+/*
+ * Stop inflating in line at the next fast seek point, so that we can
+ * switch to data inflated ahead from there.
+ */
+static guint
+zlib_readahead_limit(FILE_T state, guint count)
+{
+    guint n = fast_seek_next_index(state, state->pos + 1);
+
+    if (n < state->fast_seek->len) {
+        gint64 left = ((struct fast_seek_point *)state->fast_seek->pdata[n])->out - state->pos;
+
+        if (left < count)
+            count = (guint)left;
+    }
+    return count;
+}
+#endif /* HAVE_ZLIB */
+
 static int
 gz_head(FILE_T state)
 {
@@ -777,6 +1359,9 @@ gz_head(FILE_T state)
         buf_reset(&state->in);
     }
     state->compression = UNCOMPRESSED;
+#ifdef HAVE_MMAP
+    map_file(state);
+#endif
     return 0;
 }
 
@@ -790,12 +1375,27 @@ fill_out_buffer(FILE_T state)
             return 0;
     }
     if (state->compression == UNCOMPRESSED) {           /* straight copy */
+#ifdef HAVE_MMAP
+        if (state->map != NULL) {
+            if (map_read(state) < 0)
+                return -1;
+        } else
+#endif
         if (buf_read(state, &state->out) < 0)
             return -1;
     }
 #ifdef HAVE_ZLIB
     else if (state->compression == ZLIB) {      /* decompress */
-        zlib_read(state, state->out.buf, state->size << 1);
+        guint count = state->size << 1;
+
+        if (state->readahead != NULL) {
+            if (zlib_readahead_fill(state))
+                return 0;
+            if (state->readahead->stale && zlib_readahead_resync(state) == -1)
+                return -1;
+            count = zlib_readahead_limit(state, count);
+        }
+        zlib_read(state, state->out.buf, count);
     }
 #endif
     return 0;
@@ -840,6 +1440,7 @@ gz_skip(FILE_T state, gint64 len)
 static void
 gz_reset(FILE_T state)
 {
+    state->out.buf = state->out_alloc;
     buf_reset(&state->out);       /* no output data available */
     state->eof = FALSE;           /* not at end of file */
     state->compression = UNKNOWN; /* look for gzip header */
@@ -849,6 +1450,10 @@ gz_reset(FILE_T state)
     state->err_info = NULL;
     state->pos = 0;               /* no uncompressed data yet */
     buf_reset(&state->in);        /* no input data yet */
+#ifdef HAVE_ZLIB
+    if (state->readahead != NULL)
+        state->readahead->stale = FALSE;
+#endif
 }
 
 FILE_T
@@ -925,6 +1530,7 @@ file_fdopen(int fd)
     state->out.buf = (unsigned char *)g_try_malloc(((gsize)want) << 1);
     state->out.next = state->out.buf;
     state->out.avail = 0;
+    state->out_alloc = state->out.buf;
     state->size = want;
     if (state->in.buf == NULL || state->out.buf == NULL) {
         g_free(state->out.buf);
@@ -1009,9 +1615,37 @@ file_open(const char *path)
 }
 
 void
-file_set_random_access(FILE_T stream, gboolean random_flag _U_, GPtrArray *seek)
+file_set_random_access(FILE_T stream, gboolean random_flag, GPtrArray *seek)
 {
     stream->fast_seek = seek;
+#ifdef HAVE_ZLIB
+    /*
+     * The random access stream reads a compressed file after the
+     * sequential stream has found the fast seek points in it.
+     */
+    if (random_flag && seek != NULL && stream->readahead == NULL)
+        stream->readahead = zlib_readahead_new();
+#endif
+}
+
+/*
+ * Replace the fast seek points of a random access stream with copies of
+ * the ones another handle on the same file found when reading it
+ * sequentially.
+ */
+void
+file_copy_fast_seek(FILE_T stream, const GPtrArray *seek)
+{
+    guint i;
+
+    if (stream->fast_seek == NULL || seek == NULL)
+        return;
+    for (i = 0; i < stream->fast_seek->len; i++)
+        g_free(stream->fast_seek->pdata[i]);
+    g_ptr_array_set_size(stream->fast_seek, 0);
+    for (i = 0; i < seek->len; i++)
+        g_ptr_array_add(stream->fast_seek,
+                        g_memdup(seek->pdata[i], sizeof(struct fast_seek_point)));
 }
 
 gint64
@@ -1154,11 +1788,19 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
             off = here->in + (off2 - here->out);
         }
 
+#ifdef HAVE_MMAP
+        /* Reads from the mapping don't use the file descriptor's offset. */
+        if (file->map == NULL)
+#endif
         if (ws_lseek64(file->fd, off, SEEK_SET) == -1) {
             *err = errno;
             return -1;
         }
         fast_seek_reset(file);
+#ifdef HAVE_ZLIB
+        if (file->readahead != NULL)
+            file->readahead->stale = FALSE;
+#endif
 
         file->raw_pos = off;
         buf_reset(&file->out);
@@ -1234,6 +1876,9 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
         /*
          * Yes.  Just seek there within the file.
          */
+#ifdef HAVE_MMAP
+        if (file->map == NULL)
+#endif
         if (ws_lseek64(file->fd, offset - file->out.avail, SEEK_CUR) == -1) {
             *err = errno;
             return -1;
@@ -1388,9 +2033,66 @@ file_read(void *buf, unsigned int len, FILE_T file)
         }
     } while (len);
 
+#ifdef HAVE_MMAP
+    /* What we copied from the mapping may have been zeros in its place. */
+    if (file->map != NULL && map_truncated(file))
+        return -1;
+#endif
     return (int)got;
 }
 
+/*
+ * If the file is being read through a memory mapping and the next len
+ * bytes are in it, skip past them and return a pointer to them in the
+ * mapping, saving a copy; otherwise, return NULL, and the caller should
+ * use file_read().  The pointer remains valid until the file is closed
+ * or file_fdclose() is called on it.
+ */
+#ifdef HAVE_MMAP
+const guint8 *
+file_read_mapped(unsigned int len, FILE_T file)
+{
+    gint64 off;
+
+    if (file->map == NULL || file->compression != UNCOMPRESSED ||
+        file->err != 0 || map_truncated(file))
+        return NULL;
+
+    /* process a skip request */
+    if (file->seek_pending) {
+        file->seek_pending = FALSE;
+        if (gz_skip(file, file->skip) == -1)
+            return NULL;
+    }
+
+    /*
+     * The next byte to deliver is at this offset in the file, whether
+     * the output buffer is part of the mapping or our own buffer.
+     */
+    off = file->raw_pos - file->out.avail;
+    if (off < 0 || off + len > file->map_size)
+        return NULL;
+
+    if (len <= file->out.avail) {
+        file->out.next += len;
+        file->out.avail -= len;
+    } else {
+        /* Continue after the data with the next chunk of the mapping. */
+        file->out.buf = file->map + off + len;
+        buf_reset(&file->out);
+        file->raw_pos = off + len;
+    }
+    file->pos += len;
+    return file->map + off;
+}
+#else
+const guint8 *
+file_read_mapped(unsigned int len _U_, FILE_T file _U_)
+{
+    return NULL;
+}
+#endif /* HAVE_MMAP */
+
 /*
  * XXX - this *peeks* at next byte, not a character.
  */
@@ -1573,6 +2275,9 @@ file_clearerr(FILE_T stream)
 void
 file_fdclose(FILE_T file)
 {
+#ifdef HAVE_MMAP
+    unmap_file(file);
+#endif
     ws_close(file->fd);
     file->fd = -1;
 }
@@ -1585,6 +2290,10 @@ file_fdreopen(FILE_T file, const char *path)
     if ((fd = ws_open(path, O_RDONLY|O_BINARY, 0000)) == -1)
         return FALSE;
     file->fd = fd;
+#ifdef HAVE_MMAP
+    if (file->compression == UNCOMPRESSED)
+        map_file(file);
+#endif
     return TRUE;
 }
 
@@ -1593,14 +2302,22 @@ file_close(FILE_T file)
 {
     int fd = file->fd;
 
+#ifdef HAVE_MMAP
+    unmap_file(file);
+#endif
+
     /* free memory and close file */
     if (file->size) {
 #ifdef HAVE_ZLIB
         inflateEnd(&(file->strm));
 #endif
-        g_free(file->out.buf);
+        g_free(file->out_alloc);
         g_free(file->in.buf);
     }
+#ifdef HAVE_ZLIB
+    if (file->readahead != NULL)
+        zlib_readahead_free(file->readahead);
+#endif
     g_free(file->fast_seek_cur);
     file->err = 0;
     file->err_info = NULL;
@@ -1629,10 +2346,18 @@ struct wtap_writer {
     int err;                /* error code */
     /* zlib deflate stream */
     z_stream strm;          /* stream structure in-place (not a pointer) */
+    struct gz_parallel *par;    /* compressing on other threads, or NULL */
 };
 
+static struct gz_parallel *gz_par_new(guint threads);
+
+/*
+ * Open a gzip file for writing.  If threads is more than 1, the output
+ * is compressed on that many threads (up to GZ_PAR_MAX_THREADS);
+ * otherwise, it's compressed on the calling thread.
+ */
 GZWFILE_T
-gzwfile_open(const char *path)
+gzwfile_open(const char *path, guint threads)
 {
     int fd;
     GZWFILE_T state;
@@ -1641,7 +2366,7 @@ gzwfile_open(const char *path)
     fd = ws_open(path, O_BINARY|O_WRONLY|O_CREAT|O_TRUNC, 0666);
     if (fd == -1)
         return NULL;
-    state = gzwfile_fdopen(fd);
+    state = gzwfile_fdopen(fd, threads);
     if (state == NULL) {
         save_errno = errno;
         ws_close(fd);
@@ -1651,7 +2376,7 @@ gzwfile_open(const char *path)
 }
 
 GZWFILE_T
-gzwfile_fdopen(int fd)
+gzwfile_fdopen(int fd, guint threads)
 {
     GZWFILE_T state;
 
@@ -1671,6 +2396,9 @@ gzwfile_fdopen(int fd)
     state->pos = 0;                 /* no uncompressed data yet */
     state->strm.avail_in = 0;       /* no input data yet */
 
+    /* compress on other threads if asked to */
+    state->par = gz_par_new(threads);
+
     /* return stream */
     return state;
 }
@@ -1785,6 +2513,305 @@ gz_comp(GZWFILE_T state, int flush)
     return 0;
 }
 
+/*
+ * Compressing on several threads, as pigz does: the data is split into
+ * blocks that are compressed independently, each with the last 32K of
+ * the data before it as the preset dictionary so that the compression
+ * ratio hardly suffers, and ending with a sync flush so that it ends on
+ * a byte boundary.  The compressed blocks are written in order, between
+ * a gzip header and a trailer with the combined CRC, so the result is
+ * an ordinary single-member gzip file; the block boundaries also make
+ * good fast seek points when it's read back.
+ */
+#define GZ_PAR_MAX_THREADS  8
+#define GZ_PAR_BLOCK_SIZE   131072
+
+struct gz_block {
+    struct gz_parallel *par;
+    int level;
+    int strategy;
+    unsigned char *in;          /* uncompressed data */
+    guint in_len;
+    unsigned char dict[ZLIB_WINSIZE];   /* data preceding the block */
+    guint dict_len;
+    gboolean last;              /* TRUE for the block that ends the stream */
+    unsigned char *out;         /* compressed data */
+    guint out_len;
+    guint32 crc;                /* CRC-32 of the uncompressed data */
+    int err;                    /* error code, 0 if OK */
+    gboolean done;
+};
+
+struct gz_parallel {
+    GThreadPool *pool;
+    GMutex mutex;               /* protects done */
+    GCond cond;                 /* signaled when a block is done */
+    GQueue pending;             /* blocks being compressed, in order */
+    guint max_pending;
+    struct gz_block *cur;       /* block being filled, or NULL */
+    unsigned char dict[ZLIB_WINSIZE];   /* last 32K submitted */
+    guint dict_len;
+    guint32 crc;                /* CRC-32 of the data written so far */
+    gboolean header_written;
+};
+
+static void
+gz_block_free(struct gz_block *blk)
+{
+    g_free(blk->in);
+    g_free(blk->out);
+    g_free(blk);
+}
+
+static void
+gz_block_compress(gpointer data, gpointer user_data _U_)
+{
+    struct gz_block *blk = (struct gz_block *)data;
+    struct gz_parallel *par = blk->par;
+    z_stream strm;
+    uLong bound;
+    int ret;
+
+    blk->crc = (guint32)crc32(crc32(0L, Z_NULL, 0), blk->in, blk->in_len);
+
+    memset(&strm, 0, sizeof strm);
+    ret = deflateInit2(&strm, blk->level, Z_DEFLATED, -15, 8, blk->strategy);
+    if (ret != Z_OK) {
+        blk->err = ret == Z_MEM_ERROR ? ENOMEM : WTAP_ERR_INTERNAL;
+    } else {
+        /* Leave room for the empty stored block of the sync flush. */
+        bound = deflateBound(&strm, blk->in_len) + 16;
+        blk->out = (unsigned char *)g_try_malloc(bound);
+        if (blk->out == NULL) {
+            blk->err = ENOMEM;
+        } else {
+            if (blk->dict_len != 0)
+                (void)deflateSetDictionary(&strm, blk->dict, blk->dict_len);
+            strm.next_in = blk->in;
+            strm.avail_in = blk->in_len;
+            strm.next_out = blk->out;
+            strm.avail_out = (uInt)bound;
+            ret = deflate(&strm, blk->last ? Z_FINISH : Z_SYNC_FLUSH);
+            if (ret == Z_STREAM_ERROR || strm.avail_in != 0 ||
+                strm.avail_out == 0 || (blk->last && ret != Z_STREAM_END)) {
+                /* This "shouldn't happen". */
+                blk->err = WTAP_ERR_INTERNAL;
+            }
+            blk->out_len = (guint)(bound - strm.avail_out);
+        }
+        (void)deflateEnd(&strm);
+    }
+    g_free(blk->in);
+    blk->in = NULL;
+
+    g_mutex_lock(&par->mutex);
+    blk->done = TRUE;
+    g_cond_broadcast(&par->cond);
+    g_mutex_unlock(&par->mutex);
+}
+
+static struct gz_parallel *
+gz_par_new(guint threads)
+{
+    struct gz_parallel *par;
+
+    if (threads < 2)
+        return NULL;
+    if (threads > GZ_PAR_MAX_THREADS)
+        threads = GZ_PAR_MAX_THREADS;
+
+    par = g_new0(struct gz_parallel, 1);
+    par->pool = g_thread_pool_new(gz_block_compress, NULL, threads, FALSE, NULL);
+    if (par->pool == NULL) {
+        g_free(par);
+        return NULL;
+    }
+    g_mutex_init(&par->mutex);
+    g_cond_init(&par->cond);
+    g_queue_init(&par->pending);
+    par->max_pending = 2 * threads;
+    par->crc = (guint32)crc32(0L, Z_NULL, 0);
+    return par;
+}
+
+static void
+gz_par_free(struct gz_parallel *par)
+{
+    struct gz_block *blk;
+
+    /* Wait for the workers, then discard whatever is left. */
+    g_thread_pool_free(par->pool, FALSE, TRUE);
+    while ((blk = (struct gz_block *)g_queue_pop_head(&par->pending)) != NULL)
+        gz_block_free(blk);
+    if (par->cur != NULL)
+        gz_block_free(par->cur);
+    g_mutex_clear(&par->mutex);
+    g_cond_clear(&par->cond);
+    g_free(par);
+}
+
+static int
+gz_par_write_out(GZWFILE_T state, const unsigned char *buf, guint len)
+{
+    ssize_t got;
+
+    if (len == 0)
+        return 0;
+    got = ws_write(state->fd, buf, len);
+    if (got < 0) {
+        state->err = errno;
+        return -1;
+    }
+    if ((guint)got != len) {
+        state->err = WTAP_ERR_SHORT_WRITE;
+        return -1;
+    }
+    return 0;
+}
+
+/* Wait for the oldest block to be compressed and write it out. */
+static int
+gz_par_write_oldest(GZWFILE_T state)
+{
+    struct gz_parallel *par = state->par;
+    struct gz_block *blk;
+    int ret = 0;
+
+    blk = (struct gz_block *)g_queue_pop_head(&par->pending);
+    g_mutex_lock(&par->mutex);
+    while (!blk->done)
+        g_cond_wait(&par->cond, &par->mutex);
+    g_mutex_unlock(&par->mutex);
+
+    if (blk->err != 0) {
+        state->err = blk->err;
+        ret = -1;
+    } else {
+        ret = gz_par_write_out(state, blk->out, blk->out_len);
+        par->crc = (guint32)crc32_combine(par->crc, blk->crc, blk->in_len);
+    }
+    gz_block_free(blk);
+    return ret;
+}
+
+/* Hand the block being filled to the thread pool. */
+static int
+gz_par_submit(GZWFILE_T state, gboolean last)
+{
+    struct gz_parallel *par = state->par;
+    struct gz_block *blk = par->cur;
+
+    if (!par->header_written) {
+        /*
+         * gzip header: magic, deflate, no flags, no modification
+         * time, no extra flags, unknown OS.
+         */
+        static const unsigned char gz_header[10] = {
+            0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff
+        };
+
+        if (gz_par_write_out(state, gz_header, sizeof gz_header) == -1)
+            return -1;
+        par->header_written = TRUE;
+    }
+
+    if (blk == NULL) {
+        if (!last)
+            return 0;
+        /* We still need a final block to end the stream. */
+        blk = g_new0(struct gz_block, 1);
+    }
+    par->cur = NULL;
+
+    blk->par = par;
+    blk->level = state->level;
+    blk->strategy = state->strategy;
+    blk->last = last;
+    memcpy(blk->dict, par->dict, par->dict_len);
+    blk->dict_len = par->dict_len;
+
+    /* The end of this block is the dictionary for the next one. */
+    if (blk->in_len >= ZLIB_WINSIZE) {
+        memcpy(par->dict, blk->in + blk->in_len - ZLIB_WINSIZE, ZLIB_WINSIZE);
+        par->dict_len = ZLIB_WINSIZE;
+    } else if (blk->in_len != 0) {
+        guint keep = MIN(par->dict_len, ZLIB_WINSIZE - blk->in_len);
+
+        memmove(par->dict, par->dict + par->dict_len - keep, keep);
+        memcpy(par->dict + keep, blk->in, blk->in_len);
+        par->dict_len = keep + blk->in_len;
+    }
+
+    g_queue_push_tail(&par->pending, blk);
+    g_thread_pool_push(par->pool, blk, NULL);
+
+    while (g_queue_get_length(&par->pending) > par->max_pending) {
+        if (gz_par_write_oldest(state) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+static int
+gz_par_drain(GZWFILE_T state)
+{
+    while (!g_queue_is_empty(&state->par->pending)) {
+        if (gz_par_write_oldest(state) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+static guint
+gz_par_write(GZWFILE_T state, const void *buf, guint len)
+{
+    struct gz_parallel *par = state->par;
+    struct gz_block *blk;
+    guint put = len;
+    guint n;
+
+    while (len) {
+        blk = par->cur;
+        if (blk == NULL) {
+            blk = g_new0(struct gz_block, 1);
+            blk->in = (unsigned char *)g_try_malloc(GZ_PAR_BLOCK_SIZE);
+            if (blk->in == NULL) {
+                g_free(blk);
+                state->err = ENOMEM;
+                return 0;
+            }
+            par->cur = blk;
+        }
+        n = GZ_PAR_BLOCK_SIZE - blk->in_len;
+        if (n > len)
+            n = len;
+        memcpy(blk->in + blk->in_len, buf, n);
+        blk->in_len += n;
+        state->pos += n;
+        buf = (const char *)buf + n;
+        len -= n;
+        if (blk->in_len == GZ_PAR_BLOCK_SIZE && gz_par_submit(state, FALSE) == -1)
+            return 0;
+    }
+    return put;
+}
+
+/* Write out everything, ending with the gzip trailer. */
+static int
+gz_par_finish(GZWFILE_T state)
+{
+    unsigned char trailer[8];
+    guint32 isize = (guint32)state->pos;
+
+    if (gz_par_submit(state, TRUE) == -1 || gz_par_drain(state) == -1)
+        return -1;
+
+    /* CRC-32 and length of the uncompressed data, both little-endian */
+    phtole32(trailer, state->par->crc);
+    phtole32(trailer + 4, isize);
+    return gz_par_write_out(state, trailer, sizeof trailer);
+}
+
 /* Write out len bytes from buf.  Return 0, and set state->err, on
    failure or on an attempt to write 0 bytes (in which case state->err
    is Z_OK); return the number of bytes written on success. */
@@ -1805,6 +2832,9 @@ gzwfile_write(GZWFILE_T state, const void *buf, guint len)
     if (len == 0)
         return 0;
 
+    if (state->par != NULL)
+        return gz_par_write(state, buf, len);
+
     /* allocate memory if this is the first time through */
     if (state->size == 0 && gz_init(state) == -1)
         return 0;
@@ -1865,6 +2895,13 @@ gzwfile_flush(GZWFILE_T state)
     if (state->err != Z_OK)
         return -1;
 
+    if (state->par != NULL) {
+        /* each block ends with a sync flush, so just write them all */
+        if (gz_par_submit(state, FALSE) == -1 || gz_par_drain(state) == -1)
+            return -1;
+        return 0;
+    }
+
     /* compress remaining data with Z_SYNC_FLUSH */
     gz_comp(state, Z_SYNC_FLUSH);
     if (state->err != Z_OK)
@@ -1880,11 +2917,17 @@ gzwfile_close(GZWFILE_T state)
     int ret = 0;
 
     /* flush, free memory, and close file */
-    if (gz_comp(state, Z_FINISH) == -1 && ret == 0)
-        ret = state->err;
-    (void)deflateEnd(&(state->strm));
-    g_free(state->out);
-    g_free(state->in);
+    if (state->par != NULL) {
+        if (state->err == Z_OK && gz_par_finish(state) == -1 && ret == 0)
+            ret = state->err;
+        gz_par_free(state->par);
+    } else {
+        if (gz_comp(state, Z_FINISH) == -1 && ret == 0)
+            ret = state->err;
+        (void)deflateEnd(&(state->strm));
+        g_free(state->out);
+        g_free(state->in);
+    }
     state->err = Z_OK;
     if (ws_close(state->fd) == -1 && ret == 0)
         ret = errno;
@@ -17,12 +17,14 @@
 extern FILE_T file_open(const char *path);
 extern FILE_T file_fdopen(int fildes);
 extern void file_set_random_access(FILE_T stream, gboolean random_flag, GPtrArray *seek);
+extern void file_copy_fast_seek(FILE_T stream, const GPtrArray *seek);
 WS_DLL_PUBLIC gint64 file_seek(FILE_T stream, gint64 offset, int whence, int *err);
 WS_DLL_PUBLIC gint64 file_tell(FILE_T stream);
 extern gint64 file_tell_raw(FILE_T stream);
 extern int file_fstat(FILE_T stream, ws_statb64 *statb, int *err);
 WS_DLL_PUBLIC gboolean file_iscompressed(FILE_T stream);
 WS_DLL_PUBLIC int file_read(void *buf, unsigned int count, FILE_T file);
+extern const guint8 *file_read_mapped(unsigned int count, FILE_T file);
 WS_DLL_PUBLIC int file_peekc(FILE_T stream);
 WS_DLL_PUBLIC int file_getc(FILE_T stream);
 WS_DLL_PUBLIC char *file_gets(char *buf, int len, FILE_T stream);
@@ -37,8 +39,8 @@ extern void file_close(FILE_T file);
 #ifdef HAVE_ZLIB
 typedef struct wtap_writer *GZWFILE_T;
 
-extern GZWFILE_T gzwfile_open(const char *path);
-extern GZWFILE_T gzwfile_fdopen(int fd);
+extern GZWFILE_T gzwfile_open(const char *path, guint threads);
+extern GZWFILE_T gzwfile_fdopen(int fd, guint threads);
 extern guint gzwfile_write(GZWFILE_T state, const void *buf, guint len);
 extern int gzwfile_flush(GZWFILE_T state);
 extern int gzwfile_close(GZWFILE_T state);
@@ -52,6 +52,10 @@ static gboolean libpcap_dump(wtap_dumper *wdh, const wtap_rec *rec,
     const guint8 *pd, int *err, gchar **err_info);
 static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
     struct pcaprec_ss990915_hdr *hdr);
+static gboolean libpcap_seek_to_time(wtap *wth, const nstime_t *ts,
+    int *err, gchar **err_info);
+static gint64 libpcap_find_record_start(wtap *wth, gint64 pos, int *err,
+    gchar **err_info);
 static void libpcap_close(wtap *wth);
 
 wtap_open_return_val libpcap_open(wtap *wth, int *err, gchar **err_info)
@@ -302,6 +306,8 @@ wtap_open_return_val libpcap_open(wtap *wth, int *err, gchar **err_info)
 	wth->priv = (void *)libpcap;
 	wth->subtype_read = libpcap_read;
 	wth->subtype_seek_read = libpcap_seek_read;
+	wth->subtype_seek_to_time = libpcap_seek_to_time;
+	wth->subtype_find_record = libpcap_find_record_start;
 	wth->subtype_close = libpcap_close;
 	wth->file_encap = file_encap;
 	wth->snapshot_length = hdr.snaplen;
@@ -746,6 +752,7 @@ libpcap_read_packet(wtap *wth, FILE_T fh, wtap_rec *rec,
 	guint packet_size;
 	guint orig_size;
 	int phdr_len;
+	guint8 *pd;
 	libpcap_t *libpcap;
 
 	libpcap = (libpcap_t *)wth->priv;
@@ -826,13 +833,23 @@ libpcap_read_packet(wtap *wth, FILE_T fh, wtap_rec *rec,
 	rec->rec_header.packet_header.len = orig_size;
 
 	/*
-	 * Read the packet data.
+	 * Read the packet data.  pcap_read_post_process() only modifies
+	 * the data if the file is byte-swapped, so otherwise our caller
+	 * can use it in place if it's memory-mapped.
 	 */
-	if (!wtap_read_packet_bytes(fh, buf, packet_size, err, err_info))
-		return FALSE;	/* failed */
+	if (libpcap->byte_swapped) {
+		if (!wtap_read_packet_bytes(fh, buf, packet_size, err, err_info))
+			return FALSE;	/* failed */
+		pd = ws_buffer_start_ptr(buf);
+	} else {
+		pd = (guint8 *)wtap_read_packet_bytes_borrowed(wth, fh, buf,
+		    packet_size, err, err_info);
+		if (pd == NULL)
+			return FALSE;	/* failed */
+	}
 
 	pcap_read_post_process(wth->file_type_subtype, wth->file_encap,
-	    rec, ws_buffer_start_ptr(buf), libpcap->byte_swapped, -1);
+	    rec, pd, libpcap->byte_swapped, -1);
 	return TRUE;
 }
 
@@ -909,6 +926,240 @@ static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
 	return TRUE;
 }
 
+/*
+ * Finding a time in a file whose records are in time stamp order.
+ *
+ * pcap records have no markers we can look for, so to find where a
+ * record starts at some arbitrary offset we look for a header that
+ * makes sense, followed by LIBPCAP_SYNC_RECORDS - 1 more that make sense
+ * where the first one says the next record starts.  A header makes sense
+ * if its lengths are reasonable and its time stamp isn't before the
+ * first record's, as the records are in order.
+ */
+#define LIBPCAP_SYNC_RECORDS	4
+#define LIBPCAP_SYNC_CHUNK	(256*1024)
+/* When the range left is this small, just read through it */
+#define LIBPCAP_SEEK_LINEAR	(256*1024)
+
+static void
+libpcap_get_rec_hdr(libpcap_t *libpcap, const void *data,
+    struct pcaprec_hdr *hdr)
+{
+	memmove(hdr, data, sizeof *hdr);
+	if (libpcap->byte_swapped) {
+		hdr->ts_sec = GUINT32_SWAP_LE_BE(hdr->ts_sec);
+		hdr->ts_usec = GUINT32_SWAP_LE_BE(hdr->ts_usec);
+		hdr->incl_len = GUINT32_SWAP_LE_BE(hdr->incl_len);
+		hdr->orig_len = GUINT32_SWAP_LE_BE(hdr->orig_len);
+	}
+}
+
+static gboolean
+libpcap_rec_hdr_plausible(wtap *wth, const struct pcaprec_hdr *hdr,
+    guint32 min_secs)
+{
+	guint32 max_frac;
+
+	max_frac = (wth->file_tsprec == WTAP_TSPREC_NSEC) ? 1000000000 : 1000000;
+	return hdr->ts_usec < max_frac && hdr->ts_sec >= min_secs &&
+	    hdr->incl_len <= hdr->orig_len &&
+	    hdr->incl_len <= wtap_max_snaplen_for_encap(wth->file_encap) &&
+	    hdr->orig_len <= 128*1024*1024;
+}
+
+static void
+libpcap_rec_hdr_ts(wtap *wth, const struct pcaprec_hdr *hdr, nstime_t *ts)
+{
+	ts->secs = hdr->ts_sec;
+	if (wth->file_tsprec == WTAP_TSPREC_NSEC)
+		ts->nsecs = hdr->ts_usec;
+	else
+		ts->nsecs = hdr->ts_usec * 1000;
+}
+
+/*
+ * Check that records follow on from a plausible header at off.
+ * Returns FALSE, with *err set to 0, if they don't.
+ */
+static gboolean
+libpcap_check_records(wtap *wth, gint64 off, gint64 file_size,
+    guint32 min_secs, int *err, gchar **err_info)
+{
+	libpcap_t *libpcap = (libpcap_t *)wth->priv;
+	struct pcaprec_hdr hdr;
+	int i;
+
+	for (i = 0; i < LIBPCAP_SYNC_RECORDS; i++) {
+		if (off == file_size)
+			return TRUE;	/* the last record in the file */
+		if (file_seek(wth->fh, off, SEEK_SET, err) == -1)
+			return FALSE;
+		if (!wtap_read_bytes(wth->fh, &hdr, sizeof hdr, err, err_info)) {
+			if (*err == WTAP_ERR_SHORT_READ) {
+				*err = 0;
+				g_free(*err_info);
+				*err_info = NULL;
+			}
+			return FALSE;
+		}
+		libpcap_get_rec_hdr(libpcap, &hdr, &hdr);
+		if (!libpcap_rec_hdr_plausible(wth, &hdr, min_secs))
+			return FALSE;
+		off += sizeof hdr + hdr.incl_len;
+		if (off > file_size)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * Find the first record that starts at or after pos and before end.
+ * Returns its offset, with *ts set to its time stamp, or -1, with *err
+ * set to 0 if there isn't one we can find.
+ */
+static gint64
+libpcap_find_record(wtap *wth, gint64 pos, gint64 end, gint64 file_size,
+    guint32 min_secs, nstime_t *ts, int *err, gchar **err_info)
+{
+	libpcap_t *libpcap = (libpcap_t *)wth->priv;
+	struct pcaprec_hdr hdr;
+	guint8 *chunk;
+	int chunk_len;
+	int i;
+	gint64 found = -1;
+
+	*err = 0;
+	chunk = (guint8 *)g_malloc(LIBPCAP_SYNC_CHUNK);
+	while (found == -1 && pos < end) {
+		if (file_seek(wth->fh, pos, SEEK_SET, err) == -1)
+			break;
+		chunk_len = file_read(chunk, LIBPCAP_SYNC_CHUNK, wth->fh);
+		if (chunk_len < 0) {
+			*err = file_error(wth->fh, err_info);
+			break;
+		}
+		if (chunk_len < (int)sizeof hdr)
+			break;
+
+		for (i = 0; i + (int)sizeof hdr <= chunk_len && pos + i < end; i++) {
+			libpcap_get_rec_hdr(libpcap, chunk + i, &hdr);
+			if (!libpcap_rec_hdr_plausible(wth, &hdr, min_secs))
+				continue;
+			if (libpcap_check_records(wth, pos + i, file_size,
+			    min_secs, err, err_info)) {
+				found = pos + i;
+				libpcap_rec_hdr_ts(wth, &hdr, ts);
+				break;
+			}
+			if (*err != 0)
+				break;
+		}
+		if (*err != 0)
+			break;
+		/* The next chunk starts where a header would no longer fit in this one. */
+		pos += i;
+	}
+	g_free(chunk);
+	return found;
+}
+
+/*
+ * Can we look for records at arbitrary offsets in this file?  Only in
+ * plain pcap files; other variants have other header layouts, and ERF
+ * records have their time stamps elsewhere.  Seeking around a
+ * compressed file means decompressing it.
+ */
+static gboolean
+libpcap_can_search(wtap *wth)
+{
+	libpcap_t *libpcap = (libpcap_t *)wth->priv;
+
+	return (wth->file_type_subtype == WTAP_FILE_TYPE_SUBTYPE_PCAP ||
+	     wth->file_type_subtype == WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC) &&
+	    libpcap->lengths_swapped == NOT_SWAPPED &&
+	    wth->file_encap != WTAP_ENCAP_ERF &&
+	    !wth->ispipe && !file_iscompressed(wth->fh);
+}
+
+static gboolean
+libpcap_seek_to_time(wtap *wth, const nstime_t *target, int *err,
+    gchar **err_info)
+{
+	libpcap_t *libpcap = (libpcap_t *)wth->priv;
+	struct pcaprec_hdr hdr;
+	gint64 start, lo, hi, mid, off, file_size;
+	nstime_t ts;
+
+	*err = 0;
+	if (!libpcap_can_search(wth))
+		return FALSE;
+
+	file_size = wtap_file_size(wth, err);
+	if (file_size == -1)
+		return FALSE;
+
+	/* The first record tells us the earliest time stamp in the file. */
+	start = lo = file_tell(wth->fh);
+	if (!wtap_read_bytes_or_eof(wth->fh, &hdr, sizeof hdr, err, err_info)) {
+		if (*err == WTAP_ERR_SHORT_READ) {
+			*err = 0;
+			g_free(*err_info);
+			*err_info = NULL;
+		}
+		if (*err == 0)
+			file_seek(wth->fh, start, SEEK_SET, err);
+		return FALSE;
+	}
+	libpcap_get_rec_hdr(libpcap, &hdr, &hdr);
+	libpcap_rec_hdr_ts(wth, &hdr, &ts);
+	if (nstime_cmp(&ts, target) >= 0) {
+		file_seek(wth->fh, start, SEEK_SET, err);
+		return FALSE;
+	}
+
+	/* lo is always the start of a record before the target time. */
+	hi = file_size;
+	while (hi - lo > LIBPCAP_SEEK_LINEAR) {
+		mid = lo + (hi - lo) / 2;
+		off = libpcap_find_record(wth, mid, hi, file_size, hdr.ts_sec,
+		    &ts, err, err_info);
+		if (off == -1) {
+			if (*err != 0)
+				return FALSE;
+			hi = mid;
+		} else if (nstime_cmp(&ts, target) < 0) {
+			lo = off;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (file_seek(wth->fh, lo, SEEK_SET, err) == -1)
+		return FALSE;
+	return lo != start;
+}
+
+/*
+ * Find where a record starts, for reading the file in chunks.  The
+ * records needn't be in time order, so any time stamp is plausible.
+ */
+static gint64
+libpcap_find_record_start(wtap *wth, gint64 pos, int *err, gchar **err_info)
+{
+	gint64 file_size;
+	nstime_t ts;
+
+	*err = 0;
+	if (!libpcap_can_search(wth))
+		return -1;
+
+	file_size = wtap_file_size(wth, err);
+	if (file_size == -1)
+		return -1;
+	return libpcap_find_record(wth, pos, file_size, file_size, 0, &ts,
+	    err, err_info);
+}
+
 /* Returns 0 if we could write the specified encapsulation type,
    an error indication otherwise. */
 int libpcap_dump_can_write_encap(int encap)
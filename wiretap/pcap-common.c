@@ -2325,6 +2325,21 @@ pcap_read_post_process(int file_type, int wtap_encap,
 	}
 }
 
+void
+wtap_pcap_fill_in_pseudo_header(int encap, int fcs_len, wtap_rec *rec,
+    guint8 *pd)
+{
+	int err;
+	gchar *err_info;
+
+	/* Encapsulations without pseudo-header data never read from fh. */
+	g_assert(!wtap_encap_requires_phdr(encap));
+	pcap_process_pseudo_header(NULL, WTAP_FILE_TYPE_SUBTYPE_PCAPNG, encap,
+	    rec->rec_header.packet_header.caplen, rec, &err, &err_info);
+	pcap_read_post_process(WTAP_FILE_TYPE_SUBTYPE_PCAPNG, encap, rec, pd,
+	    FALSE, fcs_len);
+}
+
 gboolean
 wtap_encap_requires_phdr(int wtap_encap)
 {
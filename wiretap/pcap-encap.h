@@ -24,6 +24,16 @@ WS_DLL_PUBLIC int wtap_pcap_encap_to_wtap_encap(int encap);
 WS_DLL_PUBLIC int wtap_wtap_encap_to_pcap_encap(int encap);
 WS_DLL_PUBLIC gboolean wtap_encap_requires_phdr(int encap);
 
+/*
+ * Fill in the pseudo-header of a packet record that didn't come from a
+ * pcap or pcapng file, but has the same data a packet with that
+ * encapsulation in such a file would have, e.g. one handed to us by
+ * dumpcap some other way. rec's caplen must already be set, and the
+ * encapsulation must not require a pseudo-header in the packet data.
+ */
+WS_DLL_PUBLIC void wtap_pcap_fill_in_pseudo_header(int encap, int fcs_len,
+    wtap_rec *rec, guint8 *pd);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -43,6 +43,8 @@ pcapng_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
 static gboolean
 pcapng_seek_read(wtap *wth, gint64 seek_off,
                  wtap_rec *rec, Buffer *buf, int *err, gchar **err_info);
+static gint64
+pcapng_find_record(wtap *wth, gint64 pos, int *err, gchar **err_info);
 static void
 pcapng_close(wtap *wth);
 
@@ -222,6 +224,59 @@ typedef struct {
     wtap_new_ipv6_callback_t add_new_ipv6;
 } pcapng_t;
 
+/*
+ * Packet index.
+ *
+ * When asked to, we write a block of a local-use type listing runs of
+ * records: where each run starts in the file, which records it holds,
+ * and the range of their time stamps.  A small one covering the latest
+ * runs is written every PCAPNG_INDEX_ENTRIES_PER_BLOCK runs while the
+ * file is being written, and a final one covering the whole file is the
+ * last block in the file, where a reader can find it by looking at the
+ * trailing block length.
+ *
+ * Other readers skip the blocks, as they do any block type they don't
+ * know, and we don't copy them when writing a file we've read.
+ */
+#define PCAPNG_INDEX_RECORDS_PER_ENTRY  1024
+#define PCAPNG_INDEX_ENTRIES_PER_BLOCK  16
+#define PCAPNG_INDEX_MAX_ENTRIES        65536
+#define PCAPNG_INDEX_FLAG_FINAL         0x00000001  /* covers the whole file */
+#define PCAPNG_INDEX_ENTRY_HAS_TS       0x00000001  /* the time stamp range is set */
+
+/* The fixed part of a packet index block */
+typedef struct pcapng_index_block_s {
+    guint32 flags;
+    guint32 num_entries;
+    guint64 offset;         /* of this block, so we can tell if the file's been appended to */
+} pcapng_index_block_t;
+
+/* An index entry in a packet index block */
+typedef struct pcapng_index_entry_s {
+    guint32 first_record;   /* counting from 1 */
+    guint32 record_count;
+    guint32 packet_count;
+    guint32 if_count;       /* IDBs before the run */
+    guint32 dsb_count;      /* DSBs before the run */
+    guint32 flags;          /* PCAPNG_INDEX_ENTRY_ flags */
+    guint64 offset;         /* of the first record's block */
+    guint64 data_bytes;     /* sum of the packets' original lengths */
+    gint64  min_secs;
+    gint64  max_secs;
+    guint32 min_nsecs;
+    guint32 max_nsecs;
+} pcapng_index_entry_t;
+
+/* Per-file state when writing an index */
+typedef struct {
+    GArray *entries;        /* pcapng_index_entry_t for every completed run */
+    pcapng_index_entry_t pending[PCAPNG_INDEX_ENTRIES_PER_BLOCK]; /* runs not in a periodic block yet */
+    guint   num_pending;
+    guint32 run_length;     /* records per run; doubled each time we merge runs */
+    guint32 records;        /* records written so far */
+    pcapng_index_entry_t cur; /* the run being built */
+} pcapng_dump_index_t;
+
 #ifdef HAVE_PLUGINS
 /*
  * Table for plugins to handle particular block types.
@@ -264,6 +319,7 @@ register_pcapng_block_type_handler(guint block_type, block_reader reader,
     case BLOCK_TYPE_DSB:
     case BLOCK_TYPE_SYSDIG_EVENT:
     case BLOCK_TYPE_SYSTEMD_JOURNAL:
+    case BLOCK_TYPE_PACKET_INDEX:
         /*
          * Yes; we already handle it, and don't allow a replacement to
          * be registeted (if there's a bug in our code, or there's
@@ -1115,7 +1171,7 @@ pcapng_read_decryption_secrets_block(FILE_T fh, pcapng_block_header_t *bh, pcapn
 }
 
 static gboolean
-pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wtapng_block_t *wblock, int *err, gchar **err_info, gboolean enhanced)
+pcapng_read_packet_block(wtap *wth, FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wtapng_block_t *wblock, int *err, gchar **err_info, gboolean enhanced)
 {
     int bytes_read;
     guint block_read;
@@ -1132,6 +1188,7 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
     guint8 *option_content;
     int pseudo_header_len;
     int fcslen;
+    const guint8 *pd;
 #ifdef HAVE_PLUGINS
     option_handler *handler;
 #endif
@@ -1308,10 +1365,22 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
     wblock->rec->ts.secs = (time_t)(ts / iface_info.time_units_per_second);
     wblock->rec->ts.nsecs = (int)(((ts % iface_info.time_units_per_second) * 1000000000) / iface_info.time_units_per_second);
 
-    /* "(Enhanced) Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                packet.cap_len - pseudo_header_len, err, err_info))
-        return FALSE;
+    /*
+     * "(Enhanced) Packet Block" read capture data; pcap_read_post_process()
+     * only modifies it if the file is byte-swapped, so otherwise it can be
+     * used in place if the file is memory-mapped.
+     */
+    if (pn->byte_swapped) {
+        if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
+                                    packet.cap_len - pseudo_header_len, err, err_info))
+            return FALSE;
+        pd = ws_buffer_start_ptr(wblock->frame_buffer);
+    } else {
+        pd = wtap_read_packet_bytes_borrowed(wth, fh, wblock->frame_buffer,
+                                             packet.cap_len - pseudo_header_len, err, err_info);
+        if (pd == NULL)
+            return FALSE;
+    }
     block_read += packet.cap_len - pseudo_header_len;
 
     /* jump over potential padding bytes at end of the packet data */
@@ -1453,7 +1522,7 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
     }
 
     pcap_read_post_process(WTAP_FILE_TYPE_SUBTYPE_PCAPNG, iface_info.wtap_encap,
-                           wblock->rec, ws_buffer_start_ptr(wblock->frame_buffer),
+                           wblock->rec, (guint8 *)pd,
                            pn->byte_swapped, fcslen);
 
     /*
@@ -2563,7 +2632,7 @@ pcapng_read_block(wtap *wth, FILE_T fh, pcapng_t *pn, wtapng_block_t *wblock, in
                     return PCAPNG_BLOCK_ERROR;
                 break;
             case(BLOCK_TYPE_PB):
-                if (!pcapng_read_packet_block(fh, &bh, pn, wblock, err, err_info, FALSE))
+                if (!pcapng_read_packet_block(wth, fh, &bh, pn, wblock, err, err_info, FALSE))
                     return PCAPNG_BLOCK_ERROR;
                 break;
             case(BLOCK_TYPE_SPB):
@@ -2571,7 +2640,7 @@ pcapng_read_block(wtap *wth, FILE_T fh, pcapng_t *pn, wtapng_block_t *wblock, in
                     return PCAPNG_BLOCK_ERROR;
                 break;
             case(BLOCK_TYPE_EPB):
-                if (!pcapng_read_packet_block(fh, &bh, pn, wblock, err, err_info, TRUE))
+                if (!pcapng_read_packet_block(wth, fh, &bh, pn, wblock, err, err_info, TRUE))
                     return PCAPNG_BLOCK_ERROR;
                 break;
             case(BLOCK_TYPE_NRB):
@@ -2665,6 +2734,118 @@ pcapng_process_dsb(wtap *wth, wtapng_block_t *wblock)
     g_array_append_val(wth->dsbs, wblock->block);
 }
 
+/*
+ * If the file ends with a packet index block covering the whole file,
+ * load the index.  Any problem with it just means we don't have one.
+ * Returns FALSE only if we couldn't seek back to where we were.
+ */
+static gboolean
+pcapng_read_index(wtap *wth, pcapng_t *pcapng, int *err)
+{
+    gint64 saved_offset, size;
+    guint32 trailer_len, next_record, i;
+    pcapng_block_header_t bh;
+    pcapng_index_block_t ib;
+    pcapng_index_entry_t entry;
+    wtap_index_entry index_entry;
+    GArray *index;
+    int read_err;
+    gchar *read_err_info = NULL;
+
+    /* Don't read all of a compressed file to get to the end of it. */
+    if (wth->ispipe || file_iscompressed(wth->fh))
+        return TRUE;
+
+    saved_offset = file_tell(wth->fh);
+    size = wtap_file_size(wth, &read_err);
+    if (size == -1 || size - saved_offset < (gint64)(MIN_BLOCK_SIZE + sizeof ib))
+        return TRUE;
+
+    if (file_seek(wth->fh, size - (gint64)sizeof trailer_len, SEEK_SET, &read_err) == -1 ||
+        !wtap_read_bytes(wth->fh, &trailer_len, sizeof trailer_len, &read_err, &read_err_info))
+        goto done;
+    if (pcapng->byte_swapped)
+        trailer_len = GUINT32_SWAP_LE_BE(trailer_len);
+    if (trailer_len < MIN_BLOCK_SIZE + sizeof ib || trailer_len > MAX_BLOCK_SIZE ||
+        trailer_len % 4 != 0 || trailer_len > size - saved_offset)
+        goto done;
+
+    if (file_seek(wth->fh, size - trailer_len, SEEK_SET, &read_err) == -1 ||
+        !wtap_read_bytes(wth->fh, &bh, sizeof bh, &read_err, &read_err_info) ||
+        !wtap_read_bytes(wth->fh, &ib, sizeof ib, &read_err, &read_err_info))
+        goto done;
+    if (pcapng->byte_swapped) {
+        bh.block_type         = GUINT32_SWAP_LE_BE(bh.block_type);
+        bh.block_total_length = GUINT32_SWAP_LE_BE(bh.block_total_length);
+        ib.flags              = GUINT32_SWAP_LE_BE(ib.flags);
+        ib.num_entries        = GUINT32_SWAP_LE_BE(ib.num_entries);
+        ib.offset             = GUINT64_SWAP_LE_BE(ib.offset);
+    }
+    if (bh.block_type != BLOCK_TYPE_PACKET_INDEX ||
+        bh.block_total_length != trailer_len ||
+        !(ib.flags & PCAPNG_INDEX_FLAG_FINAL) ||
+        ib.offset != (guint64)(size - trailer_len) ||
+        (guint64)ib.num_entries * sizeof entry != trailer_len - MIN_BLOCK_SIZE - sizeof ib)
+        goto done;
+
+    index = g_array_sized_new(FALSE, FALSE, sizeof(wtap_index_entry), ib.num_entries);
+    next_record = 1;
+    for (i = 0; i < ib.num_entries; i++) {
+        if (!wtap_read_bytes(wth->fh, &entry, sizeof entry, &read_err, &read_err_info)) {
+            g_array_free(index, TRUE);
+            goto done;
+        }
+        if (pcapng->byte_swapped) {
+            entry.first_record = GUINT32_SWAP_LE_BE(entry.first_record);
+            entry.record_count = GUINT32_SWAP_LE_BE(entry.record_count);
+            entry.packet_count = GUINT32_SWAP_LE_BE(entry.packet_count);
+            entry.if_count     = GUINT32_SWAP_LE_BE(entry.if_count);
+            entry.dsb_count    = GUINT32_SWAP_LE_BE(entry.dsb_count);
+            entry.flags        = GUINT32_SWAP_LE_BE(entry.flags);
+            entry.offset       = GUINT64_SWAP_LE_BE(entry.offset);
+            entry.data_bytes   = GUINT64_SWAP_LE_BE(entry.data_bytes);
+            entry.min_secs     = GUINT64_SWAP_LE_BE(entry.min_secs);
+            entry.max_secs     = GUINT64_SWAP_LE_BE(entry.max_secs);
+            entry.min_nsecs    = GUINT32_SWAP_LE_BE(entry.min_nsecs);
+            entry.max_nsecs    = GUINT32_SWAP_LE_BE(entry.max_nsecs);
+        }
+
+        /* The runs must be in order, and in the part of the file before the index. */
+        if (entry.first_record != next_record || entry.record_count == 0 ||
+            entry.packet_count > entry.record_count ||
+            entry.offset < (guint64)saved_offset ||
+            entry.offset >= (guint64)(size - trailer_len)) {
+            g_array_free(index, TRUE);
+            goto done;
+        }
+        next_record += entry.record_count;
+
+        index_entry.first_record = entry.first_record;
+        index_entry.record_count = entry.record_count;
+        index_entry.packet_count = entry.packet_count;
+        index_entry.if_count = entry.if_count;
+        index_entry.dsb_count = entry.dsb_count;
+        index_entry.offset = (gint64)entry.offset;
+        index_entry.data_bytes = entry.data_bytes;
+        if (entry.flags & PCAPNG_INDEX_ENTRY_HAS_TS) {
+            index_entry.min_ts.secs = (time_t)entry.min_secs;
+            index_entry.min_ts.nsecs = (int)entry.min_nsecs;
+            index_entry.max_ts.secs = (time_t)entry.max_secs;
+            index_entry.max_ts.nsecs = (int)entry.max_nsecs;
+        } else {
+            nstime_set_unset(&index_entry.min_ts);
+            nstime_set_unset(&index_entry.max_ts);
+        }
+        g_array_append_val(index, index_entry);
+    }
+    pcapng_debug("pcapng_read_index: read an index of %u runs", ib.num_entries);
+    wth->index = index;
+
+done:
+    g_free(read_err_info);
+    return file_seek(wth->fh, saved_offset, SEEK_SET, err) != -1;
+}
+
 /* classic wtap: open capture file */
 wtap_open_return_val
 pcapng_open(wtap *wth, int *err, gchar **err_info)
@@ -2740,6 +2921,7 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
 
     wth->subtype_read = pcapng_read;
     wth->subtype_seek_read = pcapng_seek_read;
+    wth->subtype_find_record = pcapng_find_record;
     wth->subtype_close = pcapng_close;
     wth->file_type_subtype = WTAP_FILE_TYPE_SUBTYPE_PCAPNG;
 
@@ -2789,6 +2971,9 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
         pcapng_debug("pcapng_open: Read IDB number_of_interfaces %u, wtap_encap %i",
                       wth->interface_data->len, wth->file_encap);
     }
+
+    if (!pcapng_read_index(wth, pcapng, err))
+        return WTAP_OPEN_ERROR;
     return WTAP_OPEN_MINE;
 }
 
@@ -2829,6 +3014,25 @@ pcapng_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
             break;
         }
 
+        /*
+         * A thread reading one chunk of the file for wtap_read_chunks()
+         * leaves blocks that change what we know about the file to the
+         * main handle, which reads from here.
+         */
+        if (wth->chunk_worker) {
+            switch (wblock.type) {
+
+                case(BLOCK_TYPE_SHB):
+                case(BLOCK_TYPE_IDB):
+                case(BLOCK_TYPE_DSB):
+                case(BLOCK_TYPE_NRB):
+                case(BLOCK_TYPE_ISB):
+                    wtap_block_free(wblock.block);
+                    *err = 0;
+                    return FALSE;
+            }
+        }
+
         /*
          * This is a block type we process internally, rather than
          * returning it for the caller to process.
@@ -2925,6 +3129,151 @@ pcapng_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
 }
 
 
+/*
+ * Finding where a block starts at an arbitrary offset, so that
+ * wtap_read_chunks() can read different parts of the file at the same
+ * time.  Blocks start at multiples of 4 bytes and have their length at
+ * both ends, so we look for a block of a type we know whose lengths
+ * agree, followed by PCAPNG_SYNC_BLOCKS - 1 more whose lengths agree.
+ * Only the first section's byte order is tried; wtap_read_chunks()
+ * doesn't trust what it finds after another section starts.
+ */
+#define PCAPNG_SYNC_BLOCKS  4
+#define PCAPNG_SYNC_CHUNK   (256*1024)
+
+static gboolean
+pcapng_block_type_known(guint32 block_type)
+{
+    switch (block_type) {
+
+    case BLOCK_TYPE_SHB:
+    case BLOCK_TYPE_IDB:
+    case BLOCK_TYPE_PB:
+    case BLOCK_TYPE_SPB:
+    case BLOCK_TYPE_NRB:
+    case BLOCK_TYPE_ISB:
+    case BLOCK_TYPE_EPB:
+    case BLOCK_TYPE_DSB:
+    case BLOCK_TYPE_PACKET_INDEX:
+        return TRUE;
+
+    default:
+        return FALSE;
+    }
+}
+
+static gboolean
+pcapng_block_length_plausible(guint32 block_total_length, gint64 off,
+                              gint64 file_size)
+{
+    return block_total_length >= MIN_BLOCK_SIZE &&
+           block_total_length <= MAX_BLOCK_SIZE &&
+           block_total_length % 4 == 0 &&
+           off + block_total_length <= file_size;
+}
+
+/*
+ * Check that blocks follow on from a plausible block header at off.
+ * Returns FALSE, with *err set to 0, if they don't.
+ */
+static gboolean
+pcapng_check_blocks(wtap *wth, pcapng_t *pcapng, gint64 off, gint64 file_size,
+                    int *err, gchar **err_info)
+{
+    pcapng_block_header_t bh;
+    guint32 trailer_len;
+    int i;
+
+    for (i = 0; i < PCAPNG_SYNC_BLOCKS; i++) {
+        if (off == file_size)
+            return TRUE;    /* the last block in the file */
+        if (off + (gint64)sizeof bh > file_size)
+            return FALSE;
+        if (file_seek(wth->fh, off, SEEK_SET, err) == -1 ||
+            !wtap_read_bytes(wth->fh, &bh, sizeof bh, err, err_info))
+            return FALSE;
+        if (pcapng->byte_swapped) {
+            bh.block_type         = GUINT32_SWAP_LE_BE(bh.block_type);
+            bh.block_total_length = GUINT32_SWAP_LE_BE(bh.block_total_length);
+        }
+        if (!pcapng_block_length_plausible(bh.block_total_length, off, file_size))
+            return FALSE;
+        if (file_seek(wth->fh, off + bh.block_total_length - (gint64)sizeof trailer_len,
+                      SEEK_SET, err) == -1 ||
+            !wtap_read_bytes(wth->fh, &trailer_len, sizeof trailer_len, err, err_info))
+            return FALSE;
+        if (pcapng->byte_swapped)
+            trailer_len = GUINT32_SWAP_LE_BE(trailer_len);
+        if (trailer_len != bh.block_total_length)
+            return FALSE;
+        off += bh.block_total_length;
+    }
+    return TRUE;
+}
+
+static gint64
+pcapng_find_record(wtap *wth, gint64 pos, int *err, gchar **err_info)
+{
+    pcapng_t *pcapng = (pcapng_t *)wth->priv;
+    pcapng_block_header_t bh;
+    gint64 file_size;
+    guint8 *chunk;
+    int chunk_len;
+    int i;
+    gint64 found = -1;
+
+    *err = 0;
+    if (wth->ispipe || file_iscompressed(wth->fh))
+        return -1;
+    file_size = wtap_file_size(wth, err);
+    if (file_size == -1)
+        return -1;
+
+    pos = (pos + 3) & ~(gint64)3;
+    chunk = (guint8 *)g_malloc(PCAPNG_SYNC_CHUNK);
+    while (found == -1 && pos < file_size) {
+        if (file_seek(wth->fh, pos, SEEK_SET, err) == -1)
+            break;
+        chunk_len = file_read(chunk, PCAPNG_SYNC_CHUNK, wth->fh);
+        if (chunk_len < 0) {
+            *err = file_error(wth->fh, err_info);
+            break;
+        }
+        if (chunk_len < (int)sizeof bh)
+            break;
+
+        for (i = 0; i + (int)sizeof bh <= chunk_len; i += 4) {
+            memcpy(&bh, chunk + i, sizeof bh);
+            if (pcapng->byte_swapped) {
+                bh.block_type         = GUINT32_SWAP_LE_BE(bh.block_type);
+                bh.block_total_length = GUINT32_SWAP_LE_BE(bh.block_total_length);
+            }
+            if (!pcapng_block_type_known(bh.block_type) ||
+                !pcapng_block_length_plausible(bh.block_total_length, pos + i, file_size))
+                continue;
+            if (pcapng_check_blocks(wth, pcapng, pos + i, file_size, err, err_info)) {
+                found = pos + i;
+                break;
+            }
+            if (*err != 0) {
+                if (*err == WTAP_ERR_SHORT_READ) {
+                    /* The file's shorter than it was. */
+                    g_free(*err_info);
+                    *err_info = NULL;
+                    *err = 0;
+                }
+                break;
+            }
+        }
+        if (*err != 0 || found != -1 || i + (int)sizeof bh <= chunk_len)
+            break;
+        /* The next chunk starts where a header would no longer fit in this one. */
+        pos += i;
+    }
+    g_free(chunk);
+    return found;
+}
+
 /* classic wtap: seek to file position and read packet */
 static gboolean
 pcapng_seek_read(wtap *wth, gint64 seek_off,
@@ -4388,6 +4737,170 @@ pcapng_write_if_descr_block(wtap_dumper *wdh, wtap_block_t int_data, int *err)
     return TRUE;
 }
 
+static gboolean
+pcapng_write_index_block(wtap_dumper *wdh, const pcapng_index_entry_t *entries,
+                         guint num_entries, guint32 flags, int *err)
+{
+    pcapng_block_header_t bh;
+    pcapng_index_block_t ib;
+    gsize entries_len = num_entries * sizeof(pcapng_index_entry_t);
+
+    bh.block_type = BLOCK_TYPE_PACKET_INDEX;
+    bh.block_total_length = (guint32)(sizeof bh + sizeof ib + entries_len + 4);
+    ib.flags = flags;
+    ib.num_entries = num_entries;
+    ib.offset = (guint64)wdh->bytes_dumped;
+
+    if (!wtap_dump_file_write(wdh, &bh, sizeof bh, err))
+        return FALSE;
+    wdh->bytes_dumped += sizeof bh;
+
+    if (!wtap_dump_file_write(wdh, &ib, sizeof ib, err))
+        return FALSE;
+    wdh->bytes_dumped += sizeof ib;
+
+    if (entries_len != 0) {
+        if (!wtap_dump_file_write(wdh, entries, entries_len, err))
+            return FALSE;
+        wdh->bytes_dumped += entries_len;
+    }
+
+    /* write block footer */
+    if (!wtap_dump_file_write(wdh, &bh.block_total_length,
+                              sizeof bh.block_total_length, err))
+        return FALSE;
+    wdh->bytes_dumped += sizeof bh.block_total_length;
+    return TRUE;
+}
+
+/* Widen a run's time stamp range to include a time stamp. */
+static void
+pcapng_index_add_ts(pcapng_index_entry_t *entry, gint64 secs, guint32 nsecs)
+{
+    if (!(entry->flags & PCAPNG_INDEX_ENTRY_HAS_TS)) {
+        entry->flags |= PCAPNG_INDEX_ENTRY_HAS_TS;
+        entry->min_secs = entry->max_secs = secs;
+        entry->min_nsecs = entry->max_nsecs = nsecs;
+        return;
+    }
+    if (secs < entry->min_secs ||
+        (secs == entry->min_secs && nsecs < entry->min_nsecs)) {
+        entry->min_secs = secs;
+        entry->min_nsecs = nsecs;
+    }
+    if (secs > entry->max_secs ||
+        (secs == entry->max_secs && nsecs > entry->max_nsecs)) {
+        entry->max_secs = secs;
+        entry->max_nsecs = nsecs;
+    }
+}
+
+/* Halve the number of runs, to keep the final index to a reasonable size. */
+static void
+pcapng_index_merge_runs(pcapng_dump_index_t *pindex)
+{
+    pcapng_index_entry_t *entries = (pcapng_index_entry_t *)(void *)pindex->entries->data;
+    pcapng_index_entry_t *merged, *next;
+    guint i, n = 0;
+
+    for (i = 0; i < pindex->entries->len; i += 2) {
+        merged = &entries[n++];
+        *merged = entries[i];
+        if (i + 1 < pindex->entries->len) {
+            next = &entries[i + 1];
+            merged->record_count += next->record_count;
+            merged->packet_count += next->packet_count;
+            merged->data_bytes += next->data_bytes;
+            if (next->flags & PCAPNG_INDEX_ENTRY_HAS_TS) {
+                pcapng_index_add_ts(merged, next->min_secs, next->min_nsecs);
+                pcapng_index_add_ts(merged, next->max_secs, next->max_nsecs);
+            }
+        }
+    }
+    g_array_set_size(pindex->entries, n);
+    pindex->run_length *= 2;
+}
+
+/* Add the run being built to the index, and write a periodic index block
+   if enough runs have been added since the last one. */
+static gboolean
+pcapng_index_end_run(wtap_dumper *wdh, gboolean periodic, int *err)
+{
+    pcapng_dump_index_t *pindex = (pcapng_dump_index_t *)wdh->priv;
+
+    if (pindex->cur.record_count == 0)
+        return TRUE;
+
+    if (pindex->entries->len >= PCAPNG_INDEX_MAX_ENTRIES)
+        pcapng_index_merge_runs(pindex);
+    g_array_append_val(pindex->entries, pindex->cur);
+    pindex->pending[pindex->num_pending++] = pindex->cur;
+    pindex->cur.record_count = 0;
+
+    if (periodic && pindex->num_pending == PCAPNG_INDEX_ENTRIES_PER_BLOCK) {
+        if (!pcapng_write_index_block(wdh, pindex->pending, pindex->num_pending, 0, err))
+            return FALSE;
+        pindex->num_pending = 0;
+    }
+    return TRUE;
+}
+
+/* Note a record that's about to be written at the current offset. */
+static gboolean
+pcapng_index_add_record(wtap_dumper *wdh, const wtap_rec *rec, int *err)
+{
+    pcapng_dump_index_t *pindex = (pcapng_dump_index_t *)wdh->priv;
+    pcapng_index_entry_t *cur = &pindex->cur;
+
+    if (cur->record_count >= pindex->run_length) {
+        if (!pcapng_index_end_run(wdh, TRUE, err))
+            return FALSE;
+    }
+
+    if (cur->record_count == 0) {
+        memset(cur, 0, sizeof *cur);
+        cur->first_record = pindex->records + 1;
+        cur->if_count = wdh->interface_data->len;
+        cur->dsb_count = (wdh->dsbs_initial ? wdh->dsbs_initial->len : 0) +
+                         wdh->dsbs_growing_written;
+        cur->offset = (guint64)wdh->bytes_dumped;
+    }
+    /* A record without a time stamp says nothing about the run's times. */
+    if (rec->presence_flags & WTAP_HAS_TS)
+        pcapng_index_add_ts(cur, (gint64)rec->ts.secs, (guint32)rec->ts.nsecs);
+    cur->record_count++;
+    if (rec->rec_type == REC_TYPE_PACKET) {
+        cur->packet_count++;
+        cur->data_bytes += rec->rec_header.packet_header.len;
+    }
+    pindex->records++;
+    return TRUE;
+}
+
+/* Write the index covering the whole file, as the last block. */
+static gboolean
+pcapng_write_final_index_block(wtap_dumper *wdh, int *err)
+{
+    pcapng_dump_index_t *pindex = (pcapng_dump_index_t *)wdh->priv;
+
+    if (!pcapng_index_end_run(wdh, FALSE, err))
+        return FALSE;
+    return pcapng_write_index_block(wdh,
+                                    (const pcapng_index_entry_t *)(void *)pindex->entries->data,
+                                    pindex->entries->len, PCAPNG_INDEX_FLAG_FINAL, err);
+}
+
+static void
+pcapng_index_free(wtap_dumper *wdh)
+{
+    pcapng_dump_index_t *pindex = (pcapng_dump_index_t *)wdh->priv;
+
+    if (pindex != NULL && pindex->entries != NULL) {
+        g_array_free(pindex->entries, TRUE);
+        pindex->entries = NULL;
+    }
+}
+
 static gboolean pcapng_dump(wtap_dumper *wdh,
                             const wtap_rec *rec,
                             const guint8 *pd, int *err, gchar **err_info _U_)
@@ -4409,6 +4922,11 @@ static gboolean pcapng_dump(wtap_dumper *wdh,
         }
     }
 
+    /* If we're writing an index, the record goes in it at this offset. */
+    if (wdh->priv != NULL) {
+        if (!pcapng_index_add_record(wdh, rec, err))
+            return FALSE;
+    }
 
     pcapng_debug("%s: encap = %d (%s) rec type = %u", G_STRFUNC,
                   rec->rec_header.packet_header.pkt_encap,
@@ -4495,11 +5013,21 @@ static gboolean pcapng_dump_finish(wtap_dumper *wdh, int *err)
             if_stats = g_array_index(int_data_mand->interface_statistics, wtap_block_t, j);
             pcapng_debug("pcapng_dump_finish: write ISB for interface %u", ((wtapng_if_stats_mandatory_t*)wtap_block_get_mandatory_data(if_stats))->interface_id);
             if (!pcapng_write_interface_statistics_block(wdh, if_stats, err)) {
+                pcapng_index_free(wdh);
                 return FALSE;
             }
         }
     }
 
+    /* The index has to be the last block, so readers can find it. */
+    if (wdh->priv != NULL) {
+        if (!pcapng_write_final_index_block(wdh, err)) {
+            pcapng_index_free(wdh);
+            return FALSE;
+        }
+        pcapng_index_free(wdh);
+    }
+
     pcapng_debug("pcapng_dump_finish");
     return TRUE;
 }
@@ -4557,6 +5085,14 @@ pcapng_dump_open(wtap_dumper *wdh, int *err)
         }
     }
 
+    if (wdh->write_index) {
+        pcapng_dump_index_t *pindex = g_new0(pcapng_dump_index_t, 1);
+
+        pindex->entries = g_array_new(FALSE, FALSE, sizeof(pcapng_index_entry_t));
+        pindex->run_length = PCAPNG_INDEX_RECORDS_PER_ENTRY;
+        wdh->priv = pindex;
+    }
+
     return TRUE;
 }
 
@@ -29,6 +29,9 @@
 #define BLOCK_TYPE_SYSDIG_EVENT     0x00000204 /* Sysdig Event Block */
 #define BLOCK_TYPE_SYSDIG_EVF       0x00000208 /* Sysdig Event Block with flags */
 
+/* Local-use block types (high bit set) that we write ourselves */
+#define BLOCK_TYPE_PACKET_INDEX     0x80574958 /* Packet index */
+
 /* TODO: the following are not yet well defined in the draft spec,
  * and do not yet have block type values assigned to them:
  * Compression Block
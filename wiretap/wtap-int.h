@@ -28,6 +28,27 @@ typedef gboolean (*subtype_read_func)(struct wtap*, wtap_rec *,
                                       Buffer *, int *, char **, gint64 *);
 typedef gboolean (*subtype_seek_read_func)(struct wtap*, gint64, wtap_rec *,
                                            Buffer *, int *, char **);
+/* Move the sequential position to about where the records with a given
+   time stamp start, in a file whose records are in time stamp order */
+typedef gboolean (*subtype_seek_to_time_func)(struct wtap*, const nstime_t *,
+                                              int *, char **);
+
+/* Find the offset of the first record that starts at or after an
+   arbitrary offset, or return -1 */
+typedef gint64 (*subtype_find_record_func)(struct wtap*, gint64, int *,
+                                           char **);
+
+/* Records the caller has asked wtap_read() to limit itself to */
+typedef struct {
+    nstime_t start;         /* earliest time stamp wanted, or unset */
+    nstime_t stop;          /* records must be before this, or unset */
+    gboolean ordered;       /* the caller says the records are in time order */
+    gboolean positioned;    /* have we skipped to the start yet? */
+    gboolean numbered;      /* do we know how many records came before? */
+    guint32  records;       /* records read or skipped so far, if numbered */
+    gboolean have_last;     /* last_record is valid */
+    guint32  last_record;   /* last record that might be in the window */
+} wtap_time_window;
 
 /**
  * Struct holding data of the currently read file.
@@ -48,6 +69,8 @@ struct wtap {
 
     subtype_read_func           subtype_read;
     subtype_seek_read_func      subtype_seek_read;
+    subtype_seek_to_time_func   subtype_seek_to_time;   /**< or NULL if the file type can't */
+    subtype_find_record_func    subtype_find_record;    /**< or NULL if the file type can't */
     void                        (*subtype_sequential_close)(struct wtap*);
     void                        (*subtype_close)(struct wtap*);
     int                         file_encap;    /* per-file, for those
@@ -70,6 +93,11 @@ struct wtap {
     wtap_new_ipv6_callback_t    add_new_ipv6;
     wtap_new_secrets_callback_t add_new_secrets;
     GPtrArray                   *fast_seek;
+    gboolean                    borrow_data;    /* TRUE if the caller accepts a pointer into the file (wtap_read_borrowed()) */
+    const guint8                *borrowed_data; /* set by wtap_read_packet_bytes_borrowed() if it returned such a pointer */
+    GArray                      *index;         /**< wtap_index_entry for every record in the file, in order, or NULL */
+    wtap_time_window            *time_window;   /**< set by wtap_set_time_window(), or NULL */
+    gboolean                    chunk_worker;   /**< reading one chunk for wtap_read_chunks(); stop at blocks that change what we know about the file */
 };
 
 struct wtap_dumper;
@@ -90,6 +118,7 @@ struct wtap_dumper {
     int                     snaplen;
     int                     encap;
     wtap_compression_type   compression_type;
+    guint                   compress_threads;   /* threads to compress on, see wtap_dump_params */
     gboolean                needs_reload;   /* TRUE if the file requires re-loading after saving with wtap */
     gint64                  bytes_dumped;
 
@@ -111,6 +140,7 @@ struct wtap_dumper {
      */
     const GArray            *dsbs_growing;          /**< A reference to an array of DSBs (of type wtap_block_t) */
     guint                   dsbs_growing_written;   /**< Number of already processed DSBs in dsbs_growing. */
+    gboolean                write_index;            /**< Write a packet index, if the subtype can */
 };
 
 WS_DLL_PUBLIC gboolean wtap_dump_file_write(wtap_dumper *wdh, const void *buf,
@@ -312,6 +342,20 @@ gboolean
 wtap_read_packet_bytes(FILE_T fh, Buffer *buf, guint length, int *err,
     gchar **err_info);
 
+/*
+ * Read packet data, growing the buffer as necessary, and return a pointer
+ * to it, or NULL on error.  Errors are handled as for
+ * wtap_read_packet_bytes().
+ *
+ * If the caller of wtap_read() or wtap_seek_read() asked for borrowed
+ * data, and the data is in a memory-mapped file, this returns a pointer
+ * into the file without copying anything to the buffer.  Read routines
+ * should only use this for data that they don't modify afterwards.
+ */
+const guint8 *
+wtap_read_packet_bytes_borrowed(wtap *wth, FILE_T fh, Buffer *buf,
+    guint length, int *err, gchar **err_info);
+
 /*
  * Implementation of wth->subtype_read that reads the full file contents
  * as a single packet.
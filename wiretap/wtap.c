@@ -104,6 +104,15 @@ wtap_file_get_shb(wtap *wth)
 	return g_array_index(wth->shb_hdrs, wtap_block_t, 0);
 }
 
+guint
+wtap_file_get_num_shbs(wtap *wth)
+{
+	if ((wth == NULL) || (wth->shb_hdrs == NULL) || (wth->shb_hdrs->len == 0))
+		return 1;
+
+	return wth->shb_hdrs->len;
+}
+
 GArray*
 wtap_file_get_shb_for_new_file(wtap *wth)
 {
@@ -1212,6 +1221,16 @@ wtap_sequential_close(wtap *wth)
 	}
 }
 
+void
+wtap_copy_fast_seek(wtap *wth, wtap *from)
+{
+	/* Our own sequential side would add points of its own. */
+	wtap_sequential_close(wth);
+
+	if (wth->random_fh != NULL)
+		file_copy_fast_seek(wth->random_fh, from->fast_seek);
+}
+
 static void
 g_fast_seek_item_free(gpointer data, gpointer user_data _U_)
 {
@@ -1256,6 +1275,10 @@ wtap_close(wtap *wth)
 	wtap_block_array_free(wth->interface_data);
 	wtap_block_array_free(wth->dsbs);
 
+	if (wth->index != NULL)
+		g_array_free(wth->index, TRUE);
+	g_free(wth->time_window);
+
 	g_free(wth);
 }
 
@@ -1301,8 +1324,8 @@ wtapng_process_dsb(wtap *wth, wtap_block_t dsb)
 		wth->add_new_secrets(dsb_mand->secrets_type, dsb_mand->secrets_data, dsb_mand->secrets_len);
 }
 
-gboolean
-wtap_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
+static gboolean
+wtap_read_record(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
 	gchar **err_info, gint64 *offset)
 {
 	/*
@@ -1358,6 +1381,101 @@ wtap_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
 	return TRUE;	/* success */
 }
 
+/* Skip to where the time window starts, as far as we can tell. */
+static gboolean
+wtap_time_window_position(wtap *wth, int *err, gchar **err_info)
+{
+	wtap_time_window *tw = wth->time_window;
+	guint32 skipped;
+
+	tw->positioned = TRUE;
+	tw->numbered = TRUE;
+	tw->records = 0;
+	if (!nstime_is_unset(&tw->start)) {
+		if (wtap_seek_to_time(wth, &tw->start, &skipped, err)) {
+			tw->records = skipped;
+		} else if (*err != 0) {
+			return FALSE;
+		} else if (tw->ordered && wth->subtype_seek_to_time != NULL) {
+			if ((*wth->subtype_seek_to_time)(wth, &tw->start, err, err_info)) {
+				/* We don't know how many records we skipped. */
+				tw->numbered = FALSE;
+			} else if (*err != 0) {
+				return FALSE;
+			}
+		}
+	}
+	if (tw->numbered && !nstime_is_unset(&tw->stop))
+		tw->have_last = wtap_index_last_record_before(wth, &tw->stop, &tw->last_record);
+	return TRUE;
+}
+
+void
+wtap_set_time_window(wtap *wth, const nstime_t *start, const nstime_t *stop,
+    gboolean ordered)
+{
+	wtap_time_window *tw;
+
+	if (start == NULL && stop == NULL) {
+		g_free(wth->time_window);
+		wth->time_window = NULL;
+		return;
+	}
+
+	tw = g_new0(wtap_time_window, 1);
+	if (start != NULL)
+		tw->start = *start;
+	else
+		nstime_set_unset(&tw->start);
+	if (stop != NULL)
+		tw->stop = *stop;
+	else
+		nstime_set_unset(&tw->stop);
+	tw->ordered = ordered;
+	g_free(wth->time_window);
+	wth->time_window = tw;
+}
+
+gboolean
+wtap_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
+	gchar **err_info, gint64 *offset)
+{
+	wtap_time_window *tw = wth->time_window;
+
+	if (tw == NULL)
+		return wtap_read_record(wth, rec, buf, err, err_info, offset);
+
+	*err = 0;
+	*err_info = NULL;
+	if (!tw->positioned && !wtap_time_window_position(wth, err, err_info))
+		return FALSE;
+
+	for (;;) {
+		/* Nothing after the last record the index puts in the window. */
+		if (tw->have_last && tw->records >= tw->last_record) {
+			*err = 0;
+			*err_info = NULL;
+			return FALSE;
+		}
+		if (!wtap_read_record(wth, rec, buf, err, err_info, offset))
+			return FALSE;
+		tw->records++;
+
+		if (!(rec->presence_flags & WTAP_HAS_TS))
+			continue;
+		if (!nstime_is_unset(&tw->start) &&
+		    nstime_cmp(&rec->ts, &tw->start) < 0)
+			continue;
+		if (!nstime_is_unset(&tw->stop) &&
+		    nstime_cmp(&rec->ts, &tw->stop) >= 0) {
+			if (tw->ordered)
+				return FALSE;	/* *err is 0: EOF */
+			continue;
+		}
+		return TRUE;
+	}
+}
+
 /*
  * Read a given number of bytes from a file into a buffer or, if
  * buf is NULL, just discard them.
@@ -1437,6 +1555,24 @@ wtap_read_packet_bytes(FILE_T fh, Buffer *buf, guint length, int *err,
 	    err_info);
 }
 
+const guint8 *
+wtap_read_packet_bytes_borrowed(wtap *wth, FILE_T fh, Buffer *buf,
+    guint length, int *err, gchar **err_info)
+{
+	const guint8 *data;
+
+	if (wth->borrow_data) {
+		data = file_read_mapped(length, fh);
+		if (data != NULL) {
+			wth->borrowed_data = data;
+			return data;
+		}
+	}
+	if (!wtap_read_packet_bytes(fh, buf, length, err, err_info))
+		return NULL;
+	return ws_buffer_start_ptr(buf);
+}
+
 /*
  * Return an approximation of the amount of data we've read sequentially
  * from the file so far.  (gint64, in case that's 64 bits.)
@@ -1507,6 +1643,371 @@ wtap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec, Buffer *buf,
 	return TRUE;
 }
 
+gboolean
+wtap_read_borrowed(wtap *wth, wtap_rec *rec, Buffer *buf,
+    const guint8 **data, int *err, gchar **err_info, gint64 *offset)
+{
+	gboolean ret;
+
+	wth->borrow_data = TRUE;
+	wth->borrowed_data = NULL;
+	ret = wtap_read(wth, rec, buf, err, err_info, offset);
+	wth->borrow_data = FALSE;
+	if (ret)
+		*data = wth->borrowed_data != NULL ? wth->borrowed_data : ws_buffer_start_ptr(buf);
+	return ret;
+}
+
+gboolean
+wtap_seek_read_borrowed(wtap *wth, gint64 seek_off, wtap_rec *rec,
+    Buffer *buf, const guint8 **data, int *err, gchar **err_info)
+{
+	gboolean ret;
+
+	wth->borrow_data = TRUE;
+	wth->borrowed_data = NULL;
+	ret = wtap_seek_read(wth, seek_off, rec, buf, err, err_info);
+	wth->borrow_data = FALSE;
+	if (ret)
+		*data = wth->borrowed_data != NULL ? wth->borrowed_data : ws_buffer_start_ptr(buf);
+	return ret;
+}
+
+/* Chunks smaller than this aren't worth a thread */
+#define WTAP_CHUNK_MIN_SIZE	(16*1024*1024)
+
+/* One chunk of a file being read by wtap_read_chunks() */
+typedef struct {
+	const char *filename;
+	int file_type_subtype;
+	gint64 begin;		/* where to start looking for a record */
+	gboolean exact;		/* a record starts at begin */
+	gint64 end;		/* records from here on are in the next chunk */
+	void *data;
+	wtap_chunk_record_func record_func;
+	const volatile gboolean *stop_flag; /* set to make us give up early */
+	gint64 start;		/* offset of the first record given, or -1 */
+	gint64 stop;		/* offset of the first record not given */
+	gboolean used;		/* records have been given for it */
+} wtap_chunk;
+
+static gpointer
+wtap_chunk_worker(gpointer arg)
+{
+	wtap_chunk *chunk = (wtap_chunk *)arg;
+	wtap *wth;
+	wtap_rec rec;
+	Buffer buf;
+	const guint8 *data;
+	gint64 off, data_offset;
+	int err;
+	gchar *err_info = NULL;
+
+	chunk->start = -1;
+	wth = wtap_open_offline(chunk->filename, WTAP_TYPE_AUTO, &err,
+	    &err_info, FALSE);
+	if (wth == NULL) {
+		g_free(err_info);
+		return NULL;
+	}
+	if (wth->file_type_subtype != chunk->file_type_subtype ||
+	    wth->subtype_find_record == NULL) {
+		wtap_close(wth);
+		return NULL;
+	}
+	wth->chunk_worker = TRUE;
+
+	if (chunk->exact)
+		off = chunk->begin;
+	else
+		off = (*wth->subtype_find_record)(wth, chunk->begin, &err,
+		    &err_info);
+	if (off == -1 || off >= chunk->end ||
+	    file_seek(wth->fh, off, SEEK_SET, &err) == -1) {
+		g_free(err_info);
+		wtap_close(wth);
+		return NULL;
+	}
+	chunk->start = off;
+
+	wtap_rec_init(&rec);
+	ws_buffer_init(&buf, 1514);
+	for (;;) {
+		off = file_tell(wth->fh);
+		if (off >= chunk->end || (chunk->stop_flag != NULL && *chunk->stop_flag))
+			break;
+		/*
+		 * Stop at anything we can't read, including the blocks the
+		 * reader leaves for wth; the caller will read from here.
+		 */
+		if (!wtap_read_borrowed(wth, &rec, &buf, &data, &err,
+		    &err_info, &data_offset)) {
+			g_free(err_info);
+			err_info = NULL;
+			break;
+		}
+		if (data_offset >= chunk->end) {
+			/* We skipped to the next chunk's records. */
+			off = data_offset;
+			break;
+		}
+		(*chunk->record_func)(chunk->data, data_offset, &rec, data);
+		chunk->used = TRUE;
+	}
+	chunk->stop = off;
+	ws_buffer_free(&buf);
+	wtap_rec_cleanup(&rec);
+	wtap_close(wth);
+	return NULL;
+}
+
+static void
+wtap_chunk_reset(wtap_chunk *chunk, wtap_chunk_reset_func reset_func)
+{
+	if (chunk->used) {
+		(*reset_func)(chunk->data);
+		chunk->used = FALSE;
+	}
+}
+
+/*
+ * Read records with wth, from *pos up to the first one at or after
+ * target, giving them for the chunk cur.  If that record starts at
+ * target, it's the first record of the next chunk, so it isn't given,
+ * and *pos is left at target.  Otherwise *pos is left after the last
+ * record read.  Returns FALSE on a read error, or if *stop is set.
+ */
+static gboolean
+wtap_chunk_fill(wtap *wth, gint64 *pos, gint64 target, wtap_chunk *cur,
+    const volatile gboolean *stop, wtap_rec *rec, Buffer *buf, int *err,
+    gchar **err_info)
+{
+	const guint8 *data;
+	gint64 data_offset;
+
+	if (*pos >= target)
+		return TRUE;
+	if (file_seek(wth->fh, *pos, SEEK_SET, err) == -1)
+		return FALSE;
+	while (*pos < target) {
+		if (stop != NULL && *stop)
+			return FALSE;
+		if (!wtap_read_borrowed(wth, rec, buf, &data, err, err_info,
+		    &data_offset)) {
+			if (*err != 0)
+				return FALSE;
+			/* End of file. */
+			*pos = G_MAXINT64;
+			break;
+		}
+		if (data_offset == target) {
+			*pos = target;
+			break;
+		}
+		(*cur->record_func)(cur->data, data_offset, rec, data);
+		cur->used = TRUE;
+		*pos = file_tell(wth->fh);
+	}
+	return TRUE;
+}
+
+gboolean
+wtap_read_chunks(wtap *wth, const char *filename, guint num_chunks,
+    void **chunk_data, wtap_chunk_record_func record_func,
+    wtap_chunk_reset_func reset_func, const volatile gboolean *stop,
+    int *err, gchar **err_info)
+{
+	wtap_chunk *chunks, *cur;
+	GThread **threads;
+	wtap_rec rec;
+	Buffer buf;
+	gint64 first, file_size, chunk_size, pos;
+	guint shb_count, i, j;
+	gboolean lost_sync = FALSE;
+	gboolean ok = TRUE;
+
+	*err = 0;
+	*err_info = NULL;
+	if (num_chunks < 2 || wth->subtype_find_record == NULL ||
+	    wth->time_window != NULL || wth->ispipe ||
+	    file_iscompressed(wth->fh))
+		return FALSE;
+
+	first = file_tell(wth->fh);
+	file_size = wtap_file_size(wth, err);
+	if (file_size == -1) {
+		*err = 0;
+		return FALSE;
+	}
+	if ((file_size - first) / num_chunks < WTAP_CHUNK_MIN_SIZE)
+		num_chunks = (guint)((file_size - first) / WTAP_CHUNK_MIN_SIZE);
+	if (num_chunks < 2)
+		return FALSE;
+	chunk_size = (file_size - first) / num_chunks;
+
+	chunks = g_new0(wtap_chunk, num_chunks);
+	threads = g_new(GThread *, num_chunks);
+	for (i = 0; i < num_chunks; i++) {
+		chunks[i].filename = filename;
+		chunks[i].file_type_subtype = wth->file_type_subtype;
+		chunks[i].begin = first + i * chunk_size;
+		chunks[i].exact = (i == 0);
+		chunks[i].end = (i == num_chunks - 1) ? G_MAXINT64 :
+		    chunks[i].begin + chunk_size;
+		chunks[i].data = chunk_data[i];
+		chunks[i].record_func = record_func;
+		chunks[i].stop_flag = stop;
+		threads[i] = g_thread_new("wtap chunk", wtap_chunk_worker,
+		    &chunks[i]);
+	}
+	for (i = 0; i < num_chunks; i++)
+		g_thread_join(threads[i]);
+	g_free(threads);
+
+	/*
+	 * Put the chunks together.  pos is where the next record we haven't
+	 * given starts, and records we read ourselves go in cur.  A chunk's
+	 * records are only the file's records if they start at pos; if
+	 * they don't, we read its part of the file ourselves.
+	 */
+	wtap_rec_init(&rec);
+	ws_buffer_init(&buf, 1514);
+	pos = first;
+	cur = &chunks[0];
+	for (i = 0; i < num_chunks && ok; i++) {
+		shb_count = wth->shb_hdrs != NULL ? wth->shb_hdrs->len : 0;
+		if (!lost_sync && chunks[i].start > pos)
+			ok = wtap_chunk_fill(wth, &pos, chunks[i].start, cur,
+			    stop, &rec, &buf, err, err_info);
+		/*
+		 * A new section means the threads, which only knew the
+		 * first one, may have read what followed wrongly.
+		 */
+		if (wth->shb_hdrs != NULL && wth->shb_hdrs->len != shb_count)
+			lost_sync = TRUE;
+		if (ok && !lost_sync && chunks[i].start != -1 &&
+		    chunks[i].start == pos) {
+			pos = chunks[i].stop;
+			cur = &chunks[i];
+		} else {
+			wtap_chunk_reset(&chunks[i], reset_func);
+		}
+	}
+	/* Whatever's left after the last chunk we used. */
+	if (ok)
+		ok = wtap_chunk_fill(wth, &pos, G_MAXINT64, cur, stop, &rec,
+		    &buf, err, err_info);
+	if (stop != NULL && *stop) {
+		/* The chunks may have been cut short anywhere; keep nothing. */
+		for (j = 0; j < num_chunks; j++)
+			wtap_chunk_reset(&chunks[j], reset_func);
+		*err = 0;
+		g_free(*err_info);
+		*err_info = NULL;
+		ok = FALSE;
+	} else if (!ok) {
+		/* Nothing after the error counts. */
+		for (j = (guint)(cur - chunks) + 1; j < num_chunks; j++)
+			wtap_chunk_reset(&chunks[j], reset_func);
+	}
+	ws_buffer_free(&buf);
+	wtap_rec_cleanup(&rec);
+	g_free(chunks);
+	return ok;
+}
+
+gboolean
+wtap_has_index(wtap *wth)
+{
+	return wth->index != NULL && wth->index->len != 0;
+}
+
+gboolean
+wtap_seek_to_time(wtap *wth, const nstime_t *ts, guint32 *skipped, int *err)
+{
+	wtap_index_entry *entry, *target = NULL;
+	guint if_count, dsb_count;
+	guint i;
+
+	*skipped = 0;
+	*err = 0;
+	if (!wtap_has_index(wth) || wth->fh == NULL)
+		return FALSE;
+
+	/*
+	 * Find the first run that might have a record at or after ts,
+	 * but don't skip over any interface descriptions or decryption
+	 * secrets we haven't seen yet; later records might need them.
+	 */
+	if_count = wth->interface_data->len;
+	dsb_count = wth->dsbs != NULL ? wth->dsbs->len : 0;
+	for (i = 0; i < wth->index->len; i++) {
+		entry = &g_array_index(wth->index, wtap_index_entry, i);
+		if (entry->if_count > if_count || entry->dsb_count > dsb_count)
+			break;
+		target = entry;
+		if (nstime_cmp(&entry->max_ts, ts) >= 0)
+			break;
+	}
+	if (target == NULL || target->first_record <= 1 ||
+	    target->offset <= file_tell(wth->fh))
+		return FALSE;
+
+	if (file_seek(wth->fh, target->offset, SEEK_SET, err) == -1)
+		return FALSE;
+	*skipped = target->first_record - 1;
+	return TRUE;
+}
+
+gboolean
+wtap_index_last_record_before(wtap *wth, const nstime_t *ts, guint32 *last)
+{
+	wtap_index_entry *entry;
+	guint i;
+
+	*last = 0;
+	if (!wtap_has_index(wth))
+		return FALSE;
+
+	for (i = 0; i < wth->index->len; i++) {
+		entry = &g_array_index(wth->index, wtap_index_entry, i);
+		if (nstime_cmp(&entry->min_ts, ts) < 0)
+			*last = entry->first_record + entry->record_count - 1;
+	}
+	return TRUE;
+}
+
+gboolean
+wtap_index_summary(wtap *wth, guint32 *packets, guint64 *data_bytes,
+    nstime_t *start_ts, nstime_t *stop_ts)
+{
+	wtap_index_entry *entry;
+	gboolean have_ts = FALSE;
+	guint i;
+
+	*packets = 0;
+	*data_bytes = 0;
+	nstime_set_zero(start_ts);
+	nstime_set_zero(stop_ts);
+	if (!wtap_has_index(wth))
+		return FALSE;
+
+	for (i = 0; i < wth->index->len; i++) {
+		entry = &g_array_index(wth->index, wtap_index_entry, i);
+		*packets += entry->packet_count;
+		*data_bytes += entry->data_bytes;
+		/* Runs whose records all lack time stamps have no range. */
+		if (nstime_is_unset(&entry->min_ts))
+			continue;
+		if (!have_ts || nstime_cmp(&entry->min_ts, start_ts) < 0)
+			*start_ts = entry->min_ts;
+		if (!have_ts || nstime_cmp(&entry->max_ts, stop_ts) > 0)
+			*stop_ts = entry->max_ts;
+		have_ts = TRUE;
+	}
+	return TRUE;
+}
+
 static gboolean
 wtap_full_file_read_file(wtap *wth, FILE_T fh, wtap_rec *rec, Buffer *buf, int *err, gchar **err_info)
 {
@@ -1534,6 +1534,9 @@ typedef struct wtap_dump_params {
     const GArray *dsbs_growing;             /**< DSBs that will be written while writing packets, or NULL.
                                                  This array may grow since the dumper was opened and will subsequently
                                                  be written before newer packets are written in wtap_dump. */
+    guint       compress_threads;           /**< Number of threads to compress gzip output on; 0 or 1 to
+                                                 compress on the writing thread only. */
+    gboolean    write_index;                /**< Write a packet index, if the file type supports one (pcapng). */
 } wtap_dump_params;
 
 /* Zero-initializer for wtap_dump_params. */
@@ -1806,6 +1809,165 @@ WS_DLL_PUBLIC
 gboolean wtap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec,
     Buffer *buf, int *err, gchar **err_info);
 
+/** Like wtap_read(), but, for uncompressed files that are memory-mapped
+ * and file types whose records don't need to be modified when read, the
+ * record data isn't copied into *buf.
+ *
+ * @param data set, on success, to point to the record data; that's
+ * either the start of *buf or a location in the mapped file.  In the
+ * latter case it remains valid until the file is closed or wtap_fdclose()
+ * is called, so it may be used after later reads.
+ *
+ * The other parameters are as for wtap_read().
+ */
+WS_DLL_PUBLIC
+gboolean wtap_read_borrowed(wtap *wth, wtap_rec *rec, Buffer *buf,
+    const guint8 **data, int *err, gchar **err_info, gint64 *offset);
+
+/** Like wtap_seek_read(), but possibly returning a pointer into the
+ * memory-mapped file rather than copying the record data into *buf;
+ * see wtap_read_borrowed().
+ */
+WS_DLL_PUBLIC
+gboolean wtap_seek_read_borrowed(wtap *wth, gint64 seek_off, wtap_rec *rec,
+    Buffer *buf, const guint8 **data, int *err, gchar **err_info);
+
+/** Called by wtap_read_chunks() for each record in a chunk, in order.
+ * Calls for different chunks can be made at the same time from
+ * different threads.
+ *
+ * @param chunk_data the caller's data for the chunk
+ * @param offset as for wtap_read()
+ * @param rec the record's metadata
+ * @param data the record's data; only valid during the call
+ */
+typedef void (*wtap_chunk_record_func)(void *chunk_data, gint64 offset,
+    wtap_rec *rec, const guint8 *data);
+
+/** Called by wtap_read_chunks() to throw away every record given for a
+ * chunk so far, when they turn out not to be the file's records. */
+typedef void (*wtap_chunk_reset_func)(void *chunk_data);
+
+/** Read all the records in a file, splitting the file into chunks that
+ * are read at the same time by different threads, each with its own
+ * handle on the file.  Each thread finds where the first record in its
+ * chunk starts; anything the threads couldn't read, such as records
+ * after a block that changes how later ones are read, is read with wth
+ * afterwards.  Putting the records for each chunk in turn after those
+ * for the chunk before gives the records wtap_read() would have
+ * returned, in the same order.
+ *
+ * Must be called before reading any records with wth.  Only some file
+ * types can be read like this, and only when they're uncompressed
+ * regular files.
+ *
+ * @param wth the file, open for sequential reading
+ * @param filename its name, for the threads to open it with
+ * @param num_chunks the most chunks to split the file into
+ * @param chunk_data the caller's data for each chunk
+ * @param record_func called for each record
+ * @param reset_func called to throw a chunk's records away
+ * @param stop if not NULL, reading stops as soon as *stop is set, e.g.
+ * from a signal handler
+ * @param err set to 0 if the file can't be read like this, or to a
+ * read error
+ * @param err_info for some errors, a string giving more details
+ * @return TRUE if every record was read.  FALSE, with *err set to 0, if
+ * the file can't be read like this, or reading was stopped, and no
+ * records were given; unless it was stopped, the caller should read it
+ * with wtap_read().  FALSE, with *err set to an error, if the file
+ * couldn't be read; the records given are the ones before the error.
+ */
+WS_DLL_PUBLIC
+gboolean wtap_read_chunks(wtap *wth, const char *filename, guint num_chunks,
+    void **chunk_data, wtap_chunk_record_func record_func,
+    wtap_chunk_reset_func reset_func, const volatile gboolean *stop,
+    int *err, gchar **err_info);
+
+/*
+ * A capture file can have an index, written by wtap_dump() when the
+ * write_index dump parameter is set; each entry describes a run of
+ * consecutive records.  It lets readers skip parts of a file without
+ * reading them.
+ */
+typedef struct wtap_index_entry {
+    guint32  first_record;  /**< Number of the first record in the run, counting from 1 */
+    guint32  record_count;  /**< Number of records in the run */
+    guint32  packet_count;  /**< Number of them that are REC_TYPE_PACKET records */
+    guint32  if_count;      /**< Number of interfaces described before the run */
+    guint32  dsb_count;     /**< Number of decryption secrets blocks before the run */
+    gint64   offset;        /**< Offset in the file of the first record */
+    guint64  data_bytes;    /**< Sum of the packets' on-the-wire lengths */
+    nstime_t min_ts;        /**< Earliest time stamp in the run; unset if no record in it has one */
+    nstime_t max_ts;        /**< Latest time stamp in the run; unset if no record in it has one */
+} wtap_index_entry;
+
+/** Does the file have an index covering all of its records? */
+WS_DLL_PUBLIC
+gboolean wtap_has_index(wtap *wth);
+
+/** Use the file's index to skip the sequential read position forward
+ * past runs of records whose time stamps are all before ts.  Call this
+ * before the first wtap_read().
+ *
+ * @param wth the file
+ * @param ts the earliest time stamp the caller is interested in
+ * @param skipped set to the number of records skipped
+ * @param err set to an error code if the seek failed
+ * @return TRUE if we skipped anything; FALSE, with *err set to 0, if
+ * there's no index or nothing could be skipped
+ */
+WS_DLL_PUBLIC
+gboolean wtap_seek_to_time(wtap *wth, const nstime_t *ts, guint32 *skipped,
+    int *err);
+
+/** Use the file's index to find how far a reader has to go to see every
+ * record with a time stamp before ts.
+ *
+ * @param last set to the number of the last record that might have a time
+ * stamp before ts, or 0 if none do
+ * @return TRUE if the file has an index, FALSE otherwise
+ */
+WS_DLL_PUBLIC
+gboolean wtap_index_last_record_before(wtap *wth, const nstime_t *ts,
+    guint32 *last);
+
+/** Have wtap_read() return only the records with time stamps in the
+ * range [start, stop), and avoid reading the rest of the file where it
+ * can: using the file's index if it has one, or, if the caller knows the
+ * records are in time stamp order and the file type supports it, by
+ * searching the file for the start.  Call this before the first
+ * wtap_read().
+ *
+ * Records without time stamps are skipped too.  The records skipped
+ * aren't seen by the caller at all, so it can't tell what number a
+ * record has in the whole file.
+ *
+ * @param wth the file
+ * @param start the earliest time stamp wanted, or NULL for no limit
+ * @param stop the time stamp records have to be before, or NULL for no
+ * limit
+ * @param ordered TRUE if the records are known to be in time stamp
+ * order, so that reading can stop at the first record after the range
+ */
+WS_DLL_PUBLIC
+void wtap_set_time_window(wtap *wth, const nstime_t *start,
+    const nstime_t *stop, gboolean ordered);
+
+/** Get totals for the whole file from its index.
+ *
+ * @param packets set to the number of REC_TYPE_PACKET records
+ * @param data_bytes set to the sum of their on-the-wire lengths
+ * @param start_ts set to the earliest time stamp, or zero if no record
+ * has one
+ * @param stop_ts set to the latest time stamp, or zero if no record has
+ * one
+ * @return TRUE if the file has an index, FALSE otherwise
+ */
+WS_DLL_PUBLIC
+gboolean wtap_index_summary(wtap *wth, guint32 *packets, guint64 *data_bytes,
+    nstime_t *start_ts, nstime_t *stop_ts);
+
 /*** initialize a wtap_rec structure ***/
 WS_DLL_PUBLIC
 void wtap_rec_init(wtap_rec *rec);
@@ -1863,6 +2025,15 @@ int wtap_file_tsprec(wtap *wth);
 WS_DLL_PUBLIC
 wtap_block_t wtap_file_get_shb(wtap *wth);
 
+/**
+ * @brief Gets the number of section headers read so far.
+ *
+ * @param wth The wiretap session.
+ * @return The number of sections seen; 1 for file types without them.
+ */
+WS_DLL_PUBLIC
+guint wtap_file_get_num_shbs(wtap *wth);
+
 /**
  * @brief Gets new section header block for new file, based on existing info.
  * @details Creates a new wtap_block_t section header block and only
@@ -1976,6 +2147,13 @@ gboolean wtap_fdreopen(wtap *wth, const char *filename, int *err);
 WS_DLL_PUBLIC
 void wtap_sequential_close(wtap *wth);
 
+/** Give a handle opened only for random access the fast seek points that
+ * another handle on the same file found when reading it sequentially, so
+ * that reading a record from a compressed file doesn't mean decompressing
+ * everything before it. This closes the sequential side of wth. */
+WS_DLL_PUBLIC
+void wtap_copy_fast_seek(wtap *wth, wtap *from);
+
 /** Closes any open file handles and frees the memory associated with wth. */
 WS_DLL_PUBLIC
 void wtap_close(wtap *wth);
@@ -139,6 +139,40 @@ struct epb {
 };
 #define ENHANCED_PACKET_BLOCK_TYPE 0x00000006
 
+/* Packet Index Block, a local-use block type listing runs of packets
+   (see the packet index in wiretap/pcapng.c), without the entries and
+   trailing Block Total Length */
+struct pib {
+        guint32 block_type;
+        guint32 block_total_length;
+        guint32 flags;
+        guint32 num_entries;
+        guint64 offset;         /* of this block */
+};
+#define PACKET_INDEX_BLOCK_TYPE 0x80574958
+#define PIB_FLAG_FINAL          0x00000001  /* covers the whole file */
+
+/* Packet Index Block entry, for a run of records */
+struct pib_entry {
+        guint32 first_record;   /* counting from 1 */
+        guint32 record_count;
+        guint32 packet_count;
+        guint32 if_count;       /* IDBs before the run */
+        guint32 dsb_count;      /* DSBs before the run */
+        guint32 flags;
+        guint64 offset;         /* of the first record's block */
+        guint64 data_bytes;     /* sum of the packets' original lengths */
+        gint64  min_secs;
+        gint64  max_secs;
+        guint32 min_nsecs;
+        guint32 max_nsecs;
+};
+#define PIB_ENTRY_HAS_TS        0x00000001  /* the time stamp range is set */
+
+#define PIB_RECORDS_PER_ENTRY   1024
+#define PIB_ENTRIES_PER_BLOCK   16
+#define PIB_MAX_ENTRIES         65536
+
 struct option {
         guint16 type;
         guint16 value_length;
@@ -769,6 +803,176 @@ pcapng_write_interface_statistics_block(FILE* pfile,
         return write_to_file(pfile, (const guint8*)&block_total_length, sizeof(guint32), bytes_written, err);
 }
 
+/* Indexing pcapng files */
+
+struct pcapng_index_writer {
+        GArray *entries;        /* struct pib_entry for every completed run */
+        struct pib_entry pending[PIB_ENTRIES_PER_BLOCK]; /* runs not in a periodic block yet */
+        guint num_pending;
+        guint32 run_length;     /* records per run; doubled each time we merge runs */
+        guint32 records;        /* records written so far */
+        guint32 if_count;
+        struct pib_entry cur;   /* the run being built */
+};
+
+pcapng_index_writer *
+pcapng_index_writer_new(guint32 if_count)
+{
+        pcapng_index_writer *iw = g_new0(pcapng_index_writer, 1);
+
+        iw->entries = g_array_new(FALSE, FALSE, sizeof(struct pib_entry));
+        iw->run_length = PIB_RECORDS_PER_ENTRY;
+        iw->if_count = if_count;
+        return iw;
+}
+
+void
+pcapng_index_writer_free(pcapng_index_writer *iw)
+{
+        if (iw == NULL)
+                return;
+        g_array_free(iw->entries, TRUE);
+        g_free(iw);
+}
+
+static gboolean
+pcapng_write_index_block(FILE* pfile,
+                         const struct pib_entry *entries, guint num_entries,
+                         guint32 flags,
+                         guint64 *bytes_written,
+                         int *err)
+{
+        struct pib pib;
+        size_t entries_len = num_entries * sizeof(struct pib_entry);
+
+        pib.block_type = PACKET_INDEX_BLOCK_TYPE;
+        pib.block_total_length = (guint32)(sizeof(struct pib) + entries_len + sizeof(guint32));
+        pib.flags = flags;
+        pib.num_entries = num_entries;
+        pib.offset = *bytes_written;
+        if (!write_to_file(pfile, (const guint8*)&pib, sizeof(struct pib), bytes_written, err))
+                return FALSE;
+        if (entries_len != 0) {
+                if (!write_to_file(pfile, (const guint8*)entries, entries_len, bytes_written, err))
+                        return FALSE;
+        }
+        return write_to_file(pfile, (const guint8*)&pib.block_total_length, sizeof(guint32), bytes_written, err);
+}
+
+/* Widen a run's time stamp range to include a time stamp. */
+static void
+pcapng_index_add_ts(struct pib_entry *entry, gint64 secs, guint32 nsecs)
+{
+        if (!(entry->flags & PIB_ENTRY_HAS_TS)) {
+                entry->flags |= PIB_ENTRY_HAS_TS;
+                entry->min_secs = entry->max_secs = secs;
+                entry->min_nsecs = entry->max_nsecs = nsecs;
+                return;
+        }
+        if (secs < entry->min_secs ||
+            (secs == entry->min_secs && nsecs < entry->min_nsecs)) {
+                entry->min_secs = secs;
+                entry->min_nsecs = nsecs;
+        }
+        if (secs > entry->max_secs ||
+            (secs == entry->max_secs && nsecs > entry->max_nsecs)) {
+                entry->max_secs = secs;
+                entry->max_nsecs = nsecs;
+        }
+}
+
+/* Halve the number of runs, to keep the final index to a reasonable size. */
+static void
+pcapng_index_merge_runs(pcapng_index_writer *iw)
+{
+        struct pib_entry *entries = (struct pib_entry *)(void *)iw->entries->data;
+        struct pib_entry *merged, *next;
+        guint i, n = 0;
+
+        for (i = 0; i < iw->entries->len; i += 2) {
+                merged = &entries[n++];
+                *merged = entries[i];
+                if (i + 1 < iw->entries->len) {
+                        next = &entries[i + 1];
+                        merged->record_count += next->record_count;
+                        merged->packet_count += next->packet_count;
+                        merged->data_bytes += next->data_bytes;
+                        if (next->flags & PIB_ENTRY_HAS_TS) {
+                                pcapng_index_add_ts(merged, next->min_secs, next->min_nsecs);
+                                pcapng_index_add_ts(merged, next->max_secs, next->max_nsecs);
+                        }
+                }
+        }
+        g_array_set_size(iw->entries, n);
+        iw->run_length *= 2;
+}
+
+/* Add the run being built to the index, and write a periodic index block
+   if enough runs have been added since the last one. */
+static gboolean
+pcapng_index_end_run(FILE* pfile, pcapng_index_writer *iw, gboolean periodic,
+                     guint64 *bytes_written, int *err)
+{
+        if (iw->cur.record_count == 0)
+                return TRUE;
+
+        if (iw->entries->len >= PIB_MAX_ENTRIES)
+                pcapng_index_merge_runs(iw);
+        g_array_append_val(iw->entries, iw->cur);
+        iw->pending[iw->num_pending++] = iw->cur;
+        iw->cur.record_count = 0;
+
+        if (periodic && iw->num_pending == PIB_ENTRIES_PER_BLOCK) {
+                if (!pcapng_write_index_block(pfile, iw->pending, iw->num_pending, 0, bytes_written, err))
+                        return FALSE;
+                iw->num_pending = 0;
+        }
+        return TRUE;
+}
+
+gboolean
+pcapng_index_add_packet(FILE* pfile,
+                        pcapng_index_writer *iw,
+                        time_t sec, guint32 nsec,
+                        guint32 len,
+                        guint64 *bytes_written,
+                        int *err)
+{
+        struct pib_entry *cur = &iw->cur;
+
+        if (cur->record_count >= iw->run_length) {
+                if (!pcapng_index_end_run(pfile, iw, TRUE, bytes_written, err))
+                        return FALSE;
+        }
+
+        if (cur->record_count == 0) {
+                memset(cur, 0, sizeof *cur);
+                cur->first_record = iw->records + 1;
+                cur->if_count = iw->if_count;
+                cur->offset = *bytes_written;
+        }
+        pcapng_index_add_ts(cur, (gint64)sec, nsec);
+        cur->record_count++;
+        cur->packet_count++;
+        cur->data_bytes += len;
+        iw->records++;
+        return TRUE;
+}
+
+gboolean
+pcapng_write_final_index_block(FILE* pfile,
+                               pcapng_index_writer *iw,
+                               guint64 *bytes_written,
+                               int *err)
+{
+        if (!pcapng_index_end_run(pfile, iw, FALSE, bytes_written, err))
+                return FALSE;
+        return pcapng_write_index_block(pfile,
+                                        (const struct pib_entry *)(void *)iw->entries->data,
+                                        iw->entries->len, PIB_FLAG_FINAL,
+                                        bytes_written, err);
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -98,6 +98,42 @@ pcapng_write_enhanced_packet_block(FILE* pfile,
                                    guint64 *bytes_written,
                                    int *err);
 
+/* Indexing pcapng files */
+
+/** State for writing packet index blocks, a local-use block type that
+   lets readers seek by time and get totals without reading every packet.
+   Indexes only files whose packets are all written with
+   pcapng_write_enhanced_packet_block(). */
+typedef struct pcapng_index_writer pcapng_index_writer;
+
+/** Start indexing a file whose SHB and if_count IDBs have been written */
+extern pcapng_index_writer *
+pcapng_index_writer_new(guint32 if_count);
+
+extern void
+pcapng_index_writer_free(pcapng_index_writer *iw);
+
+/** Note a packet about to be written; call it before writing the packet's
+   EPB. Every so often this first writes an index block covering the most
+   recent packets.
+   Returns TRUE on success, FALSE on failure. */
+extern gboolean
+pcapng_index_add_packet(FILE* pfile,
+                        pcapng_index_writer *iw,
+                        time_t sec, guint32 nsec,
+                        guint32 len,
+                        guint64 *bytes_written,
+                        int *err);
+
+/** Write the index block covering the whole file. It has to be the last
+   block in the file, so that readers can find it.
+   Returns TRUE on success, FALSE on failure. */
+extern gboolean
+pcapng_write_final_index_block(FILE* pfile,
+                               pcapng_index_writer *iw,
+                               guint64 *bytes_written,
+                               int *err);
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -57,6 +57,17 @@ get_cpu_info(GString *str)
         g_string_append(str, " (with SSE4.2)");
 }
 
+guint
+get_num_processors(void)
+{
+#if GLIB_CHECK_VERSION(2,36,0)
+    return g_get_num_processors();
+#else
+    /* We don't know how many processors there are; assume a few. */
+    return 4;
+#endif
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -21,6 +21,13 @@ extern "C" {
 
 WS_DLL_PUBLIC void get_cpu_info(GString *str);
 
+/*
+ * Number of processors available to the process, for sizing thread pools.
+ * With GLib older than 2.36 it can't be found out, and a small default is
+ * returned instead.
+ */
+WS_DLL_PUBLIC guint get_num_processors(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
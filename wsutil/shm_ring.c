@@ -0,0 +1,329 @@
+/* shm_ring.c
+ * Single-producer, single-consumer record ring in shared memory
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef HAVE_SHM_OPEN
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "ws_attributes.h"
+
+#include "shm_ring.h"
+
+#define SHM_RING_MAGIC		0x57535252	/* "WSRR" */
+#define SHM_RING_MAX_SIZE	(1U << 30)
+
+/* Records are a 4-byte length followed by the data, padded to 8 bytes. */
+#define SHM_RING_ALIGN(n)	(((n) + 7U) & ~7U)
+/* Length value saying the rest of the area is unused; go back to the start */
+#define SHM_RING_WRAP		0xFFFFFFFFU
+
+/* Consumer states */
+#define SHM_RING_UNDECIDED	0
+#define SHM_RING_ACCEPTED	1
+#define SHM_RING_DECLINED	2
+
+/*
+ * The header at the start of the shared memory. The positions are byte
+ * counts that only ever increase, wrapping at 2^32; the offset into the
+ * record area is the position modulo the size. Each side's position is
+ * on its own cache line.
+ */
+typedef struct {
+	guint32 magic;
+	guint32 size;
+	volatile gint consumer;		/* SHM_RING_ consumer state */
+	volatile gint overflowed;
+	guint8 pad1[64 - 4 * sizeof(guint32)];
+	volatile gint head;		/* written by the producer */
+	guint8 pad2[64 - sizeof(gint)];
+	volatile gint tail;		/* written by the consumer */
+	guint8 pad3[64 - sizeof(gint)];
+} shm_ring_hdr_t;
+
+struct _shm_ring {
+	char *name;			/* NULL for the consumer */
+	shm_ring_hdr_t *hdr;
+	guint8 *data;			/* the record area */
+	guint32 size;
+	guint32 pos;			/* our copy of our own position */
+	guint32 peeked_len;		/* consumer: size of the peeked record */
+	gsize map_size;
+};
+
+#ifdef HAVE_SHM_OPEN
+
+static shm_ring_t *
+shm_ring_map(int fd, gsize map_size, int *err)
+{
+	shm_ring_t *ring;
+	void *map;
+
+	map = mmap(NULL, map_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		*err = errno;
+		return NULL;
+	}
+
+	ring = g_new0(shm_ring_t, 1);
+	ring->hdr = (shm_ring_hdr_t *)map;
+	ring->data = (guint8 *)map + sizeof(shm_ring_hdr_t);
+	ring->map_size = map_size;
+	return ring;
+}
+
+shm_ring_t *
+shm_ring_create(const char *name, guint32 size, int *err)
+{
+	shm_ring_t *ring;
+	guint32 ring_size = 4096;
+	gsize map_size;
+	int fd;
+
+	while (ring_size < size && ring_size < SHM_RING_MAX_SIZE)
+		ring_size <<= 1;
+	map_size = sizeof(shm_ring_hdr_t) + ring_size;
+
+	fd = shm_open(name, O_RDWR|O_CREAT|O_EXCL, 0600);
+	if (fd == -1) {
+		*err = errno;
+		return NULL;
+	}
+	if (ftruncate(fd, (off_t)map_size) == -1) {
+		*err = errno;
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+	ring = shm_ring_map(fd, map_size, err);
+	close(fd);
+	if (ring == NULL) {
+		shm_unlink(name);
+		return NULL;
+	}
+
+	ring->name = g_strdup(name);
+	ring->size = ring_size;
+	ring->hdr->size = ring_size;
+	ring->hdr->consumer = SHM_RING_UNDECIDED;
+	ring->hdr->overflowed = FALSE;
+	ring->hdr->head = 0;
+	ring->hdr->tail = 0;
+	/* Publish the magic number last, so an opener sees a complete header. */
+	g_atomic_int_set((volatile gint *)&ring->hdr->magic, SHM_RING_MAGIC);
+	return ring;
+}
+
+shm_ring_t *
+shm_ring_open(const char *name, int *err)
+{
+	shm_ring_t *ring;
+	struct stat st;
+	int fd;
+
+	fd = shm_open(name, O_RDWR, 0);
+	if (fd == -1) {
+		*err = errno;
+		return NULL;
+	}
+	/* Nobody else needs the name now. */
+	shm_unlink(name);
+
+	if (fstat(fd, &st) == -1) {
+		*err = errno;
+		close(fd);
+		return NULL;
+	}
+	if ((gsize)st.st_size <= sizeof(shm_ring_hdr_t)) {
+		*err = EINVAL;
+		close(fd);
+		return NULL;
+	}
+	ring = shm_ring_map(fd, (gsize)st.st_size, err);
+	close(fd);
+	if (ring == NULL)
+		return NULL;
+
+	if ((guint32)g_atomic_int_get((volatile gint *)&ring->hdr->magic) != SHM_RING_MAGIC ||
+	    ring->hdr->size == 0 || (ring->hdr->size & (ring->hdr->size - 1)) != 0 ||
+	    sizeof(shm_ring_hdr_t) + ring->hdr->size > ring->map_size) {
+		*err = EINVAL;
+		shm_ring_close(ring);
+		return NULL;
+	}
+	ring->size = ring->hdr->size;
+	ring->pos = (guint32)g_atomic_int_get(&ring->hdr->tail);
+	return ring;
+}
+
+void
+shm_ring_close(shm_ring_t *ring)
+{
+	if (ring == NULL)
+		return;
+
+	munmap(ring->hdr, ring->map_size);
+	if (ring->name != NULL) {
+		/* The consumer has usually unlinked it already. */
+		shm_unlink(ring->name);
+		g_free(ring->name);
+	}
+	g_free(ring);
+}
+
+#else /* HAVE_SHM_OPEN */
+
+shm_ring_t *
+shm_ring_create(const char *name _U_, guint32 size _U_, int *err)
+{
+	*err = ENOSYS;
+	return NULL;
+}
+
+shm_ring_t *
+shm_ring_open(const char *name _U_, int *err)
+{
+	*err = ENOSYS;
+	return NULL;
+}
+
+void
+shm_ring_close(shm_ring_t *ring _U_)
+{
+}
+
+#endif /* HAVE_SHM_OPEN */
+
+static void
+shm_ring_set_overflowed(shm_ring_t *ring)
+{
+	g_atomic_int_set(&ring->hdr->overflowed, TRUE);
+}
+
+gboolean
+shm_ring_put(shm_ring_t *ring, const void *hdr, guint32 hdr_len,
+    const void *data, guint32 data_len)
+{
+	guint32 rec_len, need, used, off, contig;
+	guint32 head = ring->pos;
+	guint32 wrap = SHM_RING_WRAP;
+	guint8 *p;
+
+	if (g_atomic_int_get(&ring->hdr->overflowed) ||
+	    g_atomic_int_get(&ring->hdr->consumer) == SHM_RING_DECLINED)
+		return FALSE;
+
+	rec_len = hdr_len + data_len;
+	need = SHM_RING_ALIGN(4 + rec_len);
+	if (rec_len < data_len || need > ring->size / 2) {
+		shm_ring_set_overflowed(ring);
+		return FALSE;
+	}
+
+	used = head - (guint32)g_atomic_int_get(&ring->hdr->tail);
+	off = head & (ring->size - 1);
+	contig = ring->size - off;
+	if (contig < need) {
+		/* Skip the rest of the area and start again at the beginning. */
+		if (used + contig + need > ring->size) {
+			shm_ring_set_overflowed(ring);
+			return FALSE;
+		}
+		memcpy(ring->data + off, &wrap, 4);
+		head += contig;
+		off = 0;
+	} else if (used + need > ring->size) {
+		shm_ring_set_overflowed(ring);
+		return FALSE;
+	}
+
+	p = ring->data + off;
+	memcpy(p, &rec_len, 4);
+	memcpy(p + 4, hdr, hdr_len);
+	if (data_len != 0)
+		memcpy(p + 4 + hdr_len, data, data_len);
+
+	/* Make the record visible to the consumer. */
+	ring->pos = head + need;
+	g_atomic_int_set(&ring->hdr->head, (gint)ring->pos);
+	return TRUE;
+}
+
+gboolean
+shm_ring_in_use(shm_ring_t *ring)
+{
+	return g_atomic_int_get(&ring->hdr->consumer) == SHM_RING_ACCEPTED &&
+	    !g_atomic_int_get(&ring->hdr->overflowed);
+}
+
+void
+shm_ring_accept(shm_ring_t *ring, gboolean accept)
+{
+	g_atomic_int_set(&ring->hdr->consumer,
+	    accept ? SHM_RING_ACCEPTED : SHM_RING_DECLINED);
+}
+
+const guint8 *
+shm_ring_peek(shm_ring_t *ring, guint32 *len)
+{
+	guint32 head = (guint32)g_atomic_int_get(&ring->hdr->head);
+	guint32 off, rec_len;
+
+	while (ring->pos != head) {
+		off = ring->pos & (ring->size - 1);
+		memcpy(&rec_len, ring->data + off, 4);
+		if (rec_len == SHM_RING_WRAP) {
+			ring->pos += ring->size - off;
+			continue;
+		}
+		if (rec_len > ring->size - off - 4) {
+			/* Corrupt; don't read past the end of the area. */
+			return NULL;
+		}
+		ring->peeked_len = SHM_RING_ALIGN(4 + rec_len);
+		*len = rec_len;
+		return ring->data + off + 4;
+	}
+	return NULL;
+}
+
+void
+shm_ring_consume(shm_ring_t *ring)
+{
+	ring->pos += ring->peeked_len;
+	ring->peeked_len = 0;
+	g_atomic_int_set(&ring->hdr->tail, (gint)ring->pos);
+}
+
+gboolean
+shm_ring_overflowed(shm_ring_t *ring)
+{
+	return g_atomic_int_get(&ring->hdr->overflowed);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,107 @@
+/* shm_ring.h
+ * Single-producer, single-consumer record ring in shared memory
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WSUTIL_SHM_RING_H__
+#define __WSUTIL_SHM_RING_H__
+
+#include <glib.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * A ring of variable-length records in a named shared memory object, for
+ * passing data from one process to another without copying it through a
+ * pipe or a file. There must be exactly one producer and one consumer.
+ *
+ * The producer never waits for the consumer; if a record doesn't fit, the
+ * ring is marked as overflowed and nothing more is put into it, so the
+ * consumer has to get anything after that some other way. The consumer
+ * tells the producer, through the ring, whether it is going to use it at
+ * all.
+ *
+ * Only available on platforms with POSIX shared memory; elsewhere
+ * creating or opening a ring always fails.
+ */
+
+typedef struct _shm_ring shm_ring_t;
+
+/** Create a ring for producing into.
+ *
+ * @param name name of the shared memory object, e.g. "/wireshark-1234"
+ * @param size size of the record area; rounded up to a power of 2
+ * @param err set to an errno value on failure
+ * @return the ring, or NULL on failure
+ */
+WS_DLL_PUBLIC shm_ring_t *shm_ring_create(const char *name, guint32 size, int *err);
+
+/** Open a ring created by another process, for consuming from. The name
+ * is unlinked once it's open, so the ring goes away when both sides have
+ * closed it.
+ *
+ * @param name name the producer created the ring with
+ * @param err set to an errno value on failure
+ * @return the ring, or NULL on failure
+ */
+WS_DLL_PUBLIC shm_ring_t *shm_ring_open(const char *name, int *err);
+
+/** Unmap the ring; the producer also unlinks its name. */
+WS_DLL_PUBLIC void shm_ring_close(shm_ring_t *ring);
+
+/** Producer: append a record made of hdr followed by data.
+ *
+ * @return TRUE if it was added, FALSE if the ring has overflowed (now or
+ * earlier) or the consumer has declined it
+ */
+WS_DLL_PUBLIC gboolean shm_ring_put(shm_ring_t *ring, const void *hdr, guint32 hdr_len,
+    const void *data, guint32 data_len);
+
+/** Producer: has the consumer said it's reading everything from the
+ * ring, and has everything put so far fit? */
+WS_DLL_PUBLIC gboolean shm_ring_in_use(shm_ring_t *ring);
+
+/** Consumer: tell the producer whether we'll be reading from the ring. */
+WS_DLL_PUBLIC void shm_ring_accept(shm_ring_t *ring, gboolean accept);
+
+/** Consumer: get the oldest record without removing it.
+ *
+ * @param len set to the length of the record
+ * @return the record, or NULL if there are none
+ */
+WS_DLL_PUBLIC const guint8 *shm_ring_peek(shm_ring_t *ring, guint32 *len);
+
+/** Consumer: remove the record returned by the last shm_ring_peek(). */
+WS_DLL_PUBLIC void shm_ring_consume(shm_ring_t *ring);
+
+/** Has the producer stopped putting records into the ring because one
+ * didn't fit? */
+WS_DLL_PUBLIC gboolean shm_ring_overflowed(shm_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WSUTIL_SHM_RING_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */